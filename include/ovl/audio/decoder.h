@@ -40,6 +40,22 @@ struct ovl_audio_decoder_vtable {
    * @return true on success, false on failure.
    */
   NODISCARD bool (*seek)(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err);
+  /**
+   * @brief Seeks to a decodable point, such as a page or frame start, at or before a sample position.
+   *
+   * Optional. Decoders whose exact seeks decode and discard audio up to the target implement this so
+   * that callers which decode forward anyway, such as reverse playback, can keep everything they decode.
+   * When the nearest known point is far before position, implementations fall back to an exact seek.
+   * @param d Pointer to the context.
+   * @param position Desired position.
+   * @param actual Receives the position the decoder landed on, never greater than position.
+   * @param err Error information.
+   * @return true on success, false on failure.
+   */
+  NODISCARD bool (*seek_keyframe)(struct ovl_audio_decoder *const d,
+                                  uint64_t const position,
+                                  uint64_t *const actual,
+                                  struct ov_error *const err);
 };
 
 struct ovl_audio_decoder {
@@ -66,3 +82,21 @@ static inline NODISCARD bool
 ovl_audio_decoder_seek(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err) {
   return d->vtable->seek(d, position, err);
 }
+
+/**
+ * @brief Seeks to a decodable point at or before position.
+ * Decoders that do not implement seek_keyframe seek exactly, and actual is set to position.
+ */
+static inline NODISCARD bool ovl_audio_decoder_seek_keyframe(struct ovl_audio_decoder *const d,
+                                                             uint64_t const position,
+                                                             uint64_t *const actual,
+                                                             struct ov_error *const err) {
+  if (d->vtable->seek_keyframe) {
+    return d->vtable->seek_keyframe(d, position, actual, err);
+  }
+  if (!d->vtable->seek(d, position, err)) {
+    return false;
+  }
+  *actual = position;
+  return true;
+}
@@ -8,7 +8,10 @@ struct ovl_audio_decoder;
  * @brief Creates a new decoder_bidi context.
  * The decoder_bidi is an implementation that enables reverse playback.
  * @param source The decoder used for playback. The decoder must support
- * accurate seeking. Subsequent operations (e.g., calling read or seek)
+ * accurate seeking. Decoders that implement seek_keyframe are started from
+ * their keyframes during reverse playback, and everything decoded from there
+ * is kept, so reverse playback of formats with pre-roll does not decode audio
+ * twice. Subsequent operations (e.g., calling read or seek)
  * on the original decoder may result in undefined behavior.
  * Furthermore, since decoder_bidi does not manage the decoder's resources,
  * you should destroy the decoder after the decoder_bidi is destroyed.
@@ -27,3 +30,55 @@ NODISCARD bool ovl_audio_decoder_bidi_create(struct ovl_audio_decoder *const sou
  * on any other instance will have no effect.
  */
 void ovl_audio_decoder_bidi_set_direction(struct ovl_audio_decoder *const d, bool const reverse);
+
+/**
+ * @brief Retrieves the direction of the decoder_bidi.
+ * Wrappers use this to find out whether a decoder they were given can play in reverse.
+ * @param d The decoder_bidi context.
+ * @param reverse Receives the direction of the decoder.
+ * @return true if d is a decoder_bidi instance, false otherwise.
+ */
+NODISCARD bool ovl_audio_decoder_bidi_get_direction(struct ovl_audio_decoder *const d, bool *const reverse);
+
+/**
+ * @brief Limits the memory the decoder_bidi uses for decoded audio.
+ * Decoded audio around the playback position is kept in a window that both directions read
+ * from, so changing direction or seeking inside it decodes nothing; only reaching its edge does.
+ * The budget covers the window, the reverse prefetch span of half its size and the output buffer,
+ * so the window shrinks with the channel count. Reverse blocks adapt to the measured cost of a
+ * seek relative to decoding and never exceed half the window. The default budget is 4 MiB.
+ * @param d The decoder_bidi context.
+ * @param bytes Memory budget in bytes. Budgets too small for two minimum-sized blocks are raised.
+ * @param err Error information.
+ * @return true on success, false on failure.
+ * @note The current window is discarded, and PCM returned by the last read must not be used afterwards.
+ * This method should only be used on a decoder_bidi instance; calling it on any other instance will fail.
+ */
+NODISCARD bool ovl_audio_decoder_bidi_set_memory_budget(struct ovl_audio_decoder *const d,
+                                                        size_t const bytes,
+                                                        struct ov_error *const err);
+
+/**
+ * Counters describing the work done by a decoder_bidi.
+ * decoded / emitted is the decode overhead of the access pattern; 1.0 means nothing was decoded twice.
+ */
+struct ovl_audio_decoder_bidi_stats {
+  // Seeks issued to the wrapped decoder.
+  uint64_t seeks;
+  // Samples per channel read from the wrapped decoder, including cancelled prefetches.
+  uint64_t decoded;
+  // Samples per channel returned by read.
+  uint64_t emitted;
+  // Current reverse block size in samples per channel.
+  size_t block_size;
+  // Window size in samples per channel derived from the memory budget.
+  size_t window_size;
+};
+
+/**
+ * @brief Retrieves the counters of a decoder_bidi.
+ * @param d The decoder_bidi context.
+ * @param stats Receives the counters. Zeroed if d is not a decoder_bidi instance.
+ */
+void ovl_audio_decoder_bidi_get_stats(struct ovl_audio_decoder *const d,
+                                      struct ovl_audio_decoder_bidi_stats *const stats);
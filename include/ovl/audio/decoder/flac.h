@@ -15,3 +15,70 @@ NODISCARD bool ovl_audio_decoder_flac_create(struct ovl_source *const source,
                                              struct ovl_audio_decoder **const dp,
                                              struct ov_error *const err);
 static inline char const *ovl_audio_decoder_flac_get_file_filter(void) { return "*.flac"; }
+
+/**
+ * @brief Builds a complete seek table by scanning the frame headers of the whole stream.
+ * Without a SEEKTABLE block, libFLAC has to bisect the byte stream on every seek.
+ * The decoder also learns frame positions while decoding, and seeks that land near a known frame
+ * jump straight to it; this function makes every frame known up front.
+ * @param d The FLAC decoder context.
+ * @param background If true, the scan runs on a worker thread and this function returns immediately.
+ * Seeks keep working while the scan is in progress. The scan runs at most once per decoder.
+ * @param err Error information.
+ * @return true on success, false on failure.
+ * @note This method should only be used on a FLAC decoder instance; calling it
+ * on any other instance will fail.
+ */
+NODISCARD bool ovl_audio_decoder_flac_build_seek_table(struct ovl_audio_decoder *const d,
+                                                       bool const background,
+                                                       struct ov_error *const err);
+
+/**
+ * @brief Creates a new decoder context for a FLAC file that decodes frames on multiple threads.
+ * Frame boundaries are located by their sync code and CRC-8 protected headers, and runs of frames
+ * are decoded concurrently by worker threads that each own a libFLAC decoder. Frames are returned
+ * in stream order, so the output is identical to ovl_audio_decoder_flac_create.
+ * Unlike that decoder, it does not skip a damaged frame header; reads fail once they reach the run of
+ * frames just before it.
+ * This mode is meant for offline jobs such as verification, analysis or transcoding where throughput
+ * matters more than latency and memory; it reads ahead by several frames per thread.
+ * @param source The source to read from.
+ * @param threads The number of worker threads, or 0 to use one per logical processor.
+ * @param dp Pointer to a location where the new context will be stored.
+ * @return Error code.
+ */
+NODISCARD bool ovl_audio_decoder_flac_create_mt(struct ovl_source *const source,
+                                                size_t const threads,
+                                                struct ovl_audio_decoder **const dp,
+                                                struct ov_error *const err);
+
+/**
+ * @brief Returns the largest number of samples per channel a single frame can produce.
+ * This is the maximum block size from STREAMINFO.
+ * @param d The FLAC decoder context.
+ * @return The maximum block size, or 0 if d is not a FLAC decoder.
+ */
+size_t ovl_audio_decoder_flac_get_max_block_size(struct ovl_audio_decoder const *const d);
+
+/**
+ * @brief Decodes the next frame directly into caller-supplied planes.
+ * Unlike ovl_audio_decoder_read, samples are converted straight from libFLAC's output into dst
+ * instead of the decoder's own frame buffer. The exceptions are the first frame after a seek that
+ * libFLAC had to resolve itself, which it has already decoded into that buffer, and the multithreaded
+ * decoder; those frames are copied.
+ * Calls to this function and ovl_audio_decoder_read can be mixed freely.
+ * @param d The FLAC decoder context.
+ * @param dst Destination planes, one per channel. No alignment is required.
+ * @param capacity Number of samples each plane can hold. Must be at least
+ * ovl_audio_decoder_flac_get_max_block_size(d).
+ * @param samples Receives the number of samples written per channel, 0 at the end of the stream.
+ * @param err Error information.
+ * @return true on success, false on failure.
+ * @note This method should only be used on a FLAC decoder instance; calling it
+ * on any other instance will fail.
+ */
+NODISCARD bool ovl_audio_decoder_flac_read_into(struct ovl_audio_decoder *const d,
+                                                float *const *const dst,
+                                                size_t const capacity,
+                                                size_t *const samples,
+                                                struct ov_error *const err);
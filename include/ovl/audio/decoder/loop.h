@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_decoder;
+
+/**
+ * @brief Creates a new decoder_loop context.
+ * The decoder_loop is an implementation that plays the loop region given by the
+ * tag of the source decoder over and over, with sample accuracy.
+ * The region starts at loop_start and is loop_length samples long; without a
+ * loop_length it ends after the sample at loop_end, which is inclusive like the
+ * end of a smpl chunk loop. The region is clipped to the end of the stream.
+ * Without a valid region, the decoder_loop plays the source as is.
+ *
+ * The head of the loop is decoded once at creation, so wrapping around plays it
+ * from memory instead of seeking at the loop point; the source is moved past
+ * the head on a worker thread while the head plays. Loops shorter than one
+ * second are kept in memory entirely and never seek again.
+ * Positions and the length reported by get_info are those of the source; reading
+ * from a position past the loop end plays on to the end of the stream.
+ * @param source The decoder used for playback. The decoder must support
+ * accurate seeking. Subsequent operations (e.g., calling read or seek)
+ * on the original decoder may result in undefined behavior.
+ * Furthermore, since decoder_loop does not manage the decoder's resources,
+ * you should destroy the decoder after the decoder_loop is destroyed.
+ * @param dp Pointer to a location where the new context will be stored.
+ * @return Error code.
+ */
+NODISCARD bool ovl_audio_decoder_loop_create(struct ovl_audio_decoder *const source,
+                                             struct ovl_audio_decoder **const dp,
+                                             struct ov_error *const err);
+
+/**
+ * @brief Enables or disables wrapping at the loop end.
+ * When disabled, playback continues past the loop end to the end of the stream,
+ * e.g. to play the outro of a piece of background music. Looping is enabled by default.
+ * @param d The decoder_loop context.
+ * @param enabled Whether to wrap at the loop end.
+ * @note This method should only be used on a decoder_loop instance; calling it
+ * on any other instance will have no effect.
+ */
+void ovl_audio_decoder_loop_set_enabled(struct ovl_audio_decoder *const d, bool const enabled);
+
+/**
+ * @brief Retrieves the loop region in use.
+ * @param d The decoder_loop context.
+ * @param start Receives the first sample of the loop.
+ * @param end Receives the sample after the last sample of the loop.
+ * @return true if the source has a valid loop region, false otherwise or if d is not a decoder_loop instance.
+ */
+NODISCARD bool ovl_audio_decoder_loop_get_region(struct ovl_audio_decoder *const d,
+                                                 uint64_t *const start,
+                                                 uint64_t *const end);
@@ -14,4 +14,16 @@ struct ovl_source;
 NODISCARD bool ovl_audio_decoder_opus_create(struct ovl_source *const source,
                                              struct ovl_audio_decoder **const dp,
                                              struct ov_error *const err);
+
+/**
+ * @brief Creates a new decoder context for an Opus file that decodes through 16-bit integers.
+ * Output is quantized to 16 bits before it is converted to float, which loses precision
+ * but halves the size of the intermediate interleaved buffer.
+ * @param source The source to read from.
+ * @param dp Pointer to a location where the new context will be stored.
+ * @return Error code.
+ */
+NODISCARD bool ovl_audio_decoder_opus_create_low_memory(struct ovl_source *const source,
+                                                        struct ovl_audio_decoder **const dp,
+                                                        struct ov_error *const err);
 static inline char const *ovl_audio_decoder_opus_get_file_filter(void) { return "*.opus"; }
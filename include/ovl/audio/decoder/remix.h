@@ -0,0 +1,50 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_decoder;
+
+enum ovl_audio_decoder_remix_order {
+  ovl_audio_decoder_remix_order_wave,   /**< WAVE order, also used by FLAC: L R C LFE, then back and side pairs */
+  ovl_audio_decoder_remix_order_vorbis, /**< Vorbis order, also used by Opus: L C R, surrounds, LFE last */
+};
+
+/**
+ * @brief Creates a new decoder_remix context with a standard matrix.
+ * The decoder_remix mixes the channels of another decoder into a different channel count.
+ * With a standard matrix, layouts of up to 8 channels are folded down to stereo the usual way: center
+ * and surrounds at -3 dB into their side, LFE dropped. Mono output is the average of that stereo fold-down.
+ * Mono and stereo sources are spread onto the front pair of larger layouts, leaving the other channels
+ * silent, and a source that already has the requested channel count is passed through.
+ * The result is not normalized, so a loud multichannel source can exceed 1.0 after a fold-down.
+ * @param source The decoder used for playback. Subsequent operations (e.g., calling read or seek)
+ * on the original decoder may result in undefined behavior. Furthermore, since decoder_remix does not
+ * manage the decoder's resources, you should destroy the decoder after the decoder_remix is destroyed.
+ * @param channels The output channel count.
+ * @param order The channel order of the source; the Vorbis and Opus decoders return Vorbis order.
+ * @param dp Pointer to a location where the new context will be stored.
+ * @return Error code. Fails with ov_error_generic_invalid_argument when there is no standard matrix
+ * from the source layout to the requested channel count.
+ */
+NODISCARD bool ovl_audio_decoder_remix_create(struct ovl_audio_decoder *const source,
+                                              size_t const channels,
+                                              enum ovl_audio_decoder_remix_order const order,
+                                              struct ovl_audio_decoder **const dp,
+                                              struct ov_error *const err);
+
+/**
+ * @brief Creates a new decoder_remix context with a custom matrix.
+ * Output channel o is the sum over source channels i of matrix[o * source channels + i] times channel i.
+ * A matrix in which every output takes one source channel at unity gain, or none, is a pure remap:
+ * read then returns the planes of the source without copying them.
+ * @param source The decoder used for playback, as in ovl_audio_decoder_remix_create.
+ * @param channels The output channel count.
+ * @param matrix channels rows of linear gains, one per source channel. Copied; NaN is rejected.
+ * @param dp Pointer to a location where the new context will be stored.
+ * @return Error code.
+ */
+NODISCARD bool ovl_audio_decoder_remix_create_matrix(struct ovl_audio_decoder *const source,
+                                                     size_t const channels,
+                                                     float const *const matrix,
+                                                     struct ovl_audio_decoder **const dp,
+                                                     struct ov_error *const err);
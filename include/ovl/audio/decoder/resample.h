@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_decoder;
+
+/**
+ * @brief Creates a new decoder_resample context.
+ * The decoder_resample converts the output of another decoder to a different sample rate
+ * with r8brain-free-src at 24-bit precision. Audio is streamed through in fixed-size blocks
+ * using buffers allocated at creation, and the info reports the converted rate, length and
+ * loop points.
+ * Seeking is sample accurate: the source is started slightly earlier on the grid where both
+ * rates meet, so the filter has the same history as in linear playback.
+ * @param source The decoder used for playback. The decoder must support accurate seeking.
+ * Subsequent operations (e.g., calling read or seek) on the original decoder may result in
+ * undefined behavior. Furthermore, since decoder_resample does not manage the decoder's
+ * resources, you should destroy the decoder after the decoder_resample is destroyed.
+ * @param sample_rate The output sample rate.
+ * @param threads The number of threads that resample channels in parallel, including the
+ * calling thread, or 0 to use one per channel up to the number of logical processors.
+ * Blocks too small to be worth splitting are always resampled on the calling thread.
+ * @param dp Pointer to a location where the new context will be stored.
+ * @return Error code.
+ */
+NODISCARD bool ovl_audio_decoder_resample_create(struct ovl_audio_decoder *const source,
+                                                 size_t const sample_rate,
+                                                 size_t const threads,
+                                                 struct ovl_audio_decoder **const dp,
+                                                 struct ov_error *const err);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_decoder;
+
+/**
+ * @brief Creates a new decoder_stretch context.
+ * The decoder_stretch changes the tempo and the pitch of another decoder independently,
+ * using signalsmith-stretch. Tempo and pitch can be changed between any two reads; this
+ * never allocates, and the change is heard from the next read on.
+ * Every read returns block_size samples, except at the end of the stream.
+ * Positions given to seek and the length reported by get_info are those of the source,
+ * since the length of the output depends on the tempo over time.
+ * @param source The decoder used for playback. The decoder must support accurate seeking.
+ * Subsequent operations (e.g., calling read or seek) on the original decoder may result in
+ * undefined behavior. Furthermore, since decoder_stretch does not manage the decoder's
+ * resources, you should destroy the decoder after the decoder_stretch is destroyed.
+ * @param block_size The number of samples per channel returned by each read,
+ * or 0 for 10 milliseconds.
+ * @param dp Pointer to a location where the new context will be stored.
+ * @return Error code.
+ */
+NODISCARD bool ovl_audio_decoder_stretch_create(struct ovl_audio_decoder *const source,
+                                                size_t const block_size,
+                                                struct ovl_audio_decoder **const dp,
+                                                struct ov_error *const err);
+
+/**
+ * @brief Sets the playback speed without changing the pitch.
+ * @param d The decoder_stretch context.
+ * @param tempo Source samples played per output sample; 1.0 is the original speed.
+ * Clamped to the range 0.25 to 4.0.
+ * @note This method should only be used on a decoder_stretch instance; calling it
+ * on any other instance will have no effect.
+ */
+void ovl_audio_decoder_stretch_set_tempo(struct ovl_audio_decoder *const d, double const tempo);
+
+/**
+ * @brief Sets the pitch shift without changing the speed.
+ * @param d The decoder_stretch context.
+ * @param semitones Pitch shift in semitones; 0.0 keeps the original pitch.
+ * @note This method should only be used on a decoder_stretch instance; calling it
+ * on any other instance will have no effect.
+ */
+void ovl_audio_decoder_stretch_set_pitch(struct ovl_audio_decoder *const d, double const semitones);
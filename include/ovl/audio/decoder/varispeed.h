@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_decoder;
+
+enum ovl_audio_decoder_varispeed_interpolation {
+  ovl_audio_decoder_varispeed_interpolation_linear,  /**< Two-point linear, the cheapest */
+  ovl_audio_decoder_varispeed_interpolation_hermite, /**< Four-point third-order Hermite, fewer artifacts */
+};
+
+/**
+ * @brief Creates a new decoder_varispeed context.
+ * The decoder_varispeed plays another decoder at a variable rate like a tape machine, so pitch follows speed.
+ * It is meant for scrubbing and tape effects on many voices at once: every read returns block_size samples,
+ * the rate is ramped linearly from the previous block's rate to the current one across each block, and read
+ * interpolates into buffers allocated at creation, so it never allocates.
+ * Negative rates play backwards when the source is a decoder_bidi. The direction is changed by ramping down
+ * to a standstill, then continuing from the same position in the other direction, so direction changes do
+ * not click either.
+ * Positions given to seek and the length reported by get_info are those of the source.
+ * Playback stops at either end of the source; a seek, or a change of direction, starts it again.
+ * @param source The decoder used for playback. The decoder must support accurate seeking.
+ * Subsequent operations (e.g., calling read or seek) on the original decoder may result in
+ * undefined behavior. Furthermore, since decoder_varispeed does not manage the decoder's
+ * resources, you should destroy the decoder after the decoder_varispeed is destroyed.
+ * @param block_size The number of samples per channel returned by each read,
+ * or 0 for 10 milliseconds.
+ * @param dp Pointer to a location where the new context will be stored.
+ * @return Error code.
+ */
+NODISCARD bool ovl_audio_decoder_varispeed_create(struct ovl_audio_decoder *const source,
+                                                  size_t const block_size,
+                                                  struct ovl_audio_decoder **const dp,
+                                                  struct ov_error *const err);
+
+/**
+ * @brief Sets the playback rate reached at the end of the next block.
+ * @param d The decoder_varispeed context.
+ * @param rate Source samples played per output sample; 1.0 is the original speed, 0.0 holds the current
+ * position. Clamped to the range -8.0 to 8.0. Negative rates are treated as 0.0 unless the source is a
+ * decoder_bidi.
+ * @note This method should only be used on a decoder_varispeed instance; calling it
+ * on any other instance will have no effect.
+ */
+void ovl_audio_decoder_varispeed_set_rate(struct ovl_audio_decoder *const d, double const rate);
+
+/**
+ * @brief Selects the interpolation. The default is ovl_audio_decoder_varispeed_interpolation_hermite.
+ * @param d The decoder_varispeed context.
+ * @param interpolation The interpolation used from the next read on.
+ * @note This method should only be used on a decoder_varispeed instance; calling it
+ * on any other instance will have no effect.
+ */
+void ovl_audio_decoder_varispeed_set_interpolation(struct ovl_audio_decoder *const d,
+                                                   enum ovl_audio_decoder_varispeed_interpolation const interpolation);
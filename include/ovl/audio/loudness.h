@@ -0,0 +1,84 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include <ovl/audio/decoder/remix.h>
+
+struct ovl_audio_decoder;
+
+/**
+ * @brief Loudness and peak measurements of a stream, following ITU-R BS.1770-4 and EBU Tech 3342.
+ */
+struct ovl_audio_loudness {
+  double integrated;  /**< Gated integrated loudness in LUFS, or -INFINITY when every block is gated out */
+  double range;       /**< Loudness range in LU, 0 for streams shorter than one 3 s window */
+  double sample_peak; /**< Highest absolute sample value, linear */
+  double true_peak;   /**< Highest absolute value of the 4x oversampled signal, linear; at least sample_peak */
+};
+
+/**
+ * @brief Measures the loudness of a stream.
+ * The decoder is seeked to the start and read to the end. Channels are weighted by their role in the
+ * given order: surrounds count 1.41 times and LFE is left out. Layouts of more than 8 channels weight
+ * every channel 1.
+ * @param decoder The decoder to measure. It is not destroyed.
+ * @param order The channel order of the decoder; the Vorbis and Opus decoders return Vorbis order.
+ * @param loudness Receives the measurements.
+ * @param err Error information output.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_loudness_analyze(struct ovl_audio_decoder *const decoder,
+                                          enum ovl_audio_decoder_remix_order const order,
+                                          struct ovl_audio_loudness *const loudness,
+                                          struct ov_error *const err);
+
+/**
+ * @brief Callbacks that hand the items of a batch to ovl_audio_loudness_analyze_batch.
+ * Both are called from worker threads, at most once per item, and for different items at the same time.
+ */
+struct ovl_audio_loudness_batch {
+  void *userdata;
+  /**
+   * Creates the decoder of an item, along with anything it reads from.
+   *
+   * @param userdata The userdata of the batch.
+   * @param index The item.
+   * @param dp Receives the decoder.
+   * @param order Receives the channel order of the decoder.
+   * @param err Error information output.
+   * @return true on success, false on failure.
+   */
+  NODISCARD bool (*open)(void *const userdata,
+                         size_t const index,
+                         struct ovl_audio_decoder **const dp,
+                         enum ovl_audio_decoder_remix_order *const order,
+                         struct ov_error *const err);
+  /**
+   * Destroys a decoder created by open, along with anything it reads from.
+   *
+   * @param userdata The userdata of the batch.
+   * @param index The item.
+   * @param dp The decoder.
+   */
+  void (*close)(void *const userdata, size_t const index, struct ovl_audio_decoder **const dp);
+};
+
+/**
+ * @brief Measures the loudness of many streams on a pool of threads.
+ * Items are handed out one at a time to whichever thread is free, the calling thread included, so
+ * long and short items balance out. An item that fails does not stop the others: its error is
+ * reported and its entry in succeeded is false.
+ * @param batch The callbacks that open and close the items.
+ * @param count The number of items.
+ * @param threads The number of threads, including the calling thread, or 0 to use one per logical processor.
+ * @param results Receives count measurements.
+ * @param succeeded Receives count flags telling which items were measured.
+ * @param err Error information output.
+ * @return true on success, false on failure. Items that fail do not make the batch fail.
+ */
+NODISCARD bool ovl_audio_loudness_analyze_batch(struct ovl_audio_loudness_batch const *const batch,
+                                                size_t const count,
+                                                size_t const threads,
+                                                struct ovl_audio_loudness *const results,
+                                                bool *const succeeded,
+                                                struct ov_error *const err);
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_decoder;
+struct ovl_audio_mixer;
+
+/**
+ * @brief Creates a new mixer.
+ * The mixer plays up to a fixed number of voices, each reading from an ovl_audio_decoder, and sums them
+ * into a planar output bus one block at a time.
+ *
+ * The mixer is split between threads: ovl_audio_mixer_render runs on a single audio thread, while the
+ * voice functions may be called from any number of control threads at the same time. Control threads never
+ * touch a voice directly; they post commands to a lock-free queue that render applies at the start of the
+ * next block, so render never waits for a lock, and it never allocates.
+ *
+ * Gain and pan changes are ramped linearly across one block, and removing a voice fades it out over one
+ * block, so neither clicks. Voices must already be at the sample rate of the bus; wrap them in a
+ * decoder_resample if they are not.
+ * @param voices Maximum number of voices playing at the same time, up to 65535.
+ * @param channels Number of channels of the output bus.
+ * @param block_size Number of samples per channel rendered by each call to ovl_audio_mixer_render.
+ * @param mp Pointer to a location where the new mixer will be stored.
+ * @return Error code.
+ */
+NODISCARD bool ovl_audio_mixer_create(size_t const voices,
+                                      size_t const channels,
+                                      size_t const block_size,
+                                      struct ovl_audio_mixer **const mp,
+                                      struct ov_error *const err);
+
+/**
+ * @brief Destroys the mixer.
+ * Decoders of voices still playing are not destroyed; they belong to the caller.
+ * No other mixer function may be running at the same time.
+ * @param mp Pointer to the mixer; set to NULL.
+ */
+void ovl_audio_mixer_destroy(struct ovl_audio_mixer **const mp);
+
+/**
+ * @brief Renders the next block.
+ * Applies the commands posted since the last call, then reads every playing voice and mixes it into the
+ * bus. A voice whose decoder ends or fails stops on its own; failures are reported and do not stop the
+ * other voices.
+ * Must only be called from one thread at a time.
+ * @param m The mixer.
+ * @param pcm Receives the bus, one plane of block_size samples per channel. Valid until the next call.
+ * @param err Error information.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool
+ovl_audio_mixer_render(struct ovl_audio_mixer *const m, float const *const **const pcm, struct ov_error *const err);
+
+/**
+ * @brief Starts a voice.
+ * The decoder is read from the render thread from then on, so the caller must not use it until
+ * ovl_audio_mixer_voice_is_active returns false. Mono voices are panned into stereo buses with a
+ * constant-power law, and stereo voices are balanced; other layouts send channel c to bus channel
+ * c modulo the bus channel count, without panning.
+ * @param m The mixer.
+ * @param decoder The decoder to play, with at most 8 channels.
+ * @param gain Linear gain.
+ * @param pan Pan from -1.0 (left) to 1.0 (right); 0.0 is centered.
+ * @param voice Receives the handle of the voice.
+ * @param err Error information. Fails with ov_error_generic_fail when every voice is in use or the
+ * command queue is full.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_mixer_voice_add(struct ovl_audio_mixer *const m,
+                                         struct ovl_audio_decoder *const decoder,
+                                         float const gain,
+                                         float const pan,
+                                         uint32_t *const voice,
+                                         struct ov_error *const err);
+
+/**
+ * @brief Fades a voice out over one block and stops it.
+ * Handles of voices that already stopped are ignored.
+ * @param m The mixer.
+ * @param voice The handle of the voice.
+ * @param err Error information. Fails with ov_error_generic_fail when the command queue is full.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool
+ovl_audio_mixer_voice_remove(struct ovl_audio_mixer *const m, uint32_t const voice, struct ov_error *const err);
+
+/**
+ * @brief Changes the gain of a voice, ramped across the next block.
+ * @param m The mixer.
+ * @param voice The handle of the voice.
+ * @param gain Linear gain.
+ * @param err Error information. Fails with ov_error_generic_fail when the command queue is full.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_mixer_voice_set_gain(struct ovl_audio_mixer *const m,
+                                              uint32_t const voice,
+                                              float const gain,
+                                              struct ov_error *const err);
+
+/**
+ * @brief Changes the pan of a voice, ramped across the next block.
+ * @param m The mixer.
+ * @param voice The handle of the voice.
+ * @param pan Pan from -1.0 (left) to 1.0 (right); 0.0 is centered.
+ * @param err Error information. Fails with ov_error_generic_fail when the command queue is full.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_mixer_voice_set_pan(struct ovl_audio_mixer *const m,
+                                             uint32_t const voice,
+                                             float const pan,
+                                             struct ov_error *const err);
+
+/**
+ * @brief Reports whether a voice still holds its decoder.
+ * A voice is active from ovl_audio_mixer_voice_add until render has stopped it, after its decoder ended,
+ * failed or the voice was removed. Once this returns false, the mixer never touches the decoder again and
+ * the caller may destroy it.
+ * @param m The mixer.
+ * @param voice The handle of the voice.
+ * @return true while the voice is active.
+ */
+bool ovl_audio_mixer_voice_is_active(struct ovl_audio_mixer *const m, uint32_t const voice);
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_decoder;
+struct ovl_source;
+
+/**
+ * @brief Waveform peak file reader.
+ *
+ * A peak file holds a min/max/RMS pyramid of a decoded audio stream so that waveforms can be drawn
+ * at any zoom without decoding. Level 0 summarizes blocks of 256 samples and every further level halves
+ * the entry count of the one below it, up to a single entry for the whole stream.
+ *
+ * The file is little-endian with a fixed layout, so it can also be used from a memory-mapped view:
+ * - a 64-byte header: "OVLPEAK\0", u32 version, u32 channels, u32 sample rate, u32 log2 of the level 0
+ *   block, u32 level count, u32 reserved, u64 samples, then zeros,
+ * - one {u64 byte offset, u64 entry count} pair per level,
+ * - the levels, each starting on an 8-byte boundary. An entry is one {i16 min, i16 max, u16 rms} triple
+ *   per channel, with min and max scaled by 32767 and rms by 65535, clamped to their range.
+ */
+struct ovl_audio_peak;
+
+struct ovl_audio_peak_info {
+  uint64_t samples;   /**< Samples per channel in the summarized stream */
+  size_t sample_rate; /**< Sample rate of the summarized stream */
+  size_t channels;    /**< Channel count of the summarized stream */
+  size_t block;       /**< Samples per entry at level 0 */
+  size_t levels;      /**< Number of levels in the pyramid */
+};
+
+struct ovl_audio_peak_value {
+  float min; /**< Lowest sample value */
+  float max; /**< Highest sample value */
+  float rms; /**< Root mean square of the samples */
+};
+
+/**
+ * @brief Decodes a stream once and writes its peak file.
+ * The stream is split into as many segments as there are decoders, and every segment after the first
+ * is decoded on its own thread. All decoders must read the same stream from independent sources; each one
+ * is seeked to the start of its segment. More than one decoder requires a known sample count.
+ * @param decoders The decoders of the stream. They are not destroyed.
+ * @param count The number of decoders, at least 1.
+ * @param path Where to write the peak file, usually the path of the asset with an extra extension.
+ * An existing file is replaced.
+ * @param err Error information output.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_peak_build(struct ovl_audio_decoder *const *const decoders,
+                                    size_t const count,
+                                    NATIVE_CHAR const *const path,
+                                    struct ov_error *const err);
+
+/**
+ * @brief Opens a peak file.
+ * Only the header and the level table are read here; queries read the entries they need from the source.
+ * @param source The peak file. Since the peak reader does not manage the source's resources,
+ * you should destroy the source after the peak reader is destroyed.
+ * @param pp Pointer to a location where the new reader will be stored.
+ * @param err Error information output.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool
+ovl_audio_peak_open(struct ovl_source *const source, struct ovl_audio_peak **const pp, struct ov_error *const err);
+
+/**
+ * @brief Destroys a peak reader.
+ * @param pp Pointer to the reader.
+ */
+void ovl_audio_peak_destroy(struct ovl_audio_peak **const pp);
+
+/**
+ * @brief Gets the description of the stream a peak file summarizes.
+ * @param p The reader.
+ * @return Pointer to the description, valid until the reader is destroyed.
+ */
+struct ovl_audio_peak_info const *ovl_audio_peak_get_info(struct ovl_audio_peak const *const p);
+
+/**
+ * @brief Summarizes consecutive ranges of samples, one per pixel.
+ * Pixel i covers the samples from start + i * samples_per_pixel up to start + (i + 1) * samples_per_pixel.
+ * The coarsest level whose entries are no longer than a pixel is used, so the cost grows with the number
+ * of pixels and not with the range shown. Pixels past the end of the stream are zero.
+ * @param p The reader.
+ * @param channel The channel to summarize.
+ * @param start The first sample of the first pixel.
+ * @param samples_per_pixel The number of samples in a pixel, greater than 0.
+ * @param pixels The number of pixels.
+ * @param values Receives pixels values.
+ * @param err Error information output.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_peak_query(struct ovl_audio_peak *const p,
+                                    size_t const channel,
+                                    uint64_t const start,
+                                    double const samples_per_pixel,
+                                    size_t const pixels,
+                                    struct ovl_audio_peak_value *const values,
+                                    struct ov_error *const err);
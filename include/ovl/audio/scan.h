@@ -0,0 +1,81 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include <ovl/audio/info.h>
+
+struct ovl_audio_scan;
+
+/**
+ * @brief One audio file found by ovl_audio_scan.
+ */
+struct ovl_audio_scan_entry {
+  NATIVE_CHAR *path;          /**< Full path of the file */
+  uint64_t size;              /**< Size of the file in bytes */
+  uint64_t modified;          /**< Last write time in microseconds since the Unix epoch */
+  struct ovl_audio_info info; /**< Format, length and tags; zero with no tags when valid is false */
+  bool valid;                 /**< false when the file could not be read as audio */
+  bool estimated;             /**< info.samples is estimated from the bitrate of an MP3 without a length header */
+  bool cached;                /**< The entry was taken from the cache instead of the file */
+};
+
+struct ovl_audio_scan_options {
+  /**
+   * File that keeps the results between scans, or NULL to read every file.
+   * A file whose path, size and last write time match its cached entry is not opened again.
+   */
+  NATIVE_CHAR const *cache_path;
+  /** Number of threads reading files, including the calling thread, or 0 to use one per logical processor */
+  size_t threads;
+};
+
+struct ovl_audio_scan_info {
+  size_t entries; /**< Number of audio files found */
+  size_t probed;  /**< Files that were opened during this scan */
+  size_t cached;  /**< Files taken from the cache */
+  size_t failed;  /**< Files that could not be read as audio, cached or not */
+};
+
+/**
+ * @brief Lists the audio files under a directory with their format, length and tags.
+ *
+ * Files are picked by their extension: .wav, .w64, .aif, .aiff, .flac, .mp3, .ogg and .opus.
+ * Subdirectories are walked too, except links and junctions. Only the headers of each file are read,
+ * on a pool of threads. A file that cannot be read does not stop the scan: its error is reported and
+ * its entry is not valid.
+ * When options has a cache path, the cache is read first and written back with the new results.
+ * A cache that cannot be read or written is reported and otherwise ignored.
+ *
+ * @param root The directory to scan.
+ * @param options The options, or NULL for the defaults.
+ * @param sp Receives the result. Must point to NULL.
+ * @param err Error information output.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_scan(NATIVE_CHAR const *const root,
+                              struct ovl_audio_scan_options const *const options,
+                              struct ovl_audio_scan **const sp,
+                              struct ov_error *const err);
+
+/**
+ * @brief Destroys a scan result.
+ *
+ * @param sp The result. Set to NULL.
+ */
+void ovl_audio_scan_destroy(struct ovl_audio_scan **const sp);
+
+/**
+ * @brief Gets the counts of a scan.
+ *
+ * @param s The result.
+ * @return The counts, valid until the result is destroyed.
+ */
+struct ovl_audio_scan_info const *ovl_audio_scan_get_info(struct ovl_audio_scan const *const s);
+
+/**
+ * @brief Gets the files of a scan.
+ *
+ * @param s The result.
+ * @return ovl_audio_scan_info.entries entries, valid until the result is destroyed.
+ */
+struct ovl_audio_scan_entry const *ovl_audio_scan_get_entries(struct ovl_audio_scan const *const s);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_decoder;
+
+/**
+ * @brief Index of the silent parts of a stream.
+ *
+ * A sample is loud when the absolute value of any of its channels is above the threshold of the scan, and
+ * silent otherwise. The index keeps every run of silent samples at least as long as the minimum length of the
+ * scan, including the ones at the start and at the end, so playback can seek past them and batch jobs can trim
+ * without decoding again.
+ */
+struct ovl_audio_silence;
+
+struct ovl_audio_silence_region {
+  uint64_t start; /**< First silent sample */
+  uint64_t end;   /**< One past the last silent sample */
+};
+
+struct ovl_audio_silence_info {
+  uint64_t samples;       /**< Samples per channel in the scanned stream */
+  uint64_t content_start; /**< First loud sample, or 0 when there is none */
+  uint64_t content_end;   /**< One past the last loud sample, or 0 when there is none */
+  size_t regions;         /**< Number of silent regions */
+};
+
+/**
+ * @brief Decodes a stream once and indexes its silent regions.
+ * The decoder is seeked to the start and read to the end.
+ * @param decoder The decoder to scan. It is not destroyed.
+ * @param threshold The highest absolute sample value that counts as silence, at least 0;
+ * 0.001f is about -60 dBFS.
+ * @param min_length The shortest run of silent samples that makes a region. content_start and content_end are
+ * exact whatever this is.
+ * @param sp Pointer to a location where the new index will be stored.
+ * @param err Error information output.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_silence_scan(struct ovl_audio_decoder *const decoder,
+                                      float const threshold,
+                                      uint64_t const min_length,
+                                      struct ovl_audio_silence **const sp,
+                                      struct ov_error *const err);
+
+/**
+ * @brief Destroys a silence index.
+ * @param sp Pointer to the index.
+ */
+void ovl_audio_silence_destroy(struct ovl_audio_silence **const sp);
+
+/**
+ * @brief Gets the summary of a silence index.
+ * @param s The index.
+ * @return Pointer to the summary, valid until the index is destroyed.
+ */
+struct ovl_audio_silence_info const *ovl_audio_silence_get_info(struct ovl_audio_silence const *const s);
+
+/**
+ * @brief Gets the silent regions.
+ * @param s The index.
+ * @return The regions in stream order, without overlaps, ovl_audio_silence_get_info(s)->regions of them;
+ * valid until the index is destroyed.
+ */
+struct ovl_audio_silence_region const *ovl_audio_silence_get_regions(struct ovl_audio_silence const *const s);
+
+/**
+ * @brief Finds where playback should continue from a position.
+ * @param s The index.
+ * @param position A sample position.
+ * @return The end of the silent region that contains position, or position itself when it is not silent.
+ */
+uint64_t ovl_audio_silence_skip(struct ovl_audio_silence const *const s, uint64_t const position);
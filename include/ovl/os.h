@@ -16,3 +16,33 @@
  */
 bool ovl_os_get_hinstance_from_fnptr(void *fn, void **hinstance, struct ov_error *const err);
 #endif
+
+/**
+ * @brief Gets the number of logical processors
+ *
+ * Used to size worker pools.
+ *
+ * @return size_t Number of logical processors, at least 1
+ */
+size_t ovl_os_get_cpu_count(void);
+
+enum ovl_os_cpu_feature {
+  ovl_os_cpu_feature_sse2 = 1 << 0,
+  ovl_os_cpu_feature_avx2 = 1 << 1,
+  ovl_os_cpu_feature_neon = 1 << 2,
+  ovl_os_cpu_feature_simd128 = 1 << 3,
+};
+
+/**
+ * @brief Gets the SIMD instruction sets usable on the running CPU
+ *
+ * Detection runs once, on the first call, with cpuid/xgetbv on x86, getauxval on Linux/AArch64
+ * and compile-time flags on WebAssembly. AVX2 is only reported when the OS saves the YMM registers.
+ *
+ * Setting the environment variable OVL_CPU_FEATURES limits the result for testing and benchmarking:
+ * "scalar" (or an empty value) disables every SIMD path, and a comma separated list such as "sse2"
+ * keeps only the named features that are also detected. The variable is read once, with the detection.
+ *
+ * @return uint32_t Bitwise OR of ovl_os_cpu_feature values
+ */
+uint32_t ovl_os_get_cpu_features(void);
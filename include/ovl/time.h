@@ -36,3 +36,13 @@ char *ovl_time_format(uint64_t const timestamp_us, char buf[26], int32_t const t
  * @return Current time in microseconds since Unix epoch
  */
 uint64_t ovl_time_now(void);
+
+/**
+ * @brief Get a monotonic timestamp in nanoseconds
+ *
+ * Unaffected by changes to the system clock, so differences between two calls measure elapsed time.
+ * The starting point is unspecified.
+ *
+ * @return Monotonic timestamp in nanoseconds
+ */
+uint64_t ovl_time_monotonic_ns(void);
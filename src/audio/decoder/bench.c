@@ -0,0 +1,822 @@
+#include "../../bench_util.h"
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/flac.h>
+#include <ovl/audio/decoder/mp3.h>
+#include <ovl/audio/decoder/ogg.h>
+#include <ovl/audio/decoder/opus.h>
+#include <ovl/audio/decoder/wav.h>
+#include <ovl/audio/info.h>
+#include <ovl/os.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+#include <ovl/source/memory.h>
+
+#include <inttypes.h>
+#include <math.h>
+#include <string.h>
+
+#ifdef __GNUC__
+#  ifndef __has_warning
+#    define __has_warning(x) 0
+#  endif
+#  pragma GCC diagnostic push
+#  if __has_warning("-Wdocumentation-unknown-command")
+#    pragma GCC diagnostic ignored "-Wdocumentation-unknown-command"
+#  endif
+#  if __has_warning("-Wdocumentation")
+#    pragma GCC diagnostic ignored "-Wdocumentation"
+#  endif
+#endif // __GNUC__
+#include <FLAC/stream_encoder.h>
+#ifdef __GNUC__
+#  pragma GCC diagnostic pop
+#endif // __GNUC__
+
+#ifndef TESTDATADIR
+#  define TESTDATADIR NSTR(".")
+#endif
+
+enum decoder_kind {
+  decoder_wav,
+  decoder_flac,
+  decoder_flac_seek_table,
+  decoder_flac_mt,
+  decoder_mp3,
+  decoder_ogg,
+  decoder_opus,
+  decoder_opus_low_memory,
+};
+
+struct options {
+  char const *filter;
+  char const *output;
+  size_t seconds;
+  size_t sample_rate;
+  size_t opens;
+  size_t passes;
+  size_t seeks;
+};
+
+struct bench_case {
+  char const *name;
+  char const *format;
+  char const *origin;
+  enum decoder_kind decoder;
+  void const *data;
+  size_t len;
+};
+
+struct membuf {
+  uint8_t *ptr;
+  size_t len;
+  size_t cap;
+  size_t pos;
+};
+
+static NODISCARD bool membuf_write(struct membuf *const b, void const *const p, size_t const n) {
+  size_t const end = b->pos + n;
+  if (end > b->cap) {
+    size_t cap = b->cap ? b->cap : 65536;
+    while (cap < end) {
+      cap *= 2;
+    }
+    if (!OV_REALLOC(&b->ptr, cap, sizeof(uint8_t))) {
+      return false;
+    }
+    b->cap = cap;
+  }
+  memcpy(b->ptr + b->pos, p, n);
+  b->pos = end;
+  if (end > b->len) {
+    b->len = end;
+  }
+  return true;
+}
+
+static void membuf_free(struct membuf *const b) {
+  if (b->ptr) {
+    OV_FREE(&b->ptr);
+  }
+  *b = (struct membuf){0};
+}
+
+static NODISCARD bool create_decoder(enum decoder_kind const kind,
+                                     struct ovl_source *const source,
+                                     struct ovl_audio_decoder **const dp,
+                                     struct ov_error *const err) {
+  bool r = false;
+  switch (kind) {
+  case decoder_wav:
+    r = ovl_audio_decoder_wav_create(source, dp, err);
+    break;
+  case decoder_flac:
+    r = ovl_audio_decoder_flac_create(source, dp, err);
+    break;
+  case decoder_flac_seek_table:
+    r = ovl_audio_decoder_flac_create(source, dp, err);
+    if (r && !ovl_audio_decoder_flac_build_seek_table(*dp, false, err)) {
+      ovl_audio_decoder_destroy(dp);
+      r = false;
+    }
+    break;
+  case decoder_flac_mt:
+    r = ovl_audio_decoder_flac_create_mt(source, 0, dp, err);
+    break;
+  case decoder_mp3:
+    r = ovl_audio_decoder_mp3_create(source, dp, err);
+    break;
+  case decoder_ogg:
+    r = ovl_audio_decoder_ogg_create(source, dp, err);
+    break;
+  case decoder_opus:
+    r = ovl_audio_decoder_opus_create(source, dp, err);
+    break;
+  case decoder_opus_low_memory:
+    r = ovl_audio_decoder_opus_create_low_memory(source, dp, err);
+    break;
+  }
+  if (!r) {
+    OV_ERROR_ADD_TRACE(err);
+  }
+  return r;
+}
+
+static NODISCARD bool
+decode_all(struct ovl_audio_decoder *const d, uint64_t *const samples, struct ov_error *const err) {
+  size_t const channels = ovl_audio_decoder_get_info(d)->channels;
+  float const *const *pcm = NULL;
+  uint64_t total = 0;
+  float acc = 0.f;
+  for (;;) {
+    size_t n = 0;
+    if (!ovl_audio_decoder_read(d, &pcm, &n, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+    for (size_t ch = 0; ch < channels; ++ch) {
+      acc += pcm[ch][0] + pcm[ch][n - 1];
+    }
+    total += n;
+  }
+  bench_util_consume(acc);
+  *samples = total;
+  return true;
+}
+
+static double ns_to_us(uint64_t const ns) { return (double)ns / 1000.0; }
+
+static NODISCARD bool run_case(struct options const *const opts,
+                               struct bench_case const *const bc,
+                               FILE *const fp,
+                               bool *const first,
+                               struct ov_error *const err) {
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *d = NULL;
+  uint64_t *times = NULL;
+  bool result = false;
+
+  {
+    if (!ovl_source_memory_create(bc->data, bc->len, &source, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    size_t const ntimes = opts->opens > opts->seeks ? opts->opens : opts->seeks;
+    if (!OV_REALLOC(&times, ntimes ? ntimes : 1, sizeof(uint64_t))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+
+    // Open latency. The first open in the process pays for lazily initialized tables and first-touch
+    // page faults on the input, later opens show the steady state.
+    uint64_t t0 = bench_util_now_ns();
+    if (!create_decoder(bc->decoder, source, &d, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    uint64_t const open_cold = bench_util_now_ns() - t0;
+    struct ovl_audio_info const info = *ovl_audio_decoder_get_info(d);
+    ovl_audio_decoder_destroy(&d);
+    for (size_t i = 0; i < opts->opens; ++i) {
+      t0 = bench_util_now_ns();
+      if (!create_decoder(bc->decoder, source, &d, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      times[i] = bench_util_now_ns() - t0;
+      ovl_audio_decoder_destroy(&d);
+    }
+    bench_util_sort_u64(times, opts->opens);
+    uint64_t const open_warm = bench_util_percentile(times, opts->opens, 50);
+
+    // Sequential decode throughput, best of several passes.
+    uint64_t decode_best = UINT64_MAX;
+    uint64_t decoded = 0;
+    for (size_t i = 0; i < opts->passes; ++i) {
+      if (!create_decoder(bc->decoder, source, &d, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      t0 = bench_util_now_ns();
+      if (!decode_all(d, &decoded, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      uint64_t const elapsed = bench_util_now_ns() - t0;
+      if (elapsed < decode_best) {
+        decode_best = elapsed;
+      }
+      ovl_audio_decoder_destroy(&d);
+    }
+    double const decode_sec = decode_best ? (double)decode_best / 1e9 : 1e-9;
+    double const samples_per_sec = (double)decoded / decode_sec;
+    double const realtime = info.sample_rate ? samples_per_sec / (double)info.sample_rate : 0.0;
+
+    // Random seek latency, measured up to the first decoded block after the seek.
+    size_t nseeks = 0;
+    if (info.samples > 0) {
+      if (!create_decoder(bc->decoder, source, &d, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      uint64_t rng = UINT64_C(0x9e3779b97f4a7c15);
+      for (; nseeks < opts->seeks; ++nseeks) {
+        uint64_t const pos = bench_util_rand(&rng) % info.samples;
+        float const *const *pcm = NULL;
+        size_t n = 0;
+        t0 = bench_util_now_ns();
+        if (!ovl_audio_decoder_seek(d, pos, err) || !ovl_audio_decoder_read(d, &pcm, &n, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        times[nseeks] = bench_util_now_ns() - t0;
+        if (n) {
+          bench_util_consume(pcm[0][0]);
+        }
+      }
+      ovl_audio_decoder_destroy(&d);
+    }
+    bench_util_sort_u64(times, nseeks);
+
+    fprintf(fp, "%s\n    {\"name\": ", *first ? "" : ",");
+    bench_util_json_string(fp, bc->name);
+    fprintf(fp, ", \"format\": ");
+    bench_util_json_string(fp, bc->format);
+    fprintf(fp, ", \"origin\": ");
+    bench_util_json_string(fp, bc->origin);
+    fprintf(fp,
+            ", \"channels\": %zu, \"sample_rate\": %zu, \"samples\": %" PRIu64 ", \"bytes\": %zu,\n"
+            "     \"open_cold_us\": %.3f, \"open_warm_us\": %.3f,\n"
+            "     \"decoded_samples\": %" PRIu64 ", \"decode_samples_per_sec\": %.1f, \"realtime\": %.2f,\n"
+            "     \"seek_us\": {\"count\": %zu, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n"
+            "     \"peak_rss_bytes\": %" PRIu64 "}",
+            info.channels,
+            info.sample_rate,
+            info.samples,
+            bc->len,
+            ns_to_us(open_cold),
+            ns_to_us(open_warm),
+            decoded,
+            samples_per_sec,
+            realtime,
+            nseeks,
+            ns_to_us(bench_util_percentile(times, nseeks, 50)),
+            ns_to_us(bench_util_percentile(times, nseeks, 90)),
+            ns_to_us(bench_util_percentile(times, nseeks, 99)),
+            ns_to_us(bench_util_percentile(times, nseeks, 100)),
+            bench_util_peak_rss());
+    fflush(fp);
+    *first = false;
+  }
+  result = true;
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (times) {
+    OV_FREE(&times);
+  }
+  return result;
+}
+
+// Synthetic corpus
+
+enum pcm_format {
+  pcm_u8,
+  pcm_i16,
+  pcm_i24,
+  pcm_i32,
+  pcm_i64,
+  pcm_f32,
+  pcm_f64,
+};
+
+struct pcm_format_desc {
+  char const *name;
+  uint16_t tag; // WAVE_FORMAT_PCM or WAVE_FORMAT_IEEE_FLOAT
+  uint16_t bits;
+};
+
+static struct pcm_format_desc const pcm_formats[] = {
+    [pcm_u8] = {"u8", 1, 8},
+    [pcm_i16] = {"i16", 1, 16},
+    [pcm_i24] = {"i24", 1, 24},
+    [pcm_i32] = {"i32", 1, 32},
+    [pcm_i64] = {"i64", 1, 64},
+    [pcm_f32] = {"f32", 3, 32},
+    [pcm_f64] = {"f64", 3, 64},
+};
+
+static size_t const channel_layouts[] = {1, 2, 6};
+
+// A tone per channel with a little noise so lossless codecs cannot compress it to nothing.
+static double synth(uint64_t *const rng, size_t const ch, size_t const i, size_t const sample_rate) {
+  double const pi = 3.14159265358979323846;
+  double const t = (double)i / (double)sample_rate;
+  double const noise = (double)(bench_util_rand(rng) >> 11) / 9007199254740992.0 * 2.0 - 1.0;
+  return 0.6 * sin(2.0 * pi * 110.0 * (double)(ch + 1) * t) + 0.05 * noise;
+}
+
+static void put_le(uint8_t *const p, uint64_t const v, size_t const bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    p[i] = (uint8_t)(v >> (i * 8));
+  }
+}
+
+static void put_be(uint8_t *const p, uint64_t const v, size_t const bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    p[i] = (uint8_t)(v >> ((bytes - 1 - i) * 8));
+  }
+}
+
+static uint64_t encode_sample(enum pcm_format const fmt, double const v) {
+  switch (fmt) {
+  case pcm_u8:
+    return (uint64_t)(int64_t)(v * 127.0 + 128.0);
+  case pcm_i16:
+    return (uint64_t)(int64_t)(v * 32767.0);
+  case pcm_i24:
+    return (uint64_t)(int64_t)(v * 8388607.0);
+  case pcm_i32:
+    return (uint64_t)(int64_t)(v * 2147483647.0);
+  case pcm_i64:
+    return (uint64_t)(int64_t)(v * 9223372036854774784.0);
+  case pcm_f32: {
+    float const f = (float)v;
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+  }
+  case pcm_f64: {
+    uint64_t u;
+    memcpy(&u, &v, sizeof(u));
+    return u;
+  }
+  }
+  return 0;
+}
+
+static NODISCARD bool generate_pcm(struct membuf *const b,
+                                   enum pcm_format const fmt,
+                                   bool const aiff,
+                                   size_t const channels,
+                                   size_t const sample_rate,
+                                   size_t const samples,
+                                   struct ov_error *const err) {
+  size_t const bytes = pcm_formats[fmt].bits / 8;
+  size_t const data_len = samples * channels * bytes;
+  uint8_t hdr[54];
+  size_t hdr_len;
+  if (aiff) {
+    // 80-bit extended sample rate: biased exponent and a normalized 64-bit mantissa.
+    int exp = 0;
+    while ((sample_rate >> exp) > 1) {
+      ++exp;
+    }
+    memcpy(hdr, "FORM", 4);
+    put_be(hdr + 4, 4 + 8 + 18 + 8 + 8 + data_len, 4);
+    memcpy(hdr + 8, "AIFFCOMM", 8);
+    put_be(hdr + 16, 18, 4);
+    put_be(hdr + 20, channels, 2);
+    put_be(hdr + 22, samples, 4);
+    put_be(hdr + 26, pcm_formats[fmt].bits, 2);
+    put_be(hdr + 28, (uint64_t)(16383 + exp), 2);
+    put_be(hdr + 30, (uint64_t)sample_rate << (63 - exp), 8);
+    memcpy(hdr + 38, "SSND", 4);
+    put_be(hdr + 42, 8 + data_len, 4);
+    put_be(hdr + 46, 0, 4);
+    put_be(hdr + 50, 0, 4);
+    hdr_len = 54;
+  } else {
+    memcpy(hdr, "RIFF", 4);
+    put_le(hdr + 4, 36 + data_len, 4);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    put_le(hdr + 16, 16, 4);
+    put_le(hdr + 20, pcm_formats[fmt].tag, 2);
+    put_le(hdr + 22, channels, 2);
+    put_le(hdr + 24, sample_rate, 4);
+    put_le(hdr + 28, sample_rate * channels * bytes, 4);
+    put_le(hdr + 32, channels * bytes, 2);
+    put_le(hdr + 34, pcm_formats[fmt].bits, 2);
+    memcpy(hdr + 36, "data", 4);
+    put_le(hdr + 40, data_len, 4);
+    hdr_len = 44;
+  }
+  if (!membuf_write(b, hdr, hdr_len)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  uint8_t frame[6 * 8];
+  uint64_t rng = UINT64_C(0x2545f4914f6cdd1d);
+  for (size_t i = 0; i < samples; ++i) {
+    for (size_t ch = 0; ch < channels; ++ch) {
+      uint64_t const v = encode_sample(fmt, synth(&rng, ch, i, sample_rate));
+      if (aiff) {
+        put_be(frame + ch * bytes, v, bytes);
+      } else {
+        put_le(frame + ch * bytes, v, bytes);
+      }
+    }
+    if (!membuf_write(b, frame, channels * bytes)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      return false;
+    }
+  }
+  return true;
+}
+
+static FLAC__StreamEncoderWriteStatus flac_write(FLAC__StreamEncoder const *const encoder,
+                                                 FLAC__byte const buffer[],
+                                                 size_t const bytes,
+                                                 uint32_t const samples,
+                                                 uint32_t const current_frame,
+                                                 void *const client_data) {
+  (void)encoder;
+  (void)samples;
+  (void)current_frame;
+  return membuf_write(client_data, buffer, bytes) ? FLAC__STREAM_ENCODER_WRITE_STATUS_OK
+                                                  : FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+}
+
+static FLAC__StreamEncoderSeekStatus
+flac_seek(FLAC__StreamEncoder const *const encoder, FLAC__uint64 const absolute_byte_offset, void *const client_data) {
+  (void)encoder;
+  struct membuf *const b = client_data;
+  if (absolute_byte_offset > b->len) {
+    return FLAC__STREAM_ENCODER_SEEK_STATUS_ERROR;
+  }
+  b->pos = (size_t)absolute_byte_offset;
+  return FLAC__STREAM_ENCODER_SEEK_STATUS_OK;
+}
+
+static FLAC__StreamEncoderTellStatus
+flac_tell(FLAC__StreamEncoder const *const encoder, FLAC__uint64 *const absolute_byte_offset, void *const client_data) {
+  (void)encoder;
+  struct membuf const *const b = client_data;
+  *absolute_byte_offset = b->pos;
+  return FLAC__STREAM_ENCODER_TELL_STATUS_OK;
+}
+
+// Encodes without a SEEKTABLE block, the case the synthesized seek table is meant for.
+static NODISCARD bool generate_flac(struct membuf *const b,
+                                    uint32_t const bits,
+                                    size_t const channels,
+                                    size_t const sample_rate,
+                                    size_t const samples,
+                                    struct ov_error *const err) {
+  enum {
+    chunk = 4096,
+  };
+  FLAC__StreamEncoder *enc = NULL;
+  FLAC__int32 *buf = NULL;
+  bool result = false;
+
+  {
+    enc = FLAC__stream_encoder_new();
+    if (!enc) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (!FLAC__stream_encoder_set_channels(enc, (uint32_t)channels) ||
+        !FLAC__stream_encoder_set_bits_per_sample(enc, bits) ||
+        !FLAC__stream_encoder_set_sample_rate(enc, (uint32_t)sample_rate) ||
+        !FLAC__stream_encoder_set_compression_level(enc, 5) || !FLAC__stream_encoder_set_blocksize(enc, 4096) ||
+        !FLAC__stream_encoder_set_total_samples_estimate(enc, samples)) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, "failed to configure FLAC encoder");
+      goto cleanup;
+    }
+    if (FLAC__stream_encoder_init_stream(enc, flac_write, flac_seek, flac_tell, NULL, b) !=
+        FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, "failed to initialize FLAC encoder");
+      goto cleanup;
+    }
+    if (!OV_REALLOC(&buf, chunk * channels, sizeof(FLAC__int32))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    double const scale = (double)((INT32_C(1) << (bits - 1)) - 1);
+    uint64_t rng = UINT64_C(0x2545f4914f6cdd1d);
+    for (size_t pos = 0; pos < samples; pos += chunk) {
+      size_t const n = samples - pos < chunk ? samples - pos : chunk;
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+          buf[i * channels + ch] = (FLAC__int32)(synth(&rng, ch, pos + i, sample_rate) * scale);
+        }
+      }
+      if (!FLAC__stream_encoder_process_interleaved(enc, buf, (uint32_t)n)) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, "failed to encode FLAC");
+        goto cleanup;
+      }
+    }
+    if (!FLAC__stream_encoder_finish(enc)) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, "failed to finish FLAC stream");
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (buf) {
+    OV_FREE(&buf);
+  }
+  if (enc) {
+    FLAC__stream_encoder_delete(enc);
+  }
+  return result;
+}
+
+static bool match(struct options const *const opts, char const *const name) {
+  return !opts->filter || strstr(name, opts->filter) != NULL;
+}
+
+static NODISCARD bool run_synthetic(struct options const *const opts,
+                                    FILE *const fp,
+                                    bool *const first,
+                                    struct ov_error *const err) {
+  static struct {
+    char const *suffix;
+    enum decoder_kind decoder;
+  } const flac_modes[] = {
+      {"", decoder_flac},
+      {"/seek_table", decoder_flac_seek_table},
+      {"/mt", decoder_flac_mt},
+  };
+  static uint32_t const flac_bits[] = {16, 24};
+
+  struct membuf b = {0};
+  char name[128];
+  bool result = false;
+
+  {
+    size_t const samples = opts->seconds * opts->sample_rate;
+    for (size_t l = 0; l < sizeof(channel_layouts) / sizeof(channel_layouts[0]); ++l) {
+      size_t const channels = channel_layouts[l];
+
+      for (size_t f = 0; f < sizeof(pcm_formats) / sizeof(pcm_formats[0]); ++f) {
+        snprintf(name, sizeof(name), "synthetic/wav/%s/%zuch", pcm_formats[f].name, channels);
+        if (!match(opts, name)) {
+          continue;
+        }
+        b.len = b.pos = 0;
+        if (!generate_pcm(&b, (enum pcm_format)f, false, channels, opts->sample_rate, samples, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        struct bench_case const bc = {name, "wav", "synthetic", decoder_wav, b.ptr, b.len};
+        if (!run_case(opts, &bc, fp, first, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+      }
+
+      // AIFF exercises the big-endian conversion paths.
+      static enum pcm_format const aiff_formats[] = {pcm_i16, pcm_i24};
+      for (size_t f = 0; f < sizeof(aiff_formats) / sizeof(aiff_formats[0]); ++f) {
+        snprintf(name, sizeof(name), "synthetic/aiff/%s/%zuch", pcm_formats[aiff_formats[f]].name, channels);
+        if (!match(opts, name)) {
+          continue;
+        }
+        b.len = b.pos = 0;
+        if (!generate_pcm(&b, aiff_formats[f], true, channels, opts->sample_rate, samples, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        struct bench_case const bc = {name, "aiff", "synthetic", decoder_wav, b.ptr, b.len};
+        if (!run_case(opts, &bc, fp, first, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+      }
+
+      for (size_t f = 0; f < sizeof(flac_bits) / sizeof(flac_bits[0]); ++f) {
+        bool generated = false;
+        for (size_t m = 0; m < sizeof(flac_modes) / sizeof(flac_modes[0]); ++m) {
+          snprintf(name,
+                   sizeof(name),
+                   "synthetic/flac/i%" PRIu32 "/%zuch%s",
+                   flac_bits[f],
+                   channels,
+                   flac_modes[m].suffix);
+          if (!match(opts, name)) {
+            continue;
+          }
+          if (!generated) {
+            b.len = b.pos = 0;
+            if (!generate_flac(&b, flac_bits[f], channels, opts->sample_rate, samples, err)) {
+              OV_ERROR_ADD_TRACE(err);
+              goto cleanup;
+            }
+            generated = true;
+          }
+          struct bench_case const bc = {name, "flac", "synthetic", flac_modes[m].decoder, b.ptr, b.len};
+          if (!run_case(opts, &bc, fp, first, err)) {
+            OV_ERROR_ADD_TRACE(err);
+            goto cleanup;
+          }
+        }
+      }
+    }
+  }
+  result = true;
+
+cleanup:
+  membuf_free(&b);
+  return result;
+}
+
+// Existing test data, the only corpus for the lossy formats since we do not link their encoders.
+
+static NODISCARD bool
+load_file(NATIVE_CHAR const *const path, struct membuf *const b, struct ov_error *const err) {
+  struct ovl_source *source = NULL;
+  bool result = false;
+
+  {
+    if (!ovl_source_file_create(path, &source, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    uint64_t const size = ovl_source_size(source);
+    if (size == UINT64_MAX || size > SIZE_MAX / 2) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, "failed to get file size");
+      goto cleanup;
+    }
+    if (!OV_REALLOC(&b->ptr, (size_t)size ? (size_t)size : 1, sizeof(uint8_t))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    b->cap = (size_t)size ? (size_t)size : 1;
+    b->len = ovl_source_read(source, b->ptr, 0, (size_t)size);
+    if (b->len != (size_t)size) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, "failed to read file");
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  return result;
+}
+
+static NODISCARD bool run_testdata(struct options const *const opts,
+                                   FILE *const fp,
+                                   bool *const first,
+                                   struct ov_error *const err) {
+  static struct {
+    char const *name;
+    char const *format;
+    NATIVE_CHAR const *path;
+    enum decoder_kind decoder;
+  } const files[] = {
+      {"testdata/test-8khz-stereo-8.wav", "wav", TESTDATADIR NSTR("/test-8khz-stereo-8.wav"), decoder_wav},
+      {"testdata/test-8khz-mono-16.aiff", "aiff", TESTDATADIR NSTR("/test-8khz-mono-16.aiff"), decoder_wav},
+      {"testdata/test.flac", "flac", TESTDATADIR NSTR("/test.flac"), decoder_flac},
+      {"testdata/test.flac/seek_table", "flac", TESTDATADIR NSTR("/test.flac"), decoder_flac_seek_table},
+      {"testdata/test.flac/mt", "flac", TESTDATADIR NSTR("/test.flac"), decoder_flac_mt},
+      {"testdata/test.mp3", "mp3", TESTDATADIR NSTR("/test.mp3"), decoder_mp3},
+      {"testdata/test.ogg", "ogg", TESTDATADIR NSTR("/test.ogg"), decoder_ogg},
+      {"testdata/test.opus", "opus", TESTDATADIR NSTR("/test.opus"), decoder_opus},
+      {"testdata/test.opus/low_memory", "opus", TESTDATADIR NSTR("/test.opus"), decoder_opus_low_memory},
+  };
+
+  struct membuf b = {0};
+  bool result = false;
+
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+    if (!match(opts, files[i].name)) {
+      continue;
+    }
+    membuf_free(&b);
+    if (!load_file(files[i].path, &b, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    struct bench_case const bc = {files[i].name, files[i].format, "testdata", files[i].decoder, b.ptr, b.len};
+    if (!run_case(opts, &bc, fp, first, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  membuf_free(&b);
+  return result;
+}
+
+static bool parse_size(char const *const s, size_t *const v) {
+  char *end = NULL;
+  unsigned long long const n = strtoull(s, &end, 10);
+  if (!*s || *end || n == 0 || n > SIZE_MAX) {
+    return false;
+  }
+  *v = (size_t)n;
+  return true;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: bench_ovl_decoders [options]\n"
+          "  --filter <substring>  run only cases whose name contains substring\n"
+          "  --output <path>       write JSON to path instead of stdout\n"
+          "  --seconds <n>         length of synthetic inputs (default 10)\n"
+          "  --sample-rate <n>     sample rate of synthetic inputs (default 48000)\n"
+          "  --opens <n>           warm open repetitions (default 20)\n"
+          "  --passes <n>          decode passes, the fastest is reported (default 3)\n"
+          "  --seeks <n>           random seeks (default 100)\n");
+}
+
+int main(int argc, char **argv) {
+  struct options opts = {
+      .seconds = 10,
+      .sample_rate = 48000,
+      .opens = 20,
+      .passes = 3,
+      .seeks = 100,
+  };
+  for (int i = 1; i < argc; ++i) {
+    char const *const a = argv[i];
+    char const *const v = i + 1 < argc ? argv[i + 1] : NULL;
+    bool ok = v != NULL;
+    if (ok && strcmp(a, "--filter") == 0) {
+      opts.filter = v;
+    } else if (ok && strcmp(a, "--output") == 0) {
+      opts.output = v;
+    } else if (ok && strcmp(a, "--seconds") == 0) {
+      ok = parse_size(v, &opts.seconds);
+    } else if (ok && strcmp(a, "--sample-rate") == 0) {
+      ok = parse_size(v, &opts.sample_rate);
+    } else if (ok && strcmp(a, "--opens") == 0) {
+      ok = parse_size(v, &opts.opens);
+    } else if (ok && strcmp(a, "--passes") == 0) {
+      ok = parse_size(v, &opts.passes);
+    } else if (ok && strcmp(a, "--seeks") == 0) {
+      ok = parse_size(v, &opts.seeks);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage();
+      return 2;
+    }
+    ++i;
+  }
+
+  struct ov_error err = {0};
+  FILE *fp = stdout;
+  bool first = true;
+  int exit_code = 1;
+  if (opts.output) {
+    fp = fopen(opts.output, "w");
+    if (!fp) {
+      fprintf(stderr, "failed to open %s\n", opts.output);
+      return 1;
+    }
+  }
+  fprintf(fp,
+          "{\n  \"schema\": 1,\n  \"cpu_count\": %zu,\n  \"synthetic_seconds\": %zu,\n  \"cases\": [",
+          ovl_os_get_cpu_count(),
+          opts.seconds);
+  if (!run_synthetic(&opts, fp, &first, &err) || !run_testdata(&opts, fp, &first, &err)) {
+    OV_ERROR_REPORT(&err, NULL);
+    goto cleanup;
+  }
+  fprintf(fp, "\n  ],\n  \"peak_rss_bytes\": %" PRIu64 "\n}\n", bench_util_peak_rss());
+  exit_code = 0;
+
+cleanup:
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return exit_code;
+}
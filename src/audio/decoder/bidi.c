@@ -2,8 +2,36 @@
 
 #include <ovl/audio/decoder.h>
 #include <ovl/audio/info.h>
+#include <ovl/time.h>
 
 #include <ovmo.h>
+#include <ovthreads.h>
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "reverse_copy.h"
+
+// Decoded PCM around the cursor is kept in window, in stream order, and both directions read from it.
+// Forward reads append what they decode and reverse reads prepend whole blocks; when the window is full,
+// the half farthest from the cursor is dropped. Flipping the direction inside the window decodes nothing.
+//
+// Reverse playback is double buffered: while the window drains, a worker thread decodes the span below it
+// into prefetch. A span ends where the window starts and begins at the decoder's keyframe at or before one
+// block earlier, so nothing the decoder has to decode anyway is thrown away.
+// The worker owns the wrapped decoder while a job is queued or decoding, so every other use of the decoder
+// goes through cancel_prefetch first.
+//
+// The block size adapts to the measured cost of a seek relative to decoding: cheap seeks give short blocks
+// so a flip or a short clip decodes little, expensive seeks are amortized over longer spans. Blocks never
+// exceed half the window, whose size follows from the memory budget and the channel count.
+enum prefetch_state {
+  prefetch_state_idle,
+  prefetch_state_queued,
+  prefetch_state_decoding,
+  prefetch_state_done,
+  prefetch_state_failed,
+};
 
 struct bidi {
   struct ovl_audio_decoder_vtable const *vtable;
@@ -13,28 +41,162 @@ struct bidi {
   uint64_t bidi_cursor;
 
   float const **pcm;
+  float **out;
+  size_t out_cap;
+  reverse_copy_func reverse_copy;
+
+  float **window;
+  size_t window_cap;
+  size_t window_off;
+  size_t window_len;
+  uint64_t window_start;
+
+  // Only touched by whoever owns the decoder, like decoder_cursor; block_size is also read by get_stats.
+  size_t block_size;
+  double seek_cost;
+  double sample_cost;
+  bool cost_measured;
 
-  float **buffer;
-  size_t buffer_cap;
-  size_t buffer_len;
-  size_t buffer_pos;
+  float **prefetch;
+  size_t prefetch_cap;
+  size_t prefetch_len;
+  uint64_t prefetch_end;
+  enum prefetch_state prefetch_state;
+
+  mtx_t mtx;
+  cnd_t job_queued;
+  cnd_t job_done;
+  bool sync_initialized;
+  thrd_t worker;
+  bool worker_started;
+  bool quit;
+  atomic_bool cancel;
+
+  // Guarded by mtx, since the worker counts its own seeks and decoded samples.
+  struct ovl_audio_decoder_bidi_stats stats;
 
   bool reverse;
 };
 
+enum {
+  block_size_min = 4096,
+  default_memory_budget = 4 * 1024 * 1024,
+};
+
 static inline size_t adjust_align8(size_t const size) { return (size + (size_t)(7)) & ~(size_t)(7); }
 static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
 
+static void add_stats(struct bidi *const ctx, uint64_t const seeks, uint64_t const decoded, uint64_t const emitted) {
+  mtx_lock(&ctx->mtx);
+  ctx->stats.seeks += seeks;
+  ctx->stats.decoded += decoded;
+  ctx->stats.emitted += emitted;
+  mtx_unlock(&ctx->mtx);
+}
+
+/**
+ * @brief Returns the window size that fits the memory budget.
+ * The budget covers the window, the prefetch span of half its size and the reverse output planes.
+ */
+static size_t window_cap_from_budget(struct bidi const *const ctx, size_t const bytes) {
+  size_t const samples = bytes / (ctx->info->channels * sizeof(float));
+  size_t const cap = samples > ctx->out_cap ? (samples - ctx->out_cap) / 3 * 2 : 0;
+  return cap < block_size_min * 2 ? block_size_min * 2 : cap;
+}
+
+/**
+ * @brief Returns the time between two ovl_time_monotonic_ns timestamps, at least one nanosecond.
+ * A span too short for the clock to see must not turn either cost into zero.
+ */
+static uint64_t elapsed_ns(uint64_t const from, uint64_t const to) { return to > from ? to - from : 1; }
+
+/**
+ * @brief Updates the cost estimates with one decoded span and derives the next block size.
+ */
+static void update_block_size(struct bidi *const ctx,
+                              uint64_t const seek_ns,
+                              uint64_t const decode_ns,
+                              uint64_t const decoded) {
+  if (decoded == 0) {
+    return;
+  }
+  double const seek = (double)seek_ns;
+  double const sample = (double)decode_ns / (double)decoded;
+  if (ctx->cost_measured) {
+    ctx->seek_cost += (seek - ctx->seek_cost) * 0.25;
+    ctx->sample_cost += (sample - ctx->sample_cost) * 0.25;
+  } else {
+    ctx->seek_cost = seek;
+    ctx->sample_cost = sample;
+    ctx->cost_measured = true;
+  }
+  // Make a seek cost at most a quarter of decoding the block it starts.
+  size_t const max = ctx->prefetch_cap;
+  size_t block_size = block_size_min;
+  if (ctx->sample_cost <= 0) {
+    block_size = ctx->seek_cost > 0 ? max : block_size_min;
+  } else {
+    double const want = ctx->seek_cost * 4 / ctx->sample_cost;
+    if (want >= (double)max) {
+      block_size = max;
+    } else if (want > (double)block_size_min) {
+      block_size = (size_t)want;
+    }
+  }
+  // Written under the lock only for get_stats; decode_span runs on the decoder's owner.
+  mtx_lock(&ctx->mtx);
+  ctx->block_size = block_size;
+  mtx_unlock(&ctx->mtx);
+}
+
+static NODISCARD bool
+alloc_planes(float ***const planes, size_t const channels, size_t const stride, struct ov_error *const err) {
+  if (!OV_REALLOC(planes, channels, sizeof(float *))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], stride * channels, sizeof(float), 16)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ++ch) {
+    (*planes)[ch] = (*planes)[ch - 1] + stride;
+  }
+  return true;
+}
+
+static void free_planes(float ***const planes) {
+  if (*planes) {
+    if ((*planes)[0]) {
+      OV_ALIGNED_FREE(&(*planes)[0]);
+    }
+    OV_FREE(planes);
+  }
+}
+
 static void destroy(struct ovl_audio_decoder **const dp) {
   struct bidi **const ctxp = (struct bidi **)(void *)dp;
   if (!ctxp || !*ctxp) {
     return;
   }
   struct bidi *ctx = *ctxp;
-  if (ctx->buffer) {
-    OV_ALIGNED_FREE(&ctx->buffer[0]);
-    OV_FREE(&ctx->buffer);
+  if (ctx->worker_started) {
+    mtx_lock(&ctx->mtx);
+    ctx->quit = true;
+    atomic_store(&ctx->cancel, true);
+    cnd_broadcast(&ctx->job_queued);
+    mtx_unlock(&ctx->mtx);
+    thrd_join(ctx->worker, NULL);
+  }
+  if (ctx->sync_initialized) {
+    cnd_destroy(&ctx->job_done);
+    cnd_destroy(&ctx->job_queued);
+    mtx_destroy(&ctx->mtx);
   }
+  free_planes(&ctx->prefetch);
+  free_planes(&ctx->window);
+  free_planes(&ctx->out);
   if (ctx->pcm) {
     OV_FREE(&ctx->pcm);
   }
@@ -46,45 +208,111 @@ static struct ovl_audio_info const *get_info(struct ovl_audio_decoder const *con
   return ctx->info;
 }
 
-static NODISCARD bool
-read_forward(struct bidi *ctx, float const *const **pcm, size_t *samples, struct ov_error *const err) {
-  bool result = false;
+/**
+ * @brief Empties the window and places it at position.
+ * The free space is put on the side the current direction will grow it.
+ */
+static void reset_window(struct bidi *const ctx, uint64_t const position) {
+  ctx->window_start = position;
+  ctx->window_len = 0;
+  ctx->window_off = ctx->reverse ? ctx->window_cap : 0;
+}
 
-  if (ctx->decoder_cursor != ctx->bidi_cursor) {
-    if (!ovl_audio_decoder_seek(ctx->decoder, ctx->bidi_cursor, err)) {
-      OV_ERROR_ADD_TRACE(err);
-      goto cleanup;
+/**
+ * @brief Appends samples that continue the window.
+ * When there is no room left, only the newest half of the window is kept.
+ */
+static void window_append(struct bidi *const ctx, float const *const *const pcm, size_t const len) {
+  size_t const channels = ctx->info->channels;
+  size_t const cap = ctx->window_cap;
+  if (len >= cap) {
+    for (size_t ch = 0; ch < channels; ++ch) {
+      memcpy(ctx->window[ch], pcm[ch] + len - cap, cap * sizeof(float));
+    }
+    ctx->window_start += ctx->window_len + len - cap;
+    ctx->window_off = 0;
+    ctx->window_len = cap;
+    return;
+  }
+  if (ctx->window_off + ctx->window_len + len > cap) {
+    size_t const keep = min2(ctx->window_len, min2(cap / 2, cap - len));
+    size_t const drop = ctx->window_len - keep;
+    for (size_t ch = 0; ch < channels; ++ch) {
+      memmove(ctx->window[ch], ctx->window[ch] + ctx->window_off + drop, keep * sizeof(float));
     }
-    ctx->decoder_cursor = ctx->bidi_cursor;
+    ctx->window_start += drop;
+    ctx->window_off = 0;
+    ctx->window_len = keep;
   }
-  size_t read;
-  if (!ovl_audio_decoder_read(ctx->decoder, pcm, &read, err)) {
-    OV_ERROR_ADD_TRACE(err);
-    goto cleanup;
+  for (size_t ch = 0; ch < channels; ++ch) {
+    memcpy(ctx->window[ch] + ctx->window_off + ctx->window_len, pcm[ch], len * sizeof(float));
   }
-  ctx->decoder_cursor += read;
-  ctx->bidi_cursor += read;
-  *samples = read;
-  result = true;
+  ctx->window_len += len;
+}
 
-cleanup:
-  return result;
+/**
+ * @brief Prepends a block that ends where the window starts.
+ * When there is no room left, only the oldest half of the window is kept.
+ * len must not exceed half the window capacity.
+ */
+static void window_prepend(struct bidi *const ctx, float const *const *const planes, size_t const len) {
+  size_t const channels = ctx->info->channels;
+  size_t const cap = ctx->window_cap;
+  if (ctx->window_off < len) {
+    size_t const keep = min2(ctx->window_len, cap / 2);
+    for (size_t ch = 0; ch < channels; ++ch) {
+      memmove(ctx->window[ch] + cap - keep, ctx->window[ch] + ctx->window_off, keep * sizeof(float));
+    }
+    ctx->window_off = cap - keep;
+    ctx->window_len = keep;
+  }
+  ctx->window_off -= len;
+  for (size_t ch = 0; ch < channels; ++ch) {
+    memcpy(ctx->window[ch] + ctx->window_off, planes[ch], len * sizeof(float));
+  }
+  ctx->window_start -= len;
+  ctx->window_len += len;
 }
 
-static NODISCARD bool fill_reverse_buffer(struct bidi *ctx, struct ov_error *const err) {
-  size_t const block_size = ctx->bidi_cursor < ctx->buffer_cap ? (size_t)ctx->bidi_cursor : ctx->buffer_cap;
-  uint64_t const start = ctx->bidi_cursor - block_size;
+/**
+ * @brief Decodes the span that ends at end into planes.
+ * The span starts at the keyframe at or before one block earlier, and is cut to prefetch_cap samples.
+ * Samples past the end of the stream are filled with silence so the window stays contiguous.
+ * Stops early without an error when the prefetch is cancelled.
+ */
+static NODISCARD bool decode_span(struct bidi *const ctx,
+                                   float *const *const planes,
+                                   uint64_t const end,
+                                   size_t *const len,
+                                   struct ov_error *const err) {
   bool result = false;
   {
-    if (!ovl_audio_decoder_seek(ctx->decoder, start, err)) {
+    size_t const block_size = min2(ctx->block_size, ctx->prefetch_cap);
+    uint64_t const target = end > block_size ? end - block_size : 0;
+    uint64_t start;
+    uint64_t const t0 = ovl_time_monotonic_ns();
+    bool const ok = ovl_audio_decoder_seek_keyframe(ctx->decoder, target, &start, err);
+    add_stats(ctx, 1, 0, 0);
+    if (!ok) {
       OV_ERROR_ADD_TRACE(err);
       goto cleanup;
     }
+    uint64_t const t1 = ovl_time_monotonic_ns();
+    if (start > target) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Invalid keyframe position"));
+      goto cleanup;
+    }
     ctx->decoder_cursor = start;
+    uint64_t const first = end - start > ctx->prefetch_cap ? end - ctx->prefetch_cap : start;
+    size_t const span = (size_t)(end - first);
     float const *const *pcm;
     size_t read;
-    size_t offset = 0;
-    while (offset < block_size) {
+    uint64_t pos = start;
+    while (pos < end) {
+      if (atomic_load(&ctx->cancel)) {
+        result = true;
+        goto cleanup;
+      }
       if (!ovl_audio_decoder_read(ctx->decoder, &pcm, &read, err)) {
         OV_ERROR_ADD_TRACE(err);
         goto cleanup;
@@ -93,18 +321,213 @@ static NODISCARD bool fill_reverse_buffer(struct bidi *ctx, struct ov_error *con
         break;
       }
       ctx->decoder_cursor += read;
-      if (read > block_size - offset) {
-        read = block_size - offset;
+      add_stats(ctx, 0, read, 0);
+      uint64_t const lo = pos < first ? first : pos;
+      uint64_t const hi = pos + read < end ? pos + read : end;
+      if (lo < hi) {
+        for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+          memcpy(planes[ch] + (size_t)(lo - first), pcm[ch] + (size_t)(lo - pos), (size_t)(hi - lo) * sizeof(float));
+        }
       }
+      pos += read;
+    }
+    uint64_t const t2 = ovl_time_monotonic_ns();
+    update_block_size(ctx, elapsed_ns(t0, t1), elapsed_ns(t1, t2), pos - start);
+    size_t const filled = pos > first ? (size_t)((pos < end ? pos : end) - first) : 0;
+    for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+      memset(planes[ch] + filled, 0, (span - filled) * sizeof(float));
+    }
+    *len = span;
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static int prefetch_thread(void *const userdata) {
+  struct bidi *const ctx = (struct bidi *)userdata;
+  mtx_lock(&ctx->mtx);
+  for (;;) {
+    while (!ctx->quit && ctx->prefetch_state != prefetch_state_queued) {
+      cnd_wait(&ctx->job_queued, &ctx->mtx);
+    }
+    if (ctx->quit) {
+      break;
+    }
+    ctx->prefetch_state = prefetch_state_decoding;
+    uint64_t const end = ctx->prefetch_end;
+    mtx_unlock(&ctx->mtx);
+    struct ov_error err = {0};
+    size_t len = 0;
+    bool const ok = decode_span(ctx, ctx->prefetch, end, &len, &err);
+    if (!ok) {
+      OV_ERROR_REPORT(&err, NULL);
+    }
+    mtx_lock(&ctx->mtx);
+    ctx->prefetch_len = len;
+    if (atomic_load(&ctx->cancel)) {
+      ctx->prefetch_state = prefetch_state_idle;
+    } else {
+      ctx->prefetch_state = ok ? prefetch_state_done : prefetch_state_failed;
+    }
+    cnd_broadcast(&ctx->job_done);
+  }
+  mtx_unlock(&ctx->mtx);
+  return 0;
+}
+
+/**
+ * @brief Discards the prefetched block and waits until the worker no longer uses the decoder.
+ */
+static void cancel_prefetch(struct bidi *const ctx) {
+  if (!ctx->worker_started) {
+    return;
+  }
+  mtx_lock(&ctx->mtx);
+  atomic_store(&ctx->cancel, true);
+  while (ctx->prefetch_state == prefetch_state_decoding) {
+    cnd_wait(&ctx->job_done, &ctx->mtx);
+  }
+  ctx->prefetch_state = prefetch_state_idle;
+  atomic_store(&ctx->cancel, false);
+  mtx_unlock(&ctx->mtx);
+}
+
+/**
+ * @brief Makes sure the span that ends where the window starts is being prefetched.
+ */
+static void queue_prefetch(struct bidi *const ctx) {
+  uint64_t const end = ctx->window_start;
+  if (end == 0) {
+    return;
+  }
+  if (!ctx->worker_started) {
+    // Without a worker, reverse playback keeps decoding each block synchronously.
+    if (thrd_create(&ctx->worker, prefetch_thread, ctx) != thrd_success) {
+      return;
+    }
+    ctx->worker_started = true;
+  }
+  mtx_lock(&ctx->mtx);
+  bool const pending = ctx->prefetch_state != prefetch_state_idle;
+  bool const match = pending && ctx->prefetch_end == end;
+  mtx_unlock(&ctx->mtx);
+  if (match) {
+    return;
+  }
+  if (pending) {
+    cancel_prefetch(ctx);
+  }
+  mtx_lock(&ctx->mtx);
+  ctx->prefetch_end = end;
+  ctx->prefetch_state = prefetch_state_queued;
+  cnd_signal(&ctx->job_queued);
+  mtx_unlock(&ctx->mtx);
+}
+
+/**
+ * @brief Takes the prefetched span if it is the requested one, waiting for the worker if needed.
+ * @param len Receives the length of the span.
+ * @param taken Set to true if the span is now in prefetch, false if it still has to be decoded.
+ */
+static NODISCARD bool take_prefetch(struct bidi *const ctx,
+                                    uint64_t const end,
+                                    size_t *const len,
+                                    bool *const taken,
+                                    struct ov_error *const err) {
+  *taken = false;
+  if (!ctx->worker_started) {
+    return true;
+  }
+  mtx_lock(&ctx->mtx);
+  bool const match = ctx->prefetch_state != prefetch_state_idle && ctx->prefetch_end == end;
+  while (match &&
+         (ctx->prefetch_state == prefetch_state_queued || ctx->prefetch_state == prefetch_state_decoding)) {
+    cnd_wait(&ctx->job_done, &ctx->mtx);
+  }
+  enum prefetch_state const state = ctx->prefetch_state;
+  if (match) {
+    ctx->prefetch_state = prefetch_state_idle;
+  }
+  mtx_unlock(&ctx->mtx);
+  if (!match) {
+    cancel_prefetch(ctx);
+    return true;
+  }
+  // The worker stays idle until the next queue_prefetch, so the buffers can be read without the lock.
+  if (state != prefetch_state_done) {
+    OV_ERROR_SET(
+        err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to decode audio for reverse playback"));
+    return false;
+  }
+  *len = ctx->prefetch_len;
+  *taken = true;
+  return true;
+}
+
+static NODISCARD bool
+read_forward(struct bidi *ctx, float const *const **pcm, size_t *samples, struct ov_error *const err) {
+  bool result = false;
+  {
+    uint64_t const window_end = ctx->window_start + ctx->window_len;
+    if (ctx->bidi_cursor >= ctx->window_start && ctx->bidi_cursor < window_end) {
+      size_t const pos = ctx->window_off + (size_t)(ctx->bidi_cursor - ctx->window_start);
       for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
-        for (size_t i = 0; i < read; ++i) {
-          ctx->buffer[ch][block_size - 1 - offset - i] = pcm[ch][i];
-        }
+        ctx->pcm[ch] = ctx->window[ch] + pos;
       }
-      offset += read;
+      size_t const r = min2(ctx->out_cap, (size_t)(window_end - ctx->bidi_cursor));
+      *pcm = ctx->pcm;
+      *samples = r;
+      ctx->bidi_cursor += r;
+      add_stats(ctx, 0, 0, r);
+      result = true;
+      goto cleanup;
+    }
+    if (ctx->bidi_cursor != window_end) {
+      reset_window(ctx, ctx->bidi_cursor);
+    }
+    cancel_prefetch(ctx);
+    if (ctx->decoder_cursor != ctx->bidi_cursor) {
+      bool const ok = ovl_audio_decoder_seek(ctx->decoder, ctx->bidi_cursor, err);
+      add_stats(ctx, 1, 0, 0);
+      if (!ok) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      ctx->decoder_cursor = ctx->bidi_cursor;
+    }
+    size_t read;
+    if (!ovl_audio_decoder_read(ctx->decoder, pcm, &read, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    window_append(ctx, *pcm, read);
+    ctx->decoder_cursor += read;
+    ctx->bidi_cursor += read;
+    *samples = read;
+    add_stats(ctx, 0, read, read);
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool fill_reverse_window(struct bidi *ctx, struct ov_error *const err) {
+  bool result = false;
+  {
+    size_t len;
+    bool taken;
+    if (!take_prefetch(ctx, ctx->window_start, &len, &taken, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (!taken && !decode_span(ctx, ctx->prefetch, ctx->window_start, &len, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
     }
-    ctx->buffer_len = offset;
-    ctx->buffer_pos = 0;
+    window_prepend(ctx, (float const *const *)ctx->prefetch, len);
   }
   result = true;
 
@@ -116,25 +539,32 @@ static NODISCARD bool
 read_reverse(struct bidi *ctx, float const *const **pcm, size_t *samples, struct ov_error *const err) {
   bool result = false;
   {
-    if (ctx->buffer_pos == ctx->buffer_len) {
-      if (ctx->bidi_cursor == 0) {
-        *samples = 0;
-        result = true;
-        goto cleanup;
+    if (ctx->bidi_cursor == 0) {
+      *samples = 0;
+      result = true;
+      goto cleanup;
+    }
+    if (ctx->bidi_cursor <= ctx->window_start || ctx->bidi_cursor > ctx->window_start + ctx->window_len) {
+      if (ctx->window_len == 0 || ctx->bidi_cursor != ctx->window_start) {
+        reset_window(ctx, ctx->bidi_cursor);
       }
-      if (!fill_reverse_buffer(ctx, err)) {
+      if (!fill_reverse_window(ctx, err)) {
         OV_ERROR_ADD_TRACE(err);
         goto cleanup;
       }
     }
-    size_t const r = min2(ctx->info->sample_rate / 10, ctx->buffer_len - ctx->buffer_pos);
+    queue_prefetch(ctx);
+    size_t const avail = (size_t)(ctx->bidi_cursor - ctx->window_start);
+    size_t const r = min2(ctx->out_cap, avail);
+    size_t const pos = ctx->window_off + avail - r;
     for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
-      ctx->pcm[ch] = ctx->buffer[ch] + ctx->buffer_pos;
+      ctx->reverse_copy(ctx->window[ch] + pos, ctx->out[ch], r);
+      ctx->pcm[ch] = ctx->out[ch];
     }
-    ctx->buffer_pos += r;
     ctx->bidi_cursor -= r;
     *pcm = ctx->pcm;
     *samples = r;
+    add_stats(ctx, 0, 0, r);
   }
   result = true;
 
@@ -164,9 +594,8 @@ static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const pos
     OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
     return false;
   }
+  // The window is kept, so seeking inside it does not decode anything either.
   ctx->bidi_cursor = position;
-  ctx->buffer_len = 0;
-  ctx->buffer_pos = 0;
   return true;
 }
 
@@ -196,28 +625,41 @@ NODISCARD bool ovl_audio_decoder_bidi_create(struct ovl_audio_decoder *const sou
         .vtable = &vtable,
         .decoder = source,
         .info = ovl_audio_decoder_get_info(source),
+        .reverse_copy = reverse_copy_get_best(),
     };
-    ctx->buffer_cap = ctx->info->sample_rate; // 1sec
-
     size_t const channels = ctx->info->channels;
-    size_t const buffer_size_aligned = adjust_align8(ctx->info->sample_rate);
+    ctx->block_size = ctx->info->sample_rate; // 1sec until the first span is measured
+    ctx->out_cap = ctx->info->sample_rate / 10;
+    ctx->window_cap = window_cap_from_budget(ctx, default_memory_budget);
+    ctx->prefetch_cap = ctx->window_cap / 2;
 
     if (!OV_REALLOC(&ctx->pcm, channels, sizeof(float *))) {
       OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
       goto cleanup;
     }
-    if (!OV_REALLOC(&ctx->buffer, channels, sizeof(float *))) {
-      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    if (!alloc_planes(&ctx->out, channels, adjust_align8(ctx->out_cap), err) ||
+        !alloc_planes(&ctx->window, channels, adjust_align8(ctx->window_cap), err) ||
+        !alloc_planes(&ctx->prefetch, channels, adjust_align8(ctx->prefetch_cap), err)) {
+      OV_ERROR_ADD_TRACE(err);
       goto cleanup;
     }
-    ctx->buffer[0] = NULL;
-    if (!OV_ALIGNED_ALLOC(&ctx->buffer[0], buffer_size_aligned * channels, sizeof(float), 16)) {
-      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    atomic_store(&ctx->cancel, false);
+    if (mtx_init(&ctx->mtx, mtx_plain) != thrd_success) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize mutex"));
+      goto cleanup;
+    }
+    if (cnd_init(&ctx->job_queued) != thrd_success) {
+      mtx_destroy(&ctx->mtx);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize condition"));
       goto cleanup;
     }
-    for (size_t ch = 1; ch < channels; ++ch) {
-      ctx->buffer[ch] = ctx->buffer[ch - 1] + buffer_size_aligned;
+    if (cnd_init(&ctx->job_done) != thrd_success) {
+      cnd_destroy(&ctx->job_queued);
+      mtx_destroy(&ctx->mtx);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize condition"));
+      goto cleanup;
     }
+    ctx->sync_initialized = true;
     *dp = (struct ovl_audio_decoder *)(void *)ctx;
   }
   result = true;
@@ -233,10 +675,76 @@ cleanup:
 
 void ovl_audio_decoder_bidi_set_direction(struct ovl_audio_decoder *const d, bool const reverse) {
   struct bidi *const ctx = (struct bidi *)(void *)d;
-  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy || ctx->reverse == reverse) {
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
     return;
   }
-  ctx->buffer_len = 0;
-  ctx->buffer_pos = 0;
+  // The window and a pending prefetch stay valid in both directions, so a flip costs nothing.
   ctx->reverse = reverse;
 }
+
+NODISCARD bool ovl_audio_decoder_bidi_get_direction(struct ovl_audio_decoder *const d, bool *const reverse) {
+  struct bidi *const ctx = (struct bidi *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy || !reverse) {
+    return false;
+  }
+  *reverse = ctx->reverse;
+  return true;
+}
+
+NODISCARD bool ovl_audio_decoder_bidi_set_memory_budget(struct ovl_audio_decoder *const d,
+                                                        size_t const bytes,
+                                                        struct ov_error *const err) {
+  struct bidi *const ctx = (struct bidi *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  size_t const cap = window_cap_from_budget(ctx, bytes);
+  float **window = NULL;
+  float **prefetch = NULL;
+  bool result = false;
+  {
+    if (cap == ctx->window_cap) {
+      result = true;
+      goto cleanup;
+    }
+    if (!alloc_planes(&window, ctx->info->channels, adjust_align8(cap), err) ||
+        !alloc_planes(&prefetch, ctx->info->channels, adjust_align8(cap / 2), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    cancel_prefetch(ctx);
+    float **tmp = ctx->window;
+    ctx->window = window;
+    window = tmp;
+    tmp = ctx->prefetch;
+    ctx->prefetch = prefetch;
+    prefetch = tmp;
+    ctx->window_cap = cap;
+    ctx->prefetch_cap = cap / 2;
+    reset_window(ctx, ctx->bidi_cursor);
+  }
+  result = true;
+
+cleanup:
+  free_planes(&prefetch);
+  free_planes(&window);
+  return result;
+}
+
+void ovl_audio_decoder_bidi_get_stats(struct ovl_audio_decoder *const d,
+                                      struct ovl_audio_decoder_bidi_stats *const stats) {
+  struct bidi *const ctx = (struct bidi *)(void *)d;
+  if (!stats) {
+    return;
+  }
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    *stats = (struct ovl_audio_decoder_bidi_stats){0};
+    return;
+  }
+  mtx_lock(&ctx->mtx);
+  *stats = ctx->stats;
+  stats->block_size = min2(ctx->block_size, ctx->prefetch_cap);
+  stats->window_size = ctx->window_cap;
+  mtx_unlock(&ctx->mtx);
+}
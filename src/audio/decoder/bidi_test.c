@@ -12,6 +12,8 @@
 #include <ovl/source.h>
 #include <ovl/source/file.h>
 
+#include <math.h>
+
 static inline size_t adjust_align8(size_t const size) { return (size + UINT64_C(7)) & ~UINT64_C(7); }
 
 static void all(void) {
@@ -565,9 +567,359 @@ cleanup:
   }
 }
 
+static void scratch(void) {
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *ogg = NULL;
+  struct ovl_audio_decoder *bidi = NULL;
+  float **golden = NULL;
+  struct ov_error err = {0};
+
+  {
+    if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &source, &err), &err)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(source, &ogg, &err), &err)) {
+      goto cleanup;
+    }
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(ogg);
+    size_t const channels = info->channels;
+    size_t const golden_len = info->sample_rate * 4;
+    size_t const golden_aligned = adjust_align8(golden_len);
+
+    if (!TEST_CHECK(OV_REALLOC(&golden, channels, sizeof(float *)))) {
+      OV_ERROR_SET_GENERIC(&err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    golden[0] = NULL;
+    if (!TEST_CHECK(OV_ALIGNED_ALLOC(&golden[0], channels * golden_aligned, sizeof(float), 16))) {
+      OV_ERROR_SET_GENERIC(&err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    for (size_t ch = 1; ch < channels; ch++) {
+      golden[ch] = golden[ch - 1] + golden_aligned;
+    }
+    {
+      size_t offset = 0;
+      while (offset < golden_len) {
+        size_t read;
+        float const *const *pcm = NULL;
+        if (!TEST_SUCCEEDED(ovl_audio_decoder_read(ogg, &pcm, &read, &err), &err)) {
+          goto cleanup;
+        }
+        if (read == 0) {
+          break;
+        }
+        size_t const sz = offset + read > golden_len ? golden_len - offset : read;
+        for (size_t ch = 0; ch < channels; ch++) {
+          memcpy(golden[ch] + offset, pcm[ch], sz * sizeof(float));
+        }
+        offset += sz;
+      }
+      TEST_CHECK(offset == golden_len);
+    }
+
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_bidi_create(ogg, &bidi, &err), &err)) {
+      goto cleanup;
+    }
+    // Smaller than the minimum on purpose; the window is raised to two minimum-sized blocks.
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_bidi_set_memory_budget(bidi, 1, &err), &err)) {
+      goto cleanup;
+    }
+
+    // Flip the direction every few reads around the middle of the golden range.
+    size_t cursor = golden_len / 2;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(bidi, cursor, &err), &err)) {
+      goto cleanup;
+    }
+    bool reverse = false;
+    size_t mismatches = 0;
+    uint64_t emitted = 0;
+    for (size_t flip = 0; flip < 40; flip++) {
+      ovl_audio_decoder_bidi_set_direction(bidi, reverse);
+      for (size_t n = 0; n < 1 + flip % 3; n++) {
+        size_t read;
+        float const *const *pcm = NULL;
+        if (!TEST_SUCCEEDED(ovl_audio_decoder_read(bidi, &pcm, &read, &err), &err)) {
+          goto cleanup;
+        }
+        if (!TEST_CHECK(read > 0 && (reverse ? read <= cursor : cursor + read <= golden_len))) {
+          goto cleanup;
+        }
+        for (size_t ch = 0; ch < channels; ch++) {
+          for (size_t i = 0; i < read; i++) {
+            float const expected = reverse ? golden[ch][cursor - 1 - i] : golden[ch][cursor + i];
+            if (fabsf(pcm[ch][i] - expected) > 0.001f) {
+              ++mismatches;
+            }
+          }
+        }
+        cursor = reverse ? cursor - read : cursor + read;
+        emitted += read;
+      }
+      reverse = !reverse;
+    }
+    TEST_CHECK(mismatches == 0);
+    TEST_MSG("mismatches=%zu", mismatches);
+
+    struct ovl_audio_decoder_bidi_stats stats = {0};
+    ovl_audio_decoder_bidi_get_stats(bidi, &stats);
+    TEST_CHECK(stats.emitted == emitted);
+    TEST_CHECK(stats.seeks > 0 && stats.decoded > 0);
+    TEST_CHECK(stats.block_size > 0 && stats.block_size <= stats.window_size / 2);
+    TEST_MSG("seeks=%llu decoded=%llu emitted=%llu block_size=%zu window_size=%zu",
+             (unsigned long long)stats.seeks,
+             (unsigned long long)stats.decoded,
+             (unsigned long long)stats.emitted,
+             stats.block_size,
+             stats.window_size);
+  }
+cleanup:
+  if (golden) {
+    OV_ALIGNED_FREE(&golden[0]);
+    OV_FREE(&golden);
+  }
+  if (bidi) {
+    ovl_audio_decoder_destroy(&bidi);
+  }
+  if (ogg) {
+    ovl_audio_decoder_destroy(&ogg);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+}
+
+// Every sample tells its position and channel apart, and stays exact in a float for these lengths.
+static float ramp_value(void const *const userdata, uint64_t const position, size_t const channel) {
+  (void)userdata;
+  return (float)position + (float)channel * 0.5f;
+}
+
+// The ramp again, decoded slowly enough that the worker is still busy when the test wants the decoder back.
+static float slow_ramp_value(void const *const userdata, uint64_t const position, size_t const channel) {
+  (void)userdata;
+  volatile uint32_t x = (uint32_t)position;
+  for (size_t i = 0; i < 100; ++i) {
+    x = x * 1664525u + 1013904223u;
+  }
+  return ramp_value(NULL, position, channel);
+}
+
+static NODISCARD bool ramp_create(size_t const channels,
+                                   uint64_t const samples,
+                                   bool const slow,
+                                   struct ovl_audio_decoder **const dp) {
+  struct ov_error err = {0};
+  return TEST_SUCCEEDED(test_util_decoder_create(
+                            &(struct test_util_decoder_options){
+                                .channels = channels,
+                                .sample_rate = 48000,
+                                .samples = samples,
+                                .chunk = slow ? 16 : 1000,
+                                .value = slow ? slow_ramp_value : ramp_value,
+                            },
+                            dp,
+                            &err),
+                        &err);
+}
+
+/**
+ * Reads once from bidi in its current direction and counts samples that differ from the ramp.
+ */
+static NODISCARD bool read_ramp(struct ovl_audio_decoder *const bidi,
+                                bool const reverse,
+                                size_t const channels,
+                                uint64_t *const cursor,
+                                size_t *const mismatches) {
+  struct ov_error err = {0};
+  size_t read;
+  float const *const *pcm = NULL;
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_read(bidi, &pcm, &read, &err), &err)) {
+    return false;
+  }
+  for (size_t ch = 0; ch < channels; ch++) {
+    for (size_t i = 0; i < read; i++) {
+      uint64_t const position = reverse ? *cursor - 1 - i : *cursor + i;
+      if (!(pcm[ch][i] == ramp_value(NULL, position, ch))) {
+        ++*mismatches;
+      }
+    }
+  }
+  *cursor = reverse ? *cursor - read : *cursor + read;
+  return true;
+}
+
+static void reverse_prefetch(void) {
+  enum {
+    channels = 2,
+    total = 48000 * 3,
+  };
+  struct ovl_audio_decoder *source = NULL;
+  struct ovl_audio_decoder *bidi = NULL;
+  float **forward = NULL;
+  struct ov_error err = {0};
+
+  {
+    if (!ramp_create(channels, total, false, &source)) {
+      goto cleanup;
+    }
+    if (!TEST_CHECK(OV_REALLOC(&forward, channels, sizeof(float *)))) {
+      goto cleanup;
+    }
+    forward[0] = NULL;
+    if (!TEST_CHECK(OV_ALIGNED_ALLOC(&forward[0], channels * adjust_align8(total), sizeof(float), 16))) {
+      goto cleanup;
+    }
+    for (size_t ch = 1; ch < channels; ch++) {
+      forward[ch] = forward[ch - 1] + adjust_align8(total);
+    }
+    size_t offset = 0;
+    while (offset < total) {
+      size_t read;
+      float const *const *pcm = NULL;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(source, &pcm, &read, &err), &err) || !TEST_CHECK(read > 0)) {
+        goto cleanup;
+      }
+      for (size_t ch = 0; ch < channels; ch++) {
+        memcpy(forward[ch] + offset, pcm[ch], read * sizeof(float));
+      }
+      offset += read;
+    }
+
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_bidi_create(source, &bidi, &err), &err)) {
+      goto cleanup;
+    }
+    // The smallest window holds two blocks, so the stream is played from dozens of prefetched spans.
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_bidi_set_memory_budget(bidi, 1, &err), &err) ||
+        !TEST_SUCCEEDED(ovl_audio_decoder_seek(bidi, total, &err), &err)) {
+      goto cleanup;
+    }
+    ovl_audio_decoder_bidi_set_direction(bidi, true);
+    size_t cursor = total;
+    size_t mismatches = 0;
+    while (cursor > 0) {
+      size_t read;
+      float const *const *pcm = NULL;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(bidi, &pcm, &read, &err), &err) ||
+          !TEST_CHECK(read > 0 && read <= cursor)) {
+        goto cleanup;
+      }
+      for (size_t ch = 0; ch < channels; ch++) {
+        for (size_t i = 0; i < read; i++) {
+          if (!(pcm[ch][i] == forward[ch][cursor - 1 - i])) {
+            ++mismatches;
+          }
+        }
+      }
+      cursor -= read;
+    }
+    TEST_CHECK(mismatches == 0);
+    TEST_MSG("mismatches=%zu", mismatches);
+
+    struct ovl_audio_decoder_bidi_stats stats = {0};
+    ovl_audio_decoder_bidi_get_stats(bidi, &stats);
+    TEST_CHECK(stats.emitted == total);
+    TEST_CHECK(stats.seeks >= total / stats.block_size);
+    TEST_MSG("seeks=%llu block_size=%zu", (unsigned long long)stats.seeks, stats.block_size);
+  }
+cleanup:
+  if (forward) {
+    OV_ALIGNED_FREE(&forward[0]);
+    OV_FREE(&forward);
+  }
+  if (bidi) {
+    ovl_audio_decoder_destroy(&bidi);
+  }
+  if (source) {
+    ovl_audio_decoder_destroy(&source);
+  }
+}
+
+static void prefetch_cancel(void) {
+  enum {
+    channels = 2,
+    total = 48000 * 10,
+    rounds = 50,
+  };
+  struct ovl_audio_decoder *source = NULL;
+  struct ovl_audio_decoder *bidi = NULL;
+  struct ov_error err = {0};
+
+  {
+    if (!ramp_create(channels, total, true, &source) ||
+        !TEST_SUCCEEDED(ovl_audio_decoder_bidi_create(source, &bidi, &err), &err) ||
+        !TEST_SUCCEEDED(ovl_audio_decoder_bidi_set_memory_budget(bidi, 1, &err), &err)) {
+      goto cleanup;
+    }
+    struct ovl_audio_decoder_bidi_stats stats = {0};
+    ovl_audio_decoder_bidi_get_stats(bidi, &stats);
+    size_t mismatches = 0;
+    uint64_t rng = UINT64_C(0x2545f4914f6cdd1d);
+    for (size_t r = 0; r < rounds; ++r) {
+      rng = rng * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+      uint64_t cursor = stats.window_size + (rng >> 33) % (total - stats.window_size * 2);
+
+      // One reverse read queues the span below the window; seeking away must drop it, wherever it got to.
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(bidi, cursor, &err), &err)) {
+        goto cleanup;
+      }
+      ovl_audio_decoder_bidi_set_direction(bidi, true);
+      if (!read_ramp(bidi, true, channels, &cursor, &mismatches)) {
+        goto cleanup;
+      }
+      cursor = r % 2 ? cursor / 2 : cursor + (total - cursor) / 2;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(bidi, cursor, &err), &err)) {
+        goto cleanup;
+      }
+      for (size_t n = 0; n < 3; ++n) {
+        if (!read_ramp(bidi, true, channels, &cursor, &mismatches)) {
+          goto cleanup;
+        }
+      }
+
+      // Reading forward past the window takes the decoder back from the worker before it is used. On odd rounds,
+      // which seeked to the lower half, the first forward read already lands past the window while the span
+      // queued by the reads above is most likely still being decoded.
+      ovl_audio_decoder_bidi_set_direction(bidi, false);
+      if (r % 2) {
+        cursor += stats.window_size * 2;
+        if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(bidi, cursor, &err), &err)) {
+          goto cleanup;
+        }
+      }
+      uint64_t const past = cursor + stats.window_size < total ? cursor + stats.window_size : total;
+      while (cursor < past) {
+        if (!read_ramp(bidi, false, channels, &cursor, &mismatches)) {
+          goto cleanup;
+        }
+      }
+
+      // And flipping back still plays what is below, whether the old prefetch survived or not.
+      ovl_audio_decoder_bidi_set_direction(bidi, true);
+      for (size_t n = 0; n < 1 + r % 4 && cursor > 0; ++n) {
+        if (!read_ramp(bidi, true, channels, &cursor, &mismatches)) {
+          goto cleanup;
+        }
+      }
+    }
+    TEST_CHECK(mismatches == 0);
+    TEST_MSG("mismatches=%zu", mismatches);
+  }
+cleanup:
+  if (bidi) {
+    ovl_audio_decoder_destroy(&bidi);
+  }
+  if (source) {
+    ovl_audio_decoder_destroy(&source);
+  }
+}
+
 TEST_LIST = {
     {"all", all},
     {"seek", seek},
     {"direction_change", direction_change},
+    {"scratch", scratch},
+    {"reverse_prefetch", reverse_prefetch},
+    {"prefetch_cancel", prefetch_cancel},
     {NULL, NULL},
 };
@@ -0,0 +1,551 @@
+#include "deinterleave.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define DEINTERLEAVE_X86 1
+#  include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define DEINTERLEAVE_NEON 1
+#  include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#  define DEINTERLEAVE_WASM 1
+#  include <wasm_simd128.h>
+#endif
+
+enum {
+  // int16 input with a channel layout that has no dedicated path is converted a block at a time into a buffer
+  // that stays in L1, then deinterleaved as float.
+  block_values = 2048,
+};
+
+static inline float i16_scale(void) { return 1.f / 32768.f; }
+
+static inline void f32_tail(float const *const src,
+                            float *const *const dst,
+                            size_t const offset,
+                            size_t const begin,
+                            size_t const frames,
+                            size_t const channels) {
+  for (size_t i = begin; i < frames; ++i) {
+    for (size_t c = 0; c < channels; ++c) {
+      dst[c][offset + i] = src[i * channels + c];
+    }
+  }
+}
+
+static inline void i16_tail(int16_t const *const src,
+                            float *const *const dst,
+                            size_t const offset,
+                            size_t const begin,
+                            size_t const frames,
+                            size_t const channels) {
+  float const scale = i16_scale();
+  for (size_t i = begin; i < frames; ++i) {
+    for (size_t c = 0; c < channels; ++c) {
+      dst[c][offset + i] = (float)src[i * channels + c] * scale;
+    }
+  }
+}
+
+static void scalar_f32(float const *const src,
+                       float *const *const dst,
+                       size_t const offset,
+                       size_t const frames,
+                       size_t const channels) {
+  f32_tail(src, dst, offset, 0, frames, channels);
+}
+
+static void scalar_i16(int16_t const *const src,
+                       float *const *const dst,
+                       size_t const offset,
+                       size_t const frames,
+                       size_t const channels) {
+  i16_tail(src, dst, offset, 0, frames, channels);
+}
+
+static struct deinterleave_kernels const scalar_kernels = {
+    .f32 = scalar_f32,
+    .i16 = scalar_i16,
+};
+
+#if defined(DEINTERLEAVE_X86) || defined(DEINTERLEAVE_NEON) || defined(DEINTERLEAVE_WASM)
+
+// Defines ISA_i16 on top of ISA_i16_mono, ISA_i16_stereo and deinterleave_f32_ISA.
+#  define DEFINE_I16_KERNEL(ISA, ATTR)                                                                                 \
+    static ATTR void ISA##_i16(int16_t const *const src,                                                               \
+                               float *const *const dst,                                                                \
+                               size_t const offset,                                                                    \
+                               size_t const frames,                                                                    \
+                               size_t const channels) {                                                                \
+      if (channels == 1) {                                                                                             \
+        ISA##_i16_mono(src, dst[0] + offset, frames);                                                                  \
+        return;                                                                                                        \
+      }                                                                                                                \
+      if (channels == 2) {                                                                                             \
+        ISA##_i16_stereo(src, dst[0] + offset, dst[1] + offset, frames);                                               \
+        return;                                                                                                        \
+      }                                                                                                                \
+      if (channels > block_values) {                                                                                   \
+        scalar_i16(src, dst, offset, frames, channels);                                                                \
+        return;                                                                                                        \
+      }                                                                                                                \
+      _Alignas(32) float tmp[block_values];                                                                            \
+      size_t const block_frames = block_values / channels;                                                             \
+      for (size_t pos = 0; pos < frames; pos += block_frames) {                                                        \
+        size_t const n = frames - pos < block_frames ? frames - pos : block_frames;                                    \
+        ISA##_i16_mono(src + pos * channels, tmp, n * channels);                                                       \
+        deinterleave_f32_##ISA(tmp, dst, offset + pos, n, channels);                                                   \
+      }                                                                                                                \
+    }
+
+#endif
+
+#ifdef DEINTERLEAVE_X86
+
+#  define SSE2 __attribute__((target("sse2")))
+#  define AVX2 __attribute__((target("avx2")))
+
+static inline SSE2 void
+transpose4(__m128 const r0, __m128 const r1, __m128 const r2, __m128 const r3, float *const *const d, size_t const i) {
+  __m128 const t0 = _mm_unpacklo_ps(r0, r1);
+  __m128 const t1 = _mm_unpacklo_ps(r2, r3);
+  __m128 const t2 = _mm_unpackhi_ps(r0, r1);
+  __m128 const t3 = _mm_unpackhi_ps(r2, r3);
+  _mm_storeu_ps(d[0] + i, _mm_movelh_ps(t0, t1));
+  _mm_storeu_ps(d[1] + i, _mm_movehl_ps(t1, t0));
+  _mm_storeu_ps(d[2] + i, _mm_movelh_ps(t2, t3));
+  _mm_storeu_ps(d[3] + i, _mm_movehl_ps(t3, t2));
+}
+
+SSE2 void deinterleave_f32_sse2(float const *const src,
+                                float *const *const dst,
+                                size_t const offset,
+                                size_t const frames,
+                                size_t const channels) {
+  size_t i = 0;
+  switch (channels) {
+  case 1:
+    memcpy(dst[0] + offset, src, frames * sizeof(float));
+    return;
+  case 2: {
+    float *const l = dst[0] + offset;
+    float *const r = dst[1] + offset;
+    for (; i + 4 <= frames; i += 4) {
+      __m128 const a = _mm_loadu_ps(src + i * 2);
+      __m128 const b = _mm_loadu_ps(src + i * 2 + 4);
+      _mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    break;
+  }
+  case 4: {
+    float *const d[4] = {dst[0] + offset, dst[1] + offset, dst[2] + offset, dst[3] + offset};
+    for (; i + 4 <= frames; i += 4) {
+      float const *const p = src + i * 4;
+      transpose4(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), _mm_loadu_ps(p + 12), d, i);
+    }
+    break;
+  }
+  case 6: {
+    float *const d[6] = {
+        dst[0] + offset, dst[1] + offset, dst[2] + offset, dst[3] + offset, dst[4] + offset, dst[5] + offset};
+    for (; i + 4 <= frames; i += 4) {
+      // Four frames are six vectors: [f0c0-3] [f0c4-5 f1c0-1] [f1c2-5] [f2c0-3] [f2c4-5 f3c0-1] [f3c2-5]
+      float const *const p = src + i * 6;
+      __m128 const v0 = _mm_loadu_ps(p);
+      __m128 const v1 = _mm_loadu_ps(p + 4);
+      __m128 const v2 = _mm_loadu_ps(p + 8);
+      __m128 const v3 = _mm_loadu_ps(p + 12);
+      __m128 const v4 = _mm_loadu_ps(p + 16);
+      __m128 const v5 = _mm_loadu_ps(p + 20);
+      __m128 const c01a = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 2, 1, 0));
+      __m128 const c01b = _mm_shuffle_ps(v3, v4, _MM_SHUFFLE(3, 2, 1, 0));
+      __m128 const c23a = _mm_shuffle_ps(v0, v2, _MM_SHUFFLE(1, 0, 3, 2));
+      __m128 const c23b = _mm_shuffle_ps(v3, v5, _MM_SHUFFLE(1, 0, 3, 2));
+      __m128 const c45a = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(3, 2, 1, 0));
+      __m128 const c45b = _mm_shuffle_ps(v4, v5, _MM_SHUFFLE(3, 2, 1, 0));
+      _mm_storeu_ps(d[0] + i, _mm_shuffle_ps(c01a, c01b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(d[1] + i, _mm_shuffle_ps(c01a, c01b, _MM_SHUFFLE(3, 1, 3, 1)));
+      _mm_storeu_ps(d[2] + i, _mm_shuffle_ps(c23a, c23b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(d[3] + i, _mm_shuffle_ps(c23a, c23b, _MM_SHUFFLE(3, 1, 3, 1)));
+      _mm_storeu_ps(d[4] + i, _mm_shuffle_ps(c45a, c45b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(d[5] + i, _mm_shuffle_ps(c45a, c45b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    break;
+  }
+  case 8: {
+    float *const lo[4] = {dst[0] + offset, dst[1] + offset, dst[2] + offset, dst[3] + offset};
+    float *const hi[4] = {dst[4] + offset, dst[5] + offset, dst[6] + offset, dst[7] + offset};
+    for (; i + 4 <= frames; i += 4) {
+      float const *const p = src + i * 8;
+      transpose4(_mm_loadu_ps(p), _mm_loadu_ps(p + 8), _mm_loadu_ps(p + 16), _mm_loadu_ps(p + 24), lo, i);
+      transpose4(_mm_loadu_ps(p + 4), _mm_loadu_ps(p + 12), _mm_loadu_ps(p + 20), _mm_loadu_ps(p + 28), hi, i);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  f32_tail(src, dst, offset, i, frames, channels);
+}
+
+static SSE2 void sse2_i16_mono(int16_t const *const src, float *const dst, size_t const n) {
+  __m128 const scale = _mm_set1_ps(i16_scale());
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i const v = _mm_loadu_si128((__m128i const *)(void const *)(src + i));
+    __m128i const lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    __m128i const hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+  }
+  for (; i < n; ++i) {
+    dst[i] = (float)src[i] * i16_scale();
+  }
+}
+
+// Each 32-bit lane holds one stereo frame, so sign-extending its low and high halves splits left and right
+// without any shuffling.
+static SSE2 void sse2_i16_stereo(int16_t const *const src, float *const l, float *const r, size_t const frames) {
+  __m128 const scale = _mm_set1_ps(i16_scale());
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    __m128i const v = _mm_loadu_si128((__m128i const *)(void const *)(src + i * 2));
+    __m128i const lv = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    __m128i const rv = _mm_srai_epi32(v, 16);
+    _mm_storeu_ps(l + i, _mm_mul_ps(_mm_cvtepi32_ps(lv), scale));
+    _mm_storeu_ps(r + i, _mm_mul_ps(_mm_cvtepi32_ps(rv), scale));
+  }
+  for (; i < frames; ++i) {
+    l[i] = (float)src[i * 2] * i16_scale();
+    r[i] = (float)src[i * 2 + 1] * i16_scale();
+  }
+}
+
+DEFINE_I16_KERNEL(sse2, SSE2)
+
+static struct deinterleave_kernels const sse2_kernels = {
+    .f32 = deinterleave_f32_sse2,
+    .i16 = sse2_i16,
+};
+
+AVX2 void deinterleave_f32_avx2(float const *const src,
+                                float *const *const dst,
+                                size_t const offset,
+                                size_t const frames,
+                                size_t const channels) {
+  if (channels != 2) {
+    // The other layouts are bound by stores and gain nothing from wider registers.
+    // deinterleave_f32_sse2 is not VEX encoded, so clear the upper halves first to avoid the transition penalty.
+    _mm256_zeroupper();
+    deinterleave_f32_sse2(src, dst, offset, frames, channels);
+    return;
+  }
+  float *const l = dst[0] + offset;
+  float *const r = dst[1] + offset;
+  size_t i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    // The in-lane shuffle yields [L0 L1 L4 L5 | L2 L3 L6 L7], the 64-bit permute restores the order.
+    __m256 const a = _mm256_loadu_ps(src + i * 2);
+    __m256 const b = _mm256_loadu_ps(src + i * 2 + 8);
+    __m256d const even = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m256d const odd = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    _mm256_storeu_ps(l + i, _mm256_castpd_ps(_mm256_permute4x64_pd(even, _MM_SHUFFLE(3, 1, 2, 0))));
+    _mm256_storeu_ps(r + i, _mm256_castpd_ps(_mm256_permute4x64_pd(odd, _MM_SHUFFLE(3, 1, 2, 0))));
+  }
+  f32_tail(src, dst, offset, i, frames, channels);
+}
+
+static AVX2 void avx2_i16_mono(int16_t const *const src, float *const dst, size_t const n) {
+  __m256 const scale = _mm256_set1_ps(i16_scale());
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i const a = _mm_loadu_si128((__m128i const *)(void const *)(src + i));
+    __m128i const b = _mm_loadu_si128((__m128i const *)(void const *)(src + i + 8));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+    _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+  }
+  for (; i < n; ++i) {
+    dst[i] = (float)src[i] * i16_scale();
+  }
+}
+
+static AVX2 void avx2_i16_stereo(int16_t const *const src, float *const l, float *const r, size_t const frames) {
+  __m256 const scale = _mm256_set1_ps(i16_scale());
+  size_t i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    __m256i const v = _mm256_loadu_si256((__m256i const *)(void const *)(src + i * 2));
+    __m256i const lv = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+    __m256i const rv = _mm256_srai_epi32(v, 16);
+    _mm256_storeu_ps(l + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lv), scale));
+    _mm256_storeu_ps(r + i, _mm256_mul_ps(_mm256_cvtepi32_ps(rv), scale));
+  }
+  for (; i < frames; ++i) {
+    l[i] = (float)src[i * 2] * i16_scale();
+    r[i] = (float)src[i * 2 + 1] * i16_scale();
+  }
+}
+
+DEFINE_I16_KERNEL(avx2, AVX2)
+
+static struct deinterleave_kernels const avx2_kernels = {
+    .f32 = deinterleave_f32_avx2,
+    .i16 = avx2_i16,
+};
+
+#endif // DEINTERLEAVE_X86
+
+#ifdef DEINTERLEAVE_NEON
+
+void deinterleave_f32_neon(float const *const src,
+                           float *const *const dst,
+                           size_t const offset,
+                           size_t const frames,
+                           size_t const channels) {
+  size_t i = 0;
+  switch (channels) {
+  case 1:
+    memcpy(dst[0] + offset, src, frames * sizeof(float));
+    return;
+  case 2:
+    for (; i + 4 <= frames; i += 4) {
+      float32x4x2_t const v = vld2q_f32(src + i * 2);
+      vst1q_f32(dst[0] + offset + i, v.val[0]);
+      vst1q_f32(dst[1] + offset + i, v.val[1]);
+    }
+    break;
+  case 4:
+    for (; i + 4 <= frames; i += 4) {
+      float32x4x4_t const v = vld4q_f32(src + i * 4);
+      for (size_t c = 0; c < 4; ++c) {
+        vst1q_f32(dst[c] + offset + i, v.val[c]);
+      }
+    }
+    break;
+  case 6:
+    for (; i + 4 <= frames; i += 4) {
+      // vld3q over two frames yields [f0cK f0cK+3 f1cK f1cK+3], unzipping with the next two frames splits them.
+      float32x4x3_t const a = vld3q_f32(src + i * 6);
+      float32x4x3_t const b = vld3q_f32(src + i * 6 + 12);
+      for (size_t c = 0; c < 3; ++c) {
+        vst1q_f32(dst[c] + offset + i, vuzp1q_f32(a.val[c], b.val[c]));
+        vst1q_f32(dst[c + 3] + offset + i, vuzp2q_f32(a.val[c], b.val[c]));
+      }
+    }
+    break;
+  case 8:
+    for (; i + 4 <= frames; i += 4) {
+      float32x4x4_t const a = vld4q_f32(src + i * 8);
+      float32x4x4_t const b = vld4q_f32(src + i * 8 + 16);
+      for (size_t c = 0; c < 4; ++c) {
+        vst1q_f32(dst[c] + offset + i, vuzp1q_f32(a.val[c], b.val[c]));
+        vst1q_f32(dst[c + 4] + offset + i, vuzp2q_f32(a.val[c], b.val[c]));
+      }
+    }
+    break;
+  default:
+    break;
+  }
+  f32_tail(src, dst, offset, i, frames, channels);
+}
+
+static inline void neon_i16x8(int16x8_t const v, float *const dst, float32x4_t const scale) {
+  vst1q_f32(dst, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+  vst1q_f32(dst + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+}
+
+static void neon_i16_mono(int16_t const *const src, float *const dst, size_t const n) {
+  float32x4_t const scale = vdupq_n_f32(i16_scale());
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    neon_i16x8(vld1q_s16(src + i), dst + i, scale);
+  }
+  for (; i < n; ++i) {
+    dst[i] = (float)src[i] * i16_scale();
+  }
+}
+
+static void neon_i16_stereo(int16_t const *const src, float *const l, float *const r, size_t const frames) {
+  float32x4_t const scale = vdupq_n_f32(i16_scale());
+  size_t i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    int16x8x2_t const v = vld2q_s16(src + i * 2);
+    neon_i16x8(v.val[0], l + i, scale);
+    neon_i16x8(v.val[1], r + i, scale);
+  }
+  for (; i < frames; ++i) {
+    l[i] = (float)src[i * 2] * i16_scale();
+    r[i] = (float)src[i * 2 + 1] * i16_scale();
+  }
+}
+
+DEFINE_I16_KERNEL(neon, )
+
+static struct deinterleave_kernels const neon_kernels = {
+    .f32 = deinterleave_f32_neon,
+    .i16 = neon_i16,
+};
+
+#endif // DEINTERLEAVE_NEON
+
+#ifdef DEINTERLEAVE_WASM
+
+static inline void simd128_transpose4(
+    v128_t const r0, v128_t const r1, v128_t const r2, v128_t const r3, float *const *const d, size_t const i) {
+  v128_t const t0 = wasm_i32x4_shuffle(r0, r1, 0, 4, 1, 5);
+  v128_t const t1 = wasm_i32x4_shuffle(r2, r3, 0, 4, 1, 5);
+  v128_t const t2 = wasm_i32x4_shuffle(r0, r1, 2, 6, 3, 7);
+  v128_t const t3 = wasm_i32x4_shuffle(r2, r3, 2, 6, 3, 7);
+  wasm_v128_store(d[0] + i, wasm_i64x2_shuffle(t0, t1, 0, 2));
+  wasm_v128_store(d[1] + i, wasm_i64x2_shuffle(t0, t1, 1, 3));
+  wasm_v128_store(d[2] + i, wasm_i64x2_shuffle(t2, t3, 0, 2));
+  wasm_v128_store(d[3] + i, wasm_i64x2_shuffle(t2, t3, 1, 3));
+}
+
+void deinterleave_f32_simd128(float const *const src,
+                              float *const *const dst,
+                              size_t const offset,
+                              size_t const frames,
+                              size_t const channels) {
+  size_t i = 0;
+  switch (channels) {
+  case 1:
+    memcpy(dst[0] + offset, src, frames * sizeof(float));
+    return;
+  case 2: {
+    float *const l = dst[0] + offset;
+    float *const r = dst[1] + offset;
+    for (; i + 4 <= frames; i += 4) {
+      v128_t const a = wasm_v128_load(src + i * 2);
+      v128_t const b = wasm_v128_load(src + i * 2 + 4);
+      wasm_v128_store(l + i, wasm_i32x4_shuffle(a, b, 0, 2, 4, 6));
+      wasm_v128_store(r + i, wasm_i32x4_shuffle(a, b, 1, 3, 5, 7));
+    }
+    break;
+  }
+  case 4: {
+    float *const d[4] = {dst[0] + offset, dst[1] + offset, dst[2] + offset, dst[3] + offset};
+    for (; i + 4 <= frames; i += 4) {
+      float const *const p = src + i * 4;
+      simd128_transpose4(
+          wasm_v128_load(p), wasm_v128_load(p + 4), wasm_v128_load(p + 8), wasm_v128_load(p + 12), d, i);
+    }
+    break;
+  }
+  case 6: {
+    float *const d[6] = {
+        dst[0] + offset, dst[1] + offset, dst[2] + offset, dst[3] + offset, dst[4] + offset, dst[5] + offset};
+    for (; i + 4 <= frames; i += 4) {
+      // Same layout as the SSE2 path: [f0c0-3] [f0c4-5 f1c0-1] [f1c2-5] [f2c0-3] [f2c4-5 f3c0-1] [f3c2-5]
+      float const *const p = src + i * 6;
+      v128_t const v0 = wasm_v128_load(p);
+      v128_t const v1 = wasm_v128_load(p + 4);
+      v128_t const v2 = wasm_v128_load(p + 8);
+      v128_t const v3 = wasm_v128_load(p + 12);
+      v128_t const v4 = wasm_v128_load(p + 16);
+      v128_t const v5 = wasm_v128_load(p + 20);
+      v128_t const c01a = wasm_i32x4_shuffle(v0, v1, 0, 1, 6, 7);
+      v128_t const c01b = wasm_i32x4_shuffle(v3, v4, 0, 1, 6, 7);
+      v128_t const c23a = wasm_i32x4_shuffle(v0, v2, 2, 3, 4, 5);
+      v128_t const c23b = wasm_i32x4_shuffle(v3, v5, 2, 3, 4, 5);
+      v128_t const c45a = wasm_i32x4_shuffle(v1, v2, 0, 1, 6, 7);
+      v128_t const c45b = wasm_i32x4_shuffle(v4, v5, 0, 1, 6, 7);
+      wasm_v128_store(d[0] + i, wasm_i32x4_shuffle(c01a, c01b, 0, 2, 4, 6));
+      wasm_v128_store(d[1] + i, wasm_i32x4_shuffle(c01a, c01b, 1, 3, 5, 7));
+      wasm_v128_store(d[2] + i, wasm_i32x4_shuffle(c23a, c23b, 0, 2, 4, 6));
+      wasm_v128_store(d[3] + i, wasm_i32x4_shuffle(c23a, c23b, 1, 3, 5, 7));
+      wasm_v128_store(d[4] + i, wasm_i32x4_shuffle(c45a, c45b, 0, 2, 4, 6));
+      wasm_v128_store(d[5] + i, wasm_i32x4_shuffle(c45a, c45b, 1, 3, 5, 7));
+    }
+    break;
+  }
+  case 8: {
+    float *const lo[4] = {dst[0] + offset, dst[1] + offset, dst[2] + offset, dst[3] + offset};
+    float *const hi[4] = {dst[4] + offset, dst[5] + offset, dst[6] + offset, dst[7] + offset};
+    for (; i + 4 <= frames; i += 4) {
+      float const *const p = src + i * 8;
+      simd128_transpose4(
+          wasm_v128_load(p), wasm_v128_load(p + 8), wasm_v128_load(p + 16), wasm_v128_load(p + 24), lo, i);
+      simd128_transpose4(
+          wasm_v128_load(p + 4), wasm_v128_load(p + 12), wasm_v128_load(p + 20), wasm_v128_load(p + 28), hi, i);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  f32_tail(src, dst, offset, i, frames, channels);
+}
+
+static void simd128_i16_mono(int16_t const *const src, float *const dst, size_t const n) {
+  v128_t const scale = wasm_f32x4_splat(i16_scale());
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    v128_t const v = wasm_v128_load(src + i);
+    v128_t const lo = wasm_i32x4_extend_low_i16x8(v);
+    v128_t const hi = wasm_i32x4_extend_high_i16x8(v);
+    wasm_v128_store(dst + i, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(lo), scale));
+    wasm_v128_store(dst + i + 4, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(hi), scale));
+  }
+  for (; i < n; ++i) {
+    dst[i] = (float)src[i] * i16_scale();
+  }
+}
+
+// Same trick as the SSE2 path: each 32-bit lane is one frame, so sign-extending its halves splits the channels.
+static void simd128_i16_stereo(int16_t const *const src, float *const l, float *const r, size_t const frames) {
+  v128_t const scale = wasm_f32x4_splat(i16_scale());
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    v128_t const v = wasm_v128_load(src + i * 2);
+    v128_t const lv = wasm_i32x4_shr(wasm_i32x4_shl(v, 16), 16);
+    v128_t const rv = wasm_i32x4_shr(v, 16);
+    wasm_v128_store(l + i, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(lv), scale));
+    wasm_v128_store(r + i, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(rv), scale));
+  }
+  for (; i < frames; ++i) {
+    l[i] = (float)src[i * 2] * i16_scale();
+    r[i] = (float)src[i * 2 + 1] * i16_scale();
+  }
+}
+
+DEFINE_I16_KERNEL(simd128, )
+
+static struct deinterleave_kernels const simd128_kernels = {
+    .f32 = deinterleave_f32_simd128,
+    .i16 = simd128_i16,
+};
+
+#endif // DEINTERLEAVE_WASM
+
+static struct deinterleave_kernels const *const tables[kernel_isa_count] = {
+    [kernel_isa_scalar] = &scalar_kernels,
+#ifdef DEINTERLEAVE_X86
+    [kernel_isa_sse2] = &sse2_kernels,
+    [kernel_isa_avx2] = &avx2_kernels,
+#endif
+#ifdef DEINTERLEAVE_NEON
+    [kernel_isa_neon] = &neon_kernels,
+#endif
+#ifdef DEINTERLEAVE_WASM
+    [kernel_isa_simd128] = &simd128_kernels,
+#endif
+};
+
+struct deinterleave_kernels const *deinterleave_get(enum kernel_isa const isa) {
+  if ((size_t)isa >= kernel_isa_count || !kernel_isa_supported(isa)) {
+    return NULL;
+  }
+  return tables[isa];
+}
+
+struct deinterleave_kernels const *deinterleave_get_best(void) {
+  for (size_t i = 0; i < kernel_isa_count; ++i) {
+    struct deinterleave_kernels const *const k = deinterleave_get(kernel_isa_preference[i]);
+    if (k) {
+      return k;
+    }
+  }
+  return &scalar_kernels;
+}
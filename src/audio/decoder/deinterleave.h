@@ -0,0 +1,73 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "../kernel.h"
+
+/**
+ * @brief Splits interleaved float samples into planes.
+ * @param src Interleaved source samples, no alignment required.
+ * @param dst Destination planes, one per channel. No alignment required.
+ * @param offset Position in each plane where the first sample is written.
+ * @param frames Number of samples per channel.
+ * @param channels Number of channels.
+ */
+typedef void (*deinterleave_f32_func)(float const *const src,
+                                      float *const *const dst,
+                                      size_t const offset,
+                                      size_t const frames,
+                                      size_t const channels);
+
+/**
+ * @brief Splits interleaved native-endian int16 samples into float planes scaled to [-1, 1).
+ * Parameters are the same as deinterleave_f32_func.
+ */
+typedef void (*deinterleave_i16_func)(int16_t const *const src,
+                                      float *const *const dst,
+                                      size_t const offset,
+                                      size_t const frames,
+                                      size_t const channels);
+
+/**
+ * @brief Deinterleave kernels for one instruction set.
+ * Every variant produces bit-identical output to the scalar kernels,
+ * with dedicated paths for mono and stereo and vectorized transposes for 4, 6 and 8 channels.
+ */
+struct deinterleave_kernels {
+  deinterleave_f32_func f32;
+  deinterleave_i16_func i16;
+};
+
+/**
+ * @brief Returns the kernels for the given instruction set.
+ * @return The kernels, or NULL if the instruction set is not compiled in or not supported by the running CPU.
+ */
+struct deinterleave_kernels const *deinterleave_get(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the fastest kernels supported by the running CPU.
+ */
+struct deinterleave_kernels const *deinterleave_get_best(void);
+
+// Float entry points for kernels compiled for the same instruction set, such as wav_kernel's
+// convert-then-deinterleave loops. Callers must have checked CPU support already.
+void deinterleave_f32_sse2(float const *const src,
+                           float *const *const dst,
+                           size_t const offset,
+                           size_t const frames,
+                           size_t const channels);
+void deinterleave_f32_avx2(float const *const src,
+                           float *const *const dst,
+                           size_t const offset,
+                           size_t const frames,
+                           size_t const channels);
+void deinterleave_f32_neon(float const *const src,
+                           float *const *const dst,
+                           size_t const offset,
+                           size_t const frames,
+                           size_t const channels);
+void deinterleave_f32_simd128(float const *const src,
+                              float *const *const dst,
+                              size_t const offset,
+                              size_t const frames,
+                              size_t const channels);
@@ -0,0 +1,277 @@
+#include "../../bench_util.h"
+
+#include "deinterleave.h"
+
+#include <string.h>
+
+enum format {
+  format_f32,
+  format_i16,
+};
+
+static struct {
+  char const *name;
+  enum format format;
+} const formats[] = {
+    {"f32", format_f32}, // minimp3 float output
+    {"i16", format_i16}, // op_read output
+};
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"scalar", kernel_isa_scalar},
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+// Buffer sizes the decoders actually hand over, plus one second at the two common rates.
+static struct {
+  char const *name;
+  size_t frames;
+  size_t sample_rate;
+} const cases[] = {
+    {"mp3_frame", 1152, 44100},
+    {"opus_chunk", 5760, 48000},
+    {"1s_44100", 44100, 44100},
+    {"1s_48000", 48000, 48000},
+};
+
+static size_t const channel_counts[] = {1, 2, 6, 8};
+
+enum {
+  max_channels = 8,
+  max_variants = kernel_isa_count,
+  repetitions = 5,
+};
+
+struct options {
+  char const *output;
+  uint64_t min_time_ns;
+};
+
+struct variant {
+  char const *name;
+  struct deinterleave_kernels const *k;
+};
+
+static inline void run_once(struct variant const *const v,
+                            enum format const format,
+                            void const *const src,
+                            float *const *const dst,
+                            size_t const frames,
+                            size_t const channels) {
+  if (format == format_f32) {
+    v->k->f32((float const *)src, dst, 0, frames, channels);
+  } else {
+    v->k->i16((int16_t const *)src, dst, 0, frames, channels);
+  }
+}
+
+static uint64_t measure(struct options const *const opts,
+                        struct variant const *const v,
+                        enum format const format,
+                        void const *const src,
+                        float *const *const dst,
+                        size_t const frames,
+                        size_t const channels,
+                        size_t *const calls_out) {
+  // Calibrate the number of calls so one repetition takes at least min_time_ns.
+  size_t calls = 1;
+  for (;;) {
+    uint64_t const t0 = bench_util_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+      run_once(v, format, src, dst, frames, channels);
+    }
+    if (bench_util_now_ns() - t0 >= opts->min_time_ns || calls >= SIZE_MAX / 2) {
+      break;
+    }
+    calls *= 2;
+  }
+  uint64_t best = UINT64_MAX;
+  for (size_t r = 0; r < repetitions; ++r) {
+    uint64_t const t0 = bench_util_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+      run_once(v, format, src, dst, frames, channels);
+    }
+    uint64_t const elapsed = bench_util_now_ns() - t0;
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+  bench_util_consume(dst[0][frames - 1]);
+  *calls_out = calls;
+  return best;
+}
+
+static NODISCARD bool run(struct options const *const opts,
+                          struct variant const *const variants,
+                          size_t const count,
+                          size_t const format_index,
+                          size_t const case_index,
+                          size_t const channels,
+                          FILE *const fp,
+                          bool *const first,
+                          struct ov_error *const err) {
+  enum format const format = formats[format_index].format;
+  size_t const frames = cases[case_index].frames;
+  void *src = NULL;
+  float *ref_buf = NULL;
+  float *out_buf = NULL;
+  bool result = false;
+
+  {
+    size_t const stride = (frames + 15) & ~(size_t)15;
+    size_t const values = frames * channels;
+    if (!OV_ALIGNED_ALLOC(&src, values, format == format_f32 ? sizeof(float) : sizeof(int16_t), 64) ||
+        !OV_ALIGNED_ALLOC(&ref_buf, stride * channels, sizeof(float), 64) ||
+        !OV_ALIGNED_ALLOC(&out_buf, stride * channels, sizeof(float), 64)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    uint64_t rng = UINT64_C(0x9e3779b97f4a7c15);
+    for (size_t i = 0; i < values; ++i) {
+      uint64_t const r = bench_util_rand(&rng);
+      if (format == format_f32) {
+        ((float *)src)[i] = (float)((double)(r >> 11) / 9007199254740992.0 * 2.0 - 1.0);
+      } else {
+        ((int16_t *)src)[i] = (int16_t)(uint16_t)r;
+      }
+    }
+    float *ref[max_channels];
+    float *out[max_channels];
+    for (size_t c = 0; c < channels; ++c) {
+      ref[c] = ref_buf + c * stride;
+      out[c] = out_buf + c * stride;
+    }
+    run_once(&variants[0], format, src, ref, frames, channels);
+
+    double scalar_ns = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+      memset(out_buf, 0, stride * channels * sizeof(float));
+      run_once(&variants[i], format, src, out, frames, channels);
+      bool matches = true;
+      for (size_t c = 0; c < channels && matches; ++c) {
+        matches = memcmp(ref[c], out[c], frames * sizeof(float)) == 0;
+      }
+      size_t calls = 0;
+      uint64_t const ns = measure(opts, &variants[i], format, src, out, frames, channels, &calls);
+      double const ns_per_call = (double)ns / (double)calls;
+      if (i == 0) {
+        scalar_ns = ns_per_call;
+      }
+      double const audio_ns = (double)frames / (double)cases[case_index].sample_rate * 1e9;
+
+      fprintf(fp, "%s\n    {\"format\": ", *first ? "" : ",");
+      bench_util_json_string(fp, formats[format_index].name);
+      fprintf(fp, ", \"case\": ");
+      bench_util_json_string(fp, cases[case_index].name);
+      fprintf(fp, ", \"variant\": ");
+      bench_util_json_string(fp, variants[i].name);
+      fprintf(fp,
+              ", \"channels\": %zu, \"frames\": %zu, \"sample_rate\": %zu, \"calls\": %zu,\n"
+              "     \"ns_per_call\": %.2f, \"samples_per_sec\": %.0f, \"x_realtime\": %.0f, "
+              "\"speedup_vs_scalar\": %.3f, \"matches_scalar\": %s}",
+              channels,
+              frames,
+              cases[case_index].sample_rate,
+              calls,
+              ns_per_call,
+              (double)values / ns_per_call * 1e9,
+              audio_ns / ns_per_call,
+              scalar_ns / ns_per_call,
+              matches ? "true" : "false");
+      fflush(fp);
+      *first = false;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (out_buf) {
+    OV_ALIGNED_FREE(&out_buf);
+  }
+  if (ref_buf) {
+    OV_ALIGNED_FREE(&ref_buf);
+  }
+  if (src) {
+    OV_ALIGNED_FREE(&src);
+  }
+  return result;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: bench_ovl_deinterleave [options]\n"
+          "  --output <path>       write JSON to path instead of stdout\n"
+          "  --min-time-ms <n>     minimum duration of one repetition (default 20)\n");
+}
+
+int main(int argc, char **argv) {
+  struct options opts = {
+      .min_time_ns = UINT64_C(20000000),
+  };
+  for (int i = 1; i < argc; ++i) {
+    char const *const a = argv[i];
+    char const *const v = i + 1 < argc ? argv[i + 1] : NULL;
+    bool ok = v != NULL;
+    if (ok && strcmp(a, "--output") == 0) {
+      opts.output = v;
+    } else if (ok && strcmp(a, "--min-time-ms") == 0) {
+      char *end = NULL;
+      unsigned long long const n = strtoull(v, &end, 10);
+      ok = *v && !*end && n > 0;
+      opts.min_time_ns = (uint64_t)n * UINT64_C(1000000);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage();
+      return 2;
+    }
+    ++i;
+  }
+
+  struct variant variants[max_variants];
+  size_t count = 0;
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    struct deinterleave_kernels const *const k = deinterleave_get(isas[i].isa);
+    if (k) {
+      variants[count++] = (struct variant){isas[i].name, k};
+    }
+  }
+
+  struct ov_error err = {0};
+  FILE *fp = stdout;
+  bool first = true;
+  int exit_code = 1;
+  if (opts.output) {
+    fp = fopen(opts.output, "w");
+    if (!fp) {
+      fprintf(stderr, "failed to open %s\n", opts.output);
+      return 1;
+    }
+  }
+  fprintf(fp, "{\n  \"schema\": 1,\n  \"results\": [");
+  for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+      for (size_t ch = 0; ch < sizeof(channel_counts) / sizeof(channel_counts[0]); ++ch) {
+        if (!run(&opts, variants, count, f, c, channel_counts[ch], fp, &first, &err)) {
+          OV_ERROR_REPORT(&err, NULL);
+          goto cleanup;
+        }
+      }
+    }
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  exit_code = 0;
+
+cleanup:
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return exit_code;
+}
@@ -0,0 +1,131 @@
+#include <ovtest.h>
+
+#include "deinterleave.h"
+
+#include <string.h>
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+enum {
+  max_channels = 9,
+  max_samples = 5000,
+  // Planes start this far into their buffers so every kernel also has to handle offset and unaligned output.
+  offset = 3,
+};
+
+static size_t const sample_counts[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 100, 1023, max_samples};
+
+static uint64_t next_rand(uint64_t *const state) {
+  *state = *state * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+  return *state >> 11;
+}
+
+static float ref_buf[max_channels][max_samples + offset + 1];
+static float out_buf[max_channels][max_samples + offset + 1];
+
+static bool same_output(size_t const channels) {
+  for (size_t c = 0; c < channels; ++c) {
+    if (memcmp(ref_buf[c], out_buf[c], sizeof(ref_buf[c])) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void f32_matches_scalar(void) {
+  struct deinterleave_kernels const *const scalar = deinterleave_get(kernel_isa_scalar);
+  if (!TEST_CHECK(scalar != NULL)) {
+    return;
+  }
+  TEST_CHECK(deinterleave_get_best() != NULL);
+
+  static float src[max_samples * max_channels];
+  float *ref[max_channels];
+  float *out[max_channels];
+  for (size_t c = 0; c < max_channels; ++c) {
+    ref[c] = ref_buf[c];
+    out[c] = out_buf[c];
+  }
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    struct deinterleave_kernels const *const k = deinterleave_get(isas[i].isa);
+    if (!k) {
+      TEST_MSG("%s is not available", isas[i].name);
+      continue;
+    }
+    for (size_t channels = 1; channels <= max_channels; ++channels) {
+      for (size_t si = 0; si < sizeof(sample_counts) / sizeof(sample_counts[0]); ++si) {
+        size_t const samples = sample_counts[si];
+        uint64_t rng = (uint64_t)(channels * 17 + si);
+        for (size_t j = 0; j < samples * channels; ++j) {
+          src[j] = (float)((double)next_rand(&rng) / 9007199254740992.0 * 2.0 - 1.0);
+        }
+        // Both buffers start with the same fill so writes outside [offset, offset + samples) are caught too.
+        memset(ref_buf, 0x55, sizeof(ref_buf));
+        memset(out_buf, 0x55, sizeof(out_buf));
+        scalar->f32(src, ref, offset, samples, channels);
+        k->f32(src, out, offset, samples, channels);
+        if (!TEST_CHECK(same_output(channels))) {
+          TEST_MSG("%s f32 channels=%zu samples=%zu differs from scalar", isas[i].name, channels, samples);
+          return;
+        }
+      }
+    }
+  }
+}
+
+static void i16_matches_scalar(void) {
+  struct deinterleave_kernels const *const scalar = deinterleave_get(kernel_isa_scalar);
+  if (!TEST_CHECK(scalar != NULL)) {
+    return;
+  }
+
+  static int16_t src[max_samples * max_channels];
+  float *ref[max_channels];
+  float *out[max_channels];
+  for (size_t c = 0; c < max_channels; ++c) {
+    ref[c] = ref_buf[c];
+    out[c] = out_buf[c];
+  }
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    struct deinterleave_kernels const *const k = deinterleave_get(isas[i].isa);
+    if (!k) {
+      TEST_MSG("%s is not available", isas[i].name);
+      continue;
+    }
+    for (size_t channels = 1; channels <= max_channels; ++channels) {
+      for (size_t si = 0; si < sizeof(sample_counts) / sizeof(sample_counts[0]); ++si) {
+        size_t const samples = sample_counts[si];
+        uint64_t rng = (uint64_t)(channels * 31 + si);
+        for (size_t j = 0; j < samples * channels; ++j) {
+          src[j] = (int16_t)(uint16_t)next_rand(&rng);
+        }
+        if (samples * channels >= 2) {
+          src[0] = INT16_MIN;
+          src[1] = INT16_MAX;
+        }
+        memset(ref_buf, 0x55, sizeof(ref_buf));
+        memset(out_buf, 0x55, sizeof(out_buf));
+        scalar->i16(src, ref, offset, samples, channels);
+        k->i16(src, out, offset, samples, channels);
+        if (!TEST_CHECK(same_output(channels))) {
+          TEST_MSG("%s i16 channels=%zu samples=%zu differs from scalar", isas[i].name, channels, samples);
+          return;
+        }
+      }
+    }
+  }
+}
+
+TEST_LIST = {
+    {"f32_matches_scalar", f32_matches_scalar},
+    {"i16_matches_scalar", i16_matches_scalar},
+    {NULL, NULL},
+};
@@ -2,12 +2,20 @@
 
 #include "../tag.h"
 #include "../tag/vorbis_comment.h"
+#include "flac_frame.h"
+#include "flac_inline.h"
+#include "flac_mt.h"
 
 #include <ovl/audio/decoder.h>
 #include <ovl/audio/info.h>
+#include <ovl/os.h>
 #include <ovl/source.h>
 
 #include <ovmo.h>
+#include <ovthreads.h>
+
+#include <stdatomic.h>
+#include <string.h>
 
 #ifdef __GNUC__
 #  ifndef __has_warning
@@ -26,65 +34,10 @@
 #  pragma GCC diagnostic pop
 #endif // __GNUC__
 
-#if defined(__GNUC__) || defined(__clang__)
-#  define ASSUME_ALIGNED_16(ptr) __builtin_assume_aligned((ptr), 16)
-#else
-#  define ASSUME_ALIGNED_16(ptr) (ptr)
-#endif
-
-static void convert_samples_1ch(int32_t const *const *const src,
-                                size_t const src_offset,
-                                float *const *const dst,
-                                size_t const samples,
-                                float const scale) {
-  int32_t const *const s = src[0] + src_offset;
-  float *const d = (float *)ASSUME_ALIGNED_16(dst[0]);
-  for (size_t i = 0; i < samples; ++i) {
-    d[i] = (float)s[i] * scale;
-  }
-}
-static void convert_samples_2ch(int32_t const *const *const src,
-                                size_t const src_offset,
-                                float *const *const dst,
-                                size_t const samples,
-                                float const scale) {
-  int32_t const *const sl = src[0] + src_offset;
-  int32_t const *const sr = src[1] + src_offset;
-  float *const l = (float *)ASSUME_ALIGNED_16(dst[0]);
-  float *const r = (float *)ASSUME_ALIGNED_16(dst[1]);
-  for (size_t i = 0; i < samples; ++i) {
-    l[i] = (float)sl[i] * scale;
-    r[i] = (float)sr[i] * scale;
-  }
-}
-static void convert_samples_multi(int32_t const *const *const src,
-                                  size_t const src_offset,
-                                  float *const *const dst,
-                                  size_t const channels,
-                                  size_t const samples,
-                                  float const scale) {
-  for (size_t c = 0; c < channels; ++c) {
-    float *const aligned_d = (float *)ASSUME_ALIGNED_16(dst[c]);
-    for (size_t i = 0; i < samples; ++i) {
-      aligned_d[i] = (float)src[c][src_offset + i] * scale;
-    }
-  }
-}
-static void convert_samples(int32_t const *const *const src,
-                            size_t const src_offset,
-                            float *const *const dst,
-                            size_t const channels,
-                            size_t const samples,
-                            uint32_t bits_per_sample) {
-  float const scale = 1.f / (float)(1u << (bits_per_sample - 1));
-  if (channels == 1) {
-    convert_samples_1ch(src, src_offset, dst, samples, scale);
-  } else if (channels == 2) {
-    convert_samples_2ch(src, src_offset, dst, samples, scale);
-  } else {
-    convert_samples_multi(src, src_offset, dst, channels, samples, scale);
-  }
-}
+struct seekpoint {
+  uint64_t sample;
+  uint64_t offset;
+};
 
 struct flac {
   struct ovl_audio_decoder_vtable const *vtable;
@@ -94,12 +47,112 @@ struct flac {
 
   FLAC__StreamDecoder *decoder;
   struct ovl_audio_info info;
+  uint32_t min_blocksize;
+  uint32_t max_blocksize;
+  uint32_t min_framesize;
 
+  flac_kernel_func kernel;
   float **buffer;
   size_t buffer_len;
   size_t buffer_cap;
+
+  // Caller-supplied planes set by ovl_audio_decoder_flac_read_into for the duration of one call.
+  // write_callback converts into them directly instead of going through buffer.
+  float *const *out;
+  size_t out_cap;
+
+  // Seek table learned from decoded frames and/or built by scanning frame headers.
+  // The file's own SEEKTABLE is left to libFLAC; this covers files that lack one.
+  struct seekpoint *seekpoints;
+  size_t seekpoints_len;
+  size_t seekpoints_cap;
+  uint64_t audio_offset;
+  uint64_t frame_offset;
+  uint64_t skip_samples;
+
+  // Guards source and seekpoints while the table builder thread is running.
+  mtx_t mtx;
+  bool mtx_initialized;
+  thrd_t builder;
+  bool builder_running;
+  atomic_bool builder_cancel;
+
+  // Frame-parallel pipeline, used instead of the decoder above when created by flac_create_mt.
+  struct flac_mt *mt;
 };
 
+static size_t find_seekpoint_index(struct seekpoint const *const sp, size_t const len, uint64_t const sample) {
+  // Returns the number of entries whose sample is <= the given sample.
+  size_t lo = 0;
+  size_t hi = len;
+  while (lo < hi) {
+    size_t const mid = lo + (hi - lo) / 2;
+    if (sp[mid].sample <= sample) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static NODISCARD bool
+reserve_seekpoints(struct seekpoint **const sp, size_t *const cap, size_t const n, struct ov_error *const err) {
+  if (n <= *cap) {
+    return true;
+  }
+  size_t newcap = *cap ? *cap : 256;
+  while (newcap < n) {
+    newcap *= 2;
+  }
+  if (!OV_REALLOC(sp, newcap, sizeof(struct seekpoint))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  *cap = newcap;
+  return true;
+}
+
+static void learn_seekpoint(struct flac *const ctx, uint64_t const sample, uint64_t const offset) {
+  mtx_lock(&ctx->mtx);
+  size_t const idx = find_seekpoint_index(ctx->seekpoints, ctx->seekpoints_len, sample);
+  if (idx > 0 && ctx->seekpoints[idx - 1].sample == sample) {
+    goto cleanup;
+  }
+  struct ov_error err = {0};
+  if (!reserve_seekpoints(&ctx->seekpoints, &ctx->seekpoints_cap, ctx->seekpoints_len + 1, &err)) {
+    OV_ERROR_REPORT(&err, NULL);
+    goto cleanup;
+  }
+  memmove(ctx->seekpoints + idx + 1, ctx->seekpoints + idx, (ctx->seekpoints_len - idx) * sizeof(struct seekpoint));
+  ctx->seekpoints[idx] = (struct seekpoint){
+      .sample = sample,
+      .offset = offset,
+  };
+  ++ctx->seekpoints_len;
+cleanup:
+  mtx_unlock(&ctx->mtx);
+}
+
+static bool find_seekpoint(struct flac *const ctx, uint64_t const sample, struct seekpoint *const sp) {
+  mtx_lock(&ctx->mtx);
+  size_t const idx = find_seekpoint_index(ctx->seekpoints, ctx->seekpoints_len, sample);
+  bool const found = idx > 0;
+  if (found) {
+    *sp = ctx->seekpoints[idx - 1];
+  }
+  mtx_unlock(&ctx->mtx);
+  return found;
+}
+
+static size_t read_source(void *const userdata, void *const p, uint64_t const offset, size_t const len) {
+  struct flac *const ctx = (struct flac *)userdata;
+  mtx_lock(&ctx->mtx);
+  size_t const r = ovl_source_read(ctx->source, p, offset, len);
+  mtx_unlock(&ctx->mtx);
+  return r;
+}
+
 static FLAC__StreamDecoderReadStatus
 read_callback(FLAC__StreamDecoder const *const decoder, FLAC__byte buffer[], size_t *bytes, void *client_data) {
   (void)decoder;
@@ -107,7 +160,7 @@ read_callback(FLAC__StreamDecoder const *const decoder, FLAC__byte buffer[], siz
   if (ctx->source_pos >= ctx->source_len) {
     return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
   }
-  size_t const read = ovl_source_read(ctx->source, buffer, ctx->source_pos, *bytes);
+  size_t const read = read_source(ctx, buffer, ctx->source_pos, *bytes);
   if (read == SIZE_MAX) {
     return FLAC__STREAM_DECODER_READ_STATUS_ABORT;
   }
@@ -178,6 +231,9 @@ static void metadata_callback(FLAC__StreamDecoder const *const decoder,
     ctx->info.channels = metadata->data.stream_info.channels;
     ctx->info.sample_rate = metadata->data.stream_info.sample_rate;
     ctx->info.samples = metadata->data.stream_info.total_samples;
+    ctx->min_blocksize = metadata->data.stream_info.min_blocksize;
+    ctx->max_blocksize = metadata->data.stream_info.max_blocksize;
+    ctx->min_framesize = metadata->data.stream_info.min_framesize;
     return;
   }
   if (metadata->type == FLAC__METADATA_TYPE_VORBIS_COMMENT) {
@@ -203,7 +259,12 @@ static FLAC__StreamDecoderWriteStatus write_callback(FLAC__StreamDecoder const *
   if (frame->header.channels != ctx->info.channels) {
     return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
   }
-  if (frame->header.blocksize > ctx->buffer_cap) {
+  size_t const skip = ctx->skip_samples < frame->header.blocksize ? (size_t)ctx->skip_samples : frame->header.blocksize;
+  size_t const frame_size = frame->header.blocksize - skip;
+  if (ctx->out && frame_size > ctx->out_cap) {
+    return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+  }
+  if (!ctx->out && frame->header.blocksize > ctx->buffer_cap) {
     size_t const align = 16 / sizeof(float);
     size_t const aligned_samples = (frame->header.blocksize + (align - 1)) & ~(align - 1);
     float *new_buffer = NULL;
@@ -221,8 +282,17 @@ static FLAC__StreamDecoderWriteStatus write_callback(FLAC__StreamDecoder const *
     }
     ctx->buffer_cap = aligned_samples;
   }
-  size_t const frame_size = frame->header.blocksize;
-  convert_samples(buffer, 0, ctx->buffer, frame->header.channels, frame_size, frame->header.bits_per_sample);
+  if (ctx->frame_offset != UINT64_MAX) {
+    learn_seekpoint(ctx, frame->header.number.sample_number, ctx->frame_offset);
+  }
+  ctx->skip_samples -= skip;
+  convert_samples(ctx->kernel,
+                  buffer,
+                  skip,
+                  ctx->out ? ctx->out : ctx->buffer,
+                  frame->header.channels,
+                  frame_size,
+                  frame->header.bits_per_sample);
   ctx->buffer_len = frame_size;
   return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
@@ -233,9 +303,21 @@ static void destroy(struct ovl_audio_decoder **const dp) {
     return;
   }
   struct flac *const ctx = *ctxp;
+  if (ctx->builder_running) {
+    atomic_store(&ctx->builder_cancel, true);
+    thrd_join(ctx->builder, NULL);
+    ctx->builder_running = false;
+  }
+  flac_mt_destroy(&ctx->mt);
   if (ctx->decoder) {
     FLAC__stream_decoder_delete(ctx->decoder);
   }
+  if (ctx->seekpoints) {
+    OV_FREE(&ctx->seekpoints);
+  }
+  if (ctx->mtx_initialized) {
+    mtx_destroy(&ctx->mtx);
+  }
   ovl_audio_tag_destroy(&ctx->info.tag);
   if (ctx->buffer) {
     if (ctx->buffer[0]) {
@@ -254,28 +336,45 @@ static struct ovl_audio_info const *get_info(struct ovl_audio_decoder const *con
   return &ctx->info;
 }
 
+// Decodes until a frame produces samples or the stream ends; buffer_len stays 0 at the end of the stream.
+static NODISCARD bool decode_frame(struct flac *const ctx, struct ov_error *const err) {
+  while (ctx->buffer_len == 0) {
+    FLAC__StreamDecoderState const state = FLAC__stream_decoder_get_state(ctx->decoder);
+    if (state == FLAC__STREAM_DECODER_END_OF_STREAM) {
+      return true;
+    }
+    // Remember where this frame starts so write_callback can record it as a seek point.
+    FLAC__uint64 pos;
+    ctx->frame_offset = FLAC__stream_decoder_get_decode_position(ctx->decoder, &pos) ? pos : UINT64_MAX;
+    bool const ok = FLAC__stream_decoder_process_single(ctx->decoder);
+    ctx->frame_offset = UINT64_MAX;
+    if (!ok) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to decode FLAC frame"));
+      return false;
+    }
+  }
+  return true;
+}
+
 static NODISCARD bool read(struct ovl_audio_decoder *const d,
                            float const *const **const pcm,
                            size_t *const samples,
                            struct ov_error *const err) {
   struct flac *const ctx = (struct flac *)(void *)d;
-  if (!ctx || !pcm || !samples || !ctx->decoder || !ctx->buffer) {
+  if (!ctx || !pcm || !samples) {
     OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
     return false;
   }
-  *pcm = (float const **)ov_deconster_(ctx->buffer);
-  if (ctx->buffer_len > 0) {
-    *samples = ctx->buffer_len;
-    ctx->buffer_len = 0;
-    return true;
+  if (ctx->mt) {
+    return flac_mt_read(ctx->mt, pcm, samples, err);
   }
-  FLAC__StreamDecoderState const state = FLAC__stream_decoder_get_state(ctx->decoder);
-  if (state == FLAC__STREAM_DECODER_END_OF_STREAM) {
-    *samples = 0;
-    return true;
+  if (!ctx->decoder || !ctx->buffer) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
   }
-  if (!FLAC__stream_decoder_process_single(ctx->decoder)) {
-    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to decode FLAC frame"));
+  *pcm = (float const **)ov_deconster_(ctx->buffer);
+  if (!decode_frame(ctx, err)) {
+    OV_ERROR_ADD_TRACE(err);
     return false;
   }
   *samples = ctx->buffer_len;
@@ -289,6 +388,23 @@ static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const pos
     OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
     return false;
   }
+  if (ctx->mt) {
+    return flac_mt_seek(ctx->mt, position, err);
+  }
+  struct seekpoint sp;
+  if (find_seekpoint(ctx, position, &sp) && position - sp.sample < ctx->info.sample_rate) {
+    // Jump straight to the known frame and decode forward; up to one second of decoding
+    // is cheaper than libFLAC's bisection over the byte stream.
+    if (!FLAC__stream_decoder_flush(ctx->decoder)) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to seek"));
+      return false;
+    }
+    ctx->source_pos = sp.offset;
+    ctx->skip_samples = position - sp.sample;
+    ctx->buffer_len = 0;
+    return true;
+  }
+  ctx->skip_samples = 0;
   if (!FLAC__stream_decoder_seek_absolute(ctx->decoder, position)) {
     OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to seek"));
     return false;
@@ -296,6 +412,122 @@ static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const pos
   return true;
 }
 
+static NODISCARD bool seek_keyframe(struct ovl_audio_decoder *const d,
+                                    uint64_t const position,
+                                    uint64_t *const actual,
+                                    struct ov_error *const err) {
+  struct flac *const ctx = (struct flac *)(void *)d;
+  if (!ctx || !actual) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (!seek(d, position, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  // When seek starts from a known frame, the samples it would skip are the only decoding thrown away,
+  // so land on the frame itself instead.
+  *actual = position - ctx->skip_samples;
+  ctx->skip_samples = 0;
+  return true;
+}
+
+static NODISCARD bool build_seek_table(struct flac *const ctx, struct ov_error *const err) {
+  struct flac_frame_scanner scanner = {0};
+  struct seekpoint *scanned = NULL;
+  size_t scanned_len = 0;
+  size_t scanned_cap = 0;
+  struct seekpoint *merged = NULL;
+  bool result = false;
+  {
+    uint32_t const fixed_blocksize = ctx->min_blocksize == ctx->max_blocksize ? ctx->min_blocksize : 0;
+    if (!flac_frame_scanner_init(&scanner,
+                                 read_source,
+                                 ctx,
+                                 ctx->audio_offset,
+                                 ctx->source_len,
+                                 fixed_blocksize,
+                                 ctx->min_framesize,
+                                 err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    for (;;) {
+      if (atomic_load(&ctx->builder_cancel)) {
+        result = true;
+        goto cleanup;
+      }
+      struct flac_frame frame;
+      bool found = false;
+      if (!flac_frame_scanner_next(&scanner, &frame, &found, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      if (!found) {
+        break;
+      }
+      if (!reserve_seekpoints(&scanned, &scanned_cap, scanned_len + 1, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      scanned[scanned_len++] = (struct seekpoint){
+          .sample = frame.sample,
+          .offset = frame.offset,
+      };
+    }
+
+    // Merge with the points learned while decoding, which may lie beyond a damaged region.
+    mtx_lock(&ctx->mtx);
+    size_t const learned_len = ctx->seekpoints_len;
+    if (!OV_REALLOC(&merged, scanned_len + learned_len + 1, sizeof(struct seekpoint))) {
+      mtx_unlock(&ctx->mtx);
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    size_t i = 0, j = 0, n = 0;
+    while (i < scanned_len || j < learned_len) {
+      struct seekpoint const *v;
+      if (j == learned_len || (i < scanned_len && scanned[i].sample <= ctx->seekpoints[j].sample)) {
+        v = &scanned[i++];
+        if (j < learned_len && ctx->seekpoints[j].sample == v->sample) {
+          ++j;
+        }
+      } else {
+        v = &ctx->seekpoints[j++];
+      }
+      merged[n++] = *v;
+    }
+    if (ctx->seekpoints) {
+      OV_FREE(&ctx->seekpoints);
+    }
+    ctx->seekpoints = merged;
+    ctx->seekpoints_len = n;
+    ctx->seekpoints_cap = scanned_len + learned_len + 1;
+    merged = NULL;
+    mtx_unlock(&ctx->mtx);
+  }
+  result = true;
+
+cleanup:
+  if (merged) {
+    OV_FREE(&merged);
+  }
+  if (scanned) {
+    OV_FREE(&scanned);
+  }
+  flac_frame_scanner_exit(&scanner);
+  return result;
+}
+
+static int builder_thread(void *const userdata) {
+  struct flac *const ctx = (struct flac *)userdata;
+  struct ov_error err = {0};
+  if (!build_seek_table(ctx, &err)) {
+    OV_ERROR_REPORT(&err, NULL);
+  }
+  return 0;
+}
+
 NODISCARD bool ovl_audio_decoder_flac_create(struct ovl_source *const source,
                                              struct ovl_audio_decoder **const dp,
                                              struct ov_error *const err) {
@@ -317,11 +549,14 @@ NODISCARD bool ovl_audio_decoder_flac_create(struct ovl_source *const source,
         .get_info = get_info,
         .read = read,
         .seek = seek,
+        .seek_keyframe = seek_keyframe,
     };
     *ctx = (struct flac){
         .vtable = &vtable,
         .source = source,
         .source_len = ovl_source_size(source),
+        .frame_offset = UINT64_MAX,
+        .kernel = flac_kernel_get_best(),
         .info =
             {
                 .tag =
@@ -336,6 +571,11 @@ NODISCARD bool ovl_audio_decoder_flac_create(struct ovl_source *const source,
       OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to get source size"));
       goto cleanup;
     }
+    if (mtx_init(&ctx->mtx, mtx_plain) != thrd_success) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize mutex"));
+      goto cleanup;
+    }
+    ctx->mtx_initialized = true;
     ctx->decoder = FLAC__stream_decoder_new();
     if (!ctx->decoder) {
       OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to allocate flac decoder"));
@@ -360,6 +600,12 @@ NODISCARD bool ovl_audio_decoder_flac_create(struct ovl_source *const source,
       OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to process FLAC metadata"));
       goto cleanup;
     }
+    FLAC__uint64 audio_offset;
+    if (!FLAC__stream_decoder_get_decode_position(ctx->decoder, &audio_offset)) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to get FLAC audio offset"));
+      goto cleanup;
+    }
+    ctx->audio_offset = audio_offset;
     if (!OV_REALLOC(&ctx->buffer, ctx->info.channels, sizeof(float *))) {
       OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
       goto cleanup;
@@ -377,3 +623,154 @@ cleanup:
   }
   return result;
 }
+
+NODISCARD bool ovl_audio_decoder_flac_build_seek_table(struct ovl_audio_decoder *const d,
+                                                       bool const background,
+                                                       struct ov_error *const err) {
+  struct flac *const ctx = (struct flac *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (ctx->builder_running) {
+    return true;
+  }
+  if (!background) {
+    if (!build_seek_table(ctx, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    return true;
+  }
+  atomic_store(&ctx->builder_cancel, false);
+  if (thrd_create(&ctx->builder, builder_thread, ctx) != thrd_success) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to create thread"));
+    return false;
+  }
+  ctx->builder_running = true;
+  return true;
+}
+
+size_t ovl_audio_decoder_flac_get_max_block_size(struct ovl_audio_decoder const *const d) {
+  struct flac const *const ctx = (struct flac const *)(void const *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    return 0;
+  }
+  return ctx->max_blocksize;
+}
+
+NODISCARD bool ovl_audio_decoder_flac_read_into(struct ovl_audio_decoder *const d,
+                                                float *const *const dst,
+                                                size_t const capacity,
+                                                size_t *const samples,
+                                                struct ov_error *const err) {
+  struct flac *const ctx = (struct flac *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy || !dst || !samples || (!ctx->decoder && !ctx->mt) ||
+      capacity < ctx->max_blocksize) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (ctx->mt) {
+    // Worker threads decode ahead into their own planes, so the frame has to be copied here.
+    float const *const *pcm = NULL;
+    size_t n = 0;
+    if (!flac_mt_read(ctx->mt, &pcm, &n, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    if (n > capacity) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to decode FLAC frame"));
+      return false;
+    }
+    for (size_t c = 0; c < ctx->info.channels; ++c) {
+      memcpy(dst[c], pcm[c], n * sizeof(float));
+    }
+    *samples = n;
+    return true;
+  }
+  if (ctx->buffer_len) {
+    // FLAC__stream_decoder_seek_absolute decodes the target frame into buffer before the next read.
+    for (size_t c = 0; c < ctx->info.channels; ++c) {
+      memcpy(dst[c], ctx->buffer[c], ctx->buffer_len * sizeof(float));
+    }
+    *samples = ctx->buffer_len;
+    ctx->buffer_len = 0;
+    return true;
+  }
+  ctx->out = dst;
+  ctx->out_cap = capacity;
+  bool const ok = decode_frame(ctx, err);
+  ctx->out = NULL;
+  ctx->out_cap = 0;
+  if (!ok) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  *samples = ctx->buffer_len;
+  ctx->buffer_len = 0;
+  return true;
+}
+
+NODISCARD bool ovl_audio_decoder_flac_create_mt(struct ovl_source *const source,
+                                                size_t const threads,
+                                                struct ovl_audio_decoder **const dp,
+                                                struct ov_error *const err) {
+  if (!dp || *dp || !source) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  struct ovl_audio_decoder *d = NULL;
+  uint8_t *header = NULL;
+  bool result = false;
+  {
+    if (!ovl_audio_decoder_flac_create(source, &d, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    struct flac *const ctx = (struct flac *)(void *)d;
+    if (ctx->audio_offset > SIZE_MAX) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_fail);
+      goto cleanup;
+    }
+    size_t const header_len = (size_t)ctx->audio_offset;
+    if (!OV_REALLOC(&header, header_len, sizeof(uint8_t))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (read_source(ctx, header, 0, header_len) != header_len) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read FLAC stream"));
+      goto cleanup;
+    }
+    if (!flac_mt_create(&ctx->mt,
+                        &(struct flac_mt_params){
+                            .read = read_source,
+                            .userdata = ctx,
+                            .header = header,
+                            .header_len = header_len,
+                            .source_len = ctx->source_len,
+                            .fixed_blocksize = ctx->min_blocksize == ctx->max_blocksize ? ctx->min_blocksize : 0,
+                            .min_framesize = ctx->min_framesize,
+                            .channels = ctx->info.channels,
+                            .threads = threads ? threads : ovl_os_get_cpu_count(),
+                        },
+                        err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    // Only needed for the metadata; the workers own a decoder each.
+    FLAC__stream_decoder_delete(ctx->decoder);
+    ctx->decoder = NULL;
+    *dp = d;
+    d = NULL;
+  }
+  result = true;
+
+cleanup:
+  if (header) {
+    OV_FREE(&header);
+  }
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  return result;
+}
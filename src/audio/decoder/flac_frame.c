@@ -0,0 +1,213 @@
+#include "flac_frame.h"
+
+#include <ovmo.h>
+#include <string.h>
+
+enum {
+  scan_chunk_size = 64 * 1024,
+  // sync(2) + codes(2) + frame/sample number(7) + block size(2) + sample rate(2) + CRC-8(1)
+  max_header_size = 16,
+};
+
+static uint8_t crc8(uint8_t const *const p, size_t const len) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= p[i];
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static bool parse_header(uint8_t const *const p,
+                         size_t const len,
+                         uint32_t const fixed_blocksize,
+                         uint64_t *const sample,
+                         uint32_t *const blocksize,
+                         size_t *const header_bytes) {
+  if (len < 6 || p[0] != 0xff || (p[1] & 0xfe) != 0xf8) {
+    return false;
+  }
+  bool const variable = p[1] & 1;
+  uint8_t const blocksize_code = p[2] >> 4;
+  uint8_t const sample_rate_code = p[2] & 0x0f;
+  uint8_t const channel_assignment = p[3] >> 4;
+  uint8_t const sample_size_code = (p[3] >> 1) & 0x07;
+  if (blocksize_code == 0 || sample_rate_code == 0x0f || channel_assignment > 10 || sample_size_code == 3 ||
+      (p[3] & 1)) {
+    return false;
+  }
+  size_t n = 4;
+
+  // UTF-8 like coded frame number (fixed block size) or sample number (variable block size)
+  uint8_t const lead = p[n++];
+  uint64_t number;
+  size_t extra;
+  if (!(lead & 0x80)) {
+    number = lead;
+    extra = 0;
+  } else if ((lead & 0xe0) == 0xc0) {
+    number = lead & 0x1f;
+    extra = 1;
+  } else if ((lead & 0xf0) == 0xe0) {
+    number = lead & 0x0f;
+    extra = 2;
+  } else if ((lead & 0xf8) == 0xf0) {
+    number = lead & 0x07;
+    extra = 3;
+  } else if ((lead & 0xfc) == 0xf8) {
+    number = lead & 0x03;
+    extra = 4;
+  } else if ((lead & 0xfe) == 0xfc) {
+    number = lead & 0x01;
+    extra = 5;
+  } else if (lead == 0xfe && variable) {
+    number = 0;
+    extra = 6;
+  } else {
+    return false;
+  }
+  if (n + extra > len) {
+    return false;
+  }
+  for (size_t i = 0; i < extra; ++i) {
+    uint8_t const c = p[n++];
+    if ((c & 0xc0) != 0x80) {
+      return false;
+    }
+    number = (number << 6) | (uint64_t)(c & 0x3f);
+  }
+
+  uint32_t bs;
+  if (blocksize_code == 1) {
+    bs = 192;
+  } else if (blocksize_code <= 5) {
+    bs = UINT32_C(576) << (blocksize_code - 2);
+  } else if (blocksize_code == 6) {
+    if (n + 1 > len) {
+      return false;
+    }
+    bs = (uint32_t)p[n] + 1;
+    n += 1;
+  } else if (blocksize_code == 7) {
+    if (n + 2 > len) {
+      return false;
+    }
+    bs = (((uint32_t)p[n] << 8) | (uint32_t)p[n + 1]) + 1;
+    n += 2;
+  } else {
+    bs = UINT32_C(256) << (blocksize_code - 8);
+  }
+
+  if (sample_rate_code == 12) {
+    n += 1;
+  } else if (sample_rate_code == 13 || sample_rate_code == 14) {
+    n += 2;
+  }
+  if (n + 1 > len || crc8(p, n) != p[n]) {
+    return false;
+  }
+  *sample = variable ? number : number * (fixed_blocksize ? fixed_blocksize : bs);
+  *blocksize = bs;
+  *header_bytes = n + 1;
+  return true;
+}
+
+NODISCARD bool flac_frame_scanner_init(struct flac_frame_scanner *const s,
+                                       flac_frame_read_func const read,
+                                       void *const userdata,
+                                       uint64_t const offset,
+                                       uint64_t const end,
+                                       uint32_t const fixed_blocksize,
+                                       uint32_t const min_framesize,
+                                       struct ov_error *const err) {
+  if (!s || !read || offset > end) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  *s = (struct flac_frame_scanner){
+      .read = read,
+      .userdata = userdata,
+      .pos = offset,
+      .end = end,
+      .fixed_blocksize = fixed_blocksize,
+      .min_framesize = min_framesize,
+  };
+  if (!OV_REALLOC(&s->buf, scan_chunk_size, sizeof(uint8_t))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  return true;
+}
+
+void flac_frame_scanner_reset(struct flac_frame_scanner *const s, uint64_t const offset, uint64_t const sample) {
+  s->pos = offset;
+  s->next_sample = sample;
+}
+
+NODISCARD bool flac_frame_scanner_next(struct flac_frame_scanner *const s,
+                                       struct flac_frame *const frame,
+                                       bool *const found,
+                                       struct ov_error *const err) {
+  if (!s || !s->buf || !frame || !found) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  while (s->pos < s->end) {
+    uint64_t const buf_end = s->buf_offset + s->buf_len;
+    if (s->pos < s->buf_offset || s->pos >= buf_end || (s->pos + max_header_size > buf_end && buf_end < s->end)) {
+      size_t const r = s->read(s->userdata, s->buf, s->pos, scan_chunk_size);
+      if (r == SIZE_MAX) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read FLAC stream"));
+        return false;
+      }
+      if (r == 0) {
+        break;
+      }
+      s->buf_offset = s->pos;
+      s->buf_len = r;
+    }
+    size_t const i = (size_t)(s->pos - s->buf_offset);
+    uint8_t const *const hit = memchr(s->buf + i, 0xff, s->buf_len - i);
+    if (!hit) {
+      s->pos = s->buf_offset + s->buf_len;
+      continue;
+    }
+    size_t const j = (size_t)(hit - s->buf);
+    uint64_t const candidate = s->buf_offset + j;
+    if (j + max_header_size > s->buf_len && s->buf_offset + s->buf_len < s->end && j > 0) {
+      // The header may straddle the window, reload starting at the candidate.
+      s->pos = candidate;
+      continue;
+    }
+    uint64_t sample;
+    uint32_t blocksize;
+    size_t header_bytes;
+    if (!parse_header(hit, s->buf_len - j, s->fixed_blocksize, &sample, &blocksize, &header_bytes) ||
+        sample != s->next_sample) {
+      s->pos = candidate + 1;
+      continue;
+    }
+    *frame = (struct flac_frame){
+        .sample = sample,
+        .offset = candidate,
+        .blocksize = blocksize,
+    };
+    s->next_sample = sample + blocksize;
+    s->pos = candidate + (s->min_framesize > header_bytes ? s->min_framesize : header_bytes);
+    *found = true;
+    return true;
+  }
+  *found = false;
+  return true;
+}
+
+void flac_frame_scanner_exit(struct flac_frame_scanner *const s) {
+  if (!s) {
+    return;
+  }
+  if (s->buf) {
+    OV_FREE(&s->buf);
+  }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ovbase.h>
+
+/**
+ * @brief Location of a FLAC frame inside the stream.
+ */
+struct flac_frame {
+  uint64_t sample; // first sample number of the frame
+  uint64_t offset; // byte offset of the frame header
+  uint32_t blocksize;
+};
+
+/**
+ * @brief Reads bytes from the underlying stream.
+ * @return The number of bytes read, or SIZE_MAX on error.
+ */
+typedef size_t (*flac_frame_read_func)(void *const userdata, void *const p, uint64_t const offset, size_t const len);
+
+/**
+ * @brief Locates FLAC frames by frame sync code and CRC-8 protected header without decoding them.
+ *
+ * Candidates are only accepted when their sample number continues the previously found frame,
+ * which rules out sync codes that happen to appear inside the compressed audio.
+ */
+struct flac_frame_scanner {
+  flac_frame_read_func read;
+  void *userdata;
+
+  uint64_t pos;
+  uint64_t end;
+  uint64_t next_sample;
+  uint32_t fixed_blocksize;
+  uint32_t min_framesize;
+
+  uint8_t *buf;
+  uint64_t buf_offset;
+  size_t buf_len;
+};
+
+/**
+ * @brief Initializes the scanner.
+ * @param s The scanner.
+ * @param read Function used to read the stream.
+ * @param userdata Passed to read.
+ * @param offset Byte offset of the first frame, which must start with sample 0.
+ * @param end Byte length of the stream.
+ * @param fixed_blocksize Block size from STREAMINFO when the stream uses fixed-size blocks, otherwise 0.
+ * @param min_framesize Minimum frame size from STREAMINFO, 0 if unknown.
+ * @param err Error information.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool flac_frame_scanner_init(struct flac_frame_scanner *const s,
+                                       flac_frame_read_func const read,
+                                       void *const userdata,
+                                       uint64_t const offset,
+                                       uint64_t const end,
+                                       uint32_t const fixed_blocksize,
+                                       uint32_t const min_framesize,
+                                       struct ov_error *const err);
+
+/**
+ * @brief Moves the scanner to a known frame boundary.
+ * @param s The scanner.
+ * @param offset Byte offset of the frame header.
+ * @param sample First sample number of that frame.
+ */
+void flac_frame_scanner_reset(struct flac_frame_scanner *const s, uint64_t const offset, uint64_t const sample);
+
+/**
+ * @brief Finds the next frame.
+ * @param s The scanner.
+ * @param frame Receives the frame location.
+ * @param found Set to false when no further frame could be located.
+ * @param err Error information.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool flac_frame_scanner_next(struct flac_frame_scanner *const s,
+                                       struct flac_frame *const frame,
+                                       bool *const found,
+                                       struct ov_error *const err);
+
+void flac_frame_scanner_exit(struct flac_frame_scanner *const s);
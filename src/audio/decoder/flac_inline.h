@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flac_kernel.h"
+
+static inline void convert_samples(flac_kernel_func const kernel,
+                                   int32_t const *const *const src,
+                                   size_t const src_offset,
+                                   float *const *const dst,
+                                   size_t const channels,
+                                   size_t const samples,
+                                   uint32_t bits_per_sample) {
+  float const scale = 1.f / (float)(1u << (bits_per_sample - 1));
+  for (size_t c = 0; c < channels; ++c) {
+    kernel(src[c] + src_offset, dst[c], samples, scale);
+  }
+}
@@ -0,0 +1,115 @@
+#include "flac_kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define FLAC_KERNEL_X86 1
+#  include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define FLAC_KERNEL_NEON 1
+#  include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#  define FLAC_KERNEL_WASM 1
+#  include <wasm_simd128.h>
+#endif
+
+// Scaling by a power of two is exact, and every variant converts with round-to-nearest like the C cast,
+// so the vectorized kernels match the scalar one bit for bit.
+
+static void scalar_to_float(int32_t const *const src, float *const dst, size_t const samples, float const scale) {
+  for (size_t i = 0; i < samples; ++i) {
+    dst[i] = (float)src[i] * scale;
+  }
+}
+
+#ifdef FLAC_KERNEL_X86
+
+static __attribute__((target("sse2"))) void
+sse2_to_float(int32_t const *const src, float *const dst, size_t const samples, float const scale) {
+  __m128 const s = _mm_set1_ps(scale);
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    __m128i const a = _mm_loadu_si128((__m128i const *)(void const *)(src + i));
+    __m128i const b = _mm_loadu_si128((__m128i const *)(void const *)(src + i + 4));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(a), s));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), s));
+  }
+  scalar_to_float(src + i, dst + i, samples - i, scale);
+}
+
+static __attribute__((target("avx2"))) void
+avx2_to_float(int32_t const *const src, float *const dst, size_t const samples, float const scale) {
+  __m256 const s = _mm256_set1_ps(scale);
+  size_t i = 0;
+  for (; i + 16 <= samples; i += 16) {
+    __m256i const a = _mm256_loadu_si256((__m256i const *)(void const *)(src + i));
+    __m256i const b = _mm256_loadu_si256((__m256i const *)(void const *)(src + i + 8));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(a), s));
+    _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), s));
+  }
+  // The tail is handled by non-VEX code; without this the compiler may tail-call it with dirty upper halves
+  // and every legacy SSE instruction afterwards pays the transition penalty.
+  _mm256_zeroupper();
+  sse2_to_float(src + i, dst + i, samples - i, scale);
+}
+
+#endif // FLAC_KERNEL_X86
+
+#ifdef FLAC_KERNEL_NEON
+
+static void neon_to_float(int32_t const *const src, float *const dst, size_t const samples, float const scale) {
+  float32x4_t const s = vdupq_n_f32(scale);
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vld1q_s32(src + i)), s));
+    vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vld1q_s32(src + i + 4)), s));
+  }
+  scalar_to_float(src + i, dst + i, samples - i, scale);
+}
+
+#endif // FLAC_KERNEL_NEON
+
+#ifdef FLAC_KERNEL_WASM
+
+static void simd128_to_float(int32_t const *const src, float *const dst, size_t const samples, float const scale) {
+  v128_t const s = wasm_f32x4_splat(scale);
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    v128_t const a = wasm_v128_load(src + i);
+    v128_t const b = wasm_v128_load(src + i + 4);
+    wasm_v128_store(dst + i, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(a), s));
+    wasm_v128_store(dst + i + 4, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(b), s));
+  }
+  scalar_to_float(src + i, dst + i, samples - i, scale);
+}
+
+#endif // FLAC_KERNEL_WASM
+
+static flac_kernel_func const kernels[kernel_isa_count] = {
+    [kernel_isa_scalar] = scalar_to_float,
+#ifdef FLAC_KERNEL_X86
+    [kernel_isa_sse2] = sse2_to_float,
+    [kernel_isa_avx2] = avx2_to_float,
+#endif
+#ifdef FLAC_KERNEL_NEON
+    [kernel_isa_neon] = neon_to_float,
+#endif
+#ifdef FLAC_KERNEL_WASM
+    [kernel_isa_simd128] = simd128_to_float,
+#endif
+};
+
+flac_kernel_func flac_kernel_get(enum kernel_isa const isa) {
+  if ((size_t)isa >= kernel_isa_count || !kernel_isa_supported(isa)) {
+    return NULL;
+  }
+  return kernels[isa];
+}
+
+flac_kernel_func flac_kernel_get_best(void) {
+  for (size_t i = 0; i < kernel_isa_count; ++i) {
+    flac_kernel_func const k = flac_kernel_get(kernel_isa_preference[i]);
+    if (k) {
+      return k;
+    }
+  }
+  return scalar_to_float;
+}
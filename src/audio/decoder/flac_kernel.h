@@ -0,0 +1,26 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "../kernel.h"
+
+/**
+ * @brief Converts one plane of decoded FLAC samples to float.
+ * @param src Source samples, no alignment required.
+ * @param dst Destination samples, no alignment required.
+ * @param samples Number of samples.
+ * @param scale Multiplier applied after the conversion, 1 / 2^(bits_per_sample - 1).
+ */
+typedef void (*flac_kernel_func)(int32_t const *const src, float *const dst, size_t const samples, float const scale);
+
+/**
+ * @brief Returns the kernel for the given instruction set.
+ * Every variant produces bit-identical output to the scalar kernel.
+ * @return The kernel, or NULL if the instruction set is not compiled in or not supported by the running CPU.
+ */
+flac_kernel_func flac_kernel_get(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the fastest kernel supported by the running CPU.
+ */
+flac_kernel_func flac_kernel_get_best(void);
@@ -0,0 +1,231 @@
+#include "../../bench_util.h"
+
+#include "flac_kernel.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+struct variant {
+  char const *name;
+  flac_kernel_func fn;
+};
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"scalar", kernel_isa_scalar},
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+// FLAC block sizes: the smallest common one, the libFLAC default, the largest allowed by the format.
+static size_t const sample_counts[] = {192, 4096, 65535};
+static uint32_t const bit_depths[] = {16, 24};
+
+enum {
+  max_variants = kernel_isa_count,
+  repetitions = 5,
+};
+
+struct options {
+  char const *output;
+  uint64_t min_time_ns;
+};
+
+struct measurement {
+  uint64_t ns;
+  uint64_t cycles;
+  size_t calls;
+};
+
+static struct measurement measure(struct options const *const opts,
+                                  struct variant const *const k,
+                                  int32_t const *const src,
+                                  float *const dst,
+                                  size_t const samples,
+                                  float const scale) {
+  // Calibrate the number of calls so one repetition takes at least min_time_ns.
+  size_t calls = 1;
+  for (;;) {
+    uint64_t const t0 = bench_util_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+      k->fn(src, dst, samples, scale);
+    }
+    uint64_t const elapsed = bench_util_now_ns() - t0;
+    if (elapsed >= opts->min_time_ns || calls >= SIZE_MAX / 2) {
+      break;
+    }
+    calls *= 2;
+  }
+  struct measurement best = {.ns = UINT64_MAX, .calls = calls};
+  for (size_t r = 0; r < repetitions; ++r) {
+    uint64_t const c0 = bench_util_cycles();
+    uint64_t const t0 = bench_util_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+      k->fn(src, dst, samples, scale);
+    }
+    uint64_t const elapsed = bench_util_now_ns() - t0;
+    uint64_t const cycles = bench_util_cycles() - c0;
+    if (elapsed < best.ns) {
+      best.ns = elapsed;
+      best.cycles = cycles;
+    }
+  }
+  bench_util_consume(dst[samples - 1]);
+  return best;
+}
+
+static NODISCARD bool run(struct options const *const opts,
+                          struct variant const *const variants,
+                          size_t const count,
+                          size_t const samples,
+                          uint32_t const bits,
+                          FILE *const fp,
+                          bool *const first,
+                          struct ov_error *const err) {
+  int32_t *src = NULL;
+  float *ref = NULL;
+  float *out = NULL;
+  bool result = false;
+
+  {
+    if (!OV_ALIGNED_ALLOC(&src, samples, sizeof(int32_t), 64) || !OV_ALIGNED_ALLOC(&ref, samples, sizeof(float), 64) ||
+        !OV_ALIGNED_ALLOC(&out, samples, sizeof(float), 64)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    uint64_t rng = UINT64_C(0x9e3779b97f4a7c15);
+    for (size_t i = 0; i < samples; ++i) {
+      src[i] = (int32_t)(bench_util_rand(&rng) >> (64 - bits)) - (int32_t)(UINT32_C(1) << (bits - 1));
+    }
+    float const scale = 1.f / (float)(1u << (bits - 1));
+    variants[0].fn(src, ref, samples, scale);
+
+    double scalar_ns = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+      struct variant const *const k = &variants[i];
+      memset(out, 0, samples * sizeof(float));
+      k->fn(src, out, samples, scale);
+      bool const matches = memcmp(ref, out, samples * sizeof(float)) == 0;
+
+      struct measurement const m = measure(opts, k, src, out, samples, scale);
+      double const ns_per_call = (double)m.ns / (double)m.calls;
+      if (i == 0) {
+        scalar_ns = ns_per_call;
+      }
+
+      fprintf(fp, "%s\n    {\"kernel\": \"i32_to_float\", \"variant\": ", *first ? "" : ",");
+      bench_util_json_string(fp, k->name);
+      fprintf(fp,
+              ", \"bits_per_sample\": %" PRIu32 ", \"samples\": %zu, \"calls\": %zu,\n"
+              "     \"ns_per_call\": %.2f, \"input_gb_per_sec\": %.3f, \"output_gb_per_sec\": %.3f, "
+              "\"samples_per_sec\": %.0f,\n"
+              "     \"cycles_per_sample\": ",
+              bits,
+              samples,
+              m.calls,
+              ns_per_call,
+              (double)(samples * sizeof(int32_t)) / ns_per_call,
+              (double)(samples * sizeof(float)) / ns_per_call,
+              (double)samples / ns_per_call * 1e9);
+      if (m.cycles) {
+        fprintf(fp, "%.3f", (double)m.cycles / (double)m.calls / (double)samples);
+      } else {
+        fprintf(fp, "null");
+      }
+      fprintf(fp,
+              ", \"speedup_vs_scalar\": %.3f, \"matches_scalar\": %s}",
+              scalar_ns / ns_per_call,
+              matches ? "true" : "false");
+      fflush(fp);
+      *first = false;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (out) {
+    OV_ALIGNED_FREE(&out);
+  }
+  if (ref) {
+    OV_ALIGNED_FREE(&ref);
+  }
+  if (src) {
+    OV_ALIGNED_FREE(&src);
+  }
+  return result;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: bench_ovl_flac_kernels [options]\n"
+          "  --output <path>       write JSON to path instead of stdout\n"
+          "  --min-time-ms <n>     minimum duration of one repetition (default 20)\n");
+}
+
+int main(int argc, char **argv) {
+  struct options opts = {
+      .min_time_ns = UINT64_C(20000000),
+  };
+  for (int i = 1; i < argc; ++i) {
+    char const *const a = argv[i];
+    char const *const v = i + 1 < argc ? argv[i + 1] : NULL;
+    bool ok = v != NULL;
+    if (ok && strcmp(a, "--output") == 0) {
+      opts.output = v;
+    } else if (ok && strcmp(a, "--min-time-ms") == 0) {
+      char *end = NULL;
+      unsigned long long const n = strtoull(v, &end, 10);
+      ok = *v && !*end && n > 0;
+      opts.min_time_ns = (uint64_t)n * UINT64_C(1000000);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage();
+      return 2;
+    }
+    ++i;
+  }
+
+  struct variant variants[max_variants];
+  size_t count = 0;
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    flac_kernel_func const fn = flac_kernel_get(isas[i].isa);
+    if (fn) {
+      variants[count++] = (struct variant){isas[i].name, fn};
+    }
+  }
+
+  struct ov_error err = {0};
+  FILE *fp = stdout;
+  bool first = true;
+  int exit_code = 1;
+  if (opts.output) {
+    fp = fopen(opts.output, "w");
+    if (!fp) {
+      fprintf(stderr, "failed to open %s\n", opts.output);
+      return 1;
+    }
+  }
+  fprintf(fp, "{\n  \"schema\": 1,\n  \"results\": [");
+  for (size_t b = 0; b < sizeof(bit_depths) / sizeof(bit_depths[0]); ++b) {
+    for (size_t s = 0; s < sizeof(sample_counts) / sizeof(sample_counts[0]); ++s) {
+      if (!run(&opts, variants, count, sample_counts[s], bit_depths[b], fp, &first, &err)) {
+        OV_ERROR_REPORT(&err, NULL);
+        goto cleanup;
+      }
+    }
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  exit_code = 0;
+
+cleanup:
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return exit_code;
+}
@@ -0,0 +1,82 @@
+#include <ovtest.h>
+
+#include "flac_kernel.h"
+
+#include <string.h>
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+static uint64_t next_rand(uint64_t *const state) {
+  *state = *state * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+  return *state >> 11;
+}
+
+static void matches_scalar(void) {
+  enum {
+    max_samples = 5000,
+  };
+  static size_t const sample_counts[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 100, 1023, max_samples};
+  static uint32_t const bits[] = {4, 8, 12, 16, 20, 24, 32};
+  flac_kernel_func const scalar = flac_kernel_get(kernel_isa_scalar);
+  if (!TEST_CHECK(scalar != NULL)) {
+    return;
+  }
+  TEST_CHECK(flac_kernel_get_best() != NULL);
+
+  static int32_t src[max_samples + 1];
+  static float ref[max_samples + 1];
+  static float out[max_samples + 1];
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    flac_kernel_func const k = flac_kernel_get(isas[i].isa);
+    if (!k) {
+      TEST_MSG("%s is not available", isas[i].name);
+      continue;
+    }
+    for (size_t bi = 0; bi < sizeof(bits) / sizeof(bits[0]); ++bi) {
+      float const scale = 1.f / (float)(1u << (bits[bi] - 1));
+      for (size_t si = 0; si < sizeof(sample_counts) / sizeof(sample_counts[0]); ++si) {
+        size_t const samples = sample_counts[si];
+        // Start one element in so the kernels also see unaligned planes.
+        size_t const offset = si & 1;
+        uint64_t rng = (uint64_t)(bi * 131 + si);
+        for (size_t j = 0; j < samples; ++j) {
+          // Keep values in the range of the bit depth including both extremes.
+          int64_t const lo = -((int64_t)1 << (bits[bi] - 1));
+          int64_t v = lo + (int64_t)(next_rand(&rng) % ((uint64_t)1 << bits[bi]));
+          if (j == 0) {
+            v = lo;
+          } else if (j == 1) {
+            v = -lo - 1;
+          }
+          src[offset + j] = (int32_t)v;
+        }
+        memset(ref, 0, sizeof(ref));
+        memset(out, 0x55, sizeof(out));
+        scalar(src + offset, ref + offset, samples, scale);
+        k(src + offset, out + offset, samples, scale);
+        if (!TEST_CHECK(memcmp(ref + offset, out + offset, samples * sizeof(float)) == 0)) {
+          TEST_MSG("%s bits=%u samples=%zu differs from scalar", isas[i].name, bits[bi], samples);
+          return;
+        }
+        static uint8_t const untouched[sizeof(float)] = {0x55, 0x55, 0x55, 0x55};
+        if (!TEST_CHECK(memcmp(out + offset + samples, untouched, sizeof(float)) == 0)) {
+          TEST_MSG("%s bits=%u samples=%zu wrote past the end", isas[i].name, bits[bi], samples);
+          return;
+        }
+      }
+    }
+  }
+}
+
+TEST_LIST = {
+    {"matches_scalar", matches_scalar},
+    {NULL, NULL},
+};
@@ -0,0 +1,658 @@
+#include "flac_mt.h"
+
+#include "flac_inline.h"
+
+#include <ovmo.h>
+#include <ovthreads.h>
+
+#include <string.h>
+
+#ifdef __GNUC__
+#  ifndef __has_warning
+#    define __has_warning(x) 0
+#  endif
+#  pragma GCC diagnostic push
+#  if __has_warning("-Wdocumentation-unknown-command")
+#    pragma GCC diagnostic ignored "-Wdocumentation-unknown-command"
+#  endif
+#  if __has_warning("-Wdocumentation")
+#    pragma GCC diagnostic ignored "-Wdocumentation"
+#  endif
+#endif // __GNUC__
+#include <FLAC/stream_decoder.h>
+#ifdef __GNUC__
+#  pragma GCC diagnostic pop
+#endif // __GNUC__
+
+enum {
+  job_frames = 16,
+  jobs_per_thread = 2,
+};
+
+enum job_state {
+  job_state_free,
+  job_state_queued,
+  job_state_decoding,
+  job_state_done,
+  job_state_failed,
+};
+
+struct job {
+  enum job_state state;
+  size_t first_frame;
+  size_t frames;
+  // The job runs to the end of the stream, past the last frame the scanner found.
+  bool last;
+
+  uint8_t *data;
+  size_t data_len;
+  size_t data_cap;
+
+  // Each frame starts at a 16-byte aligned position so convert_samples can be used as is.
+  float **planes;
+  size_t samples_cap;
+};
+
+struct worker {
+  struct flac_mt *mt;
+  thrd_t thread;
+  bool thread_started;
+  FLAC__StreamDecoder *decoder;
+
+  uint8_t const *data;
+  size_t data_len;
+  size_t data_pos;
+
+  struct job *job;
+  size_t frame;
+  size_t written;
+};
+
+struct flac_mt {
+  struct flac_mt_params params;
+  uint8_t *header;
+  flac_kernel_func kernel;
+
+  struct flac_frame_scanner scanner;
+  bool scanner_done;
+  struct flac_frame *frames;
+  size_t frames_len;
+  size_t frames_cap;
+  size_t next_frame;
+
+  struct job *jobs;
+  size_t jobs_cap;
+  size_t head;
+  size_t count;
+
+  size_t emit_frame;
+  size_t emit_pos;
+  bool emitting;
+  uint64_t skip;
+  float const **pcm;
+
+  struct worker *workers;
+  size_t workers_len;
+
+  mtx_t mtx;
+  cnd_t job_queued;
+  cnd_t job_done;
+  bool sync_initialized;
+  bool quit;
+};
+
+static inline size_t align4(size_t const n) { return (n + 3) & ~(size_t)3; }
+
+static FLAC__StreamDecoderReadStatus
+read_callback(FLAC__StreamDecoder const *const decoder, FLAC__byte buffer[], size_t *bytes, void *client_data) {
+  (void)decoder;
+  struct worker *const w = (struct worker *)client_data;
+  size_t const remaining = w->data_len - w->data_pos;
+  if (remaining == 0) {
+    *bytes = 0;
+    return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+  }
+  size_t const n = *bytes < remaining ? *bytes : remaining;
+  memcpy(buffer, w->data + w->data_pos, n);
+  w->data_pos += n;
+  *bytes = n;
+  return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+static FLAC__bool eof_callback(FLAC__StreamDecoder const *const decoder, void *client_data) {
+  (void)decoder;
+  struct worker const *const w = (struct worker const *)client_data;
+  return w->data_pos >= w->data_len;
+}
+
+static FLAC__StreamDecoderWriteStatus write_callback(FLAC__StreamDecoder const *const decoder,
+                                                     FLAC__Frame const *const frame,
+                                                     FLAC__int32 const *const buffer[],
+                                                     void *const client_data) {
+  (void)decoder;
+  struct worker *const w = (struct worker *)client_data;
+  struct flac_mt const *const mt = w->mt;
+  struct job *const job = w->job;
+  if (!job || w->frame >= job->frames || frame->header.channels != mt->params.channels) {
+    return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+  }
+  // mt->frames belongs to the reading thread, so only the job's own capacity is checked here.
+  size_t const blocksize = frame->header.blocksize;
+  if (w->written + blocksize > job->samples_cap) {
+    return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+  }
+  float *dst[FLAC__MAX_CHANNELS];
+  for (size_t ch = 0; ch < mt->params.channels; ++ch) {
+    dst[ch] = job->planes[ch] + w->written;
+  }
+  convert_samples(mt->kernel, buffer, 0, dst, mt->params.channels, blocksize, frame->header.bits_per_sample);
+  w->written += align4(blocksize);
+  ++w->frame;
+  return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void
+error_callback(FLAC__StreamDecoder const *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data) {
+  (void)decoder;
+  (void)status;
+  (void)client_data;
+}
+
+static bool decode_job(struct worker *const w, struct job *const job) {
+  if (!FLAC__stream_decoder_flush(w->decoder)) {
+    return false;
+  }
+  w->data = job->data;
+  w->data_len = job->data_len;
+  w->data_pos = 0;
+  w->job = job;
+  w->frame = 0;
+  w->written = 0;
+  bool ok = true;
+  while (w->frame < job->frames) {
+    size_t const before = w->frame;
+    if (!FLAC__stream_decoder_process_single(w->decoder) || w->frame == before) {
+      ok = false;
+      break;
+    }
+  }
+  // The scanner stops at a frame header it cannot read, such as a damaged one. Any frame libFLAC still finds
+  // in the rest of the stream is one the scanner missed, and write_callback rejects it instead of letting the
+  // stream end there without an error.
+  while (ok && job->last && FLAC__stream_decoder_get_state(w->decoder) != FLAC__STREAM_DECODER_END_OF_STREAM) {
+    ok = FLAC__stream_decoder_process_single(w->decoder);
+  }
+  w->job = NULL;
+  w->data = NULL;
+  return ok;
+}
+
+static struct job *pick_job(struct flac_mt *const mt) {
+  for (size_t i = 0; i < mt->count; ++i) {
+    struct job *const job = &mt->jobs[(mt->head + i) % mt->jobs_cap];
+    if (job->state == job_state_queued) {
+      return job;
+    }
+  }
+  return NULL;
+}
+
+static int worker_thread(void *const userdata) {
+  struct worker *const w = (struct worker *)userdata;
+  struct flac_mt *const mt = w->mt;
+  mtx_lock(&mt->mtx);
+  for (;;) {
+    struct job *job = NULL;
+    while (!mt->quit && (job = pick_job(mt)) == NULL) {
+      cnd_wait(&mt->job_queued, &mt->mtx);
+    }
+    if (mt->quit) {
+      break;
+    }
+    job->state = job_state_decoding;
+    mtx_unlock(&mt->mtx);
+    bool const ok = decode_job(w, job);
+    mtx_lock(&mt->mtx);
+    job->state = ok ? job_state_done : job_state_failed;
+    cnd_broadcast(&mt->job_done);
+  }
+  mtx_unlock(&mt->mtx);
+  return 0;
+}
+
+static NODISCARD bool init_worker(struct flac_mt *const mt, struct worker *const w, struct ov_error *const err) {
+  w->mt = mt;
+  w->decoder = FLAC__stream_decoder_new();
+  if (!w->decoder) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to allocate flac decoder"));
+    return false;
+  }
+  FLAC__stream_decoder_set_md5_checking(w->decoder, false);
+  if (FLAC__stream_decoder_init_stream(w->decoder,
+                                       read_callback,
+                                       NULL,
+                                       NULL,
+                                       NULL,
+                                       eof_callback,
+                                       write_callback,
+                                       NULL,
+                                       error_callback,
+                                       w) != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize FLAC decoder"));
+    return false;
+  }
+  w->data = mt->header;
+  w->data_len = mt->params.header_len;
+  w->data_pos = 0;
+  bool const ok = FLAC__stream_decoder_process_until_end_of_metadata(w->decoder);
+  w->data = NULL;
+  if (!ok) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to process FLAC metadata"));
+    return false;
+  }
+  return true;
+}
+
+static NODISCARD bool scan_frames(struct flac_mt *const mt, size_t const want, struct ov_error *const err) {
+  while (!mt->scanner_done && mt->frames_len < want) {
+    struct flac_frame frame;
+    bool found = false;
+    if (!flac_frame_scanner_next(&mt->scanner, &frame, &found, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    if (!found) {
+      mt->scanner_done = true;
+      break;
+    }
+    if (mt->frames_len == mt->frames_cap) {
+      size_t const newcap = mt->frames_cap ? mt->frames_cap * 2 : 256;
+      if (!OV_REALLOC(&mt->frames, newcap, sizeof(struct flac_frame))) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        return false;
+      }
+      mt->frames_cap = newcap;
+    }
+    mt->frames[mt->frames_len++] = frame;
+  }
+  return true;
+}
+
+static NODISCARD bool prepare_job(struct flac_mt *const mt, struct job *const job, struct ov_error *const err) {
+  // One extra frame is scanned so the end of the last frame in this job is known.
+  if (!scan_frames(mt, mt->next_frame + job_frames + 1, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  size_t const available = mt->frames_len - mt->next_frame;
+  size_t const frames = available < job_frames ? available : job_frames;
+  size_t const last = mt->next_frame + frames;
+  uint64_t const begin = mt->frames[mt->next_frame].offset;
+  uint64_t const end = last < mt->frames_len ? mt->frames[last].offset : mt->params.source_len;
+  size_t const data_len = (size_t)(end - begin);
+
+  size_t samples = 0;
+  for (size_t i = mt->next_frame; i < last; ++i) {
+    samples += align4(mt->frames[i].blocksize);
+  }
+  if (samples > job->samples_cap) {
+    float *planes = NULL;
+    if (!OV_ALIGNED_ALLOC(&planes, samples * mt->params.channels, sizeof(float), 16)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      return false;
+    }
+    if (job->planes[0]) {
+      OV_ALIGNED_FREE(&job->planes[0]);
+    }
+    for (size_t ch = 0; ch < mt->params.channels; ++ch) {
+      job->planes[ch] = planes + samples * ch;
+    }
+    job->samples_cap = samples;
+  }
+  if (data_len > job->data_cap) {
+    if (!OV_REALLOC(&job->data, data_len, sizeof(uint8_t))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      return false;
+    }
+    job->data_cap = data_len;
+  }
+  size_t pos = 0;
+  while (pos < data_len) {
+    size_t const r = mt->params.read(mt->params.userdata, job->data + pos, begin + pos, data_len - pos);
+    if (r == SIZE_MAX || r == 0) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read FLAC stream"));
+      return false;
+    }
+    pos += r;
+  }
+  job->data_len = data_len;
+  job->first_frame = mt->next_frame;
+  job->frames = frames;
+  job->last = last == mt->frames_len;
+  mt->next_frame = last;
+  return true;
+}
+
+static NODISCARD bool fill_queue(struct flac_mt *const mt, struct ov_error *const err) {
+  for (;;) {
+    mtx_lock(&mt->mtx);
+    bool const full = mt->count == mt->jobs_cap;
+    mtx_unlock(&mt->mtx);
+    if (full) {
+      return true;
+    }
+    if (!scan_frames(mt, mt->next_frame + 1, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    if (mt->next_frame >= mt->frames_len) {
+      return true;
+    }
+    // Free slots are only touched by this thread, so the job can be prepared without the lock.
+    struct job *const job = &mt->jobs[(mt->head + mt->count) % mt->jobs_cap];
+    if (!prepare_job(mt, job, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    mtx_lock(&mt->mtx);
+    job->state = job_state_queued;
+    ++mt->count;
+    cnd_signal(&mt->job_queued);
+    mtx_unlock(&mt->mtx);
+  }
+}
+
+static void release_head(struct flac_mt *const mt) {
+  mtx_lock(&mt->mtx);
+  mt->jobs[mt->head].state = job_state_free;
+  mt->head = (mt->head + 1) % mt->jobs_cap;
+  --mt->count;
+  mtx_unlock(&mt->mtx);
+  mt->emit_frame = 0;
+  mt->emit_pos = 0;
+}
+
+NODISCARD bool flac_mt_read(struct flac_mt *const mt,
+                            float const *const **const pcm,
+                            size_t *const samples,
+                            struct ov_error *const err) {
+  if (!mt || !pcm || !samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  for (;;) {
+    if (mt->emitting) {
+      struct job const *const job = &mt->jobs[mt->head];
+      mt->emit_pos += align4(mt->frames[job->first_frame + mt->emit_frame].blocksize);
+      ++mt->emit_frame;
+      mt->emitting = false;
+      if (mt->emit_frame == job->frames) {
+        release_head(mt);
+      }
+    }
+    if (!fill_queue(mt, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    mtx_lock(&mt->mtx);
+    if (mt->count == 0) {
+      mtx_unlock(&mt->mtx);
+      *samples = 0;
+      return true;
+    }
+    struct job *const job = &mt->jobs[mt->head];
+    while (job->state == job_state_queued || job->state == job_state_decoding) {
+      cnd_wait(&mt->job_done, &mt->mtx);
+    }
+    enum job_state const state = job->state;
+    mtx_unlock(&mt->mtx);
+    if (state != job_state_done) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to decode FLAC frame"));
+      return false;
+    }
+    size_t const blocksize = mt->frames[job->first_frame + mt->emit_frame].blocksize;
+    mt->emitting = true;
+    if (mt->skip >= blocksize) {
+      mt->skip -= blocksize;
+      continue;
+    }
+    size_t const skip = (size_t)mt->skip;
+    mt->skip = 0;
+    for (size_t ch = 0; ch < mt->params.channels; ++ch) {
+      mt->pcm[ch] = job->planes[ch] + mt->emit_pos + skip;
+    }
+    *pcm = (float const *const *)mt->pcm;
+    *samples = blocksize - skip;
+    return true;
+  }
+}
+
+static void drain(struct flac_mt *const mt) {
+  mtx_lock(&mt->mtx);
+  for (size_t i = 0; i < mt->count; ++i) {
+    struct job *const job = &mt->jobs[(mt->head + i) % mt->jobs_cap];
+    if (job->state == job_state_queued) {
+      job->state = job_state_free;
+    }
+  }
+  for (;;) {
+    bool busy = false;
+    for (size_t i = 0; i < mt->jobs_cap; ++i) {
+      if (mt->jobs[i].state == job_state_decoding) {
+        busy = true;
+        break;
+      }
+    }
+    if (!busy) {
+      break;
+    }
+    cnd_wait(&mt->job_done, &mt->mtx);
+  }
+  for (size_t i = 0; i < mt->jobs_cap; ++i) {
+    mt->jobs[i].state = job_state_free;
+  }
+  mt->head = 0;
+  mt->count = 0;
+  mtx_unlock(&mt->mtx);
+  mt->emit_frame = 0;
+  mt->emit_pos = 0;
+  mt->emitting = false;
+}
+
+NODISCARD bool flac_mt_seek(struct flac_mt *const mt, uint64_t const position, struct ov_error *const err) {
+  if (!mt) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  drain(mt);
+  for (;;) {
+    if (mt->frames_len > 0) {
+      struct flac_frame const *const last = &mt->frames[mt->frames_len - 1];
+      if (position < last->sample + last->blocksize || mt->scanner_done) {
+        break;
+      }
+    } else if (mt->scanner_done) {
+      break;
+    }
+    if (!scan_frames(mt, mt->frames_len + job_frames, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+  }
+  size_t lo = 0;
+  size_t hi = mt->frames_len;
+  while (lo < hi) {
+    size_t const mid = lo + (hi - lo) / 2;
+    if (mt->frames[mid].sample <= position) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == 0) {
+    mt->next_frame = 0;
+    mt->skip = 0;
+    return true;
+  }
+  mt->next_frame = lo - 1;
+  mt->skip = position - mt->frames[lo - 1].sample;
+  return true;
+}
+
+void flac_mt_destroy(struct flac_mt **const mtp) {
+  if (!mtp || !*mtp) {
+    return;
+  }
+  struct flac_mt *const mt = *mtp;
+  if (mt->sync_initialized) {
+    mtx_lock(&mt->mtx);
+    mt->quit = true;
+    cnd_broadcast(&mt->job_queued);
+    mtx_unlock(&mt->mtx);
+  }
+  if (mt->workers) {
+    for (size_t i = 0; i < mt->workers_len; ++i) {
+      struct worker *const w = &mt->workers[i];
+      if (w->thread_started) {
+        thrd_join(w->thread, NULL);
+      }
+      if (w->decoder) {
+        FLAC__stream_decoder_delete(w->decoder);
+      }
+    }
+    OV_FREE(&mt->workers);
+  }
+  if (mt->jobs) {
+    for (size_t i = 0; i < mt->jobs_cap; ++i) {
+      struct job *const job = &mt->jobs[i];
+      if (job->planes) {
+        if (job->planes[0]) {
+          OV_ALIGNED_FREE(&job->planes[0]);
+        }
+        OV_FREE(&job->planes);
+      }
+      if (job->data) {
+        OV_FREE(&job->data);
+      }
+    }
+    OV_FREE(&mt->jobs);
+  }
+  if (mt->sync_initialized) {
+    cnd_destroy(&mt->job_done);
+    cnd_destroy(&mt->job_queued);
+    mtx_destroy(&mt->mtx);
+  }
+  if (mt->pcm) {
+    OV_FREE(&mt->pcm);
+  }
+  if (mt->frames) {
+    OV_FREE(&mt->frames);
+  }
+  if (mt->header) {
+    OV_FREE(&mt->header);
+  }
+  flac_frame_scanner_exit(&mt->scanner);
+  OV_FREE(mtp);
+}
+
+NODISCARD bool
+flac_mt_create(struct flac_mt **const mtp, struct flac_mt_params const *const params, struct ov_error *const err) {
+  if (!mtp || *mtp || !params || !params->read || !params->header || !params->threads || !params->channels ||
+      params->channels > FLAC__MAX_CHANNELS) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  struct flac_mt *mt = NULL;
+  bool result = false;
+  {
+    if (!OV_REALLOC(&mt, 1, sizeof(*mt))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    *mt = (struct flac_mt){
+        .params = *params,
+        .kernel = flac_kernel_get_best(),
+    };
+    if (!OV_REALLOC(&mt->header, params->header_len, sizeof(uint8_t))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memcpy(mt->header, params->header, params->header_len);
+    mt->params.header = NULL;
+
+    if (!flac_frame_scanner_init(&mt->scanner,
+                                 params->read,
+                                 params->userdata,
+                                 params->header_len,
+                                 params->source_len,
+                                 params->fixed_blocksize,
+                                 params->min_framesize,
+                                 err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (!OV_REALLOC(&mt->pcm, params->channels, sizeof(float const *))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+
+    mt->jobs_cap = params->threads * jobs_per_thread;
+    if (!OV_REALLOC(&mt->jobs, mt->jobs_cap, sizeof(struct job))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memset(mt->jobs, 0, mt->jobs_cap * sizeof(struct job));
+    for (size_t i = 0; i < mt->jobs_cap; ++i) {
+      if (!OV_REALLOC(&mt->jobs[i].planes, params->channels, sizeof(float *))) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        goto cleanup;
+      }
+      mt->jobs[i].planes[0] = NULL;
+    }
+
+    if (mtx_init(&mt->mtx, mtx_plain) != thrd_success) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize mutex"));
+      goto cleanup;
+    }
+    if (cnd_init(&mt->job_queued) != thrd_success) {
+      mtx_destroy(&mt->mtx);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize condition"));
+      goto cleanup;
+    }
+    if (cnd_init(&mt->job_done) != thrd_success) {
+      cnd_destroy(&mt->job_queued);
+      mtx_destroy(&mt->mtx);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize condition"));
+      goto cleanup;
+    }
+    mt->sync_initialized = true;
+
+    if (!OV_REALLOC(&mt->workers, params->threads, sizeof(struct worker))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memset(mt->workers, 0, params->threads * sizeof(struct worker));
+    mt->workers_len = params->threads;
+    for (size_t i = 0; i < mt->workers_len; ++i) {
+      struct worker *const w = &mt->workers[i];
+      if (!init_worker(mt, w, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      if (thrd_create(&w->thread, worker_thread, w) != thrd_success) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to create thread"));
+        goto cleanup;
+      }
+      w->thread_started = true;
+    }
+    *mtp = mt;
+    mt = NULL;
+  }
+  result = true;
+
+cleanup:
+  if (mt) {
+    flac_mt_destroy(&mt);
+  }
+  return result;
+}
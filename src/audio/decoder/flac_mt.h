@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "flac_frame.h"
+
+struct flac_mt;
+
+struct flac_mt_params {
+  flac_frame_read_func read;
+  void *userdata;
+
+  // Stream bytes before the first frame ("fLaC" and all metadata blocks).
+  // Every worker decoder is primed with them so it knows STREAMINFO.
+  uint8_t const *header;
+  size_t header_len;
+
+  uint64_t source_len;
+  uint32_t fixed_blocksize;
+  uint32_t min_framesize;
+  size_t channels;
+  size_t threads;
+};
+
+/**
+ * @brief Creates a frame-parallel FLAC decoding pipeline.
+ *
+ * Frame boundaries are located with flac_frame_scanner on the caller's thread.
+ * Runs of frames are handed to worker threads that each own a libFLAC decoder,
+ * and the decoded frames are returned in stream order.
+ */
+NODISCARD bool
+flac_mt_create(struct flac_mt **const mtp, struct flac_mt_params const *const params, struct ov_error *const err);
+void flac_mt_destroy(struct flac_mt **const mtp);
+NODISCARD bool flac_mt_read(struct flac_mt *const mt,
+                            float const *const **const pcm,
+                            size_t *const samples,
+                            struct ov_error *const err);
+NODISCARD bool flac_mt_seek(struct flac_mt *const mt, uint64_t const position, struct ov_error *const err);
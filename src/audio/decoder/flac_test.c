@@ -5,15 +5,19 @@
 #endif
 
 #include <inttypes.h>
+#include <string.h>
 
 #include <ovarray.h>
 
 #include "../../test_util.h"
+#include "flac_frame.h"
 #include <ovl/audio/decoder.h>
 #include <ovl/audio/decoder/flac.h>
 #include <ovl/audio/info.h>
+#include <ovl/file.h>
 #include <ovl/source.h>
 #include <ovl/source/file.h>
+#include <ovl/source/memory.h>
 
 #ifdef __GNUC__
 #  ifndef __has_warning
@@ -411,8 +415,485 @@ cleanup:
   }
 }
 
+static bool verify_seek(struct ovl_audio_decoder *const d,
+                        struct test_util_decoded_audio const *const audio,
+                        uint64_t const position) {
+  struct ov_error err = {0};
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(d, position, &err), &err)) {
+    return false;
+  }
+  size_t const want = audio->samples - (size_t)position < 8192 ? audio->samples - (size_t)position : 8192;
+  size_t pos = (size_t)position;
+  struct test_util_wave_diff_count count = {0};
+  while (pos < (size_t)position + want) {
+    float const *const *pcm = NULL;
+    size_t read = 0;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+      return false;
+    }
+    if (read == 0) {
+      break;
+    }
+    if (read > (size_t)position + want - pos) {
+      read = (size_t)position + want - pos;
+    }
+    test_util_wave_diff_counter(
+        &count, pcm, (float const *[]){audio->buffer[0] + pos, audio->buffer[1] + pos}, read, audio->channels);
+    pos += read;
+  }
+  TEST_CHECK(pos == (size_t)position + want);
+  TEST_MSG("position %" PRIu64 ": want %zu got %zu", position, (size_t)position + want, pos);
+  TEST_CHECK(count.mismatches == 0);
+  TEST_MSG("position %" PRIu64 ": mismatches %zu / %zu", position, count.mismatches, count.total_samples);
+  return true;
+}
+
+static void seek_table(void) {
+  struct test_util_decoded_audio audio = {0};
+  struct ovl_audio_decoder *d = NULL;
+  struct ovl_source *source = NULL;
+  struct ov_error err = {0};
+
+  audio = decoder_all(TESTDATADIR NSTR("/test.flac"));
+  if (!TEST_CHECK(audio.buffer)) {
+    goto cleanup;
+  }
+  {
+    uint64_t const positions[] = {
+        (uint64_t)(60 * audio.sample_rate / 89),
+        0,
+        audio.samples / 2,
+        audio.samples / 2 + 1,
+        audio.samples - 1000,
+        1,
+    };
+
+    // Seek points learned while decoding
+    if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.flac"), &source, &err), &err)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_create(source, &d, &err), &err)) {
+      goto cleanup;
+    }
+    for (;;) {
+      float const *const *pcm = NULL;
+      size_t read = 0;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (read == 0) {
+        break;
+      }
+    }
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); ++i) {
+      if (!verify_seek(d, &audio, positions[i])) {
+        goto cleanup;
+      }
+    }
+    ovl_audio_decoder_destroy(&d);
+
+    // Seek table built by scanning frame headers
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_create(source, &d, &err), &err)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_build_seek_table(d, false, &err), &err)) {
+      goto cleanup;
+    }
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); ++i) {
+      if (!verify_seek(d, &audio, positions[i])) {
+        goto cleanup;
+      }
+    }
+    ovl_audio_decoder_destroy(&d);
+
+    // Background build racing with seeks
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_create(source, &d, &err), &err)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_build_seek_table(d, true, &err), &err)) {
+      goto cleanup;
+    }
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); ++i) {
+      if (!verify_seek(d, &audio, positions[i])) {
+        goto cleanup;
+      }
+    }
+  }
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (audio.buffer) {
+    OV_ARRAY_DESTROY(&audio.buffer[0]);
+    OV_ARRAY_DESTROY(&audio.buffer);
+  }
+}
+
+static void mt(void) {
+  struct test_util_decoded_audio audio = {0};
+  struct ovl_audio_decoder *d = NULL;
+  struct ovl_source *source = NULL;
+  struct ov_error err = {0};
+
+  audio = decoder_all(TESTDATADIR NSTR("/test.flac"));
+  if (!TEST_CHECK(audio.buffer)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.flac"), &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_create_mt(source, 3, &d, &err), &err)) {
+    goto cleanup;
+  }
+  {
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(d);
+    TEST_CHECK(info->samples == audio.samples);
+    TEST_CHECK(info->channels == audio.channels);
+
+    float const *const *pcm = NULL;
+    size_t pos = 0;
+    struct test_util_wave_diff_count count = {0};
+    for (;;) {
+      size_t read = 0;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (read == 0) {
+        break;
+      }
+      if (!TEST_CHECK(pos + read <= audio.samples)) {
+        goto cleanup;
+      }
+      test_util_wave_diff_counter(
+          &count, pcm, (float const *[]){audio.buffer[0] + pos, audio.buffer[1] + pos}, read, info->channels);
+      pos += read;
+    }
+    TEST_CHECK(pos == audio.samples);
+    TEST_MSG("want %zu got %zu", audio.samples, pos);
+    TEST_CHECK(count.mismatches == 0);
+    TEST_MSG("mismatches %zu / %zu", count.mismatches, count.total_samples);
+
+    uint64_t const positions[] = {
+        audio.samples - 1000,
+        (uint64_t)(60 * audio.sample_rate / 89),
+        0,
+        audio.samples / 2 + 1,
+    };
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); ++i) {
+      if (!verify_seek(d, &audio, positions[i])) {
+        goto cleanup;
+      }
+    }
+  }
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (audio.buffer) {
+    OV_ARRAY_DESTROY(&audio.buffer[0]);
+    OV_ARRAY_DESTROY(&audio.buffer);
+  }
+}
+
+struct memory {
+  uint8_t const *p;
+  size_t len;
+};
+
+static size_t read_memory(void *const userdata, void *const p, uint64_t const offset, size_t const len) {
+  struct memory const *const m = (struct memory const *)userdata;
+  if (offset >= m->len) {
+    return 0;
+  }
+  size_t const n = len < m->len - (size_t)offset ? len : m->len - (size_t)offset;
+  memcpy(p, m->p + offset, n);
+  return n;
+}
+
+static void mt_damaged(void) {
+  struct ovl_file *file = NULL;
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *d = NULL;
+  struct flac_frame_scanner scanner = {0};
+  struct ov_error err = {0};
+  static uint8_t buf[256 * 1024];
+  size_t len = 0;
+
+  if (!TEST_SUCCEEDED(ovl_file_open(TESTDATADIR NSTR("/test.flac"), &file, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_file_read(file, buf, sizeof(buf), &len, &err), &err)) {
+    goto cleanup;
+  }
+  // Skip "fLaC" and the metadata blocks to reach the first frame.
+  size_t offset = 4;
+  bool last_block = false;
+  while (!last_block && offset + 4 <= len) {
+    last_block = (buf[offset] & 0x80) != 0;
+    offset += 4 + (((size_t)buf[offset + 1] << 16) | ((size_t)buf[offset + 2] << 8) | buf[offset + 3]);
+  }
+  struct memory m = {buf, len};
+  if (!TEST_SUCCEEDED(flac_frame_scanner_init(&scanner, read_memory, &m, offset, len, 0, 0, &err), &err)) {
+    goto cleanup;
+  }
+  // Break the sync code of a frame halfway through the stream.
+  struct flac_frame frame = {0};
+  bool found = false;
+  do {
+    if (!TEST_SUCCEEDED(flac_frame_scanner_next(&scanner, &frame, &found, &err), &err) || !TEST_CHECK(found)) {
+      goto cleanup;
+    }
+  } while (frame.offset < len / 2);
+  buf[frame.offset + 1] = 0;
+
+  if (!TEST_SUCCEEDED(ovl_source_memory_create(buf, len, &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_create_mt(source, 3, &d, &err), &err)) {
+    goto cleanup;
+  }
+  // The frames after the damaged one must not be dropped silently.
+  bool ok = true;
+  uint64_t pos = 0;
+  for (;;) {
+    float const *const *pcm = NULL;
+    size_t read = 0;
+    ok = ovl_audio_decoder_read(d, &pcm, &read, &err);
+    if (!ok || read == 0) {
+      break;
+    }
+    pos += read;
+  }
+  TEST_FAILED_WITH(ok, &err, ov_error_type_generic, ov_error_generic_fail);
+  TEST_CHECK(pos <= frame.sample);
+  TEST_MSG("failed at %llu, damaged frame at %llu", (unsigned long long)pos, (unsigned long long)frame.sample);
+
+cleanup:
+  flac_frame_scanner_exit(&scanner);
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (file) {
+    ovl_file_close(file);
+  }
+}
+
+static void seek_read_into(struct ovl_audio_decoder *const d,
+                           float *const *const planes,
+                           size_t const cap,
+                           struct test_util_decoded_audio const *const audio,
+                           uint64_t const position) {
+  struct ov_error err = {0};
+  size_t read = 0;
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(d, position, &err), &err)) {
+    return;
+  }
+  // Fill the planes with a value the file never decodes to, so samples that were not written show up.
+  for (size_t c = 0; c < audio->channels; ++c) {
+    for (size_t i = 0; i < cap; ++i) {
+      planes[c][i] = 2.f;
+    }
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_read_into(d, planes, cap, &read, &err), &err)) {
+    return;
+  }
+  if (!TEST_CHECK(read > 0 && position + read <= audio->samples)) {
+    TEST_MSG("position=%llu read=%zu", (unsigned long long)position, read);
+    return;
+  }
+  struct test_util_wave_diff_count count = {0};
+  test_util_wave_diff_counter(&count,
+                              (float const *const *)planes,
+                              (float const *[]){audio->buffer[0] + position, audio->buffer[1] + position},
+                              read,
+                              audio->channels);
+  TEST_CHECK(count.mismatches == 0);
+  TEST_MSG("position=%llu mismatches %zu / %zu", (unsigned long long)position, count.mismatches, count.total_samples);
+}
+
+static void read_into(void) {
+  struct test_util_decoded_audio audio = {0};
+  struct ovl_audio_decoder *d = NULL;
+  struct ovl_source *source = NULL;
+  float *buffer = NULL;
+  struct ov_error err = {0};
+
+  audio = decoder_all(TESTDATADIR NSTR("/test.flac"));
+  if (!TEST_CHECK(audio.buffer)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.flac"), &source, &err), &err)) {
+    goto cleanup;
+  }
+  for (size_t threads = 0; threads < 2; ++threads) {
+    bool ok = threads ? ovl_audio_decoder_flac_create_mt(source, 2, &d, &err)
+                      : ovl_audio_decoder_flac_create(source, &d, &err);
+    if (!TEST_SUCCEEDED(ok, &err)) {
+      goto cleanup;
+    }
+    size_t const cap = ovl_audio_decoder_flac_get_max_block_size(d);
+    if (!TEST_CHECK(cap > 0)) {
+      goto cleanup;
+    }
+    // Offset the planes by one sample so the conversion cannot rely on alignment.
+    if (!TEST_CHECK(OV_REALLOC(&buffer, (cap + 1) * audio.channels, sizeof(float)))) {
+      goto cleanup;
+    }
+    float *const planes[2] = {buffer + 1, buffer + 1 + cap};
+    size_t read = 0;
+    TEST_FAILED_WITH(ovl_audio_decoder_flac_read_into(d, planes, cap - 1, &read, &err),
+                     &err,
+                     ov_error_type_generic,
+                     ov_error_generic_invalid_argument);
+
+    // Mix both read paths and make sure neither loses or duplicates samples.
+    size_t pos = 0;
+    struct test_util_wave_diff_count count = {0};
+    for (size_t i = 0;; ++i) {
+      float const *const *pcm = NULL;
+      if (i % 3 == 2) {
+        if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+          goto cleanup;
+        }
+      } else {
+        if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_read_into(d, planes, cap, &read, &err), &err)) {
+          goto cleanup;
+        }
+        pcm = (float const *const *)planes;
+      }
+      if (read == 0) {
+        break;
+      }
+      if (!TEST_CHECK(pos + read <= audio.samples)) {
+        goto cleanup;
+      }
+      test_util_wave_diff_counter(
+          &count, pcm, (float const *[]){audio.buffer[0] + pos, audio.buffer[1] + pos}, read, audio.channels);
+      pos += read;
+    }
+    TEST_CHECK(pos == audio.samples);
+    TEST_MSG("threads=%zu want %zu got %zu", threads, audio.samples, pos);
+    TEST_CHECK(count.mismatches == 0);
+    TEST_MSG("threads=%zu mismatches %zu / %zu", threads, count.mismatches, count.total_samples);
+
+    // A seek that lands inside a frame must only write the remainder of that frame.
+    // After the full decode above the seek starts from a learned seek point.
+    seek_read_into(d, planes, cap, &audio, audio.samples / 2 + 1);
+    ovl_audio_decoder_destroy(&d);
+
+    // A fresh decoder has no seek points, so libFLAC seeks by itself and decodes the target frame.
+    ok = threads ? ovl_audio_decoder_flac_create_mt(source, 2, &d, &err)
+                 : ovl_audio_decoder_flac_create(source, &d, &err);
+    if (!TEST_SUCCEEDED(ok, &err)) {
+      goto cleanup;
+    }
+    seek_read_into(d, planes, cap, &audio, audio.samples / 2 + 1);
+    ovl_audio_decoder_destroy(&d);
+  }
+
+cleanup:
+  if (buffer) {
+    OV_FREE(&buffer);
+  }
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (audio.buffer) {
+    OV_ARRAY_DESTROY(&audio.buffer[0]);
+    OV_ARRAY_DESTROY(&audio.buffer);
+  }
+}
+
+static void seek_keyframe(void) {
+  struct test_util_decoded_audio audio = {0};
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *d = NULL;
+  struct ov_error err = {0};
+
+  {
+    audio = decoder_all(TESTDATADIR NSTR("/test.flac"));
+    if (!TEST_CHECK(audio.buffer)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.flac"), &source, &err), &err)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_create(source, &d, &err), &err)) {
+      goto cleanup;
+    }
+    // With every frame known, the decoder can land on the frame that contains the position.
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_flac_build_seek_table(d, false, &err), &err)) {
+      goto cleanup;
+    }
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(d);
+    uint64_t const position = (uint64_t)(60 * audio.sample_rate / 89) + 1;
+    uint64_t actual = UINT64_MAX;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_seek_keyframe(d, position, &actual, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(actual <= position);
+    TEST_CHECK(position - actual < info->sample_rate);
+    TEST_MSG("position=%llu actual=%llu", (unsigned long long)position, (unsigned long long)actual);
+
+    // Decoding from the landing point must give the same audio as decoding from the start.
+    float const *const *pcm = NULL;
+    size_t pos = (size_t)actual;
+    size_t const end = pos + info->sample_rate;
+    struct test_util_wave_diff_count count = {0};
+    while (pos < end) {
+      size_t read = 0;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (read == 0) {
+        break;
+      }
+      test_util_wave_diff_counter(
+          &count, pcm, (float const *[]){audio.buffer[0] + pos, audio.buffer[1] + pos}, read, info->channels);
+      pos += read;
+    }
+    TEST_CHECK(pos >= end);
+    TEST_CHECK(count.large_diff_count == 0);
+    TEST_MSG("Total samples: %zu, Mismatches: %zu, Large differences: %zu",
+             count.total_samples,
+             count.mismatches,
+             count.large_diff_count);
+  }
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (audio.buffer) {
+    OV_ARRAY_DESTROY(&audio.buffer[0]);
+    OV_ARRAY_DESTROY(&audio.buffer);
+  }
+}
+
 TEST_LIST = {
     {"all", all},
     {"seek", seek},
+    {"seek_keyframe", seek_keyframe},
+    {"seek_table", seek_table},
+    {"mt", mt},
+    {"mt_damaged", mt_damaged},
+    {"read_into", read_into},
     {NULL, NULL},
 };
@@ -0,0 +1,514 @@
+#include <ovl/audio/decoder/loop.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+
+#include <ovmo.h>
+#include <ovthreads.h>
+
+#include <string.h>
+
+// The loop region is [loop_start, loop_end). Its head, up to one second, is decoded into head at creation.
+// Whenever playback enters the head while the wrapped decoder is somewhere else, most notably right after
+// wrapping at the loop end, the head is played from memory and a worker thread seeks the decoder to the end
+// of the head and reads the first chunk there. By the time the head has drained, the decoder is in place,
+// so neither the seek nor the pre-roll of lossy formats lands on the loop boundary.
+// The worker owns the wrapped decoder while a job is queued or decoding, so every other use of the decoder
+// goes through cancel_resume or take_resume first.
+enum resume_state {
+  resume_state_idle,
+  resume_state_queued,
+  resume_state_decoding,
+  resume_state_done,
+  resume_state_failed,
+};
+
+struct loop {
+  struct ovl_audio_decoder_vtable const *vtable;
+  struct ovl_audio_decoder *decoder;
+  struct ovl_audio_info const *info;
+  uint64_t decoder_cursor;
+  uint64_t loop_cursor;
+
+  uint64_t loop_start;
+  uint64_t loop_end;
+  bool has_loop;
+  bool enabled;
+
+  float const **pcm;
+  float **head;
+  size_t head_len;
+  size_t out_cap;
+
+  // The first chunk after the head, read by the worker; valid until the wrapped decoder is read again.
+  float const *const *resume_pcm;
+  size_t resume_len;
+  uint64_t resume_target;
+  enum resume_state resume_state;
+
+  mtx_t mtx;
+  cnd_t job_queued;
+  cnd_t job_done;
+  bool sync_initialized;
+  thrd_t worker;
+  bool worker_started;
+  bool quit;
+};
+
+static inline size_t adjust_align8(size_t const size) { return (size + (size_t)(7)) & ~(size_t)(7); }
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+
+static NODISCARD bool
+alloc_planes(float ***const planes, size_t const channels, size_t const stride, struct ov_error *const err) {
+  if (!OV_REALLOC(planes, channels, sizeof(float *))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], stride * channels, sizeof(float), 16)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ++ch) {
+    (*planes)[ch] = (*planes)[ch - 1] + stride;
+  }
+  return true;
+}
+
+static void free_planes(float ***const planes) {
+  if (*planes) {
+    if ((*planes)[0]) {
+      OV_ALIGNED_FREE(&(*planes)[0]);
+    }
+    OV_FREE(planes);
+  }
+}
+
+static void destroy(struct ovl_audio_decoder **const dp) {
+  struct loop **const ctxp = (struct loop **)(void *)dp;
+  if (!ctxp || !*ctxp) {
+    return;
+  }
+  struct loop *ctx = *ctxp;
+  if (ctx->worker_started) {
+    mtx_lock(&ctx->mtx);
+    ctx->quit = true;
+    cnd_broadcast(&ctx->job_queued);
+    mtx_unlock(&ctx->mtx);
+    thrd_join(ctx->worker, NULL);
+  }
+  if (ctx->sync_initialized) {
+    cnd_destroy(&ctx->job_done);
+    cnd_destroy(&ctx->job_queued);
+    mtx_destroy(&ctx->mtx);
+  }
+  free_planes(&ctx->head);
+  if (ctx->pcm) {
+    OV_FREE(&ctx->pcm);
+  }
+  OV_FREE(ctxp);
+}
+
+static struct ovl_audio_info const *get_info(struct ovl_audio_decoder const *const d) {
+  struct loop const *const ctx = (struct loop const *)(void const *)d;
+  return ctx->info;
+}
+
+/**
+ * @brief Moves the wrapped decoder to target and reads the first chunk there.
+ */
+static NODISCARD bool resume(struct loop *const ctx, uint64_t const target, struct ov_error *const err) {
+  bool result = false;
+  {
+    if (!ovl_audio_decoder_seek(ctx->decoder, target, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    ctx->decoder_cursor = target;
+    float const *const *pcm;
+    size_t read;
+    if (!ovl_audio_decoder_read(ctx->decoder, &pcm, &read, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    ctx->decoder_cursor += read;
+    ctx->resume_pcm = pcm;
+    ctx->resume_len = read;
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static int resume_thread(void *const userdata) {
+  struct loop *const ctx = (struct loop *)userdata;
+  mtx_lock(&ctx->mtx);
+  for (;;) {
+    while (!ctx->quit && ctx->resume_state != resume_state_queued) {
+      cnd_wait(&ctx->job_queued, &ctx->mtx);
+    }
+    if (ctx->quit) {
+      break;
+    }
+    ctx->resume_state = resume_state_decoding;
+    uint64_t const target = ctx->resume_target;
+    mtx_unlock(&ctx->mtx);
+    struct ov_error err = {0};
+    bool const ok = resume(ctx, target, &err);
+    if (!ok) {
+      OV_ERROR_REPORT(&err, NULL);
+    }
+    mtx_lock(&ctx->mtx);
+    ctx->resume_state = ok ? resume_state_done : resume_state_failed;
+    cnd_broadcast(&ctx->job_done);
+  }
+  mtx_unlock(&ctx->mtx);
+  return 0;
+}
+
+/**
+ * @brief Discards the pending job and waits until the worker no longer uses the decoder.
+ */
+static void cancel_resume(struct loop *const ctx) {
+  if (!ctx->worker_started) {
+    return;
+  }
+  mtx_lock(&ctx->mtx);
+  while (ctx->resume_state == resume_state_decoding) {
+    cnd_wait(&ctx->job_done, &ctx->mtx);
+  }
+  ctx->resume_state = resume_state_idle;
+  mtx_unlock(&ctx->mtx);
+}
+
+/**
+ * @brief Makes sure the decoder is being moved to target.
+ * Without a worker, nothing is queued and the seek happens when the head has drained.
+ */
+static void queue_resume(struct loop *const ctx, uint64_t const target) {
+  if (!ctx->worker_started) {
+    if (thrd_create(&ctx->worker, resume_thread, ctx) != thrd_success) {
+      return;
+    }
+    ctx->worker_started = true;
+  }
+  mtx_lock(&ctx->mtx);
+  bool const pending = ctx->resume_state != resume_state_idle;
+  bool const match = pending && ctx->resume_target == target;
+  mtx_unlock(&ctx->mtx);
+  if (match) {
+    return;
+  }
+  if (pending) {
+    cancel_resume(ctx);
+  }
+  mtx_lock(&ctx->mtx);
+  ctx->resume_target = target;
+  ctx->resume_state = resume_state_queued;
+  cnd_signal(&ctx->job_queued);
+  mtx_unlock(&ctx->mtx);
+}
+
+/**
+ * @brief Takes the chunk read by the worker if it starts at the cursor, waiting for the worker if needed.
+ * @param taken Set to true if the chunk is in resume_pcm, false if the decoder has to be read directly.
+ */
+static NODISCARD bool take_resume(struct loop *const ctx, bool *const taken, struct ov_error *const err) {
+  *taken = false;
+  if (!ctx->worker_started) {
+    return true;
+  }
+  mtx_lock(&ctx->mtx);
+  bool const match = ctx->resume_state != resume_state_idle && ctx->resume_target == ctx->loop_cursor;
+  while (match && (ctx->resume_state == resume_state_queued || ctx->resume_state == resume_state_decoding)) {
+    cnd_wait(&ctx->job_done, &ctx->mtx);
+  }
+  enum resume_state const state = ctx->resume_state;
+  if (match) {
+    ctx->resume_state = resume_state_idle;
+  }
+  mtx_unlock(&ctx->mtx);
+  if (!match) {
+    cancel_resume(ctx);
+    return true;
+  }
+  if (state != resume_state_done) {
+    OV_ERROR_SET(
+        err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to resume decoding after the loop point"));
+    return false;
+  }
+  *taken = true;
+  return true;
+}
+
+/**
+ * @brief Returns true if the wrapped decoder is idle and positioned at the cursor.
+ */
+static bool decoder_at_cursor(struct loop *const ctx) {
+  if (ctx->worker_started) {
+    mtx_lock(&ctx->mtx);
+    bool const idle = ctx->resume_state == resume_state_idle;
+    mtx_unlock(&ctx->mtx);
+    if (!idle) {
+      return false;
+    }
+  }
+  return ctx->decoder_cursor == ctx->loop_cursor;
+}
+
+static NODISCARD bool read(struct ovl_audio_decoder *const d,
+                           float const *const **const pcm,
+                           size_t *const samples,
+                           struct ov_error *const err) {
+  struct loop *const ctx = (struct loop *)(void *)d;
+  if (!ctx || !pcm || !samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  bool result = false;
+  {
+    bool const wrap = ctx->has_loop && ctx->enabled && ctx->loop_cursor < ctx->loop_end;
+    uint64_t const head_end = ctx->loop_start + ctx->head_len;
+    if (ctx->head_len > 0 && ctx->loop_cursor >= ctx->loop_start && ctx->loop_cursor < head_end &&
+        !decoder_at_cursor(ctx)) {
+      // While looping, loops that fit in the head never need the decoder again.
+      if (head_end < (wrap ? ctx->loop_end : ctx->info->samples)) {
+        queue_resume(ctx, head_end);
+      }
+      size_t const offset = (size_t)(ctx->loop_cursor - ctx->loop_start);
+      size_t const r = min2(ctx->out_cap, ctx->head_len - offset);
+      for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+        ctx->pcm[ch] = ctx->head[ch] + offset;
+      }
+      *pcm = ctx->pcm;
+      *samples = r;
+      ctx->loop_cursor += r;
+      if (wrap && ctx->loop_cursor == ctx->loop_end) {
+        ctx->loop_cursor = ctx->loop_start;
+      }
+      result = true;
+      goto cleanup;
+    }
+
+    bool taken;
+    if (!take_resume(ctx, &taken, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    float const *const *src;
+    size_t read;
+    if (taken) {
+      src = ctx->resume_pcm;
+      read = ctx->resume_len;
+    } else {
+      if (ctx->decoder_cursor != ctx->loop_cursor) {
+        if (!ovl_audio_decoder_seek(ctx->decoder, ctx->loop_cursor, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        ctx->decoder_cursor = ctx->loop_cursor;
+      }
+      if (!ovl_audio_decoder_read(ctx->decoder, &src, &read, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      ctx->decoder_cursor += read;
+    }
+    if (read == 0 && wrap && ctx->loop_cursor > ctx->loop_start) {
+      // The stream is shorter than its header claims; the loop ends where the audio does.
+      ctx->loop_end = ctx->loop_cursor;
+      ctx->loop_cursor = ctx->loop_start;
+      if (!ovl_audio_decoder_read(d, pcm, samples, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      result = true;
+      goto cleanup;
+    }
+    size_t const r = wrap && ctx->loop_end - ctx->loop_cursor < read ? (size_t)(ctx->loop_end - ctx->loop_cursor) : read;
+    *pcm = src;
+    *samples = r;
+    ctx->loop_cursor += r;
+    if (wrap && ctx->loop_cursor == ctx->loop_end) {
+      ctx->loop_cursor = ctx->loop_start;
+    }
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err) {
+  struct loop *const ctx = (struct loop *)(void *)d;
+  if (!ctx || position > ctx->info->samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  // The decoder is moved lazily, so seeking into the head costs nothing.
+  ctx->loop_cursor = position;
+  return true;
+}
+
+/**
+ * @brief Derives the loop region from the tag.
+ * @return true if the tag describes a non-empty region inside the stream.
+ */
+static bool find_region(struct ovl_audio_info const *const info, uint64_t *const start, uint64_t *const end) {
+  struct ovl_audio_tag const *const tag = &info->tag;
+  if (tag->loop_start == UINT64_MAX || tag->loop_start >= info->samples) {
+    return false;
+  }
+  uint64_t e;
+  if (tag->loop_length != UINT64_MAX && tag->loop_length > 0) {
+    e = tag->loop_length > UINT64_MAX - tag->loop_start ? UINT64_MAX : tag->loop_start + tag->loop_length;
+  } else if (tag->loop_end != UINT64_MAX && tag->loop_end >= tag->loop_start) {
+    e = tag->loop_end + 1;
+  } else {
+    return false;
+  }
+  *start = tag->loop_start;
+  *end = e < info->samples ? e : info->samples;
+  return true;
+}
+
+/**
+ * @brief Decodes the head of the loop region into head.
+ * Leaves the decoder right after what it has read, and shortens the loop if the stream ends inside the head.
+ */
+static NODISCARD bool fill_head(struct loop *const ctx, size_t const cap, struct ov_error *const err) {
+  bool result = false;
+  {
+    if (!ovl_audio_decoder_seek(ctx->decoder, ctx->loop_start, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    ctx->decoder_cursor = ctx->loop_start;
+    while (ctx->head_len < cap) {
+      float const *const *pcm;
+      size_t read;
+      if (!ovl_audio_decoder_read(ctx->decoder, &pcm, &read, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      if (read == 0) {
+        ctx->loop_end = ctx->loop_start + ctx->head_len;
+        break;
+      }
+      ctx->decoder_cursor += read;
+      size_t const n = min2(read, cap - ctx->head_len);
+      for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+        memcpy(ctx->head[ch] + ctx->head_len, pcm[ch], n * sizeof(float));
+      }
+      ctx->head_len += n;
+    }
+    ctx->has_loop = ctx->head_len > 0;
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+NODISCARD bool ovl_audio_decoder_loop_create(struct ovl_audio_decoder *const source,
+                                             struct ovl_audio_decoder **const dp,
+                                             struct ov_error *const err) {
+  if (!dp || *dp || !source) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct loop *ctx = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&ctx, 1, sizeof(*ctx))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    static struct ovl_audio_decoder_vtable const vtable = {
+        .destroy = destroy,
+        .get_info = get_info,
+        .read = read,
+        .seek = seek,
+    };
+    *ctx = (struct loop){
+        .vtable = &vtable,
+        .decoder = source,
+        .info = ovl_audio_decoder_get_info(source),
+        .enabled = true,
+    };
+    size_t const channels = ctx->info->channels;
+    ctx->out_cap = ctx->info->sample_rate / 10;
+
+    if (!OV_REALLOC(&ctx->pcm, channels, sizeof(float *))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (mtx_init(&ctx->mtx, mtx_plain) != thrd_success) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize mutex"));
+      goto cleanup;
+    }
+    if (cnd_init(&ctx->job_queued) != thrd_success) {
+      mtx_destroy(&ctx->mtx);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize condition"));
+      goto cleanup;
+    }
+    if (cnd_init(&ctx->job_done) != thrd_success) {
+      cnd_destroy(&ctx->job_queued);
+      mtx_destroy(&ctx->mtx);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize condition"));
+      goto cleanup;
+    }
+    ctx->sync_initialized = true;
+
+    if (find_region(ctx->info, &ctx->loop_start, &ctx->loop_end)) {
+      // One second of head hides the seek and pre-roll of any supported format.
+      uint64_t const len = ctx->loop_end - ctx->loop_start;
+      size_t const cap = len < ctx->info->sample_rate ? (size_t)len : ctx->info->sample_rate;
+      if (!alloc_planes(&ctx->head, channels, adjust_align8(cap), err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      if (!fill_head(ctx, cap, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+    *dp = (struct ovl_audio_decoder *)(void *)ctx;
+  }
+  result = true;
+
+cleanup:
+  if (!result) {
+    if (ctx) {
+      destroy((struct ovl_audio_decoder **)(void *)&ctx);
+    }
+  }
+  return result;
+}
+
+void ovl_audio_decoder_loop_set_enabled(struct ovl_audio_decoder *const d, bool const enabled) {
+  struct loop *const ctx = (struct loop *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    return;
+  }
+  ctx->enabled = enabled;
+}
+
+NODISCARD bool ovl_audio_decoder_loop_get_region(struct ovl_audio_decoder *const d,
+                                                 uint64_t *const start,
+                                                 uint64_t *const end) {
+  struct loop *const ctx = (struct loop *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy || !ctx->has_loop) {
+    return false;
+  }
+  if (start) {
+    *start = ctx->loop_start;
+  }
+  if (end) {
+    *end = ctx->loop_end;
+  }
+  return true;
+}
@@ -0,0 +1,279 @@
+#include <ovtest.h>
+
+#ifndef TESTDATADIR
+#  define TESTDATADIR NSTR(".")
+#endif
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/loop.h>
+#include <ovl/audio/decoder/ogg.h>
+#include <ovl/audio/decoder/wav.h>
+#include <ovl/audio/info.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+
+#include <inttypes.h>
+#include <math.h>
+
+// Passes everything through to the wrapped decoder, counting seeks and optionally replacing the loop points.
+struct counting {
+  struct ovl_audio_decoder_vtable const *vtable;
+  struct ovl_audio_decoder *inner;
+  struct ovl_audio_info info;
+  size_t seeks;
+  uint64_t last_seek;
+};
+
+static void counting_destroy(struct ovl_audio_decoder **const dp) { (void)dp; }
+
+static struct ovl_audio_info const *counting_get_info(struct ovl_audio_decoder const *const d) {
+  struct counting const *const ctx = (struct counting const *)(void const *)d;
+  return &ctx->info;
+}
+
+static NODISCARD bool counting_read(struct ovl_audio_decoder *const d,
+                                    float const *const **const pcm,
+                                    size_t *const samples,
+                                    struct ov_error *const err) {
+  struct counting *const ctx = (struct counting *)(void *)d;
+  return ovl_audio_decoder_read(ctx->inner, pcm, samples, err);
+}
+
+static NODISCARD bool
+counting_seek(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err) {
+  struct counting *const ctx = (struct counting *)(void *)d;
+  ++ctx->seeks;
+  ctx->last_seek = position;
+  return ovl_audio_decoder_seek(ctx->inner, position, err);
+}
+
+static struct ovl_audio_decoder_vtable const counting_vtable = {
+    .destroy = counting_destroy,
+    .get_info = counting_get_info,
+    .read = counting_read,
+    .seek = counting_seek,
+};
+
+static inline size_t adjust_align8(size_t const size) { return (size + UINT64_C(7)) & ~UINT64_C(7); }
+
+static bool alloc_golden(float ***const golden, size_t const channels, size_t const samples) {
+  if (!OV_REALLOC(golden, channels, sizeof(float *))) {
+    return false;
+  }
+  (*golden)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*golden)[0], channels * adjust_align8(samples), sizeof(float), 16)) {
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ch++) {
+    (*golden)[ch] = (*golden)[ch - 1] + adjust_align8(samples);
+  }
+  return true;
+}
+
+static size_t decode_all(struct ovl_audio_decoder *const d, float *const *const golden, size_t const samples) {
+  struct ov_error err = {0};
+  size_t const channels = ovl_audio_decoder_get_info(d)->channels;
+  size_t offset = 0;
+  while (offset < samples) {
+    size_t read;
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err) || read == 0) {
+      break;
+    }
+    size_t const sz = offset + read > samples ? samples - offset : read;
+    for (size_t ch = 0; ch < channels; ch++) {
+      memcpy(golden[ch] + offset, pcm[ch], sz * sizeof(float));
+    }
+    offset += sz;
+  }
+  return offset;
+}
+
+/**
+ * Plays the decoder from position 0 for the given number of samples and compares the result with golden,
+ * wrapped at the loop region. Returns the number of mismatching samples.
+ */
+static size_t play_and_compare(struct ovl_audio_decoder *const loop,
+                               float const *const *const golden,
+                               uint64_t const loop_start,
+                               uint64_t const loop_end,
+                               size_t const samples) {
+  struct ov_error err = {0};
+  size_t const channels = ovl_audio_decoder_get_info(loop)->channels;
+  size_t mismatches = 0;
+  uint64_t expected = 0;
+  size_t offset = 0;
+  while (offset < samples) {
+    size_t read;
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_read(loop, &pcm, &read, &err), &err)) {
+      return SIZE_MAX;
+    }
+    if (!TEST_CHECK(read > 0)) {
+      return SIZE_MAX;
+    }
+    for (size_t i = 0; i < read; i++) {
+      for (size_t ch = 0; ch < channels; ch++) {
+        if (fabsf(pcm[ch][i] - golden[ch][expected]) > 0.001f) {
+          ++mismatches;
+        }
+      }
+      if (++expected == loop_end) {
+        expected = loop_start;
+      }
+    }
+    offset += read;
+  }
+  return mismatches;
+}
+
+static void wrap(void) {
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *ogg = NULL;
+  struct ovl_audio_decoder *loop = NULL;
+  float **golden = NULL;
+  struct counting counting = {.vtable = &counting_vtable};
+  struct ov_error err = {0};
+
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(source, &ogg, &err), &err)) {
+    goto cleanup;
+  }
+
+  {
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(ogg);
+    size_t const rate = info->sample_rate;
+    // A loop longer than the cached head, so the decoder has to be moved after each wrap.
+    uint64_t const loop_start = rate / 2;
+    uint64_t const loop_end = loop_start + rate * 3;
+    if (!TEST_CHECK(info->samples > loop_end)) {
+      goto cleanup;
+    }
+    if (!TEST_CHECK(alloc_golden(&golden, info->channels, (size_t)loop_end))) {
+      goto cleanup;
+    }
+    TEST_CHECK(decode_all(ogg, golden, (size_t)loop_end) == loop_end);
+
+    counting.inner = ogg;
+    counting.info = *info;
+    counting.info.tag.loop_start = loop_start;
+    counting.info.tag.loop_end = UINT64_MAX;
+    counting.info.tag.loop_length = loop_end - loop_start;
+    struct ovl_audio_decoder *const inner = (struct ovl_audio_decoder *)(void *)&counting;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_loop_create(inner, &loop, &err), &err)) {
+      goto cleanup;
+    }
+    uint64_t start = 0;
+    uint64_t end = 0;
+    TEST_CHECK(ovl_audio_decoder_loop_get_region(loop, &start, &end));
+    TEST_CHECK(start == loop_start && end == loop_end);
+
+    // Four passes through the loop; after creation the decoder is only moved to the start of the stream
+    // and past the cached head, never to the loop point itself.
+    counting.seeks = 0;
+    size_t const total = (size_t)(loop_end + (loop_end - loop_start) * 3);
+    size_t const mismatches = play_and_compare(loop, (float const *const *)golden, loop_start, loop_end, total);
+    TEST_CHECK(mismatches == 0);
+    TEST_MSG("mismatches=%zu", mismatches);
+    TEST_CHECK(counting.seeks == 4);
+    TEST_MSG("seeks=%zu", counting.seeks);
+    TEST_CHECK(counting.last_seek == loop_start + rate);
+    TEST_MSG("last_seek=%" PRIu64, counting.last_seek);
+
+    // Without looping, playback continues past the loop end.
+    ovl_audio_decoder_loop_set_enabled(loop, false);
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(loop, loop_end - 1, &err), &err)) {
+      goto cleanup;
+    }
+    size_t read;
+    float const *const *pcm = NULL;
+    if (TEST_SUCCEEDED(ovl_audio_decoder_read(loop, &pcm, &read, &err), &err)) {
+      TEST_CHECK(read > 1);
+    }
+  }
+
+cleanup:
+  if (golden) {
+    OV_ALIGNED_FREE(&golden[0]);
+    OV_FREE(&golden);
+  }
+  if (loop) {
+    ovl_audio_decoder_destroy(&loop);
+  }
+  if (ogg) {
+    ovl_audio_decoder_destroy(&ogg);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+}
+
+static void short_loop(void) {
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *wav = NULL;
+  struct ovl_audio_decoder *loop = NULL;
+  float **golden = NULL;
+  struct counting counting = {.vtable = &counting_vtable};
+  struct ov_error err = {0};
+
+  if (!TEST_SUCCEEDED(
+          ovl_source_file_create(TESTDATADIR NSTR("/test-8khz-mono-8-loop-smpl.wav"), &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_wav_create(source, &wav, &err), &err)) {
+    goto cleanup;
+  }
+
+  {
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(wav);
+    size_t const samples = (size_t)info->samples;
+    if (!TEST_CHECK(alloc_golden(&golden, info->channels, samples))) {
+      goto cleanup;
+    }
+    TEST_CHECK(decode_all(wav, golden, samples) == samples);
+
+    counting.inner = wav;
+    counting.info = *info;
+    struct ovl_audio_decoder *const inner = (struct ovl_audio_decoder *)(void *)&counting;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_loop_create(inner, &loop, &err), &err)) {
+      goto cleanup;
+    }
+    // The smpl chunk loops 5803 to 11057 inclusive.
+    uint64_t start = 0;
+    uint64_t end = 0;
+    TEST_CHECK(ovl_audio_decoder_loop_get_region(loop, &start, &end));
+    TEST_CHECK(start == 5803 && end == 11058);
+    TEST_MSG("start=%" PRIu64 " end=%" PRIu64, start, end);
+
+    // The whole loop fits in the cached head, so only the move back to the start of the stream seeks.
+    counting.seeks = 0;
+    size_t const mismatches = play_and_compare(loop, (float const *const *)golden, start, end, samples * 4);
+    TEST_CHECK(mismatches == 0);
+    TEST_MSG("mismatches=%zu", mismatches);
+    TEST_CHECK(counting.seeks == 1);
+    TEST_MSG("seeks=%zu", counting.seeks);
+  }
+
+cleanup:
+  if (golden) {
+    OV_ALIGNED_FREE(&golden[0]);
+    OV_FREE(&golden);
+  }
+  if (loop) {
+    ovl_audio_decoder_destroy(&loop);
+  }
+  if (wav) {
+    ovl_audio_decoder_destroy(&wav);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+}
+
+TEST_LIST = {
+    {"wrap", wrap},
+    {"short_loop", short_loop},
+    {NULL, NULL},
+};
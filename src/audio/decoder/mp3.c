@@ -2,6 +2,7 @@
 
 #include "../tag.h"
 #include "../tag/id3v2.h"
+#include "deinterleave.h"
 
 #include <ovl/audio/decoder.h>
 #include <ovl/audio/info.h>
@@ -66,6 +67,7 @@ struct mp3 {
   mp3dec_ex_t dec;
   mp3dec_io_t io;
 
+  struct deinterleave_kernels const *kernels;
   float **pcm;
   struct ovl_audio_info info;
 };
@@ -132,11 +134,7 @@ static NODISCARD bool read(struct ovl_audio_decoder *const d,
   }
   size_t const channels = ctx->info.channels;
   size_t const n = r / channels;
-  for (size_t i = 0; i < n; i++) {
-    for (size_t ch = 0; ch < channels; ch++) {
-      ctx->pcm[ch][i] = buf[i * channels + ch];
-    }
-  }
+  ctx->kernels->f32(buf, ctx->pcm, 0, n, channels);
   *pcm = (float const *const *)ctx->pcm;
   *samples = n;
   return true;
@@ -181,6 +179,7 @@ NODISCARD bool ovl_audio_decoder_mp3_create(struct ovl_source *const source,
         .vtable = &vtable,
         .source = source,
         .source_len = ovl_source_size(source),
+        .kernels = deinterleave_get_best(),
         .io =
             {
                 .read = cb_read,
@@ -159,6 +159,38 @@ static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const pos
   return true;
 }
 
+static NODISCARD bool seek_keyframe(struct ovl_audio_decoder *const d,
+                                    uint64_t const position,
+                                    uint64_t *const actual,
+                                    struct ov_error *const err) {
+  struct ogg *const ctx = (struct ogg *)(void *)d;
+  if (!ctx || !actual) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (position > INT64_MAX) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Invalid position"));
+    return false;
+  }
+  // ov_pcm_seek is ov_pcm_seek_page followed by decoding and discarding up to the target,
+  // so stopping at the page leaves the same stream with nothing thrown away.
+  if (ov_pcm_seek_page(&ctx->of, (ogg_int64_t)position) != 0) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to seek"));
+    return false;
+  }
+  ogg_int64_t const landed = ov_pcm_tell(&ctx->of);
+  if (landed >= 0 && (uint64_t)landed <= position && position - (uint64_t)landed < ctx->info.sample_rate) {
+    *actual = (uint64_t)landed;
+    return true;
+  }
+  if (!seek(d, position, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  *actual = position;
+  return true;
+}
+
 NODISCARD bool ovl_audio_decoder_ogg_create(struct ovl_source *const source,
                                             struct ovl_audio_decoder **const dp,
                                             struct ov_error *const err) {
@@ -178,6 +210,7 @@ NODISCARD bool ovl_audio_decoder_ogg_create(struct ovl_source *const source,
         .get_info = get_info,
         .read = read,
         .seek = seek,
+        .seek_keyframe = seek_keyframe,
     };
     *ctx = (struct ogg){
         .vtable = &vtable,
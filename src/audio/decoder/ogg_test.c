@@ -351,8 +351,74 @@ cleanup:
   }
 }
 
+static void seek_keyframe(void) {
+  struct test_util_decoded_audio audio = {0};
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *d = NULL;
+  struct ov_error err = {0};
+
+  {
+    audio = decoder_all(TESTDATADIR NSTR("/test.ogg"));
+    if (!TEST_CHECK(audio.buffer)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &source, &err), &err)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(source, &d, &err), &err)) {
+      goto cleanup;
+    }
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(d);
+    uint64_t const position = (uint64_t)(60 * audio.sample_rate / 89) + 1;
+    uint64_t actual = UINT64_MAX;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_seek_keyframe(d, position, &actual, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(actual <= position);
+    TEST_CHECK(position - actual < info->sample_rate);
+    TEST_MSG("position=%llu actual=%llu", (unsigned long long)position, (unsigned long long)actual);
+
+    // Decoding from the landing point must give the same audio as decoding from the start.
+    float const *const *pcm = NULL;
+    size_t pos = (size_t)actual;
+    size_t const end = pos + info->sample_rate;
+    struct test_util_wave_diff_count count = {0};
+    while (pos < end) {
+      size_t read = 0;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (read == 0) {
+        break;
+      }
+      test_util_wave_diff_counter(
+          &count, pcm, (float const *[]){audio.buffer[0] + pos, audio.buffer[1] + pos}, read, info->channels);
+      pos += read;
+    }
+    TEST_CHECK(pos >= end);
+    TEST_CHECK(count.large_diff_count == 0);
+    TEST_MSG("Total samples: %zu, Mismatches: %zu, Large differences: %zu",
+             count.total_samples,
+             count.mismatches,
+             count.large_diff_count);
+  }
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (audio.buffer) {
+    OV_ARRAY_DESTROY(&audio.buffer[0]);
+    OV_ARRAY_DESTROY(&audio.buffer);
+  }
+}
+
 TEST_LIST = {
     {"all", all},
     {"seek", seek},
+    {"seek_keyframe", seek_keyframe},
     {NULL, NULL},
 };
@@ -2,6 +2,7 @@
 
 #include "../tag.h"
 #include "../tag/vorbis_comment.h"
+#include "deinterleave.h"
 
 #include <ovl/audio/decoder.h>
 #include <ovl/audio/info.h>
@@ -37,8 +38,11 @@ struct opus {
   OggOpusFile *of;
   struct ovl_audio_info info;
 
+  struct deinterleave_kernels const *kernels;
   float **pcm;
-  int16_t *buf;
+  // Interleaved output of OpusFile. Exactly one of them is allocated, buf16 only in low-memory mode.
+  float *buf;
+  int16_t *buf16;
 };
 
 static int cb_read(void *const stream, unsigned char *const ptr, int const nbytes) {
@@ -114,6 +118,9 @@ static void destroy(struct ovl_audio_decoder **const dp) {
   if (ctx->buf) {
     OV_ALIGNED_FREE(&ctx->buf);
   }
+  if (ctx->buf16) {
+    OV_ALIGNED_FREE(&ctx->buf16);
+  }
   if (ctx->pcm) {
     if (ctx->pcm[0]) {
       OV_ALIGNED_FREE(&ctx->pcm[0]);
@@ -131,56 +138,6 @@ static struct ovl_audio_info const *get_info(struct ovl_audio_decoder const *con
   return &ctx->info;
 }
 
-#if defined(__GNUC__) || defined(__clang__)
-#  define ASSUME_ALIGNED_16(ptr) __builtin_assume_aligned((ptr), 16)
-#else
-#  define ASSUME_ALIGNED_16(ptr) (ptr)
-#endif
-
-static inline float conv_int16_to_float(int16_t const v) {
-  static float const inv_scale = 1.f / 32768.f;
-  return (float)v * inv_scale;
-}
-
-static inline void int16_to_float_1ch(int16_t const *const src, float *const *const dst, size_t const samples) {
-  int16_t const *const s = (int16_t const *)ASSUME_ALIGNED_16(src);
-  float *const d = (float *)ASSUME_ALIGNED_16(dst[0]);
-  for (size_t i = 0; i < samples; ++i) {
-    d[i] = conv_int16_to_float(s[i]);
-  }
-}
-
-static inline void int16_to_float_2ch(int16_t const *const src, float *const *const dst, size_t const samples) {
-  int16_t const *const s = (int16_t const *)ASSUME_ALIGNED_16(src);
-  float *const dl = (float *)ASSUME_ALIGNED_16(dst[0]);
-  float *const dr = (float *)ASSUME_ALIGNED_16(dst[1]);
-  for (size_t i = 0; i < samples; ++i) {
-    dl[i] = conv_int16_to_float(s[i * 2]);
-    dr[i] = conv_int16_to_float(s[i * 2 + 1]);
-  }
-}
-
-static inline void
-int16_to_float_multi(int16_t const *const src, float *const *const dst, size_t const channels, size_t const samples) {
-  int16_t const *const s = (int16_t const *)ASSUME_ALIGNED_16(src);
-  for (size_t i = 0; i < samples; i++) {
-    for (size_t c = 0; c < channels; c++) {
-      dst[c][i] = conv_int16_to_float(*(s + i * channels + c));
-    }
-  }
-}
-
-static inline void
-int16_to_float(int16_t const *const src, float *const *const dst, size_t const channels, size_t const samples) {
-  if (channels == 1) {
-    int16_to_float_1ch(src, dst, samples);
-  } else if (channels == 2) {
-    int16_to_float_2ch(src, dst, samples);
-  } else {
-    int16_to_float_multi(src, dst, channels, samples);
-  }
-}
-
 static NODISCARD bool read(struct ovl_audio_decoder *const d,
                            float const *const **const pcm,
                            size_t *const samples,
@@ -190,17 +147,21 @@ static NODISCARD bool read(struct ovl_audio_decoder *const d,
     OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
     return false;
   }
-  // OpusFile has op_read_float that can get data in float format,
-  // but this function internally converts data obtained in int16 to float.
-  // In this program, conversion from interleaved format is also required,
-  // so it is more efficient to convert to float at that timing.
-  int const r = op_read(ctx->of, ctx->buf, (int)(chunk_samples * ctx->info.channels), NULL);
+  // libopus decodes in float, so op_read_float hands over the decoder output as is.
+  // op_read quantizes it to int16 first, which loses precision and is only used in low-memory mode.
+  int const buf_size = (int)(chunk_samples * ctx->info.channels);
+  int const r =
+      ctx->buf16 ? op_read(ctx->of, ctx->buf16, buf_size, NULL) : op_read_float(ctx->of, ctx->buf, buf_size, NULL);
   if (r < 0) {
     OV_ERROR_SETF(
         err, ov_error_type_generic, ov_error_generic_fail, "%1$d", gettext("Failed to read samples.(code:%1$d)"), r);
     return false;
   }
-  int16_to_float(ctx->buf, ctx->pcm, ctx->info.channels, (size_t)r);
+  if (ctx->buf16) {
+    ctx->kernels->i16(ctx->buf16, ctx->pcm, 0, (size_t)r, ctx->info.channels);
+  } else {
+    ctx->kernels->f32(ctx->buf, ctx->pcm, 0, (size_t)r, ctx->info.channels);
+  }
   *pcm = (float const *const *)ov_deconster_(ctx->pcm);
   *samples = (size_t)r;
   return true;
@@ -221,9 +182,10 @@ static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const pos
   return true;
 }
 
-NODISCARD bool ovl_audio_decoder_opus_create(struct ovl_source *const source,
-                                             struct ovl_audio_decoder **const dp,
-                                             struct ov_error *const err) {
+static NODISCARD bool create(struct ovl_source *const source,
+                             bool const low_memory,
+                             struct ovl_audio_decoder **const dp,
+                             struct ov_error *const err) {
   if (!dp || !source) {
     OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
     return false;
@@ -245,6 +207,7 @@ NODISCARD bool ovl_audio_decoder_opus_create(struct ovl_source *const source,
         .vtable = &vtable,
         .source = source,
         .source_len = ovl_source_size(source),
+        .kernels = deinterleave_get_best(),
         .info =
             {
                 .tag =
@@ -315,7 +278,10 @@ NODISCARD bool ovl_audio_decoder_opus_create(struct ovl_source *const source,
     for (size_t ch = 1; ch < ctx->info.channels; ++ch) {
       ctx->pcm[ch] = ctx->pcm[0] + chunk_samples * ch;
     }
-    if (!OV_ALIGNED_ALLOC(&ctx->buf, chunk_samples * ctx->info.channels, sizeof(int16_t), 16)) {
+    bool const allocated = low_memory
+                               ? OV_ALIGNED_ALLOC(&ctx->buf16, chunk_samples * ctx->info.channels, sizeof(int16_t), 16)
+                               : OV_ALIGNED_ALLOC(&ctx->buf, chunk_samples * ctx->info.channels, sizeof(float), 16);
+    if (!allocated) {
       OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
       goto cleanup;
     }
@@ -330,3 +296,23 @@ cleanup:
   }
   return result;
 }
+
+NODISCARD bool ovl_audio_decoder_opus_create(struct ovl_source *const source,
+                                             struct ovl_audio_decoder **const dp,
+                                             struct ov_error *const err) {
+  if (!create(source, false, dp, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+NODISCARD bool ovl_audio_decoder_opus_create_low_memory(struct ovl_source *const source,
+                                                        struct ovl_audio_decoder **const dp,
+                                                        struct ov_error *const err) {
+  if (!create(source, true, dp, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
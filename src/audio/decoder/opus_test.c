@@ -249,6 +249,8 @@ static void all(void) {
     }
 
     TEST_CHECK(pos == info->samples);
+    // Both sides decode with op_read_float, so the output has to match exactly.
+    TEST_CHECK(count.mismatches == 0);
     TEST_CHECK(count.large_diff_count == 0);
     TEST_MSG("Total samples: %zu, Mismatches: %zu (%.2f%%), Large differences: "
              "%zu (%.2f%%)",
@@ -371,8 +373,70 @@ cleanup:
   }
 }
 
+static void low_memory(void) {
+  struct test_util_decoded_audio audio = {0};
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *d = NULL;
+  struct ov_error err = {0};
+
+  audio = decoder_all(TESTDATADIR NSTR("/test.opus"));
+  if (!TEST_CHECK(audio.buffer)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.opus"), &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_opus_create_low_memory(source, &d, &err), &err)) {
+    goto cleanup;
+  }
+  {
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(d);
+    TEST_CHECK(info->samples == audio.samples);
+    TEST_CHECK(info->channels == audio.channels);
+
+    float const *const *pcm = NULL;
+    size_t pos = 0;
+    struct test_util_wave_diff_count count = {0};
+    while (pos < info->samples) {
+      size_t read = 0;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (read == 0) {
+        break;
+      }
+      if (!TEST_CHECK(pos + read <= audio.samples)) {
+        goto cleanup;
+      }
+      test_util_wave_diff_counter(
+          &count, pcm, (float const *[]){audio.buffer[0] + pos, audio.buffer[1] + pos}, read, info->channels);
+      pos += read;
+    }
+    TEST_CHECK(pos == info->samples);
+    // The int16 path only differs by quantization.
+    TEST_CHECK(count.large_diff_count == 0);
+    TEST_MSG("Total samples: %zu, Mismatches: %zu, Large differences: %zu",
+             count.total_samples,
+             count.mismatches,
+             count.large_diff_count);
+  }
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (audio.buffer) {
+    OV_ARRAY_DESTROY(&audio.buffer[0]);
+    OV_ARRAY_DESTROY(&audio.buffer);
+  }
+}
+
 TEST_LIST = {
     {"all", all},
     {"seek", seek},
+    {"low_memory", low_memory},
     {NULL, NULL},
 };
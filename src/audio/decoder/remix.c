@@ -0,0 +1,415 @@
+#include <ovl/audio/decoder/remix.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+
+#include <math.h>
+#include <ovmo.h>
+#include <string.h>
+
+#include "../mixer_kernel.h"
+
+// Every output channel is a row of gains over the source channels. Matrices that only pick channels, like
+// the identity or mono to stereo, are turned into a map at creation, and read returns pointers into the
+// source planes for them. Any other matrix is mixed with the mixer kernels, one nonzero gain at a time, in
+// chunks no longer than the buffers allocated at creation.
+
+enum {
+  chunk = 4096,
+  max_standard_channels = 8,
+};
+
+enum role {
+  role_m,
+  role_l,
+  role_r,
+  role_c,
+  role_lfe,
+  role_ls,
+  role_rs,
+  role_bc,
+};
+
+// Both back and side pairs are surrounds of their side for a fold-down.
+static enum role const wave_roles[max_standard_channels][max_standard_channels] = {
+    {role_m},
+    {role_l, role_r},
+    {role_l, role_r, role_c},
+    {role_l, role_r, role_ls, role_rs},
+    {role_l, role_r, role_c, role_ls, role_rs},
+    {role_l, role_r, role_c, role_lfe, role_ls, role_rs},
+    {role_l, role_r, role_c, role_lfe, role_bc, role_ls, role_rs},
+    {role_l, role_r, role_c, role_lfe, role_ls, role_rs, role_ls, role_rs},
+};
+
+static enum role const vorbis_roles[max_standard_channels][max_standard_channels] = {
+    {role_m},
+    {role_l, role_r},
+    {role_l, role_c, role_r},
+    {role_l, role_r, role_ls, role_rs},
+    {role_l, role_c, role_r, role_ls, role_rs},
+    {role_l, role_c, role_r, role_ls, role_rs, role_lfe},
+    {role_l, role_c, role_r, role_ls, role_rs, role_bc, role_lfe},
+    {role_l, role_c, role_r, role_ls, role_rs, role_ls, role_rs, role_lfe},
+};
+
+#define MINUS_3DB 0.70710678f
+
+// Gains of each role into the left and right of a stereo fold-down.
+static float const stereo_gains[][2] = {
+    [role_m] = {1.f, 1.f},
+    [role_l] = {1.f, 0.f},
+    [role_r] = {0.f, 1.f},
+    [role_c] = {MINUS_3DB, MINUS_3DB},
+    [role_lfe] = {0.f, 0.f},
+    [role_ls] = {MINUS_3DB, 0.f},
+    [role_rs] = {0.f, MINUS_3DB},
+    [role_bc] = {0.5f, 0.5f},
+};
+
+struct remix {
+  struct ovl_audio_decoder_vtable const *vtable;
+  struct ovl_audio_decoder *decoder;
+  struct ovl_audio_info info;
+  struct mixer_kernels const *kernels;
+  size_t src_channels;
+  // channels rows of src_channels gains.
+  float *matrix;
+  // Source channel of each output channel of a pure remap, or SIZE_MAX for silence; NULL to mix.
+  size_t *map;
+  // The matrix is the identity, so reads are passed through.
+  bool identity;
+
+  float **out;
+  float const **pcm;
+  float *zeros;
+
+  // The rest of the last source read.
+  float const *const *src_pcm;
+  size_t src_off;
+  size_t src_len;
+};
+
+static inline size_t adjust_align8(size_t const size) { return (size + (size_t)(7)) & ~(size_t)(7); }
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+static inline bool is_zero(float const v) { return !(v < 0.f) && !(v > 0.f); }
+
+static NODISCARD bool
+alloc_planes(float ***const planes, size_t const channels, size_t const stride, struct ov_error *const err) {
+  if (!OV_REALLOC(planes, channels, sizeof(float *))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], stride * channels, sizeof(float), 16)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ++ch) {
+    (*planes)[ch] = (*planes)[ch - 1] + stride;
+  }
+  return true;
+}
+
+static void free_planes(float ***const planes) {
+  if (*planes) {
+    if ((*planes)[0]) {
+      OV_ALIGNED_FREE(&(*planes)[0]);
+    }
+    OV_FREE(planes);
+  }
+}
+
+static void destroy(struct ovl_audio_decoder **const dp) {
+  struct remix **const ctxp = (struct remix **)(void *)dp;
+  if (!ctxp || !*ctxp) {
+    return;
+  }
+  struct remix *ctx = *ctxp;
+  free_planes(&ctx->out);
+  if (ctx->zeros) {
+    OV_ALIGNED_FREE(&ctx->zeros);
+  }
+  if (ctx->pcm) {
+    OV_FREE(&ctx->pcm);
+  }
+  if (ctx->map) {
+    OV_FREE(&ctx->map);
+  }
+  if (ctx->matrix) {
+    OV_FREE(&ctx->matrix);
+  }
+  OV_FREE(ctxp);
+}
+
+static struct ovl_audio_info const *get_info(struct ovl_audio_decoder const *const d) {
+  struct remix const *const ctx = (struct remix const *)(void const *)d;
+  return &ctx->info;
+}
+
+static NODISCARD bool read(struct ovl_audio_decoder *const d,
+                           float const *const **const pcm,
+                           size_t *const samples,
+                           struct ov_error *const err) {
+  struct remix *const ctx = (struct remix *)(void *)d;
+  if (!ctx || !pcm || !samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (ctx->identity) {
+    if (!ovl_audio_decoder_read(ctx->decoder, pcm, samples, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    return true;
+  }
+  if (ctx->src_off == ctx->src_len) {
+    size_t read;
+    if (!ovl_audio_decoder_read(ctx->decoder, &ctx->src_pcm, &read, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    ctx->src_off = 0;
+    ctx->src_len = read;
+    if (read == 0) {
+      *samples = 0;
+      return true;
+    }
+  }
+  size_t const n = min2(chunk, ctx->src_len - ctx->src_off);
+  size_t const channels = ctx->info.channels;
+  size_t const src_channels = ctx->src_channels;
+  float const *const *const src = ctx->src_pcm;
+  size_t const off = ctx->src_off;
+  if (ctx->map) {
+    for (size_t o = 0; o < channels; ++o) {
+      ctx->pcm[o] = ctx->map[o] == SIZE_MAX ? ctx->zeros : src[ctx->map[o]] + off;
+    }
+  } else {
+    for (size_t o = 0; o < channels; ++o) {
+      float *const dst = ctx->out[o];
+      float const *const row = ctx->matrix + o * src_channels;
+      memset(dst, 0, n * sizeof(float));
+      for (size_t i = 0; i < src_channels; ++i) {
+        if (!is_zero(row[i])) {
+          ctx->kernels->add(dst, src[i] + off, n, row[i]);
+        }
+      }
+      ctx->pcm[o] = dst;
+    }
+  }
+  ctx->src_off += n;
+  *pcm = ctx->pcm;
+  *samples = n;
+  return true;
+}
+
+static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err) {
+  struct remix *const ctx = (struct remix *)(void *)d;
+  if (!ctx) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  ctx->src_off = 0;
+  ctx->src_len = 0;
+  if (!ovl_audio_decoder_seek(ctx->decoder, position, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the source channel a row picks at unity gain, SIZE_MAX if it is silent,
+ * or SIZE_MAX - 1 if it has to be mixed.
+ */
+static size_t picked_channel(float const *const row, size_t const src_channels) {
+  size_t picked = SIZE_MAX;
+  for (size_t i = 0; i < src_channels; ++i) {
+    if (is_zero(row[i])) {
+      continue;
+    }
+    if (picked != SIZE_MAX || !is_zero(row[i] - 1.f)) {
+      return SIZE_MAX - 1;
+    }
+    picked = i;
+  }
+  return picked;
+}
+
+/**
+ * @brief Builds a map from the matrix if every row picks at most one source channel at unity gain.
+ */
+static NODISCARD bool build_map(struct remix *const ctx, struct ov_error *const err) {
+  size_t const channels = ctx->info.channels;
+  size_t const src_channels = ctx->src_channels;
+  bool identity = channels == src_channels;
+  for (size_t o = 0; o < channels; ++o) {
+    size_t const picked = picked_channel(ctx->matrix + o * src_channels, src_channels);
+    if (picked == SIZE_MAX - 1) {
+      return true;
+    }
+    identity = identity && picked == o;
+  }
+  if (identity) {
+    ctx->identity = true;
+    return true;
+  }
+  if (!OV_REALLOC(&ctx->map, channels, sizeof(size_t))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t o = 0; o < channels; ++o) {
+    ctx->map[o] = picked_channel(ctx->matrix + o * src_channels, src_channels);
+  }
+  return true;
+}
+
+NODISCARD bool ovl_audio_decoder_remix_create_matrix(struct ovl_audio_decoder *const source,
+                                                     size_t const channels,
+                                                     float const *const matrix,
+                                                     struct ovl_audio_decoder **const dp,
+                                                     struct ov_error *const err) {
+  if (!dp || *dp || !source || !channels || !matrix) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  struct ovl_audio_info const *const src_info = ovl_audio_decoder_get_info(source);
+  size_t const src_channels = src_info->channels;
+  if (!src_channels) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  for (size_t i = 0; i < channels * src_channels; ++i) {
+    if (isnan(matrix[i])) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+      return false;
+    }
+  }
+
+  struct remix *ctx = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&ctx, 1, sizeof(*ctx))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    static struct ovl_audio_decoder_vtable const vtable = {
+        .destroy = destroy,
+        .get_info = get_info,
+        .read = read,
+        .seek = seek,
+    };
+    *ctx = (struct remix){
+        .vtable = &vtable,
+        .decoder = source,
+        .info = *src_info,
+        .kernels = mixer_kernel_get_best(),
+        .src_channels = src_channels,
+    };
+    ctx->info.channels = channels;
+    if (!OV_REALLOC(&ctx->matrix, channels * src_channels, sizeof(float))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memcpy(ctx->matrix, matrix, channels * src_channels * sizeof(float));
+    if (!build_map(ctx, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (!ctx->identity) {
+      if (!OV_REALLOC(&ctx->pcm, channels, sizeof(float *))) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        goto cleanup;
+      }
+      if (ctx->map) {
+        if (!OV_ALIGNED_ALLOC(&ctx->zeros, chunk, sizeof(float), 16)) {
+          OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+          goto cleanup;
+        }
+        memset(ctx->zeros, 0, chunk * sizeof(float));
+      } else if (!alloc_planes(&ctx->out, channels, adjust_align8(chunk), err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+    *dp = (struct ovl_audio_decoder *)(void *)ctx;
+  }
+  result = true;
+
+cleanup:
+  if (!result) {
+    if (ctx) {
+      destroy((struct ovl_audio_decoder **)(void *)&ctx);
+    }
+  }
+  return result;
+}
+
+NODISCARD bool ovl_audio_decoder_remix_create(struct ovl_audio_decoder *const source,
+                                              size_t const channels,
+                                              enum ovl_audio_decoder_remix_order const order,
+                                              struct ovl_audio_decoder **const dp,
+                                              struct ov_error *const err) {
+  if (!dp || *dp || !source || !channels) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  size_t const src_channels = ovl_audio_decoder_get_info(source)->channels;
+  if (!src_channels) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  float *matrix = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&matrix, channels * src_channels, sizeof(float))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memset(matrix, 0, channels * src_channels * sizeof(float));
+    if (channels == src_channels) {
+      for (size_t o = 0; o < channels; ++o) {
+        matrix[o * src_channels + o] = 1.f;
+      }
+    } else if (channels <= 2 && src_channels <= max_standard_channels) {
+      enum role const *const roles =
+          order == ovl_audio_decoder_remix_order_vorbis ? vorbis_roles[src_channels - 1] : wave_roles[src_channels - 1];
+      for (size_t i = 0; i < src_channels; ++i) {
+        float const *const g = stereo_gains[roles[i]];
+        if (channels == 2) {
+          matrix[i] = g[0];
+          matrix[src_channels + i] = g[1];
+        } else {
+          matrix[i] = (g[0] + g[1]) * 0.5f;
+        }
+      }
+    } else if (src_channels <= 2 && channels > src_channels) {
+      // Onto the front pair of a larger layout; mono goes to both sides. Vorbis order puts the centre between
+      // left and right in every layout with one.
+      size_t const right = order == ovl_audio_decoder_remix_order_vorbis && channels >= 3 && channels != 4 ? 2 : 1;
+      matrix[0] = 1.f;
+      matrix[right * src_channels + src_channels - 1] = 1.f;
+    } else {
+      OV_ERROR_SET(err,
+                   ov_error_type_generic,
+                   ov_error_generic_invalid_argument,
+                   gettext("No standard matrix for this channel layout"));
+      goto cleanup;
+    }
+    if (!ovl_audio_decoder_remix_create_matrix(source, channels, matrix, dp, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (matrix) {
+    OV_FREE(&matrix);
+  }
+  return result;
+}
@@ -0,0 +1,264 @@
+#include <ovtest.h>
+
+#ifndef TESTDATADIR
+#  define TESTDATADIR NSTR(".")
+#endif
+
+#include "../../test_util.h"
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/ogg.h>
+#include <ovl/audio/decoder/remix.h>
+#include <ovl/audio/info.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+
+#include <inttypes.h>
+#include <math.h>
+
+enum {
+  max_channels = 8,
+  chunk = 5000,
+};
+
+// Channel c holds 2^c, so every mix of them can be told apart.
+static float constant_value(void const *const userdata, uint64_t const position, size_t const channel) {
+  (void)userdata;
+  (void)position;
+  return (float)(1u << channel);
+}
+
+static struct ovl_audio_decoder *source;
+
+static void constant_exit(void) {
+  if (source) {
+    ovl_audio_decoder_destroy(&source);
+  }
+}
+
+// Replaces the source with one that plays constant_value, in reads longer than the remix chunk.
+static struct ovl_audio_decoder *constant_init(size_t const channels, uint64_t const samples) {
+  struct ov_error err = {0};
+  constant_exit();
+  TEST_SUCCEEDED(test_util_decoder_create(
+                     &(struct test_util_decoder_options){
+                         .channels = channels,
+                         .sample_rate = 48000,
+                         .samples = samples,
+                         .chunk = chunk,
+                         .value = constant_value,
+                     },
+                     &source,
+                     &err),
+                 &err);
+  return source;
+}
+
+static float const *const *source_pcm(void) { return ((struct test_util_decoder const *)(void const *)source)->pcm; }
+
+#define k3db 0.70710678f
+
+static bool near(float const a, float const b) { return fabsf(a - b) < 1e-4f; }
+
+/**
+ * Reads to the end and checks that every sample of each output channel equals expected.
+ */
+static void check_constant(struct ovl_audio_decoder *const d, float const *const expected, char const *const what) {
+  struct ov_error err = {0};
+  struct ovl_audio_info const *const info = ovl_audio_decoder_get_info(d);
+  uint64_t total = 0;
+  size_t bad = 0;
+  for (;;) {
+    size_t read;
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+      return;
+    }
+    if (read == 0) {
+      break;
+    }
+    for (size_t ch = 0; ch < info->channels; ++ch) {
+      for (size_t i = 0; i < read; ++i) {
+        bad += !near(pcm[ch][i], expected[ch]);
+      }
+    }
+    total += read;
+  }
+  TEST_CHECK(bad == 0);
+  TEST_MSG("%s: %zu wrong samples", what, bad);
+  uint64_t const samples = ovl_audio_decoder_get_info(source)->samples;
+  TEST_CHECK(total == samples);
+  TEST_MSG("%s: want %" PRIu64 " got %" PRIu64, what, samples, total);
+}
+
+static void standard(void) {
+  struct ov_error err = {0};
+  static struct {
+    char const *name;
+    size_t src_channels;
+    size_t channels;
+    enum ovl_audio_decoder_remix_order order;
+    float expected[max_channels];
+  } const cases[] = {
+      // L R C LFE Ls Rs = 1 2 4 8 16 32
+      {"wave 5.1",
+       6,
+       2,
+       ovl_audio_decoder_remix_order_wave,
+       {1.f + (4.f + 16.f) * k3db, 2.f + (4.f + 32.f) * k3db}},
+      // L C R Ls Rs LFE = 1 2 4 8 16 32
+      {"vorbis 5.1",
+       6,
+       2,
+       ovl_audio_decoder_remix_order_vorbis,
+       {1.f + (2.f + 8.f) * k3db, 4.f + (2.f + 16.f) * k3db}},
+      // L R C LFE Bl Br Sl Sr = 1 2 4 8 16 32 64 128; mono is the average of the stereo fold-down.
+      {"wave 7.1 to mono",
+       8,
+       1,
+       ovl_audio_decoder_remix_order_wave,
+       {(1.f + 2.f) * 0.5f + 4.f * k3db + (16.f + 32.f + 64.f + 128.f) * k3db * 0.5f}},
+      {"stereo to mono", 2, 1, ovl_audio_decoder_remix_order_wave, {1.5f}},
+      {"mono to stereo", 1, 2, ovl_audio_decoder_remix_order_wave, {1.f, 1.f}},
+      {"stereo to 5.1", 2, 6, ovl_audio_decoder_remix_order_wave, {1.f, 2.f, 0.f, 0.f, 0.f, 0.f}},
+      {"vorbis stereo to 5.1", 2, 6, ovl_audio_decoder_remix_order_vorbis, {1.f, 0.f, 2.f, 0.f, 0.f, 0.f}},
+      {"vorbis mono to 5.1", 1, 6, ovl_audio_decoder_remix_order_vorbis, {1.f, 0.f, 1.f, 0.f, 0.f, 0.f}},
+      {"vorbis stereo to quad", 2, 4, ovl_audio_decoder_remix_order_vorbis, {1.f, 2.f, 0.f, 0.f}},
+  };
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+    struct ovl_audio_decoder *d = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_remix_create(
+                            constant_init(cases[c].src_channels, 12345), cases[c].channels, cases[c].order, &d, &err),
+                        &err)) {
+      continue;
+    }
+    TEST_CHECK(ovl_audio_decoder_get_info(d)->channels == cases[c].channels);
+    check_constant(d, cases[c].expected, cases[c].name);
+    ovl_audio_decoder_destroy(&d);
+  }
+
+  // There is no standard way to fold 5.1 into four channels.
+  struct ovl_audio_decoder *d = NULL;
+  TEST_FAILED_WITH(
+      ovl_audio_decoder_remix_create(constant_init(6, 100), 4, ovl_audio_decoder_remix_order_wave, &d, &err),
+      &err,
+      ov_error_type_generic,
+      ov_error_generic_invalid_argument);
+  constant_exit();
+}
+
+static void remap(void) {
+  struct ov_error err = {0};
+  struct ovl_audio_decoder *d = NULL;
+
+  // Identity is passed straight through.
+  static float const identity[4] = {1.f, 0.f, 0.f, 1.f};
+  if (TEST_SUCCEEDED(ovl_audio_decoder_remix_create_matrix(constant_init(2, 100), 2, identity, &d, &err), &err)) {
+    float const *const *pcm = NULL;
+    size_t read;
+    if (TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+      TEST_CHECK(pcm == source_pcm() && read == 100);
+    }
+    ovl_audio_decoder_destroy(&d);
+  }
+
+  // Swapping the sides and adding a silent third channel returns the source planes without copying.
+  static float const swap[6] = {0.f, 1.f, 1.f, 0.f, 0.f, 0.f};
+  if (TEST_SUCCEEDED(ovl_audio_decoder_remix_create_matrix(constant_init(2, 12345), 3, swap, &d, &err), &err)) {
+    float const *const *pcm = NULL;
+    size_t read;
+    if (TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+      TEST_CHECK(pcm[0] == source_pcm()[1] && pcm[1] == source_pcm()[0]);
+    }
+    if (TEST_SUCCEEDED(ovl_audio_decoder_seek(d, 0, &err), &err)) {
+      check_constant(d, (float const[]){2.f, 1.f, 0.f}, "swap");
+    }
+    ovl_audio_decoder_destroy(&d);
+  }
+
+  static float const with_nan[2] = {1.f, NAN};
+  TEST_FAILED_WITH(ovl_audio_decoder_remix_create_matrix(constant_init(2, 100), 1, with_nan, &d, &err),
+                   &err,
+                   ov_error_type_generic,
+                   ov_error_generic_invalid_argument);
+  constant_exit();
+}
+
+static void file(void) {
+  struct ovl_source *src = NULL;
+  struct ovl_source *ref_src = NULL;
+  struct ovl_audio_decoder *ogg = NULL;
+  struct ovl_audio_decoder *ref = NULL;
+  struct ovl_audio_decoder *mono = NULL;
+  struct ov_error err = {0};
+
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &src, &err), &err) ||
+      !TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &ref_src, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(src, &ogg, &err), &err) ||
+      !TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(ref_src, &ref, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_remix_create(ogg, 1, ovl_audio_decoder_remix_order_vorbis, &mono, &err),
+                      &err)) {
+    goto cleanup;
+  }
+
+  {
+    // The mono fold-down of a stereo file is the average of both sides.
+    size_t ref_off = 0;
+    size_t ref_len = 0;
+    float const *const *ref_pcm = NULL;
+    uint64_t total = 0;
+    size_t mismatches = 0;
+    for (;;) {
+      size_t read;
+      float const *const *pcm = NULL;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(mono, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (read == 0) {
+        break;
+      }
+      for (size_t i = 0; i < read; ++i) {
+        if (ref_off == ref_len) {
+          if (!TEST_SUCCEEDED(ovl_audio_decoder_read(ref, &ref_pcm, &ref_len, &err), &err) ||
+              !TEST_CHECK(ref_len > 0)) {
+            goto cleanup;
+          }
+          ref_off = 0;
+        }
+        mismatches += !near(pcm[0][i], (ref_pcm[0][ref_off] + ref_pcm[1][ref_off]) * 0.5f);
+        ++ref_off;
+      }
+      total += read;
+    }
+    TEST_CHECK(mismatches == 0);
+    TEST_MSG("mismatches=%zu", mismatches);
+    TEST_CHECK(total == ovl_audio_decoder_get_info(ref)->samples);
+  }
+
+cleanup:
+  if (mono) {
+    ovl_audio_decoder_destroy(&mono);
+  }
+  if (ref) {
+    ovl_audio_decoder_destroy(&ref);
+  }
+  if (ogg) {
+    ovl_audio_decoder_destroy(&ogg);
+  }
+  if (ref_src) {
+    ovl_source_destroy(&ref_src);
+  }
+  if (src) {
+    ovl_source_destroy(&src);
+  }
+}
+
+TEST_LIST = {
+    {"standard", standard},
+    {"remap", remap},
+    {"file", file},
+    {NULL, NULL},
+};
@@ -0,0 +1,521 @@
+#include <ovl/audio/decoder/resample.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+#include <ovl/os.h>
+
+#include <ovmo.h>
+#include <ovthreads.h>
+
+#include <string.h>
+
+#include "resample_r8b.h"
+
+// Every channel has its own r8brain resampler. Source samples are gathered into in until a block is full,
+// then each channel is resampled and converted back to float into out; channels are independent, so with
+// workers they are handed out one at a time to whichever thread is free, the reader included.
+//
+// Input position src_step * k and output position dst_step * k are the same instant for every k, so a seek
+// restarts the resamplers on such a grid point far enough before the target to refill the filter history,
+// and drops the output up to the target. The result matches linear playback.
+enum {
+  block_size = 4096,
+  // Blocks smaller than this across all channels are resampled on the reader's thread;
+  // waking the workers would cost more than they save.
+  parallel_min_samples = 8192,
+};
+
+struct resample;
+
+struct worker {
+  struct resample *ctx;
+  thrd_t thread;
+};
+
+struct resample {
+  struct ovl_audio_decoder_vtable const *vtable;
+  struct ovl_audio_decoder *decoder;
+  struct ovl_audio_info info;
+  size_t src_rate;
+  uint64_t src_step;
+  uint64_t dst_step;
+  size_t preroll;
+
+  struct resample_r8b **r8b;
+  double **in;
+  size_t in_len;
+  float **out;
+  size_t out_cap;
+  float const **pcm;
+
+  // The rest of the last source read that did not fit into the block.
+  float const *const *src_pcm;
+  size_t src_off;
+  size_t src_len;
+
+  // Source position of the next sample gathered into in.
+  uint64_t src_cursor;
+  // Output position of the next sample the resamplers produce.
+  uint64_t out_cursor;
+  // Output position of the next sample returned by read.
+  uint64_t cursor;
+  // Output length, UINT64_MAX until the source has ended.
+  uint64_t out_end;
+  bool eof;
+
+  // Number of samples channel 0 produced in the last block; every channel produces the same.
+  size_t produced;
+
+  struct worker *workers;
+  size_t workers_len;
+  mtx_t mtx;
+  cnd_t job_queued;
+  cnd_t job_done;
+  bool sync_initialized;
+  uint64_t generation;
+  size_t next_channel;
+  size_t done_channels;
+  bool quit;
+};
+
+static inline size_t adjust_align8(size_t const size) { return (size + (size_t)(7)) & ~(size_t)(7); }
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+static inline uint64_t max64(uint64_t const a, uint64_t const b) { return a > b ? a : b; }
+static inline uint64_t min64(uint64_t const a, uint64_t const b) { return a < b ? a : b; }
+
+static uint64_t gcd(uint64_t a, uint64_t b) {
+  while (b) {
+    uint64_t const t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+static uint64_t scale_floor(uint64_t const v, uint64_t const from, uint64_t const to) {
+  return v / from * to + v % from * to / from;
+}
+
+static uint64_t scale_ceil(uint64_t const v, uint64_t const from, uint64_t const to) {
+  return v / from * to + (v % from * to + from - 1) / from;
+}
+
+static NODISCARD bool
+alloc_float_planes(float ***const planes, size_t const channels, size_t const stride, struct ov_error *const err) {
+  if (!OV_REALLOC(planes, channels, sizeof(float *))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], stride * channels, sizeof(float), 16)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ++ch) {
+    (*planes)[ch] = (*planes)[ch - 1] + stride;
+  }
+  return true;
+}
+
+static NODISCARD bool
+alloc_double_planes(double ***const planes, size_t const channels, size_t const stride, struct ov_error *const err) {
+  if (!OV_REALLOC(planes, channels, sizeof(double *))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], stride * channels, sizeof(double), 16)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ++ch) {
+    (*planes)[ch] = (*planes)[ch - 1] + stride;
+  }
+  return true;
+}
+
+static void destroy(struct ovl_audio_decoder **const dp) {
+  struct resample **const ctxp = (struct resample **)(void *)dp;
+  if (!ctxp || !*ctxp) {
+    return;
+  }
+  struct resample *ctx = *ctxp;
+  if (ctx->workers_len) {
+    mtx_lock(&ctx->mtx);
+    ctx->quit = true;
+    cnd_broadcast(&ctx->job_queued);
+    mtx_unlock(&ctx->mtx);
+    for (size_t i = 0; i < ctx->workers_len; ++i) {
+      thrd_join(ctx->workers[i].thread, NULL);
+    }
+  }
+  if (ctx->workers) {
+    OV_FREE(&ctx->workers);
+  }
+  if (ctx->sync_initialized) {
+    cnd_destroy(&ctx->job_done);
+    cnd_destroy(&ctx->job_queued);
+    mtx_destroy(&ctx->mtx);
+  }
+  if (ctx->r8b) {
+    for (size_t ch = 0; ch < ctx->info.channels; ++ch) {
+      resample_r8b_destroy(&ctx->r8b[ch]);
+    }
+    OV_FREE(&ctx->r8b);
+  }
+  if (ctx->in) {
+    if (ctx->in[0]) {
+      OV_ALIGNED_FREE(&ctx->in[0]);
+    }
+    OV_FREE(&ctx->in);
+  }
+  if (ctx->out) {
+    if (ctx->out[0]) {
+      OV_ALIGNED_FREE(&ctx->out[0]);
+    }
+    OV_FREE(&ctx->out);
+  }
+  if (ctx->pcm) {
+    OV_FREE(&ctx->pcm);
+  }
+  OV_FREE(ctxp);
+}
+
+static struct ovl_audio_info const *get_info(struct ovl_audio_decoder const *const d) {
+  struct resample const *const ctx = (struct resample const *)(void const *)d;
+  return &ctx->info;
+}
+
+/**
+ * @brief Resamples the block in one channel and keeps the part between the cursor and the end.
+ */
+static void process_channel(struct resample *const ctx, size_t const ch) {
+  double *op;
+  size_t const n = resample_r8b_process(ctx->r8b[ch], ctx->in[ch], ctx->in_len, &op);
+  uint64_t const lo = max64(ctx->out_cursor, ctx->cursor);
+  uint64_t const hi = min64(ctx->out_cursor + n, ctx->out_end);
+  if (lo < hi) {
+    float *const dst = ctx->out[ch];
+    double const *const src = op + (size_t)(lo - ctx->out_cursor);
+    size_t const len = (size_t)(hi - lo);
+    for (size_t i = 0; i < len; ++i) {
+      dst[i] = (float)src[i];
+    }
+  }
+  if (ch == 0) {
+    ctx->produced = n;
+  }
+}
+
+static int worker_thread(void *const userdata) {
+  struct resample *const ctx = ((struct worker *)userdata)->ctx;
+  size_t const channels = ctx->info.channels;
+  uint64_t seen = 0;
+  mtx_lock(&ctx->mtx);
+  for (;;) {
+    while (!ctx->quit && ctx->generation == seen) {
+      cnd_wait(&ctx->job_queued, &ctx->mtx);
+    }
+    if (ctx->quit) {
+      break;
+    }
+    seen = ctx->generation;
+    while (ctx->next_channel < channels) {
+      size_t const ch = ctx->next_channel++;
+      mtx_unlock(&ctx->mtx);
+      process_channel(ctx, ch);
+      mtx_lock(&ctx->mtx);
+      if (++ctx->done_channels == channels) {
+        cnd_signal(&ctx->job_done);
+      }
+    }
+  }
+  mtx_unlock(&ctx->mtx);
+  return 0;
+}
+
+/**
+ * @brief Resamples the block in every channel, in parallel when it is large enough.
+ */
+static void process_block(struct resample *const ctx) {
+  size_t const channels = ctx->info.channels;
+  if (ctx->workers_len == 0 || ctx->in_len * channels < parallel_min_samples) {
+    for (size_t ch = 0; ch < channels; ++ch) {
+      process_channel(ctx, ch);
+    }
+    return;
+  }
+  mtx_lock(&ctx->mtx);
+  ctx->next_channel = 0;
+  ctx->done_channels = 0;
+  ++ctx->generation;
+  cnd_broadcast(&ctx->job_queued);
+  while (ctx->next_channel < channels) {
+    size_t const ch = ctx->next_channel++;
+    mtx_unlock(&ctx->mtx);
+    process_channel(ctx, ch);
+    mtx_lock(&ctx->mtx);
+    ++ctx->done_channels;
+  }
+  while (ctx->done_channels < channels) {
+    cnd_wait(&ctx->job_done, &ctx->mtx);
+  }
+  mtx_unlock(&ctx->mtx);
+}
+
+/**
+ * @brief Gathers the next block of source samples into in.
+ * After the source has ended, the block is padded with silence to flush the filters.
+ */
+static NODISCARD bool fill_block(struct resample *const ctx, struct ov_error *const err) {
+  bool result = false;
+  {
+    size_t const channels = ctx->info.channels;
+    ctx->in_len = 0;
+    while (!ctx->eof && ctx->in_len < block_size) {
+      if (ctx->src_off == ctx->src_len) {
+        size_t read;
+        if (!ovl_audio_decoder_read(ctx->decoder, &ctx->src_pcm, &read, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        ctx->src_off = 0;
+        ctx->src_len = read;
+        if (read == 0) {
+          ctx->eof = true;
+          ctx->out_end = scale_ceil(ctx->src_cursor, ctx->src_rate, ctx->info.sample_rate);
+          break;
+        }
+      }
+      size_t const n = min2(block_size - ctx->in_len, ctx->src_len - ctx->src_off);
+      for (size_t ch = 0; ch < channels; ++ch) {
+        float const *const src = ctx->src_pcm[ch] + ctx->src_off;
+        double *const dst = ctx->in[ch] + ctx->in_len;
+        for (size_t i = 0; i < n; ++i) {
+          dst[i] = (double)src[i];
+        }
+      }
+      ctx->in_len += n;
+      ctx->src_off += n;
+      ctx->src_cursor += n;
+    }
+    if (ctx->eof) {
+      for (size_t ch = 0; ch < channels; ++ch) {
+        memset(ctx->in[ch] + ctx->in_len, 0, (block_size - ctx->in_len) * sizeof(double));
+      }
+      ctx->in_len = block_size;
+    }
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool read(struct ovl_audio_decoder *const d,
+                           float const *const **const pcm,
+                           size_t *const samples,
+                           struct ov_error *const err) {
+  struct resample *const ctx = (struct resample *)(void *)d;
+  if (!ctx || !pcm || !samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  bool result = false;
+  {
+    // Loops more than once only while the filters fill up after a seek, or while output before the cursor
+    // is being dropped.
+    for (;;) {
+      if (ctx->cursor >= ctx->out_end) {
+        *samples = 0;
+        break;
+      }
+      if (!fill_block(ctx, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      uint64_t const lo = max64(ctx->out_cursor, ctx->cursor);
+      process_block(ctx);
+      uint64_t const hi = min64(ctx->out_cursor + ctx->produced, ctx->out_end);
+      ctx->out_cursor += ctx->produced;
+      if (lo < hi) {
+        for (size_t ch = 0; ch < ctx->info.channels; ++ch) {
+          ctx->pcm[ch] = ctx->out[ch];
+        }
+        *pcm = ctx->pcm;
+        *samples = (size_t)(hi - lo);
+        ctx->cursor = hi;
+        break;
+      }
+    }
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err) {
+  struct resample *const ctx = (struct resample *)(void *)d;
+  if (!ctx || position > ctx->info.samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  bool result = false;
+  {
+    // The filters look as far back as ahead, and the stages r8brain chains can reach a little past the
+    // reported latency, so twice the latency is restarted from.
+    uint64_t const back = (ctx->preroll * 2 + ctx->src_step - 1) / ctx->src_step;
+    uint64_t k = position / ctx->dst_step;
+    k = k > back ? k - back : 0;
+    ctx->src_off = 0;
+    ctx->src_len = 0;
+    if (!ovl_audio_decoder_seek(ctx->decoder, k * ctx->src_step, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    for (size_t ch = 0; ch < ctx->info.channels; ++ch) {
+      resample_r8b_clear(ctx->r8b[ch]);
+    }
+    ctx->src_cursor = k * ctx->src_step;
+    ctx->out_cursor = k * ctx->dst_step;
+    ctx->cursor = position;
+    ctx->out_end = UINT64_MAX;
+    ctx->eof = false;
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+/**
+ * @brief Converts a tag position to the output rate, keeping UINT64_MAX as invalid.
+ */
+static uint64_t scale_tag(uint64_t const v, uint64_t const from, uint64_t const to) {
+  return v == UINT64_MAX ? UINT64_MAX : scale_floor(v, from, to);
+}
+
+NODISCARD bool ovl_audio_decoder_resample_create(struct ovl_audio_decoder *const source,
+                                                 size_t const sample_rate,
+                                                 size_t const threads,
+                                                 struct ovl_audio_decoder **const dp,
+                                                 struct ov_error *const err) {
+  if (!dp || *dp || !source || !sample_rate) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct resample *ctx = NULL;
+  bool result = false;
+
+  {
+    struct ovl_audio_info const *const src_info = ovl_audio_decoder_get_info(source);
+    if (!src_info->sample_rate || !src_info->channels) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+      goto cleanup;
+    }
+    if (!OV_REALLOC(&ctx, 1, sizeof(*ctx))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    static struct ovl_audio_decoder_vtable const vtable = {
+        .destroy = destroy,
+        .get_info = get_info,
+        .read = read,
+        .seek = seek,
+    };
+    *ctx = (struct resample){
+        .vtable = &vtable,
+        .decoder = source,
+        .info = *src_info,
+        .src_rate = src_info->sample_rate,
+        .out_end = UINT64_MAX,
+    };
+    size_t const channels = src_info->channels;
+    uint64_t const from = src_info->sample_rate;
+    uint64_t const to = sample_rate;
+    uint64_t const g = gcd(from, to);
+    ctx->src_step = from / g;
+    ctx->dst_step = to / g;
+    ctx->info.sample_rate = sample_rate;
+    ctx->info.samples = scale_ceil(src_info->samples, from, to);
+    ctx->info.tag.loop_start = scale_tag(src_info->tag.loop_start, from, to);
+    ctx->info.tag.loop_end = scale_tag(src_info->tag.loop_end, from, to);
+    if (src_info->tag.loop_length != UINT64_MAX && src_info->tag.loop_start != UINT64_MAX) {
+      ctx->info.tag.loop_length =
+          scale_floor(src_info->tag.loop_start + src_info->tag.loop_length, from, to) - ctx->info.tag.loop_start;
+    } else {
+      ctx->info.tag.loop_length = scale_tag(src_info->tag.loop_length, from, to);
+    }
+
+    if (!OV_REALLOC(&ctx->r8b, channels, sizeof(struct resample_r8b *))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memset(ctx->r8b, 0, channels * sizeof(struct resample_r8b *));
+    for (size_t ch = 0; ch < channels; ++ch) {
+      ctx->r8b[ch] = resample_r8b_create((double)from, (double)to, block_size);
+      if (!ctx->r8b[ch]) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to create resampler"));
+        goto cleanup;
+      }
+    }
+    ctx->preroll = resample_r8b_get_in_len_before_out_pos(ctx->r8b[0], 0);
+    ctx->out_cap = resample_r8b_get_max_out_len(ctx->r8b[0], block_size);
+
+    if (!OV_REALLOC(&ctx->pcm, channels, sizeof(float *))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (!alloc_double_planes(&ctx->in, channels, adjust_align8(block_size), err) ||
+        !alloc_float_planes(&ctx->out, channels, adjust_align8(ctx->out_cap), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+
+    if (mtx_init(&ctx->mtx, mtx_plain) != thrd_success) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize mutex"));
+      goto cleanup;
+    }
+    if (cnd_init(&ctx->job_queued) != thrd_success) {
+      mtx_destroy(&ctx->mtx);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize condition"));
+      goto cleanup;
+    }
+    if (cnd_init(&ctx->job_done) != thrd_success) {
+      cnd_destroy(&ctx->job_queued);
+      mtx_destroy(&ctx->mtx);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to initialize condition"));
+      goto cleanup;
+    }
+    ctx->sync_initialized = true;
+
+    // The reader resamples channels too, so it counts as one of the threads.
+    size_t const n = min2(threads ? threads : ovl_os_get_cpu_count(), channels);
+    if (n > 1) {
+      if (!OV_REALLOC(&ctx->workers, n - 1, sizeof(struct worker))) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        goto cleanup;
+      }
+      for (size_t i = 0; i < n - 1; ++i) {
+        ctx->workers[i].ctx = ctx;
+        // Without a worker, the remaining ones take over its channels.
+        if (thrd_create(&ctx->workers[i].thread, worker_thread, &ctx->workers[i]) != thrd_success) {
+          break;
+        }
+        ++ctx->workers_len;
+      }
+    }
+    *dp = (struct ovl_audio_decoder *)(void *)ctx;
+  }
+  result = true;
+
+cleanup:
+  if (!result) {
+    if (ctx) {
+      destroy((struct ovl_audio_decoder **)(void *)&ctx);
+    }
+  }
+  return result;
+}
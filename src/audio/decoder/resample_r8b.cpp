@@ -0,0 +1,47 @@
+#include "resample_r8b.h"
+
+#include <CDSPResampler.h>
+
+#include <new>
+
+// struct resample_r8b is never defined; pointers to it are r8b::CDSPResampler24 objects.
+
+static inline r8b::CDSPResampler24 *get(struct resample_r8b *const r) {
+  return reinterpret_cast<r8b::CDSPResampler24 *>(r);
+}
+
+struct resample_r8b *resample_r8b_create(double const src_rate, double const dst_rate, size_t const max_in_len) {
+  try {
+    r8b::CDSPResampler24 *const r =
+        new (std::nothrow) r8b::CDSPResampler24(src_rate, dst_rate, static_cast<int>(max_in_len));
+    return reinterpret_cast<struct resample_r8b *>(r);
+  } catch (...) {
+    // Filter design allocates internally and may throw std::bad_alloc; C callers only see NULL.
+    return NULL;
+  }
+}
+
+void resample_r8b_destroy(struct resample_r8b **const rp) {
+  if (!rp || !*rp) {
+    return;
+  }
+  delete get(*rp);
+  *rp = NULL;
+}
+
+size_t resample_r8b_get_max_out_len(struct resample_r8b *const r, size_t const max_in_len) {
+  return static_cast<size_t>(get(r)->getMaxOutLen(static_cast<int>(max_in_len)));
+}
+
+size_t resample_r8b_get_in_len_before_out_pos(struct resample_r8b *const r, size_t const out_pos) {
+  return static_cast<size_t>(get(r)->getInLenBeforeOutPos(static_cast<int>(out_pos)));
+}
+
+void resample_r8b_clear(struct resample_r8b *const r) { get(r)->clear(); }
+
+size_t resample_r8b_process(struct resample_r8b *const r, double *const in, size_t const len, double **const out) {
+  double *op = NULL;
+  int const n = get(r)->process(in, static_cast<int>(len), op);
+  *out = op;
+  return n > 0 ? static_cast<size_t>(n) : 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+
+// C interface to r8brain-free-src, which is C++ and works in double precision.
+// The implementation lives in resample_r8b.cpp and is built together with r8brain itself.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct resample_r8b;
+
+/**
+ * @brief Creates a streaming resampler with 24-bit precision for one channel.
+ * Its latency is compensated, so the first output sample lines up with the first input sample.
+ * @param src_rate Input sample rate.
+ * @param dst_rate Output sample rate.
+ * @param max_in_len Largest number of samples passed to a single resample_r8b_process call.
+ * @return The resampler, or NULL if it could not be created.
+ */
+struct resample_r8b *resample_r8b_create(double const src_rate, double const dst_rate, size_t const max_in_len);
+void resample_r8b_destroy(struct resample_r8b **const rp);
+
+/**
+ * @brief Returns the largest number of samples a single resample_r8b_process call can produce.
+ */
+size_t resample_r8b_get_max_out_len(struct resample_r8b *const r, size_t const max_in_len);
+
+/**
+ * @brief Returns the number of input samples that must be fed before the output sample at out_pos is produced.
+ */
+size_t resample_r8b_get_in_len_before_out_pos(struct resample_r8b *const r, size_t const out_pos);
+
+/**
+ * @brief Forgets all input, as if the resampler was newly created.
+ */
+void resample_r8b_clear(struct resample_r8b *const r);
+
+/**
+ * @brief Resamples the next len input samples.
+ * @param in Input samples. r8brain may use this buffer as scratch space, so it is overwritten.
+ * @param out Receives a pointer to the output samples, valid until the next call.
+ * @return The number of output samples, which may be 0 while the filter is filling up.
+ */
+size_t resample_r8b_process(struct resample_r8b *const r, double *const in, size_t const len, double **const out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+#include <ovtest.h>
+
+#ifndef TESTDATADIR
+#  define TESTDATADIR NSTR(".")
+#endif
+
+#include "../../test_util.h"
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/ogg.h>
+#include <ovl/audio/decoder/resample.h>
+#include <ovl/audio/info.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+
+#include <inttypes.h>
+
+static inline size_t adjust_align8(size_t const size) { return (size + UINT64_C(7)) & ~UINT64_C(7); }
+
+static bool alloc_planes(float ***const planes, size_t const channels, size_t const samples) {
+  if (!OV_REALLOC(planes, channels, sizeof(float *))) {
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], channels * adjust_align8(samples), sizeof(float), 16)) {
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ch++) {
+    (*planes)[ch] = (*planes)[ch - 1] + adjust_align8(samples);
+  }
+  return true;
+}
+
+static void free_planes(float ***const planes) {
+  if (*planes) {
+    if ((*planes)[0]) {
+      OV_ALIGNED_FREE(&(*planes)[0]);
+    }
+    OV_FREE(planes);
+  }
+}
+
+static size_t decode_to_end(struct ovl_audio_decoder *const d, float *const *const dst, size_t const capacity) {
+  struct ov_error err = {0};
+  size_t const channels = ovl_audio_decoder_get_info(d)->channels;
+  size_t offset = 0;
+  for (;;) {
+    size_t read;
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err) || read == 0) {
+      break;
+    }
+    size_t const sz = offset + read > capacity ? (offset < capacity ? capacity - offset : 0) : read;
+    for (size_t ch = 0; ch < channels; ch++) {
+      memcpy(dst[ch] + offset, pcm[ch], sz * sizeof(float));
+    }
+    offset += read;
+  }
+  return offset;
+}
+
+static void resample_and_seek(void) {
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *ogg = NULL;
+  struct ovl_audio_decoder *resample = NULL;
+  float **golden = NULL;
+  float **buffer = NULL;
+  struct ov_error err = {0};
+
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(source, &ogg, &err), &err)) {
+    goto cleanup;
+  }
+
+  {
+    struct ovl_audio_info const *src_info = ovl_audio_decoder_get_info(ogg);
+    uint64_t const src_samples = src_info->samples;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_resample_create(ogg, 44100, 1, &resample, &err), &err)) {
+      goto cleanup;
+    }
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(resample);
+    uint64_t const samples_expected = (src_samples * 44100 + 47999) / 48000;
+    TEST_CHECK(info->sample_rate == 44100);
+    TEST_CHECK(info->channels == src_info->channels);
+    TEST_CHECK(info->samples == samples_expected);
+    TEST_MSG("samples want %" PRIu64 " got %" PRIu64, samples_expected, info->samples);
+
+    size_t const channels = info->channels;
+    size_t const total = (size_t)info->samples;
+    if (!TEST_CHECK(alloc_planes(&golden, channels, total)) || !TEST_CHECK(alloc_planes(&buffer, channels, total))) {
+      goto cleanup;
+    }
+    size_t const decoded = decode_to_end(resample, golden, total);
+    TEST_CHECK(decoded == total);
+    TEST_MSG("decoded %zu of %zu samples", decoded, total);
+    ovl_audio_decoder_destroy(&resample);
+
+    // Resampling channels in parallel and starting from a seek must give the same output as linear playback.
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_resample_create(ogg, 44100, 2, &resample, &err), &err)) {
+      goto cleanup;
+    }
+    size_t const position = total / 3 + 7;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(resample, position, &err), &err)) {
+      goto cleanup;
+    }
+    float *rest[8] = {0};
+    for (size_t ch = 0; ch < channels && ch < 8; ch++) {
+      rest[ch] = buffer[ch] + position;
+    }
+    size_t const n = decode_to_end(resample, rest, total - position);
+    TEST_CHECK(n == total - position);
+    TEST_MSG("decoded %zu of %zu samples after seek", n, total - position);
+
+    float const *golden_rest[8] = {0};
+    for (size_t ch = 0; ch < channels && ch < 8; ch++) {
+      golden_rest[ch] = golden[ch] + position;
+    }
+    struct test_util_wave_diff_count diff = {0};
+    test_util_wave_diff_counter(&diff, golden_rest, (float const *const *)rest, total - position, channels);
+    TEST_CHECK(diff.mismatches == 0 && diff.large_diff_count == 0);
+    TEST_MSG("Waveform differences: mismatches=%zu, large_diff_count=%zu, total_samples=%zu",
+             diff.mismatches,
+             diff.large_diff_count,
+             diff.total_samples);
+  }
+
+cleanup:
+  free_planes(&buffer);
+  free_planes(&golden);
+  if (resample) {
+    ovl_audio_decoder_destroy(&resample);
+  }
+  if (ogg) {
+    ovl_audio_decoder_destroy(&ogg);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+}
+
+TEST_LIST = {
+    {"resample_and_seek", resample_and_seek},
+    {NULL, NULL},
+};
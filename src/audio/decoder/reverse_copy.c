@@ -0,0 +1,116 @@
+#include "reverse_copy.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define REVERSE_COPY_X86 1
+#  include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define REVERSE_COPY_NEON 1
+#  include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#  define REVERSE_COPY_WASM 1
+#  include <wasm_simd128.h>
+#endif
+
+// Every variant walks src forward and dst backward one vector at a time, reversing the lanes of each vector,
+// and leaves the remainder to the scalar loop, which writes the front of dst.
+
+static void scalar_reverse_copy(float const *const src, float *const dst, size_t const n) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[n - 1 - i] = src[i];
+  }
+}
+
+#ifdef REVERSE_COPY_X86
+
+static __attribute__((target("sse2"))) void
+sse2_reverse_copy(float const *const src, float *const dst, size_t const n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128 const a = _mm_loadu_ps(src + i);
+    __m128 const b = _mm_loadu_ps(src + i + 4);
+    _mm_storeu_ps(dst + n - i - 4, _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3)));
+    _mm_storeu_ps(dst + n - i - 8, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)));
+  }
+  scalar_reverse_copy(src + i, dst, n - i);
+}
+
+static __attribute__((target("avx2"))) void
+avx2_reverse_copy(float const *const src, float *const dst, size_t const n) {
+  __m256i const idx = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256 const a = _mm256_loadu_ps(src + i);
+    __m256 const b = _mm256_loadu_ps(src + i + 8);
+    _mm256_storeu_ps(dst + n - i - 8, _mm256_permutevar8x32_ps(a, idx));
+    _mm256_storeu_ps(dst + n - i - 16, _mm256_permutevar8x32_ps(b, idx));
+  }
+  // sse2_reverse_copy is not VEX encoded, so clear the upper halves first to avoid the transition penalty.
+  _mm256_zeroupper();
+  sse2_reverse_copy(src + i, dst, n - i);
+}
+
+#endif // REVERSE_COPY_X86
+
+#ifdef REVERSE_COPY_NEON
+
+static inline float32x4_t neon_reverse(float32x4_t const v) {
+  float32x4_t const r = vrev64q_f32(v);
+  return vcombine_f32(vget_high_f32(r), vget_low_f32(r));
+}
+
+static void neon_reverse_copy(float const *const src, float *const dst, size_t const n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    vst1q_f32(dst + n - i - 4, neon_reverse(vld1q_f32(src + i)));
+    vst1q_f32(dst + n - i - 8, neon_reverse(vld1q_f32(src + i + 4)));
+  }
+  scalar_reverse_copy(src + i, dst, n - i);
+}
+
+#endif // REVERSE_COPY_NEON
+
+#ifdef REVERSE_COPY_WASM
+
+static void simd128_reverse_copy(float const *const src, float *const dst, size_t const n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    v128_t const a = wasm_v128_load(src + i);
+    v128_t const b = wasm_v128_load(src + i + 4);
+    wasm_v128_store(dst + n - i - 4, wasm_i32x4_shuffle(a, a, 3, 2, 1, 0));
+    wasm_v128_store(dst + n - i - 8, wasm_i32x4_shuffle(b, b, 3, 2, 1, 0));
+  }
+  scalar_reverse_copy(src + i, dst, n - i);
+}
+
+#endif // REVERSE_COPY_WASM
+
+static reverse_copy_func const kernels[kernel_isa_count] = {
+    [kernel_isa_scalar] = scalar_reverse_copy,
+#ifdef REVERSE_COPY_X86
+    [kernel_isa_sse2] = sse2_reverse_copy,
+    [kernel_isa_avx2] = avx2_reverse_copy,
+#endif
+#ifdef REVERSE_COPY_NEON
+    [kernel_isa_neon] = neon_reverse_copy,
+#endif
+#ifdef REVERSE_COPY_WASM
+    [kernel_isa_simd128] = simd128_reverse_copy,
+#endif
+};
+
+reverse_copy_func reverse_copy_get(enum kernel_isa const isa) {
+  if ((size_t)isa >= kernel_isa_count || !kernel_isa_supported(isa)) {
+    return NULL;
+  }
+  return kernels[isa];
+}
+
+reverse_copy_func reverse_copy_get_best(void) {
+  for (size_t i = 0; i < kernel_isa_count; ++i) {
+    reverse_copy_func const k = reverse_copy_get(kernel_isa_preference[i]);
+    if (k) {
+      return k;
+    }
+  }
+  return scalar_reverse_copy;
+}
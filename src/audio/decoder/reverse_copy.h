@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "../kernel.h"
+
+/**
+ * @brief Copies samples in reverse order, dst[n - 1 - i] = src[i].
+ * @param src Source samples, no alignment required.
+ * @param dst Destination samples, no alignment required. Must not overlap src.
+ * @param n Number of samples.
+ */
+typedef void (*reverse_copy_func)(float const *const src, float *const dst, size_t const n);
+
+/**
+ * @brief Returns the kernel for the given instruction set.
+ * @return The kernel, or NULL if the instruction set is not compiled in or not supported by the running CPU.
+ */
+reverse_copy_func reverse_copy_get(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the fastest kernel supported by the running CPU.
+ */
+reverse_copy_func reverse_copy_get_best(void);
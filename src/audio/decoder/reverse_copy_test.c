@@ -0,0 +1,65 @@
+#include <ovtest.h>
+
+#include "reverse_copy.h"
+
+#include <string.h>
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"scalar", kernel_isa_scalar},
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+static void reverses(void) {
+  enum {
+    max_samples = 5000,
+    guard = 4,
+  };
+  static size_t const sample_counts[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 100, 1023, max_samples};
+  TEST_CHECK(reverse_copy_get_best() != NULL);
+
+  static float src[max_samples + 1];
+  static float out[max_samples + guard * 2 + 1];
+  for (size_t i = 0; i < max_samples + 1; ++i) {
+    src[i] = (float)i + 0.5f;
+  }
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    reverse_copy_func const k = reverse_copy_get(isas[i].isa);
+    if (!k) {
+      TEST_MSG("%s is not available", isas[i].name);
+      continue;
+    }
+    for (size_t si = 0; si < sizeof(sample_counts) / sizeof(sample_counts[0]); ++si) {
+      size_t const samples = sample_counts[si];
+      // Shift source and destination by one element on alternate runs so the kernels also see unaligned buffers.
+      size_t const offset = si & 1;
+      memset(out, 0x55, sizeof(out));
+      k(src + offset, out + guard + offset, samples);
+      bool ok = true;
+      for (size_t j = 0; j < samples && ok; ++j) {
+        ok = out[guard + offset + samples - 1 - j] == src[offset + j];
+      }
+      if (!TEST_CHECK(ok)) {
+        TEST_MSG("%s samples=%zu produced wrong output", isas[i].name, samples);
+        return;
+      }
+      static uint8_t const untouched[guard * sizeof(float)] = {
+          0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55};
+      if (!TEST_CHECK(memcmp(out + offset, untouched, sizeof(untouched)) == 0 &&
+                      memcmp(out + guard + offset + samples, untouched, sizeof(untouched)) == 0)) {
+        TEST_MSG("%s samples=%zu wrote out of bounds", isas[i].name, samples);
+        return;
+      }
+    }
+  }
+}
+
+TEST_LIST = {
+    {"reverses", reverses},
+    {NULL, NULL},
+};
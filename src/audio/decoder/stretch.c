@@ -0,0 +1,287 @@
+#include <ovl/audio/decoder/stretch.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+
+#include <ovmo.h>
+
+#include <string.h>
+
+#include "stretch_signalsmith.h"
+
+// Each read produces one block of output from tempo * block_size source samples; the fraction left over
+// is carried into the next block so the tempo holds over time. After a seek, the processor is primed with
+// its input latency worth of source before the first block. When the source ends, the output still held
+// back by the processor is flushed as one last short read.
+
+#define TEMPO_MIN 0.25
+#define TEMPO_MAX 4.0
+
+struct stretch {
+  struct ovl_audio_decoder_vtable const *vtable;
+  struct ovl_audio_decoder *decoder;
+  struct ovl_audio_info const *info;
+  struct stretch_signalsmith *processor;
+  size_t block_size;
+
+  float **in;
+  size_t in_cap;
+  size_t in_len;
+  float **out;
+  size_t out_cap;
+  float const **pcm;
+
+  // The rest of the last source read that did not fit into the block.
+  float const *const *src_pcm;
+  size_t src_off;
+  size_t src_len;
+
+  double tempo;
+  double carry;
+  bool primed;
+  bool eof;
+  bool flushed;
+};
+
+static inline size_t adjust_align8(size_t const size) { return (size + (size_t)(7)) & ~(size_t)(7); }
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+static inline size_t max2(size_t const a, size_t const b) { return a > b ? a : b; }
+
+static NODISCARD bool
+alloc_planes(float ***const planes, size_t const channels, size_t const stride, struct ov_error *const err) {
+  if (!OV_REALLOC(planes, channels, sizeof(float *))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], stride * channels, sizeof(float), 16)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ++ch) {
+    (*planes)[ch] = (*planes)[ch - 1] + stride;
+  }
+  return true;
+}
+
+static void free_planes(float ***const planes) {
+  if (*planes) {
+    if ((*planes)[0]) {
+      OV_ALIGNED_FREE(&(*planes)[0]);
+    }
+    OV_FREE(planes);
+  }
+}
+
+static void destroy(struct ovl_audio_decoder **const dp) {
+  struct stretch **const ctxp = (struct stretch **)(void *)dp;
+  if (!ctxp || !*ctxp) {
+    return;
+  }
+  struct stretch *ctx = *ctxp;
+  stretch_signalsmith_destroy(&ctx->processor);
+  free_planes(&ctx->out);
+  free_planes(&ctx->in);
+  if (ctx->pcm) {
+    OV_FREE(&ctx->pcm);
+  }
+  OV_FREE(ctxp);
+}
+
+static struct ovl_audio_info const *get_info(struct ovl_audio_decoder const *const d) {
+  struct stretch const *const ctx = (struct stretch const *)(void const *)d;
+  return ctx->info;
+}
+
+/**
+ * @brief Gathers up to want source samples into in.
+ * Fewer samples are gathered only when the source ends, which also sets eof.
+ */
+static NODISCARD bool gather(struct stretch *const ctx, size_t const want, struct ov_error *const err) {
+  bool result = false;
+  {
+    ctx->in_len = 0;
+    while (ctx->in_len < want) {
+      if (ctx->src_off == ctx->src_len) {
+        size_t read;
+        if (!ovl_audio_decoder_read(ctx->decoder, &ctx->src_pcm, &read, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        ctx->src_off = 0;
+        ctx->src_len = read;
+        if (read == 0) {
+          ctx->eof = true;
+          break;
+        }
+      }
+      size_t const n = min2(want - ctx->in_len, ctx->src_len - ctx->src_off);
+      for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+        memcpy(ctx->in[ch] + ctx->in_len, ctx->src_pcm[ch] + ctx->src_off, n * sizeof(float));
+      }
+      ctx->in_len += n;
+      ctx->src_off += n;
+    }
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool read(struct ovl_audio_decoder *const d,
+                           float const *const **const pcm,
+                           size_t *const samples,
+                           struct ov_error *const err) {
+  struct stretch *const ctx = (struct stretch *)(void *)d;
+  if (!ctx || !pcm || !samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  bool result = false;
+  {
+    if (ctx->flushed) {
+      *samples = 0;
+      result = true;
+      goto cleanup;
+    }
+    if (!ctx->primed) {
+      if (!gather(ctx, stretch_signalsmith_get_input_latency(ctx->processor), err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      stretch_signalsmith_seek(ctx->processor, (float const *const *)ctx->in, ctx->in_len, ctx->tempo);
+      ctx->primed = true;
+    }
+    size_t out_len = 0;
+    if (!ctx->eof) {
+      ctx->carry += (double)ctx->block_size * ctx->tempo;
+      size_t const want = (size_t)ctx->carry;
+      ctx->carry -= (double)want;
+      if (!gather(ctx, want, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      // The last source samples are stretched to their share of a block.
+      out_len = ctx->in_len == want ? ctx->block_size : (size_t)((double)ctx->in_len / ctx->tempo + 0.5);
+      out_len = min2(out_len, ctx->block_size);
+      if (out_len > 0) {
+        stretch_signalsmith_process(ctx->processor, (float const *const *)ctx->in, ctx->in_len, ctx->out, out_len);
+      }
+    }
+    if (out_len == 0) {
+      out_len = stretch_signalsmith_get_output_latency(ctx->processor);
+      stretch_signalsmith_flush(ctx->processor, ctx->out, out_len);
+      ctx->flushed = true;
+    }
+    for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+      ctx->pcm[ch] = ctx->out[ch];
+    }
+    *pcm = ctx->pcm;
+    *samples = out_len;
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err) {
+  struct stretch *const ctx = (struct stretch *)(void *)d;
+  if (!ctx || position > ctx->info->samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  ctx->src_off = 0;
+  ctx->src_len = 0;
+  if (!ovl_audio_decoder_seek(ctx->decoder, position, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  ctx->carry = 0;
+  ctx->primed = false;
+  ctx->eof = false;
+  ctx->flushed = false;
+  return true;
+}
+
+NODISCARD bool ovl_audio_decoder_stretch_create(struct ovl_audio_decoder *const source,
+                                                size_t const block_size,
+                                                struct ovl_audio_decoder **const dp,
+                                                struct ov_error *const err) {
+  if (!dp || *dp || !source) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct stretch *ctx = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&ctx, 1, sizeof(*ctx))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    static struct ovl_audio_decoder_vtable const vtable = {
+        .destroy = destroy,
+        .get_info = get_info,
+        .read = read,
+        .seek = seek,
+    };
+    *ctx = (struct stretch){
+        .vtable = &vtable,
+        .decoder = source,
+        .info = ovl_audio_decoder_get_info(source),
+        .tempo = 1.0,
+    };
+    size_t const channels = ctx->info->channels;
+    ctx->block_size = block_size ? block_size : max2(ctx->info->sample_rate / 100, 1);
+    ctx->processor = stretch_signalsmith_create(channels, (double)ctx->info->sample_rate);
+    if (!ctx->processor) {
+      OV_ERROR_SET(
+          err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to create time-stretch processor"));
+      goto cleanup;
+    }
+    // The carried fraction never reaches a whole sample, so a block at the fastest tempo fits in one more.
+    ctx->in_cap = max2((size_t)((double)ctx->block_size * TEMPO_MAX) + 1,
+                       stretch_signalsmith_get_input_latency(ctx->processor));
+    ctx->out_cap = max2(ctx->block_size, stretch_signalsmith_get_output_latency(ctx->processor));
+
+    if (!OV_REALLOC(&ctx->pcm, channels, sizeof(float *))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (!alloc_planes(&ctx->in, channels, adjust_align8(ctx->in_cap), err) ||
+        !alloc_planes(&ctx->out, channels, adjust_align8(ctx->out_cap), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    *dp = (struct ovl_audio_decoder *)(void *)ctx;
+  }
+  result = true;
+
+cleanup:
+  if (!result) {
+    if (ctx) {
+      destroy((struct ovl_audio_decoder **)(void *)&ctx);
+    }
+  }
+  return result;
+}
+
+void ovl_audio_decoder_stretch_set_tempo(struct ovl_audio_decoder *const d, double const tempo) {
+  struct stretch *const ctx = (struct stretch *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    return;
+  }
+  // Written so that NaN ends up at the minimum too.
+  ctx->tempo = !(tempo > TEMPO_MIN) ? TEMPO_MIN : tempo > TEMPO_MAX ? TEMPO_MAX : tempo;
+}
+
+void ovl_audio_decoder_stretch_set_pitch(struct ovl_audio_decoder *const d, double const semitones) {
+  struct stretch *const ctx = (struct stretch *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    return;
+  }
+  stretch_signalsmith_set_transpose_semitones(ctx->processor, semitones);
+}
@@ -0,0 +1,66 @@
+#include "stretch_signalsmith.h"
+
+#include <signalsmith-stretch.h>
+
+#include <new>
+
+// struct stretch_signalsmith is never defined; pointers to it are SignalsmithStretch<float> objects.
+typedef signalsmith::stretch::SignalsmithStretch<float> stretch;
+
+static inline stretch *get(struct stretch_signalsmith *const s) { return reinterpret_cast<stretch *>(s); }
+
+struct stretch_signalsmith *stretch_signalsmith_create(size_t const channels, double const sample_rate) {
+  stretch *s = NULL;
+  try {
+    s = new (std::nothrow) stretch();
+    if (!s) {
+      return NULL;
+    }
+    s->presetDefault(static_cast<int>(channels), static_cast<float>(sample_rate));
+  } catch (...) {
+    // Buffers are sized by the preset and may throw std::bad_alloc; C callers only see NULL.
+    delete s;
+    return NULL;
+  }
+  return reinterpret_cast<struct stretch_signalsmith *>(s);
+}
+
+void stretch_signalsmith_destroy(struct stretch_signalsmith **const sp) {
+  if (!sp || !*sp) {
+    return;
+  }
+  delete get(*sp);
+  *sp = NULL;
+}
+
+size_t stretch_signalsmith_get_input_latency(struct stretch_signalsmith *const s) {
+  return static_cast<size_t>(get(s)->inputLatency());
+}
+
+size_t stretch_signalsmith_get_output_latency(struct stretch_signalsmith *const s) {
+  return static_cast<size_t>(get(s)->outputLatency());
+}
+
+void stretch_signalsmith_set_transpose_semitones(struct stretch_signalsmith *const s, double const semitones) {
+  get(s)->setTransposeSemitones(static_cast<float>(semitones));
+}
+
+void stretch_signalsmith_seek(struct stretch_signalsmith *const s,
+                              float const *const *const in,
+                              size_t const in_len,
+                              double const rate) {
+  get(s)->reset();
+  get(s)->seek(in, static_cast<int>(in_len), rate);
+}
+
+void stretch_signalsmith_process(struct stretch_signalsmith *const s,
+                                 float const *const *const in,
+                                 size_t const in_len,
+                                 float *const *const out,
+                                 size_t const out_len) {
+  get(s)->process(in, static_cast<int>(in_len), out, static_cast<int>(out_len));
+}
+
+void stretch_signalsmith_flush(struct stretch_signalsmith *const s, float *const *const out, size_t const out_len) {
+  get(s)->flush(out, static_cast<int>(out_len));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+
+// C interface to signalsmith-stretch, which is a C++ header-only library.
+// The implementation lives in stretch_signalsmith.cpp.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct stretch_signalsmith;
+
+/**
+ * @brief Creates a time-stretch and pitch-shift processor with the default preset.
+ * All memory is allocated here; changing the transposition or the ratio of input to output
+ * samples between process calls does not allocate.
+ * @return The processor, or NULL if it could not be created.
+ */
+struct stretch_signalsmith *stretch_signalsmith_create(size_t const channels, double const sample_rate);
+void stretch_signalsmith_destroy(struct stretch_signalsmith **const sp);
+
+/**
+ * @brief Returns the number of input samples seek needs to fill the analysis window.
+ */
+size_t stretch_signalsmith_get_input_latency(struct stretch_signalsmith *const s);
+
+/**
+ * @brief Returns the number of output samples flush produces at the end of the input.
+ */
+size_t stretch_signalsmith_get_output_latency(struct stretch_signalsmith *const s);
+
+void stretch_signalsmith_set_transpose_semitones(struct stretch_signalsmith *const s, double const semitones);
+
+/**
+ * @brief Clears the state and primes it with input that precedes the next process call.
+ * @param rate Playback rate, input samples per output sample.
+ */
+void stretch_signalsmith_seek(struct stretch_signalsmith *const s,
+                              float const *const *const in,
+                              size_t const in_len,
+                              double const rate);
+
+/**
+ * @brief Consumes in_len input samples and produces out_len output samples.
+ * The ratio of the two sets the tempo for this block.
+ */
+void stretch_signalsmith_process(struct stretch_signalsmith *const s,
+                                 float const *const *const in,
+                                 size_t const in_len,
+                                 float *const *const out,
+                                 size_t const out_len);
+
+/**
+ * @brief Produces the output still held back after the last input.
+ */
+void stretch_signalsmith_flush(struct stretch_signalsmith *const s, float *const *const out, size_t const out_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,116 @@
+#include <ovtest.h>
+
+#ifndef TESTDATADIR
+#  define TESTDATADIR NSTR(".")
+#endif
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/ogg.h>
+#include <ovl/audio/decoder/stretch.h>
+#include <ovl/audio/info.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+
+#include <inttypes.h>
+
+enum {
+  block_size = 480,
+};
+
+/**
+ * Reads to the end of the stream, checking that every read but the last returns a full block.
+ * Returns the number of samples read, or UINT64_MAX on failure.
+ */
+static uint64_t read_to_end(struct ovl_audio_decoder *const d) {
+  struct ov_error err = {0};
+  uint64_t total = 0;
+  size_t short_reads = 0;
+  for (;;) {
+    size_t read;
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+      return UINT64_MAX;
+    }
+    if (read == 0) {
+      break;
+    }
+    if (read != block_size) {
+      ++short_reads;
+    }
+    total += read;
+  }
+  // The last block of source and the flushed tail may both be short.
+  TEST_CHECK(short_reads <= 2);
+  TEST_MSG("short_reads=%zu", short_reads);
+  return total;
+}
+
+static void tempo_and_pitch(void) {
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *ogg = NULL;
+  struct ovl_audio_decoder *stretch = NULL;
+  struct ov_error err = {0};
+
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(source, &ogg, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_stretch_create(ogg, block_size, &stretch, &err), &err)) {
+    goto cleanup;
+  }
+
+  {
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(stretch);
+    uint64_t const samples = info->samples;
+    // The processor holds back well under a second, which comes out at the end.
+    uint64_t const slack = info->sample_rate;
+    static double const tempos[] = {1.0, 2.0, 0.5};
+    for (size_t i = 0; i < sizeof(tempos) / sizeof(tempos[0]); ++i) {
+      ovl_audio_decoder_stretch_set_tempo(stretch, tempos[i]);
+      ovl_audio_decoder_stretch_set_pitch(stretch, (double)i * 3.0);
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(stretch, 0, &err), &err)) {
+        goto cleanup;
+      }
+      uint64_t const expected = (uint64_t)((double)samples / tempos[i]);
+      uint64_t const got = read_to_end(stretch);
+      TEST_CHECK(got != UINT64_MAX && got + block_size >= expected && got <= expected + block_size + slack);
+      TEST_MSG("tempo %.2f: want about %" PRIu64 " got %" PRIu64, tempos[i], expected, got);
+    }
+
+    // Parameters change between reads without disturbing the block size.
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(stretch, samples / 2, &err), &err)) {
+      goto cleanup;
+    }
+    for (size_t i = 0; i < 64; ++i) {
+      ovl_audio_decoder_stretch_set_tempo(stretch, 0.75 + (double)(i % 8) * 0.125);
+      ovl_audio_decoder_stretch_set_pitch(stretch, (double)(i % 5) - 2.0);
+      size_t read;
+      float const *const *pcm = NULL;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(stretch, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (!TEST_CHECK(read == block_size)) {
+        TEST_MSG("read %zu at block %zu", read, i);
+        break;
+      }
+    }
+  }
+
+cleanup:
+  if (stretch) {
+    ovl_audio_decoder_destroy(&stretch);
+  }
+  if (ogg) {
+    ovl_audio_decoder_destroy(&ogg);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+}
+
+TEST_LIST = {
+    {"tempo_and_pitch", tempo_and_pitch},
+    {NULL, NULL},
+};
@@ -0,0 +1,405 @@
+#include <ovl/audio/decoder/varispeed.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/bidi.h>
+#include <ovl/audio/info.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "varispeed_kernel.h"
+
+// Source samples are gathered into span, a short per-channel buffer that starts one sample before the
+// playhead and is refilled on every read. pos is the playhead as an offset into span, and origin is the
+// position in the source of span[0]; in reverse, span runs backwards from origin, as decoder_bidi returns it.
+// Each read first computes the integer and fractional position of every output sample, which all channels
+// share, then runs the interpolation kernel once per channel and drops what the next block no longer needs.
+
+#define RATE_MAX 8.0
+
+enum {
+  // Keeps the positions of a block at the fastest rate within int32_t.
+  max_block_size = 1 << 20,
+};
+
+struct varispeed {
+  struct ovl_audio_decoder_vtable const *vtable;
+  struct ovl_audio_decoder *decoder;
+  struct ovl_audio_info const *info;
+  struct varispeed_kernels const *kernels;
+  varispeed_func interpolate;
+  size_t block_size;
+  // Whether the source is a decoder_bidi, which can play backwards.
+  bool bidi;
+
+  float **span;
+  size_t span_cap;
+  size_t span_len;
+  // Index of the first sample in span past the end of the source, or SIZE_MAX until the source ends.
+  size_t span_end;
+  float **out;
+  float const **pcm;
+  int32_t *idx;
+  float *frac;
+
+  // The rest of the last source read that did not fit into span.
+  float const *const *src_pcm;
+  size_t src_off;
+  size_t src_len;
+
+  double pos;
+  int64_t origin;
+  bool reverse;
+  // Rate reached at the end of the last block, always non-negative; reverse holds the direction.
+  double speed;
+  // Rate requested by set_rate.
+  double rate;
+  bool started;
+  bool eof;
+  bool ended;
+};
+
+static inline size_t adjust_align8(size_t const size) { return (size + (size_t)(7)) & ~(size_t)(7); }
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+static inline size_t max2(size_t const a, size_t const b) { return a > b ? a : b; }
+
+static NODISCARD bool
+alloc_planes(float ***const planes, size_t const channels, size_t const stride, struct ov_error *const err) {
+  if (!OV_REALLOC(planes, channels, sizeof(float *))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], stride * channels, sizeof(float), 16)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ++ch) {
+    (*planes)[ch] = (*planes)[ch - 1] + stride;
+  }
+  return true;
+}
+
+static void free_planes(float ***const planes) {
+  if (*planes) {
+    if ((*planes)[0]) {
+      OV_ALIGNED_FREE(&(*planes)[0]);
+    }
+    OV_FREE(planes);
+  }
+}
+
+static void destroy(struct ovl_audio_decoder **const dp) {
+  struct varispeed **const ctxp = (struct varispeed **)(void *)dp;
+  if (!ctxp || !*ctxp) {
+    return;
+  }
+  struct varispeed *ctx = *ctxp;
+  free_planes(&ctx->out);
+  free_planes(&ctx->span);
+  if (ctx->frac) {
+    OV_ALIGNED_FREE(&ctx->frac);
+  }
+  if (ctx->idx) {
+    OV_ALIGNED_FREE(&ctx->idx);
+  }
+  if (ctx->pcm) {
+    OV_FREE(&ctx->pcm);
+  }
+  OV_FREE(ctxp);
+}
+
+static struct ovl_audio_info const *get_info(struct ovl_audio_decoder const *const d) {
+  struct varispeed const *const ctx = (struct varispeed const *)(void const *)d;
+  return ctx->info;
+}
+
+static double playhead(struct varispeed const *const ctx) {
+  return ctx->reverse ? (double)ctx->origin - ctx->pos : (double)ctx->origin + ctx->pos;
+}
+
+/**
+ * @brief Starts playback at a position of the source in the given direction.
+ * span is started so that the samples on both sides of the playhead are available; positions before the
+ * start or past the end of the source that this reaches into are filled with silence.
+ */
+static NODISCARD bool
+restart(struct varispeed *const ctx, double const position, bool const reverse, struct ov_error *const err) {
+  int64_t const samples = (int64_t)ctx->info->samples;
+  // Playback that ended may have moved the playhead past either end. Backwards, playback starts on the last
+  // sample rather than on the silence after it.
+  double const end = reverse && samples > 0 ? (double)(samples - 1) : (double)samples;
+  double const at = position < 0 ? 0 : position > end ? end : position;
+  int64_t const whole = (int64_t)floor(at);
+  size_t zeros;
+  uint64_t seek_to;
+  if (!reverse) {
+    int64_t const first = whole - 1;
+    zeros = first < 0 ? (size_t)-first : 0;
+    seek_to = first < 0 ? 0 : (uint64_t)first;
+    ctx->origin = first;
+    ctx->pos = at - (double)first;
+  } else {
+    // decoder_bidi returns the sample before its position first.
+    int64_t const last = whole + 3;
+    zeros = last > samples ? (size_t)(last - samples) : 0;
+    seek_to = (uint64_t)(last > samples ? samples : last);
+    ctx->origin = last - 1;
+    ctx->pos = (double)ctx->origin - at;
+  }
+  ovl_audio_decoder_bidi_set_direction(ctx->decoder, reverse);
+  ctx->src_off = 0;
+  ctx->src_len = 0;
+  if (!ovl_audio_decoder_seek(ctx->decoder, seek_to, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+    memset(ctx->span[ch], 0, zeros * sizeof(float));
+  }
+  ctx->span_len = zeros;
+  ctx->span_end = SIZE_MAX;
+  ctx->reverse = reverse;
+  ctx->started = true;
+  ctx->eof = false;
+  ctx->ended = false;
+  return true;
+}
+
+/**
+ * @brief Fills span up to need samples, padding with silence once the source ends.
+ */
+static NODISCARD bool fill(struct varispeed *const ctx, size_t const need, struct ov_error *const err) {
+  size_t const channels = ctx->info->channels;
+  bool result = false;
+  {
+    while (ctx->span_len < need) {
+      if (ctx->eof) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+          memset(ctx->span[ch] + ctx->span_len, 0, (need - ctx->span_len) * sizeof(float));
+        }
+        ctx->span_len = need;
+        break;
+      }
+      if (ctx->src_off == ctx->src_len) {
+        size_t read;
+        if (!ovl_audio_decoder_read(ctx->decoder, &ctx->src_pcm, &read, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        ctx->src_off = 0;
+        ctx->src_len = read;
+        if (read == 0) {
+          ctx->eof = true;
+          ctx->span_end = ctx->span_len;
+        }
+        continue;
+      }
+      size_t const n = min2(need - ctx->span_len, ctx->src_len - ctx->src_off);
+      for (size_t ch = 0; ch < channels; ++ch) {
+        memcpy(ctx->span[ch] + ctx->span_len, ctx->src_pcm[ch] + ctx->src_off, n * sizeof(float));
+      }
+      ctx->span_len += n;
+      ctx->src_off += n;
+    }
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool read(struct ovl_audio_decoder *const d,
+                           float const *const **const pcm,
+                           size_t *const samples,
+                           struct ov_error *const err) {
+  struct varispeed *const ctx = (struct varispeed *)(void *)d;
+  if (!ctx || !pcm || !samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  bool result = false;
+  {
+    if (!ctx->started) {
+      if (!restart(ctx, 0, false, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+    bool want_reverse = ctx->reverse;
+    double target = fabs(ctx->rate);
+    if (ctx->rate < 0) {
+      if (ctx->bidi) {
+        want_reverse = true;
+      } else {
+        target = 0;
+      }
+    } else if (ctx->rate > 0) {
+      want_reverse = false;
+    }
+    if (want_reverse != ctx->reverse) {
+      if (ctx->speed > 0) {
+        // Come to a standstill first; the direction changes on the next read.
+        target = 0;
+      } else if (!restart(ctx, playhead(ctx), want_reverse, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+    if (ctx->ended) {
+      *samples = 0;
+      result = true;
+      goto cleanup;
+    }
+
+    size_t const block_size = ctx->block_size;
+    double const from = ctx->speed;
+    double const step = (target - from) / (double)block_size;
+    double u = ctx->pos;
+    for (size_t i = 0; i < block_size; ++i) {
+      // u is never negative, so truncation is floor.
+      int32_t const w = (int32_t)u;
+      ctx->idx[i] = w;
+      ctx->frac[i] = (float)(u - (double)w);
+      u += from + step * (double)(i + 1);
+    }
+    // Covers the taps of this block and those of the first sample of the next one.
+    if (!fill(ctx, (size_t)u + 3, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    // Stop before the first output that would interpolate past the last sample of the source.
+    size_t n = 0;
+    while (n < block_size && (size_t)ctx->idx[n] + 1 < ctx->span_end) {
+      ++n;
+    }
+    for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+      ctx->interpolate(ctx->span[ch], ctx->idx, ctx->frac, ctx->out[ch], n);
+      ctx->pcm[ch] = ctx->out[ch];
+    }
+    if (n < block_size) {
+      ctx->ended = true;
+      ctx->speed = 0;
+    } else {
+      ctx->speed = target;
+    }
+
+    // Keep one sample before the new playhead for the hermite kernel.
+    size_t const drop = (size_t)u - 1;
+    if (drop > 0) {
+      for (size_t ch = 0; ch < ctx->info->channels; ++ch) {
+        memmove(ctx->span[ch], ctx->span[ch] + drop, (ctx->span_len - drop) * sizeof(float));
+      }
+      ctx->span_len -= drop;
+      if (ctx->span_end != SIZE_MAX) {
+        ctx->span_end = ctx->span_end > drop ? ctx->span_end - drop : 0;
+      }
+      ctx->origin += ctx->reverse ? -(int64_t)drop : (int64_t)drop;
+    }
+    ctx->pos = u - (double)drop;
+    *pcm = ctx->pcm;
+    *samples = n;
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool seek(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err) {
+  struct varispeed *const ctx = (struct varispeed *)(void *)d;
+  if (!ctx || position > ctx->info->samples) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (!restart(ctx, (double)position, ctx->reverse, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+NODISCARD bool ovl_audio_decoder_varispeed_create(struct ovl_audio_decoder *const source,
+                                                  size_t const block_size,
+                                                  struct ovl_audio_decoder **const dp,
+                                                  struct ov_error *const err) {
+  if (!dp || *dp || !source || block_size > max_block_size) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct varispeed *ctx = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&ctx, 1, sizeof(*ctx))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    static struct ovl_audio_decoder_vtable const vtable = {
+        .destroy = destroy,
+        .get_info = get_info,
+        .read = read,
+        .seek = seek,
+    };
+    bool reverse = false;
+    *ctx = (struct varispeed){
+        .vtable = &vtable,
+        .decoder = source,
+        .info = ovl_audio_decoder_get_info(source),
+        .kernels = varispeed_get_best(),
+        .bidi = ovl_audio_decoder_bidi_get_direction(source, &reverse),
+        .speed = 1.0,
+        .rate = 1.0,
+    };
+    ctx->interpolate = ctx->kernels->hermite;
+    size_t const channels = ctx->info->channels;
+    ctx->block_size = block_size ? block_size : max2(ctx->info->sample_rate / 100, 1);
+    // A block starts at most two samples into span and moves at most RATE_MAX samples per output sample,
+    // and the next block needs one sample behind and two ahead of where this one ends.
+    ctx->span_cap = ctx->block_size * (size_t)RATE_MAX + 8;
+
+    if (!OV_REALLOC(&ctx->pcm, channels, sizeof(float *))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (!alloc_planes(&ctx->span, channels, adjust_align8(ctx->span_cap), err) ||
+        !alloc_planes(&ctx->out, channels, adjust_align8(ctx->block_size), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (!OV_ALIGNED_ALLOC(&ctx->idx, adjust_align8(ctx->block_size), sizeof(int32_t), 16) ||
+        !OV_ALIGNED_ALLOC(&ctx->frac, adjust_align8(ctx->block_size), sizeof(float), 16)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    *dp = (struct ovl_audio_decoder *)(void *)ctx;
+  }
+  result = true;
+
+cleanup:
+  if (!result) {
+    if (ctx) {
+      destroy((struct ovl_audio_decoder **)(void *)&ctx);
+    }
+  }
+  return result;
+}
+
+void ovl_audio_decoder_varispeed_set_rate(struct ovl_audio_decoder *const d, double const rate) {
+  struct varispeed *const ctx = (struct varispeed *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    return;
+  }
+  ctx->rate = isnan(rate) ? 0.0 : rate < -RATE_MAX ? -RATE_MAX : rate > RATE_MAX ? RATE_MAX : rate;
+}
+
+void ovl_audio_decoder_varispeed_set_interpolation(struct ovl_audio_decoder *const d,
+                                                   enum ovl_audio_decoder_varispeed_interpolation const interpolation) {
+  struct varispeed *const ctx = (struct varispeed *)(void *)d;
+  if (!ctx || !ctx->vtable || ctx->vtable->destroy != destroy) {
+    return;
+  }
+  ctx->interpolate = interpolation == ovl_audio_decoder_varispeed_interpolation_linear ? ctx->kernels->linear
+                                                                                         : ctx->kernels->hermite;
+}
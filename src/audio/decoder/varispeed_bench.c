@@ -0,0 +1,248 @@
+#include "../../bench_util.h"
+#include "../../test_util.h"
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/varispeed.h>
+#include <ovl/audio/info.h>
+
+#include <math.h>
+#include <string.h>
+
+// Measures the CPU cost of one decoder_varispeed voice. The source is a synthetic stereo signal that costs
+// nothing to produce, so the figures are the varispeed alone; voices_per_core is how many voices one core
+// could keep up with in real time.
+
+enum {
+  channels = 2,
+  sample_rate = 48000,
+  repetitions = 3,
+};
+
+// Output samples per read, from low-latency mixer callbacks to the 10 ms default and larger offline blocks.
+static size_t const block_sizes[] = {64, 128, 256, 480, 1024};
+
+static struct {
+  char const *name;
+  enum ovl_audio_decoder_varispeed_interpolation interpolation;
+} const interpolations[] = {
+    {"linear", ovl_audio_decoder_varispeed_interpolation_linear},
+    {"hermite", ovl_audio_decoder_varispeed_interpolation_hermite},
+};
+
+static struct {
+  char const *name;
+  double rate;
+  // Moves the rate on every block instead of holding it.
+  bool scrub;
+} const settings[] = {
+    {"rate_1", 1.0, false},
+    {"rate_0.73", 0.73, false},
+    {"rate_1.9", 1.9, false},
+    {"scrub", 1.0, true},
+};
+
+struct options {
+  char const *output;
+  size_t seconds;
+};
+
+static NODISCARD bool run(struct options const *const opts,
+                          struct ovl_audio_decoder *const tone,
+                          size_t const block_size,
+                          size_t const interpolation,
+                          size_t const setting,
+                          FILE *const fp,
+                          bool *const first,
+                          struct ov_error *const err) {
+  struct ovl_audio_decoder *d = NULL;
+  bool result = false;
+
+  {
+    if (!ovl_audio_decoder_varispeed_create(tone, block_size, &d, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    ovl_audio_decoder_varispeed_set_interpolation(d, interpolations[interpolation].interpolation);
+    bool const scrub = settings[setting].scrub;
+
+    size_t const blocks = opts->seconds * sample_rate / block_size;
+    uint64_t best_ns = UINT64_MAX;
+    uint64_t best_cycles = 0;
+    float acc = 0.f;
+    for (size_t r = 0; r < repetitions; ++r) {
+      if (!ovl_audio_decoder_seek(d, 0, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      ovl_audio_decoder_varispeed_set_rate(d, settings[setting].rate);
+      uint64_t const c0 = bench_util_cycles();
+      uint64_t const t0 = bench_util_now_ns();
+      for (size_t i = 0; i < blocks; ++i) {
+        if (scrub) {
+          // Sweeps between 0.25 and 1.75 about once a second, as a hand on a jog wheel would.
+          double const t = (double)(i * block_size) / (double)sample_rate;
+          ovl_audio_decoder_varispeed_set_rate(d, 1.0 + 0.75 * sin(t * 6.0));
+        }
+        float const *const *pcm = NULL;
+        size_t n = 0;
+        if (!ovl_audio_decoder_read(d, &pcm, &n, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        if (n) {
+          acc += pcm[0][n - 1];
+        }
+      }
+      uint64_t const elapsed = bench_util_now_ns() - t0;
+      uint64_t const cycles = bench_util_cycles() - c0;
+      if (elapsed < best_ns) {
+        best_ns = elapsed;
+        best_cycles = cycles;
+      }
+    }
+    bench_util_consume(acc);
+
+    double const audio_ns = (double)(blocks * block_size) / (double)sample_rate * 1e9;
+    fprintf(fp, "%s\n    {\"kernel\": \"varispeed\", \"interpolation\": ", *first ? "" : ",");
+    bench_util_json_string(fp, interpolations[interpolation].name);
+    fprintf(fp, ", \"setting\": ");
+    bench_util_json_string(fp, settings[setting].name);
+    fprintf(fp,
+            ", \"block_size\": %zu, \"blocks\": %zu,\n"
+            "     \"ns_per_block\": %.1f, \"cpu_percent_per_voice\": %.4f, \"voices_per_core\": %.1f,\n"
+            "     \"cycles_per_sample\": ",
+            block_size,
+            blocks,
+            (double)best_ns / (double)blocks,
+            (double)best_ns / audio_ns * 100.0,
+            audio_ns / (double)best_ns);
+    if (best_cycles) {
+      fprintf(fp, "%.2f}", (double)best_cycles / (double)(blocks * block_size));
+    } else {
+      fprintf(fp, "null}");
+    }
+    fflush(fp);
+    *first = false;
+  }
+  result = true;
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  return result;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: bench_ovl_varispeed [options]\n"
+          "  --output <path>       write JSON to path instead of stdout\n"
+          "  --seconds <n>         seconds of output per repetition (default 10)\n");
+}
+
+int main(int argc, char **argv) {
+  struct options opts = {
+      .seconds = 10,
+  };
+  for (int i = 1; i < argc; ++i) {
+    char const *const a = argv[i];
+    char const *const v = i + 1 < argc ? argv[i + 1] : NULL;
+    bool ok = v != NULL;
+    if (ok && strcmp(a, "--output") == 0) {
+      opts.output = v;
+    } else if (ok && strcmp(a, "--seconds") == 0) {
+      char *end = NULL;
+      unsigned long long const n = strtoull(v, &end, 10);
+      ok = *v && !*end && n > 0;
+      opts.seconds = (size_t)n;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage();
+      return 2;
+    }
+    ++i;
+  }
+
+  struct ovl_audio_decoder *tone = NULL;
+  float *buffer[channels] = {NULL};
+  struct ov_error err = {0};
+  FILE *fp = stdout;
+  bool first = true;
+  int exit_code = 1;
+
+  // One second of a chord with a little noise.
+  for (size_t ch = 0; ch < channels; ++ch) {
+    if (!OV_ALIGNED_ALLOC(&buffer[ch], sample_rate, sizeof(float), 16)) {
+      OV_ERROR_SET_GENERIC(&err, ov_error_generic_out_of_memory);
+      OV_ERROR_REPORT(&err, NULL);
+      goto cleanup;
+    }
+  }
+  {
+    uint64_t rng = UINT64_C(0x9e3779b97f4a7c15);
+    static double const freqs[] = {220.0, 277.0, 330.0, 440.0};
+    for (size_t i = 0; i < sample_rate; ++i) {
+      double v = 0.0;
+      for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); ++f) {
+        v += sin(2.0 * 3.14159265358979323846 * freqs[f] * (double)i / (double)sample_rate) * 0.2;
+      }
+      for (size_t ch = 0; ch < channels; ++ch) {
+        float const noise = (float)(int32_t)(bench_util_rand(&rng) >> 32) * (1.f / 2147483648.f);
+        buffer[ch][i] = (float)v + noise * 0.01f;
+      }
+    }
+  }
+  // Long enough for every repetition even at the fastest rate. The buffers hold one second of a signal that
+  // repeats every second, so reading only moves the position.
+  if (!test_util_decoder_create(
+          &(struct test_util_decoder_options){
+              .channels = channels,
+              .sample_rate = sample_rate,
+              .samples = (uint64_t)(opts.seconds + 1) * sample_rate * 2,
+              .chunk = sample_rate,
+              .planes = (float const *const *)buffer,
+              .period = sample_rate,
+          },
+          &tone,
+          &err)) {
+    OV_ERROR_REPORT(&err, NULL);
+    goto cleanup;
+  }
+
+  if (opts.output) {
+    fp = fopen(opts.output, "w");
+    if (!fp) {
+      fprintf(stderr, "failed to open %s\n", opts.output);
+      goto cleanup;
+    }
+  }
+  fprintf(fp, "{\n  \"schema\": 1,\n  \"results\": [");
+  for (size_t p = 0; p < sizeof(interpolations) / sizeof(interpolations[0]); ++p) {
+    for (size_t s = 0; s < sizeof(settings) / sizeof(settings[0]); ++s) {
+      for (size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); ++b) {
+        if (!run(&opts, tone, block_sizes[b], p, s, fp, &first, &err)) {
+          OV_ERROR_REPORT(&err, NULL);
+          goto cleanup;
+        }
+      }
+    }
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  exit_code = 0;
+
+cleanup:
+  if (fp && fp != stdout) {
+    fclose(fp);
+  }
+  if (tone) {
+    ovl_audio_decoder_destroy(&tone);
+  }
+  for (size_t ch = 0; ch < channels; ++ch) {
+    if (buffer[ch]) {
+      OV_ALIGNED_FREE(&buffer[ch]);
+    }
+  }
+  return exit_code;
+}
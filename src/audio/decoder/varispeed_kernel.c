@@ -0,0 +1,311 @@
+#include "varispeed_kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define VARISPEED_X86 1
+#  include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define VARISPEED_NEON 1
+#  include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#  define VARISPEED_WASM 1
+#  include <wasm_simd128.h>
+#endif
+
+// The vector kernels evaluate the same expressions in the same order as the scalar ones, one output per lane.
+// Contraction into fused multiply-adds is disabled so that targets with FMA round the scalar code the same way.
+#pragma STDC FP_CONTRACT OFF
+
+// The hermite kernels load the four taps of each output as one unaligned vector and transpose four of them,
+// which turns a gather into plain loads; AVX2 uses its gather instruction instead.
+
+static inline float scalar_linear_one(float const *const s, float const f) { return s[0] + (s[1] - s[0]) * f; }
+
+static inline float scalar_hermite_one(float const *const s, float const f) {
+  float const xm1 = s[-1];
+  float const x0 = s[0];
+  float const x1 = s[1];
+  float const x2 = s[2];
+  float const c1 = (x1 - xm1) * 0.5f;
+  float const c2 = xm1 - x0 * 2.5f + (x1 + x1) - x2 * 0.5f;
+  float const c3 = (x2 - xm1) * 0.5f + (x0 - x1) * 1.5f;
+  return ((c3 * f + c2) * f + c1) * f + x0;
+}
+
+static void scalar_linear(float const *const src,
+                          int32_t const *const idx,
+                          float const *const frac,
+                          float *const dst,
+                          size_t const n) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = scalar_linear_one(src + idx[i], frac[i]);
+  }
+}
+
+static void scalar_hermite(float const *const src,
+                           int32_t const *const idx,
+                           float const *const frac,
+                           float *const dst,
+                           size_t const n) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = scalar_hermite_one(src + idx[i], frac[i]);
+  }
+}
+
+static struct varispeed_kernels const scalar_kernels = {
+    .linear = scalar_linear,
+    .hermite = scalar_hermite,
+};
+
+#ifdef VARISPEED_X86
+
+static __attribute__((target("sse2"))) inline __m128
+sse2_hermite_eval(__m128 const xm1, __m128 const x0, __m128 const x1, __m128 const x2, __m128 const f) {
+  __m128 const half = _mm_set1_ps(0.5f);
+  __m128 const c1 = _mm_mul_ps(_mm_sub_ps(x1, xm1), half);
+  __m128 const c2 = _mm_sub_ps(
+      _mm_add_ps(_mm_sub_ps(xm1, _mm_mul_ps(x0, _mm_set1_ps(2.5f))), _mm_add_ps(x1, x1)), _mm_mul_ps(x2, half));
+  __m128 const c3 =
+      _mm_add_ps(_mm_mul_ps(_mm_sub_ps(x2, xm1), half), _mm_mul_ps(_mm_sub_ps(x0, x1), _mm_set1_ps(1.5f)));
+  return _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, f), c2), f), c1), f), x0);
+}
+
+// Loads the two taps of two outputs with one 64-bit load each, as p[0], p[1], q[0], q[1].
+static __attribute__((target("sse2"))) inline __m128 sse2_load_pairs(float const *const p, float const *const q) {
+  return _mm_castsi128_ps(_mm_unpacklo_epi64(_mm_loadl_epi64((__m128i const *)(void const *)p),
+                                             _mm_loadl_epi64((__m128i const *)(void const *)q)));
+}
+
+static __attribute__((target("sse2"))) void sse2_linear(float const *const src,
+                                                        int32_t const *const idx,
+                                                        float const *const frac,
+                                                        float *const dst,
+                                                        size_t const n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 const p01 = sse2_load_pairs(src + idx[i], src + idx[i + 1]);
+    __m128 const p23 = sse2_load_pairs(src + idx[i + 2], src + idx[i + 3]);
+    __m128 const a = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 const b = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm_storeu_ps(dst + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_loadu_ps(frac + i))));
+  }
+  scalar_linear(src, idx + i, frac + i, dst + i, n - i);
+}
+
+static __attribute__((target("sse2"))) void sse2_hermite(float const *const src,
+                                                         int32_t const *const idx,
+                                                         float const *const frac,
+                                                         float *const dst,
+                                                         size_t const n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 xm1 = _mm_loadu_ps(src + idx[i] - 1);
+    __m128 x0 = _mm_loadu_ps(src + idx[i + 1] - 1);
+    __m128 x1 = _mm_loadu_ps(src + idx[i + 2] - 1);
+    __m128 x2 = _mm_loadu_ps(src + idx[i + 3] - 1);
+    _MM_TRANSPOSE4_PS(xm1, x0, x1, x2);
+    _mm_storeu_ps(dst + i, sse2_hermite_eval(xm1, x0, x1, x2, _mm_loadu_ps(frac + i)));
+  }
+  scalar_hermite(src, idx + i, frac + i, dst + i, n - i);
+}
+
+static __attribute__((target("avx2"))) void avx2_linear(float const *const src,
+                                                        int32_t const *const idx,
+                                                        float const *const frac,
+                                                        float *const dst,
+                                                        size_t const n) {
+  __m256i const one = _mm256_set1_epi32(1);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i const vi = _mm256_loadu_si256((__m256i const *)(void const *)(idx + i));
+    __m256 const a = _mm256_i32gather_ps(src, vi, 4);
+    __m256 const b = _mm256_i32gather_ps(src, _mm256_add_epi32(vi, one), 4);
+    _mm256_storeu_ps(dst + i, _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), _mm256_loadu_ps(frac + i))));
+  }
+  // sse2_linear is not VEX encoded, so clear the upper halves first to avoid the transition penalty.
+  _mm256_zeroupper();
+  sse2_linear(src, idx + i, frac + i, dst + i, n - i);
+}
+
+static __attribute__((target("avx2"))) void avx2_hermite(float const *const src,
+                                                         int32_t const *const idx,
+                                                         float const *const frac,
+                                                         float *const dst,
+                                                         size_t const n) {
+  __m256i const one = _mm256_set1_epi32(1);
+  __m256 const half = _mm256_set1_ps(0.5f);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i const vi = _mm256_loadu_si256((__m256i const *)(void const *)(idx + i));
+    __m256i const vi1 = _mm256_add_epi32(vi, one);
+    __m256 const xm1 = _mm256_i32gather_ps(src, _mm256_sub_epi32(vi, one), 4);
+    __m256 const x0 = _mm256_i32gather_ps(src, vi, 4);
+    __m256 const x1 = _mm256_i32gather_ps(src, vi1, 4);
+    __m256 const x2 = _mm256_i32gather_ps(src, _mm256_add_epi32(vi1, one), 4);
+    __m256 const f = _mm256_loadu_ps(frac + i);
+    __m256 const c1 = _mm256_mul_ps(_mm256_sub_ps(x1, xm1), half);
+    __m256 const c2 = _mm256_sub_ps(
+        _mm256_add_ps(_mm256_sub_ps(xm1, _mm256_mul_ps(x0, _mm256_set1_ps(2.5f))), _mm256_add_ps(x1, x1)),
+        _mm256_mul_ps(x2, half));
+    __m256 const c3 = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(x2, xm1), half),
+                                    _mm256_mul_ps(_mm256_sub_ps(x0, x1), _mm256_set1_ps(1.5f)));
+    _mm256_storeu_ps(
+        dst + i,
+        _mm256_add_ps(
+            _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(c3, f), c2), f), c1), f), x0));
+  }
+  _mm256_zeroupper();
+  sse2_hermite(src, idx + i, frac + i, dst + i, n - i);
+}
+
+static struct varispeed_kernels const sse2_kernels = {
+    .linear = sse2_linear,
+    .hermite = sse2_hermite,
+};
+
+static struct varispeed_kernels const avx2_kernels = {
+    .linear = avx2_linear,
+    .hermite = avx2_hermite,
+};
+
+#endif // VARISPEED_X86
+
+#ifdef VARISPEED_NEON
+
+static void neon_linear(float const *const src,
+                        int32_t const *const idx,
+                        float const *const frac,
+                        float *const dst,
+                        size_t const n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t const p01 = vcombine_f32(vld1_f32(src + idx[i]), vld1_f32(src + idx[i + 1]));
+    float32x4_t const p23 = vcombine_f32(vld1_f32(src + idx[i + 2]), vld1_f32(src + idx[i + 3]));
+    float32x4x2_t const ab = vuzpq_f32(p01, p23);
+    vst1q_f32(dst + i, vaddq_f32(ab.val[0], vmulq_f32(vsubq_f32(ab.val[1], ab.val[0]), vld1q_f32(frac + i))));
+  }
+  scalar_linear(src, idx + i, frac + i, dst + i, n - i);
+}
+
+static void neon_hermite(float const *const src,
+                         int32_t const *const idx,
+                         float const *const frac,
+                         float *const dst,
+                         size_t const n) {
+  float32x4_t const half = vdupq_n_f32(0.5f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    float32x4x2_t const t01 = vtrnq_f32(vld1q_f32(src + idx[i] - 1), vld1q_f32(src + idx[i + 1] - 1));
+    float32x4x2_t const t23 = vtrnq_f32(vld1q_f32(src + idx[i + 2] - 1), vld1q_f32(src + idx[i + 3] - 1));
+    float32x4_t const xm1 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    float32x4_t const x0 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    float32x4_t const x1 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    float32x4_t const x2 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+    float32x4_t const f = vld1q_f32(frac + i);
+    float32x4_t const c1 = vmulq_f32(vsubq_f32(x1, xm1), half);
+    float32x4_t const c2 =
+        vsubq_f32(vaddq_f32(vsubq_f32(xm1, vmulq_f32(x0, vdupq_n_f32(2.5f))), vaddq_f32(x1, x1)), vmulq_f32(x2, half));
+    float32x4_t const c3 =
+        vaddq_f32(vmulq_f32(vsubq_f32(x2, xm1), half), vmulq_f32(vsubq_f32(x0, x1), vdupq_n_f32(1.5f)));
+    vst1q_f32(dst + i, vaddq_f32(vmulq_f32(vaddq_f32(vmulq_f32(vaddq_f32(vmulq_f32(c3, f), c2), f), c1), f), x0));
+  }
+  scalar_hermite(src, idx + i, frac + i, dst + i, n - i);
+}
+
+static struct varispeed_kernels const neon_kernels = {
+    .linear = neon_linear,
+    .hermite = neon_hermite,
+};
+
+#endif // VARISPEED_NEON
+
+#ifdef VARISPEED_WASM
+
+static void simd128_linear(float const *const src,
+                           int32_t const *const idx,
+                           float const *const frac,
+                           float *const dst,
+                           size_t const n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    v128_t const p01 = wasm_f32x4_make(src[idx[i]], src[idx[i] + 1], src[idx[i + 1]], src[idx[i + 1] + 1]);
+    v128_t const p23 = wasm_f32x4_make(src[idx[i + 2]], src[idx[i + 2] + 1], src[idx[i + 3]], src[idx[i + 3] + 1]);
+    v128_t const a = wasm_i32x4_shuffle(p01, p23, 0, 2, 4, 6);
+    v128_t const b = wasm_i32x4_shuffle(p01, p23, 1, 3, 5, 7);
+    wasm_v128_store(dst + i, wasm_f32x4_add(a, wasm_f32x4_mul(wasm_f32x4_sub(b, a), wasm_v128_load(frac + i))));
+  }
+  scalar_linear(src, idx + i, frac + i, dst + i, n - i);
+}
+
+static void simd128_hermite(float const *const src,
+                            int32_t const *const idx,
+                            float const *const frac,
+                            float *const dst,
+                            size_t const n) {
+  v128_t const half = wasm_f32x4_splat(0.5f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    v128_t const r0 = wasm_v128_load(src + idx[i] - 1);
+    v128_t const r1 = wasm_v128_load(src + idx[i + 1] - 1);
+    v128_t const r2 = wasm_v128_load(src + idx[i + 2] - 1);
+    v128_t const r3 = wasm_v128_load(src + idx[i + 3] - 1);
+    v128_t const t0 = wasm_i32x4_shuffle(r0, r1, 0, 4, 1, 5);
+    v128_t const t1 = wasm_i32x4_shuffle(r2, r3, 0, 4, 1, 5);
+    v128_t const t2 = wasm_i32x4_shuffle(r0, r1, 2, 6, 3, 7);
+    v128_t const t3 = wasm_i32x4_shuffle(r2, r3, 2, 6, 3, 7);
+    v128_t const xm1 = wasm_i32x4_shuffle(t0, t1, 0, 1, 4, 5);
+    v128_t const x0 = wasm_i32x4_shuffle(t0, t1, 2, 3, 6, 7);
+    v128_t const x1 = wasm_i32x4_shuffle(t2, t3, 0, 1, 4, 5);
+    v128_t const x2 = wasm_i32x4_shuffle(t2, t3, 2, 3, 6, 7);
+    v128_t const f = wasm_v128_load(frac + i);
+    v128_t const c1 = wasm_f32x4_mul(wasm_f32x4_sub(x1, xm1), half);
+    v128_t const c2 = wasm_f32x4_sub(
+        wasm_f32x4_add(wasm_f32x4_sub(xm1, wasm_f32x4_mul(x0, wasm_f32x4_splat(2.5f))), wasm_f32x4_add(x1, x1)),
+        wasm_f32x4_mul(x2, half));
+    v128_t const c3 = wasm_f32x4_add(wasm_f32x4_mul(wasm_f32x4_sub(x2, xm1), half),
+                                     wasm_f32x4_mul(wasm_f32x4_sub(x0, x1), wasm_f32x4_splat(1.5f)));
+    wasm_v128_store(
+        dst + i,
+        wasm_f32x4_add(
+            wasm_f32x4_mul(wasm_f32x4_add(wasm_f32x4_mul(wasm_f32x4_add(wasm_f32x4_mul(c3, f), c2), f), c1), f),
+            x0));
+  }
+  scalar_hermite(src, idx + i, frac + i, dst + i, n - i);
+}
+
+static struct varispeed_kernels const simd128_kernels = {
+    .linear = simd128_linear,
+    .hermite = simd128_hermite,
+};
+
+#endif // VARISPEED_WASM
+
+static struct varispeed_kernels const *const tables[kernel_isa_count] = {
+    [kernel_isa_scalar] = &scalar_kernels,
+#ifdef VARISPEED_X86
+    [kernel_isa_sse2] = &sse2_kernels,
+    [kernel_isa_avx2] = &avx2_kernels,
+#endif
+#ifdef VARISPEED_NEON
+    [kernel_isa_neon] = &neon_kernels,
+#endif
+#ifdef VARISPEED_WASM
+    [kernel_isa_simd128] = &simd128_kernels,
+#endif
+};
+
+struct varispeed_kernels const *varispeed_get(enum kernel_isa const isa) {
+  if ((size_t)isa >= kernel_isa_count || !kernel_isa_supported(isa)) {
+    return NULL;
+  }
+  return tables[isa];
+}
+
+struct varispeed_kernels const *varispeed_get_best(void) {
+  for (size_t i = 0; i < kernel_isa_count; ++i) {
+    struct varispeed_kernels const *const k = varispeed_get(kernel_isa_preference[i]);
+    if (k) {
+      return k;
+    }
+  }
+  return &scalar_kernels;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "../kernel.h"
+
+/**
+ * @brief Interpolates samples at fractional positions, dst[i] = src at idx[i] + frac[i].
+ * @param src Source samples, no alignment required. The linear kernel reads src[idx[i]] and src[idx[i] + 1],
+ * the hermite kernel also reads src[idx[i] - 1] and src[idx[i] + 2], so every one of those must be valid.
+ * @param idx Integer part of each position.
+ * @param frac Fractional part of each position, in [0, 1).
+ * @param dst Destination samples, no alignment required.
+ * @param n Number of samples.
+ */
+typedef void (*varispeed_func)(float const *const src,
+                               int32_t const *const idx,
+                               float const *const frac,
+                               float *const dst,
+                               size_t const n);
+
+/**
+ * @brief Varispeed interpolation kernels for one instruction set.
+ * Every variant produces bit-identical output to the scalar kernels.
+ * The positions are computed once per block and shared by all channels, so the kernels only gather and
+ * evaluate the polynomial.
+ */
+struct varispeed_kernels {
+  // Two-point linear interpolation.
+  varispeed_func linear;
+  // Four-point, third-order Hermite (Catmull-Rom) interpolation.
+  varispeed_func hermite;
+};
+
+/**
+ * @brief Returns the kernels for the given instruction set.
+ * @return The kernels, or NULL if the instruction set is not compiled in or not supported by the running CPU.
+ */
+struct varispeed_kernels const *varispeed_get(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the fastest kernels supported by the running CPU.
+ */
+struct varispeed_kernels const *varispeed_get_best(void);
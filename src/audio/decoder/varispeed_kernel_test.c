@@ -0,0 +1,135 @@
+#include <ovtest.h>
+
+#include "varispeed_kernel.h"
+
+#include <math.h>
+#include <string.h>
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"scalar", kernel_isa_scalar},
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+enum {
+  src_samples = 4096,
+  max_samples = 1031,
+  guard = 4,
+};
+
+static float src[src_samples];
+static int32_t idx[max_samples];
+static float frac[max_samples];
+static float expected[max_samples];
+static float out[max_samples + guard * 2];
+
+static uint32_t xorshift(uint32_t *const state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static void prepare(void) {
+  uint32_t state = 0x9e3779b9;
+  for (size_t i = 0; i < src_samples; ++i) {
+    src[i] = (float)(xorshift(&state) & 0xffff) / 32768.f - 1.f;
+  }
+  // Positions move forward at an uneven rate, stand still and repeat, like a playhead during a scrub.
+  int32_t pos = 1;
+  for (size_t i = 0; i < max_samples; ++i) {
+    pos += (int32_t)(xorshift(&state) % 4);
+    if (pos > src_samples - 3) {
+      pos = 1;
+    }
+    idx[i] = pos;
+    frac[i] = (float)(xorshift(&state) & 0xffff) / 65536.f;
+  }
+}
+
+static void check(char const *const kind, size_t const which) {
+  static size_t const sample_counts[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 33, 100, max_samples};
+  struct varispeed_kernels const *const scalar = varispeed_get(kernel_isa_scalar);
+  if (!TEST_CHECK(scalar != NULL)) {
+    return;
+  }
+  varispeed_func const ref = which ? scalar->hermite : scalar->linear;
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    struct varispeed_kernels const *const k = varispeed_get(isas[i].isa);
+    if (!k) {
+      TEST_MSG("%s is not available", isas[i].name);
+      continue;
+    }
+    varispeed_func const fn = which ? k->hermite : k->linear;
+    for (size_t si = 0; si < sizeof(sample_counts) / sizeof(sample_counts[0]); ++si) {
+      size_t const samples = sample_counts[si];
+      // Start on alternate positions so the kernels also see unaligned position and output buffers.
+      size_t const offset = si & 1;
+      size_t const n = samples - (samples && offset ? 1 : 0);
+      ref(src, idx + offset, frac + offset, expected, n);
+      memset(out, 0x55, sizeof(out));
+      fn(src, idx + offset, frac + offset, out + guard + offset, n);
+      if (!TEST_CHECK(memcmp(out + guard + offset, expected, n * sizeof(float)) == 0)) {
+        TEST_MSG("%s %s samples=%zu differs from scalar", isas[i].name, kind, n);
+        return;
+      }
+      static uint8_t const untouched[guard * sizeof(float)] = {
+          0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55};
+      if (!TEST_CHECK(memcmp(out + offset, untouched, sizeof(untouched)) == 0 &&
+                      memcmp(out + guard + offset + n, untouched, sizeof(untouched)) == 0)) {
+        TEST_MSG("%s %s samples=%zu wrote out of bounds", isas[i].name, kind, n);
+        return;
+      }
+    }
+  }
+}
+
+static void linear_matches_scalar(void) {
+  prepare();
+  check("linear", 0);
+}
+
+static void hermite_matches_scalar(void) {
+  prepare();
+  check("hermite", 1);
+}
+
+static void interpolates(void) {
+  struct varispeed_kernels const *const k = varispeed_get_best();
+  if (!TEST_CHECK(k != NULL)) {
+    return;
+  }
+  // Both kernels pass through the samples at whole positions and reproduce a straight line in between.
+  float line[16];
+  for (size_t i = 0; i < 16; ++i) {
+    line[i] = (float)i * 0.25f - 1.f;
+  }
+  int32_t const pos[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  float const f[8] = {0.f, 0.5f, 0.25f, 0.75f, 0.f, 0.125f, 0.5f, 0.875f};
+  float y[8];
+  varispeed_func const fns[2] = {k->linear, k->hermite};
+  for (size_t fi = 0; fi < 2; ++fi) {
+    fns[fi](line, pos, f, y, 8);
+    for (size_t i = 0; i < 8; ++i) {
+      float const want = ((float)pos[i] + f[i]) * 0.25f - 1.f;
+      if (!TEST_CHECK(fabsf(y[i] - want) < 1e-6f)) {
+        TEST_MSG("%s at %d+%g: want %g, got %g", fi ? "hermite" : "linear", pos[i], (double)f[i], (double)want,
+                 (double)y[i]);
+      }
+    }
+  }
+}
+
+TEST_LIST = {
+    {"linear_matches_scalar", linear_matches_scalar},
+    {"hermite_matches_scalar", hermite_matches_scalar},
+    {"interpolates", interpolates},
+    {NULL, NULL},
+};
@@ -0,0 +1,212 @@
+#include <ovtest.h>
+
+#ifndef TESTDATADIR
+#  define TESTDATADIR NSTR(".")
+#endif
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/bidi.h>
+#include <ovl/audio/decoder/ogg.h>
+#include <ovl/audio/decoder/varispeed.h>
+#include <ovl/audio/info.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+
+#include <inttypes.h>
+
+enum {
+  block_size = 480,
+};
+
+/**
+ * Reads to the end of the stream, checking that every read but the last returns a full block.
+ * Returns the number of samples read, or UINT64_MAX on failure.
+ */
+static uint64_t read_to_end(struct ovl_audio_decoder *const d) {
+  struct ov_error err = {0};
+  uint64_t total = 0;
+  size_t short_reads = 0;
+  for (;;) {
+    size_t read;
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_read(d, &pcm, &read, &err), &err)) {
+      return UINT64_MAX;
+    }
+    if (read == 0) {
+      break;
+    }
+    if (read != block_size) {
+      ++short_reads;
+    }
+    total += read;
+  }
+  TEST_CHECK(short_reads <= 1);
+  TEST_MSG("short_reads=%zu", short_reads);
+  return total;
+}
+
+static void unity(void) {
+  struct ovl_source *source = NULL;
+  struct ovl_source *ref_source = NULL;
+  struct ovl_audio_decoder *ogg = NULL;
+  struct ovl_audio_decoder *ref = NULL;
+  struct ovl_audio_decoder *varispeed = NULL;
+  struct ov_error err = {0};
+
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &source, &err), &err) ||
+      !TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &ref_source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(source, &ogg, &err), &err) ||
+      !TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(ref_source, &ref, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_varispeed_create(ogg, block_size, &varispeed, &err), &err)) {
+    goto cleanup;
+  }
+
+  {
+    // At rate 1 every output lands on a whole sample, so both kernels return the source unchanged.
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(ref);
+    size_t ref_off = 0;
+    size_t ref_len = 0;
+    float const *const *ref_pcm = NULL;
+    uint64_t total = 0;
+    size_t mismatches = 0;
+    for (;;) {
+      size_t read;
+      float const *const *pcm = NULL;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(varispeed, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (read == 0) {
+        break;
+      }
+      if (total == (uint64_t)info->sample_rate * 5) {
+        ovl_audio_decoder_varispeed_set_interpolation(varispeed, ovl_audio_decoder_varispeed_interpolation_linear);
+      }
+      for (size_t i = 0; i < read; ++i) {
+        if (ref_off == ref_len) {
+          if (!TEST_SUCCEEDED(ovl_audio_decoder_read(ref, &ref_pcm, &ref_len, &err), &err) ||
+              !TEST_CHECK(ref_len > 0)) {
+            goto cleanup;
+          }
+          ref_off = 0;
+        }
+        for (size_t ch = 0; ch < info->channels; ++ch) {
+          if (pcm[ch][i] != ref_pcm[ch][ref_off]) {
+            ++mismatches;
+          }
+        }
+        ++ref_off;
+      }
+      total += read;
+    }
+    TEST_CHECK(mismatches == 0);
+    TEST_MSG("mismatches=%zu", mismatches);
+    // The last sample has nothing after it to interpolate towards.
+    TEST_CHECK(total + 1 == info->samples);
+    TEST_MSG("want %" PRIu64 " got %" PRIu64, info->samples - 1, total);
+  }
+
+cleanup:
+  if (varispeed) {
+    ovl_audio_decoder_destroy(&varispeed);
+  }
+  if (ref) {
+    ovl_audio_decoder_destroy(&ref);
+  }
+  if (ogg) {
+    ovl_audio_decoder_destroy(&ogg);
+  }
+  if (ref_source) {
+    ovl_source_destroy(&ref_source);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+}
+
+static void rates(void) {
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *ogg = NULL;
+  struct ovl_audio_decoder *bidi = NULL;
+  struct ovl_audio_decoder *varispeed = NULL;
+  struct ov_error err = {0};
+
+  if (!TEST_SUCCEEDED(ovl_source_file_create(TESTDATADIR NSTR("/test.ogg"), &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_ogg_create(source, &ogg, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_bidi_create(ogg, &bidi, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_decoder_varispeed_create(bidi, block_size, &varispeed, &err), &err)) {
+    goto cleanup;
+  }
+
+  {
+    struct ovl_audio_info const *info = ovl_audio_decoder_get_info(varispeed);
+    uint64_t const samples = info->samples;
+    static double const speeds[] = {2.0, 0.5, 7.25};
+    for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); ++i) {
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(varispeed, 0, &err), &err)) {
+        goto cleanup;
+      }
+      // The first block ramps up from the standstill the last run ended in.
+      ovl_audio_decoder_varispeed_set_rate(varispeed, speeds[i]);
+      uint64_t const expected = (uint64_t)((double)samples / speeds[i]);
+      uint64_t const got = read_to_end(varispeed);
+      TEST_CHECK(got != UINT64_MAX && got + block_size >= expected && got <= expected + block_size);
+      TEST_MSG("rate %.2f: want about %" PRIu64 " got %" PRIu64, speeds[i], expected, got);
+    }
+
+    // Backwards from the middle: one block to stop, then back to the start at rate 1.
+    ovl_audio_decoder_varispeed_set_rate(varispeed, -1.0);
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(varispeed, samples / 2, &err), &err)) {
+      goto cleanup;
+    }
+    uint64_t const got = read_to_end(varispeed);
+    TEST_CHECK(got != UINT64_MAX && got + block_size >= samples / 2 && got <= samples / 2 + block_size * 2);
+    TEST_MSG("reverse: want about %" PRIu64 " got %" PRIu64, samples / 2, got);
+
+    // Changing rate and direction between reads keeps full blocks.
+    if (!TEST_SUCCEEDED(ovl_audio_decoder_seek(varispeed, samples / 2, &err), &err)) {
+      goto cleanup;
+    }
+    for (size_t i = 0; i < 64; ++i) {
+      ovl_audio_decoder_varispeed_set_rate(varispeed, (double)(i % 7) - 3.0);
+      size_t read;
+      float const *const *pcm = NULL;
+      if (!TEST_SUCCEEDED(ovl_audio_decoder_read(varispeed, &pcm, &read, &err), &err)) {
+        goto cleanup;
+      }
+      if (!TEST_CHECK(read == block_size)) {
+        TEST_MSG("read %zu at block %zu", read, i);
+        break;
+      }
+    }
+  }
+
+cleanup:
+  if (varispeed) {
+    ovl_audio_decoder_destroy(&varispeed);
+  }
+  if (bidi) {
+    ovl_audio_decoder_destroy(&bidi);
+  }
+  if (ogg) {
+    ovl_audio_decoder_destroy(&ogg);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+}
+
+TEST_LIST = {
+    {"unity", unity},
+    {"rates", rates},
+    {NULL, NULL},
+};
@@ -14,6 +14,7 @@
 #include "../tag.h"
 #include "../tag/id3v2.h"
 #include "wav_inline.h"
+#include "wav_kernel.h"
 
 #define WAVE_FORMAT_PCM 1
 #define WAVE_FORMAT_IEEE_FLOAT 3
@@ -74,6 +75,8 @@ struct wav {
   void *raw_buffer;
   float **float_buffer;
   size_t buffer_samples;
+
+  struct wav_kernels const *kernels;
 };
 
 static NODISCARD bool
@@ -1026,22 +1029,22 @@ static NODISCARD bool read(struct ovl_audio_decoder *const d,
     process_i8((int8_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_i16le:
-    process_i16le((int16_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->i16le(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_i16be:
-    process_i16be((int16_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->i16be(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_i24le:
-    process_i24le((uint8_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->i24le(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_i24be:
-    process_i24be((uint8_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->i24be(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_i32le:
-    process_i32le((int32_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->i32le(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_i32be:
-    process_i32be((int32_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->i32be(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_i64le:
     process_i64le((int64_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
@@ -1050,16 +1053,16 @@ static NODISCARD bool read(struct ovl_audio_decoder *const d,
     process_i64be((int64_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_f32le:
-    process_f32le((uint32_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->f32le(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_f32be:
-    process_f32le((uint32_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->f32be(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_f64le:
-    process_f64le((uint64_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->f64le(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   case sample_format_f64be:
-    process_f64be((uint64_t const *)ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
+    ctx->kernels->f64be(ctx->raw_buffer, ctx->float_buffer, channels, got_samples);
     break;
   }
   ctx->position += got_samples;
@@ -1102,6 +1105,7 @@ NODISCARD bool ovl_audio_decoder_wav_create(struct ovl_source *const source,
     *ctx = (struct wav){
         .vtable = &vtable,
         .source = source,
+        .kernels = wav_kernel_get_best(),
         .info =
             {
                 .tag =
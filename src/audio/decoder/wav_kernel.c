@@ -0,0 +1,580 @@
+#include "wav_kernel.h"
+
+#include "deinterleave.h"
+#include "wav_inline.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define WAV_KERNEL_X86 1
+#  include <immintrin.h>
+#elif (defined(__aarch64__) && (!defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)) ||            \
+    defined(_M_ARM64)
+#  define WAV_KERNEL_NEON 1
+#  include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#  define WAV_KERNEL_WASM 1
+#  include <wasm_simd128.h>
+#endif
+
+// The vectorized kernels convert a block of interleaved samples into a small float buffer that stays in L1,
+// then deinterleave it into the destination planes. This keeps one conversion routine per sample format
+// and one deinterleave routine per channel layout instead of one routine for every combination.
+enum {
+  block_values = 2048,
+};
+
+#define DEFINE_SCALAR_KERNEL(NAME, TYPE)                                                                               \
+  static void scalar_##NAME(                                                                                           \
+      void const *const src, float *const *const dst, size_t const channels, size_t const samples) {                   \
+    process_##NAME((TYPE const *)src, dst, channels, samples);                                                         \
+  }
+
+DEFINE_SCALAR_KERNEL(i16le, int16_t)
+DEFINE_SCALAR_KERNEL(i16be, int16_t)
+DEFINE_SCALAR_KERNEL(i24le, uint8_t)
+DEFINE_SCALAR_KERNEL(i24be, uint8_t)
+DEFINE_SCALAR_KERNEL(i32le, int32_t)
+DEFINE_SCALAR_KERNEL(i32be, int32_t)
+DEFINE_SCALAR_KERNEL(f32le, uint32_t)
+DEFINE_SCALAR_KERNEL(f32be, uint32_t)
+DEFINE_SCALAR_KERNEL(f64le, uint64_t)
+DEFINE_SCALAR_KERNEL(f64be, uint64_t)
+
+static struct wav_kernels const scalar_kernels = {
+    .i16le = scalar_i16le,
+    .i16be = scalar_i16be,
+    .i24le = scalar_i24le,
+    .i24be = scalar_i24be,
+    .i32le = scalar_i32le,
+    .i32be = scalar_i32be,
+    .f32le = scalar_f32le,
+    .f32be = scalar_f32be,
+    .f64le = scalar_f64le,
+    .f64be = scalar_f64be,
+};
+
+#if defined(WAV_KERNEL_X86) || defined(WAV_KERNEL_NEON) || defined(WAV_KERNEL_WASM)
+
+// Converts values [begin, n) one by one, used for the tail that does not fill a whole vector.
+#  define DEFINE_TAIL(NAME, TYPE, STEP)                                                                                \
+    static inline void tail_##NAME(void const *const src, float *const dst, size_t const begin, size_t const n) {      \
+      TYPE const *const s = (TYPE const *)src;                                                                         \
+      for (size_t i = begin; i < n; ++i) {                                                                             \
+        dst[i] = read_as_##NAME(s + i * STEP);                                                                         \
+      }                                                                                                                \
+    }
+
+DEFINE_TAIL(i16le, int16_t, 1)
+DEFINE_TAIL(i16be, int16_t, 1)
+DEFINE_TAIL(i24le, uint8_t, 3)
+DEFINE_TAIL(i24be, uint8_t, 3)
+DEFINE_TAIL(i32le, int32_t, 1)
+DEFINE_TAIL(i32be, int32_t, 1)
+DEFINE_TAIL(f32le, uint32_t, 1)
+DEFINE_TAIL(f32be, uint32_t, 1)
+DEFINE_TAIL(f64le, uint64_t, 1)
+DEFINE_TAIL(f64be, uint64_t, 1)
+
+// Defines the planar kernel ISA_NAME on top of ISA_NAME_to_float and deinterleave_f32_ISA.
+#  define DEFINE_PLANAR_KERNEL(ISA, ATTR, NAME, BYTES)                                                                 \
+    static ATTR void ISA##_##NAME(                                                                                     \
+        void const *const src, float *const *const dst, size_t const channels, size_t const samples) {                 \
+      if (channels == 1) {                                                                                             \
+        ISA##_##NAME##_to_float(src, dst[0], samples);                                                                 \
+        return;                                                                                                        \
+      }                                                                                                                \
+      if (channels > block_values) {                                                                                   \
+        scalar_##NAME(src, dst, channels, samples);                                                                    \
+        return;                                                                                                        \
+      }                                                                                                                \
+      _Alignas(32) float tmp[block_values];                                                                            \
+      size_t const block_frames = block_values / channels;                                                             \
+      uint8_t const *const s = (uint8_t const *)src;                                                                   \
+      for (size_t pos = 0; pos < samples; pos += block_frames) {                                                       \
+        size_t const n = samples - pos < block_frames ? samples - pos : block_frames;                                  \
+        ISA##_##NAME##_to_float(s + pos * channels * BYTES, tmp, n * channels);                                        \
+        deinterleave_f32_##ISA(tmp, dst, pos, n, channels);                                                            \
+      }                                                                                                                \
+    }
+
+#endif
+
+#ifdef WAV_KERNEL_X86
+
+#  define SSE2 __attribute__((target("sse2")))
+#  define AVX2 __attribute__((target("avx2")))
+
+static inline SSE2 __m128i sse2_nop(__m128i const v) { return v; }
+static inline SSE2 __m128i sse2_bswap16(__m128i const v) {
+  return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+static inline SSE2 __m128i sse2_bswap32(__m128i const v) {
+  __m128i const w = sse2_bswap16(v);
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(w, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+static inline SSE2 __m128i sse2_bswap64(__m128i const v) {
+  __m128i const w = sse2_bswap16(v);
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(w, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+#  define DEFINE_SSE2_I16(NAME, SWAP)                                                                                  \
+    static SSE2 void sse2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      int16_t const *const s = (int16_t const *)src;                                                                   \
+      __m128 const scale = _mm_set1_ps(inv_scale16());                                                                 \
+      size_t i = 0;                                                                                                    \
+      for (; i + 8 <= n; i += 8) {                                                                                     \
+        __m128i const v = SWAP(_mm_loadu_si128((__m128i const *)(void const *)(s + i)));                               \
+        __m128i const lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);                                               \
+        __m128i const hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);                                               \
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));                                                \
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));                                            \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_SSE2_I32(NAME, SWAP)                                                                                  \
+    static SSE2 void sse2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      int32_t const *const s = (int32_t const *)src;                                                                   \
+      __m128 const scale = _mm_set1_ps(inv_scale32());                                                                 \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        __m128i const v = SWAP(_mm_loadu_si128((__m128i const *)(void const *)(s + i)));                               \
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));                                                 \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_SSE2_F32(NAME, SWAP)                                                                                  \
+    static SSE2 void sse2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      uint32_t const *const s = (uint32_t const *)src;                                                                 \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        __m128i const v = SWAP(_mm_loadu_si128((__m128i const *)(void const *)(s + i)));                               \
+        _mm_storeu_ps(dst + i, _mm_castsi128_ps(v));                                                                   \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_SSE2_F64(NAME, SWAP)                                                                                  \
+    static SSE2 void sse2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      uint64_t const *const s = (uint64_t const *)src;                                                                 \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        __m128i const a = SWAP(_mm_loadu_si128((__m128i const *)(void const *)(s + i)));                               \
+        __m128i const b = SWAP(_mm_loadu_si128((__m128i const *)(void const *)(s + i + 2)));                           \
+        _mm_storeu_ps(dst + i,                                                                                         \
+                      _mm_movelh_ps(_mm_cvtpd_ps(_mm_castsi128_pd(a)), _mm_cvtpd_ps(_mm_castsi128_pd(b))));           \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+DEFINE_SSE2_I16(i16le, sse2_nop)
+DEFINE_SSE2_I16(i16be, sse2_bswap16)
+DEFINE_SSE2_I32(i32le, sse2_nop)
+DEFINE_SSE2_I32(i32be, sse2_bswap32)
+DEFINE_SSE2_F32(f32le, sse2_nop)
+DEFINE_SSE2_F32(f32be, sse2_bswap32)
+DEFINE_SSE2_F64(f64le, sse2_nop)
+DEFINE_SSE2_F64(f64be, sse2_bswap64)
+
+DEFINE_PLANAR_KERNEL(sse2, SSE2, i16le, 2)
+DEFINE_PLANAR_KERNEL(sse2, SSE2, i16be, 2)
+DEFINE_PLANAR_KERNEL(sse2, SSE2, i32le, 4)
+DEFINE_PLANAR_KERNEL(sse2, SSE2, i32be, 4)
+DEFINE_PLANAR_KERNEL(sse2, SSE2, f32le, 4)
+DEFINE_PLANAR_KERNEL(sse2, SSE2, f32be, 4)
+DEFINE_PLANAR_KERNEL(sse2, SSE2, f64le, 8)
+DEFINE_PLANAR_KERNEL(sse2, SSE2, f64be, 8)
+
+static struct wav_kernels const sse2_kernels = {
+    .i16le = sse2_i16le,
+    .i16be = sse2_i16be,
+    // Unpacking 3-byte samples needs a byte shuffle that SSE2 lacks,
+    // and a vectorized deinterleave alone does not beat the fused scalar loop.
+    .i24le = scalar_i24le,
+    .i24be = scalar_i24be,
+    .i32le = sse2_i32le,
+    .i32be = sse2_i32be,
+    .f32le = sse2_f32le,
+    .f32be = sse2_f32be,
+    .f64le = sse2_f64le,
+    .f64be = sse2_f64be,
+};
+
+static inline AVX2 __m256i avx2_nop(__m256i const v) { return v; }
+static inline AVX2 __m256i avx2_bswap16(__m256i const v) {
+  __m128i const mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  return _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(mask));
+}
+static inline AVX2 __m256i avx2_bswap32(__m256i const v) {
+  __m128i const mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  return _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(mask));
+}
+static inline AVX2 __m256i avx2_bswap64(__m256i const v) {
+  __m128i const mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  return _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(mask));
+}
+
+#  define DEFINE_AVX2_I16(NAME, SWAP)                                                                                  \
+    static AVX2 void avx2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      int16_t const *const s = (int16_t const *)src;                                                                   \
+      __m256 const scale = _mm256_set1_ps(inv_scale16());                                                              \
+      size_t i = 0;                                                                                                    \
+      for (; i + 16 <= n; i += 16) {                                                                                   \
+        __m256i const v = SWAP(_mm256_loadu_si256((__m256i const *)(void const *)(s + i)));                            \
+        __m256i const lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v));                                           \
+        __m256i const hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1));                                      \
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));                                       \
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));                                   \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+// Each 128-bit lane takes four 3-byte samples from a 16-byte load and moves them to the top of a 32-bit lane,
+// exactly like read_as_i24le/be. The second load starts 12 bytes in, so keep 4 spare bytes before the end.
+#  define DEFINE_AVX2_I24(NAME, ...)                                                                                   \
+    static AVX2 void avx2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      uint8_t const *const s = (uint8_t const *)src;                                                                   \
+      __m128i const mask = _mm_setr_epi8(__VA_ARGS__);                                                                 \
+      __m256 const scale = _mm256_set1_ps(1.f / 2147483648.f);                                                         \
+      size_t i = 0;                                                                                                    \
+      for (; i + 10 <= n; i += 8) {                                                                                    \
+        __m128i const lo = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(void const *)(s + i * 3)), mask);        \
+        __m128i const hi = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(void const *)(s + i * 3 + 12)), mask);   \
+        __m256i const v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);                                  \
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));                                        \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_AVX2_I32(NAME, SWAP)                                                                                  \
+    static AVX2 void avx2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      int32_t const *const s = (int32_t const *)src;                                                                   \
+      __m256 const scale = _mm256_set1_ps(inv_scale32());                                                              \
+      size_t i = 0;                                                                                                    \
+      for (; i + 8 <= n; i += 8) {                                                                                     \
+        __m256i const v = SWAP(_mm256_loadu_si256((__m256i const *)(void const *)(s + i)));                            \
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));                                        \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_AVX2_F32(NAME, SWAP)                                                                                  \
+    static AVX2 void avx2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      uint32_t const *const s = (uint32_t const *)src;                                                                 \
+      size_t i = 0;                                                                                                    \
+      for (; i + 8 <= n; i += 8) {                                                                                     \
+        __m256i const v = SWAP(_mm256_loadu_si256((__m256i const *)(void const *)(s + i)));                            \
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(v));                                                             \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_AVX2_F64(NAME, SWAP)                                                                                  \
+    static AVX2 void avx2_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                 \
+      uint64_t const *const s = (uint64_t const *)src;                                                                 \
+      size_t i = 0;                                                                                                    \
+      for (; i + 8 <= n; i += 8) {                                                                                     \
+        __m256i const a = SWAP(_mm256_loadu_si256((__m256i const *)(void const *)(s + i)));                            \
+        __m256i const b = SWAP(_mm256_loadu_si256((__m256i const *)(void const *)(s + i + 4)));                        \
+        _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_castsi256_pd(a)));                                               \
+        _mm_storeu_ps(dst + i + 4, _mm256_cvtpd_ps(_mm256_castsi256_pd(b)));                                           \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+DEFINE_AVX2_I16(i16le, avx2_nop)
+DEFINE_AVX2_I16(i16be, avx2_bswap16)
+DEFINE_AVX2_I24(i24le, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11)
+DEFINE_AVX2_I24(i24be, -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9)
+DEFINE_AVX2_I32(i32le, avx2_nop)
+DEFINE_AVX2_I32(i32be, avx2_bswap32)
+DEFINE_AVX2_F32(f32le, avx2_nop)
+DEFINE_AVX2_F32(f32be, avx2_bswap32)
+DEFINE_AVX2_F64(f64le, avx2_nop)
+DEFINE_AVX2_F64(f64be, avx2_bswap64)
+
+DEFINE_PLANAR_KERNEL(avx2, AVX2, i16le, 2)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, i16be, 2)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, i24le, 3)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, i24be, 3)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, i32le, 4)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, i32be, 4)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, f32le, 4)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, f32be, 4)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, f64le, 8)
+DEFINE_PLANAR_KERNEL(avx2, AVX2, f64be, 8)
+
+static struct wav_kernels const avx2_kernels = {
+    .i16le = avx2_i16le,
+    .i16be = avx2_i16be,
+    .i24le = avx2_i24le,
+    .i24be = avx2_i24be,
+    .i32le = avx2_i32le,
+    .i32be = avx2_i32be,
+    .f32le = avx2_f32le,
+    .f32be = avx2_f32be,
+    .f64le = avx2_f64le,
+    .f64be = avx2_f64be,
+};
+
+#endif // WAV_KERNEL_X86
+
+#ifdef WAV_KERNEL_NEON
+
+static inline uint8x16_t neon_nop(uint8x16_t const v) { return v; }
+
+#  define DEFINE_NEON_I16(NAME, SWAP)                                                                                  \
+    static void neon_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                      \
+      uint8_t const *const s = (uint8_t const *)src;                                                                   \
+      float const scale = inv_scale16();                                                                               \
+      size_t i = 0;                                                                                                    \
+      for (; i + 8 <= n; i += 8) {                                                                                     \
+        int16x8_t const v = vreinterpretq_s16_u8(SWAP(vld1q_u8(s + i * 2)));                                           \
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));                             \
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(v)), scale));                                  \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+// vld3q splits 16 samples into their three bytes, which are zipped back together in the top 24 bits.
+#  define DEFINE_NEON_I24(NAME, B0, B1, B2)                                                                            \
+    static void neon_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                      \
+      uint8_t const *const s = (uint8_t const *)src;                                                                   \
+      uint8x16_t const zero = vdupq_n_u8(0);                                                                           \
+      float const scale = 1.f / 2147483648.f;                                                                          \
+      size_t i = 0;                                                                                                    \
+      for (; i + 16 <= n; i += 16) {                                                                                   \
+        uint8x16x3_t const v = vld3q_u8(s + i * 3);                                                                    \
+        uint16x8_t const lo0 = vreinterpretq_u16_u8(vzip1q_u8(zero, v.val[B0]));                                       \
+        uint16x8_t const lo1 = vreinterpretq_u16_u8(vzip2q_u8(zero, v.val[B0]));                                       \
+        uint16x8_t const hi0 = vreinterpretq_u16_u8(vzip1q_u8(v.val[B1], v.val[B2]));                                  \
+        uint16x8_t const hi1 = vreinterpretq_u16_u8(vzip2q_u8(v.val[B1], v.val[B2]));                                  \
+        int32x4_t const w0 = vreinterpretq_s32_u16(vzip1q_u16(lo0, hi0));                                              \
+        int32x4_t const w1 = vreinterpretq_s32_u16(vzip2q_u16(lo0, hi0));                                              \
+        int32x4_t const w2 = vreinterpretq_s32_u16(vzip1q_u16(lo1, hi1));                                              \
+        int32x4_t const w3 = vreinterpretq_s32_u16(vzip2q_u16(lo1, hi1));                                              \
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(w0), scale));                                                     \
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(w1), scale));                                                 \
+        vst1q_f32(dst + i + 8, vmulq_n_f32(vcvtq_f32_s32(w2), scale));                                                 \
+        vst1q_f32(dst + i + 12, vmulq_n_f32(vcvtq_f32_s32(w3), scale));                                                \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_NEON_I32(NAME, SWAP)                                                                                  \
+    static void neon_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                      \
+      uint8_t const *const s = (uint8_t const *)src;                                                                   \
+      float const scale = inv_scale32();                                                                               \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        int32x4_t const v = vreinterpretq_s32_u8(SWAP(vld1q_u8(s + i * 4)));                                           \
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(v), scale));                                                      \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_NEON_F32(NAME, SWAP)                                                                                  \
+    static void neon_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                      \
+      uint8_t const *const s = (uint8_t const *)src;                                                                   \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        vst1q_f32(dst + i, vreinterpretq_f32_u8(SWAP(vld1q_u8(s + i * 4))));                                           \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_NEON_F64(NAME, SWAP)                                                                                  \
+    static void neon_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                      \
+      uint8_t const *const s = (uint8_t const *)src;                                                                   \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        float64x2_t const a = vreinterpretq_f64_u8(SWAP(vld1q_u8(s + i * 8)));                                         \
+        float64x2_t const b = vreinterpretq_f64_u8(SWAP(vld1q_u8(s + i * 8 + 16)));                                    \
+        vst1q_f32(dst + i, vcombine_f32(vcvt_f32_f64(a), vcvt_f32_f64(b)));                                            \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+DEFINE_NEON_I16(i16le, neon_nop)
+DEFINE_NEON_I16(i16be, vrev16q_u8)
+DEFINE_NEON_I24(i24le, 0, 1, 2)
+DEFINE_NEON_I24(i24be, 2, 1, 0)
+DEFINE_NEON_I32(i32le, neon_nop)
+DEFINE_NEON_I32(i32be, vrev32q_u8)
+DEFINE_NEON_F32(f32le, neon_nop)
+DEFINE_NEON_F32(f32be, vrev32q_u8)
+DEFINE_NEON_F64(f64le, neon_nop)
+DEFINE_NEON_F64(f64be, vrev64q_u8)
+
+DEFINE_PLANAR_KERNEL(neon, , i16le, 2)
+DEFINE_PLANAR_KERNEL(neon, , i16be, 2)
+DEFINE_PLANAR_KERNEL(neon, , i24le, 3)
+DEFINE_PLANAR_KERNEL(neon, , i24be, 3)
+DEFINE_PLANAR_KERNEL(neon, , i32le, 4)
+DEFINE_PLANAR_KERNEL(neon, , i32be, 4)
+DEFINE_PLANAR_KERNEL(neon, , f32le, 4)
+DEFINE_PLANAR_KERNEL(neon, , f32be, 4)
+DEFINE_PLANAR_KERNEL(neon, , f64le, 8)
+DEFINE_PLANAR_KERNEL(neon, , f64be, 8)
+
+static struct wav_kernels const neon_kernels = {
+    .i16le = neon_i16le,
+    .i16be = neon_i16be,
+    .i24le = neon_i24le,
+    .i24be = neon_i24be,
+    .i32le = neon_i32le,
+    .i32be = neon_i32be,
+    .f32le = neon_f32le,
+    .f32be = neon_f32be,
+    .f64le = neon_f64le,
+    .f64be = neon_f64be,
+};
+
+#endif // WAV_KERNEL_NEON
+
+#ifdef WAV_KERNEL_WASM
+
+static inline v128_t simd128_nop(v128_t const v) { return v; }
+static inline v128_t simd128_bswap16(v128_t const v) {
+  return wasm_i8x16_shuffle(v, v, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+}
+static inline v128_t simd128_bswap32(v128_t const v) {
+  return wasm_i8x16_shuffle(v, v, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+}
+static inline v128_t simd128_bswap64(v128_t const v) {
+  return wasm_i8x16_shuffle(v, v, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+}
+
+#  define DEFINE_SIMD128_I16(NAME, SWAP)                                                                               \
+    static void simd128_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                   \
+      int16_t const *const s = (int16_t const *)src;                                                                   \
+      v128_t const scale = wasm_f32x4_splat(inv_scale16());                                                            \
+      size_t i = 0;                                                                                                    \
+      for (; i + 8 <= n; i += 8) {                                                                                     \
+        v128_t const v = SWAP(wasm_v128_load(s + i));                                                                  \
+        v128_t const lo = wasm_i32x4_extend_low_i16x8(v);                                                              \
+        v128_t const hi = wasm_i32x4_extend_high_i16x8(v);                                                             \
+        wasm_v128_store(dst + i, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(lo), scale));                                 \
+        wasm_v128_store(dst + i + 4, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(hi), scale));                             \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+// Same shuffle as the AVX2 path, with index 16 picking a zero byte from the second operand.
+// The second load starts 12 bytes in, so keep 4 spare bytes before the end.
+#  define DEFINE_SIMD128_I24(NAME, ...)                                                                                \
+    static void simd128_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                   \
+      uint8_t const *const s = (uint8_t const *)src;                                                                   \
+      v128_t const zero = wasm_i32x4_splat(0);                                                                         \
+      v128_t const scale = wasm_f32x4_splat(1.f / 2147483648.f);                                                       \
+      size_t i = 0;                                                                                                    \
+      for (; i + 10 <= n; i += 8) {                                                                                    \
+        v128_t const lo = wasm_i8x16_shuffle(wasm_v128_load(s + i * 3), zero, __VA_ARGS__);                            \
+        v128_t const hi = wasm_i8x16_shuffle(wasm_v128_load(s + i * 3 + 12), zero, __VA_ARGS__);                       \
+        wasm_v128_store(dst + i, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(lo), scale));                                 \
+        wasm_v128_store(dst + i + 4, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(hi), scale));                             \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_SIMD128_I32(NAME, SWAP)                                                                               \
+    static void simd128_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                   \
+      int32_t const *const s = (int32_t const *)src;                                                                   \
+      v128_t const scale = wasm_f32x4_splat(inv_scale32());                                                            \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        v128_t const v = SWAP(wasm_v128_load(s + i));                                                                  \
+        wasm_v128_store(dst + i, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(v), scale));                                  \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_SIMD128_F32(NAME, SWAP)                                                                               \
+    static void simd128_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                   \
+      uint32_t const *const s = (uint32_t const *)src;                                                                 \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        wasm_v128_store(dst + i, SWAP(wasm_v128_load(s + i)));                                                         \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+#  define DEFINE_SIMD128_F64(NAME, SWAP)                                                                               \
+    static void simd128_##NAME##_to_float(void const *const src, float *const dst, size_t const n) {                   \
+      uint64_t const *const s = (uint64_t const *)src;                                                                 \
+      size_t i = 0;                                                                                                    \
+      for (; i + 4 <= n; i += 4) {                                                                                     \
+        v128_t const a = wasm_f32x4_demote_f64x2_zero(SWAP(wasm_v128_load(s + i)));                                    \
+        v128_t const b = wasm_f32x4_demote_f64x2_zero(SWAP(wasm_v128_load(s + i + 2)));                                \
+        wasm_v128_store(dst + i, wasm_i64x2_shuffle(a, b, 0, 2));                                                      \
+      }                                                                                                                \
+      tail_##NAME(src, dst, i, n);                                                                                     \
+    }
+
+DEFINE_SIMD128_I16(i16le, simd128_nop)
+DEFINE_SIMD128_I16(i16be, simd128_bswap16)
+DEFINE_SIMD128_I24(i24le, 16, 0, 1, 2, 16, 3, 4, 5, 16, 6, 7, 8, 16, 9, 10, 11)
+DEFINE_SIMD128_I24(i24be, 16, 2, 1, 0, 16, 5, 4, 3, 16, 8, 7, 6, 16, 11, 10, 9)
+DEFINE_SIMD128_I32(i32le, simd128_nop)
+DEFINE_SIMD128_I32(i32be, simd128_bswap32)
+DEFINE_SIMD128_F32(f32le, simd128_nop)
+DEFINE_SIMD128_F32(f32be, simd128_bswap32)
+DEFINE_SIMD128_F64(f64le, simd128_nop)
+DEFINE_SIMD128_F64(f64be, simd128_bswap64)
+
+DEFINE_PLANAR_KERNEL(simd128, , i16le, 2)
+DEFINE_PLANAR_KERNEL(simd128, , i16be, 2)
+DEFINE_PLANAR_KERNEL(simd128, , i24le, 3)
+DEFINE_PLANAR_KERNEL(simd128, , i24be, 3)
+DEFINE_PLANAR_KERNEL(simd128, , i32le, 4)
+DEFINE_PLANAR_KERNEL(simd128, , i32be, 4)
+DEFINE_PLANAR_KERNEL(simd128, , f32le, 4)
+DEFINE_PLANAR_KERNEL(simd128, , f32be, 4)
+DEFINE_PLANAR_KERNEL(simd128, , f64le, 8)
+DEFINE_PLANAR_KERNEL(simd128, , f64be, 8)
+
+static struct wav_kernels const simd128_kernels = {
+    .i16le = simd128_i16le,
+    .i16be = simd128_i16be,
+    .i24le = simd128_i24le,
+    .i24be = simd128_i24be,
+    .i32le = simd128_i32le,
+    .i32be = simd128_i32be,
+    .f32le = simd128_f32le,
+    .f32be = simd128_f32be,
+    .f64le = simd128_f64le,
+    .f64be = simd128_f64be,
+};
+
+#endif // WAV_KERNEL_WASM
+
+static struct wav_kernels const *const tables[kernel_isa_count] = {
+    [kernel_isa_scalar] = &scalar_kernels,
+#ifdef WAV_KERNEL_X86
+    [kernel_isa_sse2] = &sse2_kernels,
+    [kernel_isa_avx2] = &avx2_kernels,
+#endif
+#ifdef WAV_KERNEL_NEON
+    [kernel_isa_neon] = &neon_kernels,
+#endif
+#ifdef WAV_KERNEL_WASM
+    [kernel_isa_simd128] = &simd128_kernels,
+#endif
+};
+
+struct wav_kernels const *wav_kernel_get(enum kernel_isa const isa) {
+  if ((size_t)isa >= kernel_isa_count || !kernel_isa_supported(isa)) {
+    return NULL;
+  }
+  return tables[isa];
+}
+
+struct wav_kernels const *wav_kernel_get_best(void) {
+  for (size_t i = 0; i < kernel_isa_count; ++i) {
+    struct wav_kernels const *const k = wav_kernel_get(kernel_isa_preference[i]);
+    if (k) {
+      return k;
+    }
+  }
+  return &scalar_kernels;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "../kernel.h"
+
+/**
+ * @brief Converts interleaved PCM to planar float.
+ * @param src Interleaved source samples, no alignment required.
+ * @param dst Destination planes, one per channel.
+ * @param channels Number of channels.
+ * @param samples Number of samples per channel.
+ */
+typedef void (*wav_kernel_func)(void const *const src,
+                                float *const *const dst,
+                                size_t const channels,
+                                size_t const samples);
+
+/**
+ * @brief PCM conversion kernels for one instruction set.
+ * Every variant produces bit-identical output to the scalar process_* functions in wav_inline.h.
+ */
+struct wav_kernels {
+  wav_kernel_func i16le;
+  wav_kernel_func i16be;
+  wav_kernel_func i24le;
+  wav_kernel_func i24be;
+  wav_kernel_func i32le;
+  wav_kernel_func i32be;
+  wav_kernel_func f32le;
+  wav_kernel_func f32be;
+  wav_kernel_func f64le;
+  wav_kernel_func f64be;
+};
+
+/**
+ * @brief Returns the kernels for the given instruction set.
+ * @return The kernels, or NULL if the instruction set is not compiled in or not supported by the running CPU.
+ */
+struct wav_kernels const *wav_kernel_get(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the fastest kernels supported by the running CPU.
+ */
+struct wav_kernels const *wav_kernel_get_best(void);
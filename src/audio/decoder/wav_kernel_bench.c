@@ -0,0 +1,340 @@
+#include "../../bench_util.h"
+
+#include "wav_inline.h"
+#include "wav_kernel.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+enum fill_kind {
+  fill_random,
+  fill_f32le,
+  fill_f32be,
+  fill_f64le,
+  fill_f64be,
+};
+
+struct kernel {
+  char const *name;
+  size_t bytes;
+  enum fill_kind fill;
+  wav_kernel_func scalar;
+  size_t simd_offset; // offset in struct wav_kernels, SIZE_MAX if there is no vectorized variant
+};
+
+struct variant {
+  char const *name;
+  wav_kernel_func fn;
+};
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+#define DEFINE_SCALAR_KERNEL(NAME, TYPE)                                                                               \
+  static void scalar_##NAME(                                                                                           \
+      void const *const src, float *const *const dst, size_t const channels, size_t const samples) {                   \
+    process_##NAME((TYPE const *)src, dst, channels, samples);                                                         \
+  }
+
+DEFINE_SCALAR_KERNEL(u8, uint8_t)
+DEFINE_SCALAR_KERNEL(i8, int8_t)
+DEFINE_SCALAR_KERNEL(i16le, int16_t)
+DEFINE_SCALAR_KERNEL(i16be, int16_t)
+DEFINE_SCALAR_KERNEL(i24le, uint8_t)
+DEFINE_SCALAR_KERNEL(i24be, uint8_t)
+DEFINE_SCALAR_KERNEL(i32le, int32_t)
+DEFINE_SCALAR_KERNEL(i32be, int32_t)
+DEFINE_SCALAR_KERNEL(i64le, int64_t)
+DEFINE_SCALAR_KERNEL(i64be, int64_t)
+DEFINE_SCALAR_KERNEL(f32le, uint32_t)
+DEFINE_SCALAR_KERNEL(f32be, uint32_t)
+DEFINE_SCALAR_KERNEL(f64le, uint64_t)
+DEFINE_SCALAR_KERNEL(f64be, uint64_t)
+
+#define NO_SIMD SIZE_MAX
+#define SIMD(NAME) offsetof(struct wav_kernels, NAME)
+
+static struct kernel const kernels[] = {
+    {"u8", 1, fill_random, scalar_u8, NO_SIMD},
+    {"i8", 1, fill_random, scalar_i8, NO_SIMD},
+    {"i16le", 2, fill_random, scalar_i16le, SIMD(i16le)},
+    {"i16be", 2, fill_random, scalar_i16be, SIMD(i16be)},
+    {"i24le", 3, fill_random, scalar_i24le, SIMD(i24le)},
+    {"i24be", 3, fill_random, scalar_i24be, SIMD(i24be)},
+    {"i32le", 4, fill_random, scalar_i32le, SIMD(i32le)},
+    {"i32be", 4, fill_random, scalar_i32be, SIMD(i32be)},
+    {"i64le", 8, fill_random, scalar_i64le, NO_SIMD},
+    {"i64be", 8, fill_random, scalar_i64be, NO_SIMD},
+    {"f32le", 4, fill_f32le, scalar_f32le, SIMD(f32le)},
+    {"f32be", 4, fill_f32be, scalar_f32be, SIMD(f32be)},
+    {"f64le", 8, fill_f64le, scalar_f64le, SIMD(f64le)},
+    {"f64be", 8, fill_f64be, scalar_f64be, SIMD(f64be)},
+};
+
+static size_t const channel_counts[] = {1, 2, 4, 6, 8};
+static size_t const frame_counts[] = {256, 4096, 65536};
+
+enum {
+  max_channels = 8,
+  max_variants = kernel_isa_count,
+  repetitions = 5,
+};
+
+struct options {
+  char const *filter;
+  char const *output;
+  uint64_t min_time_ns;
+};
+
+// Float formats get values in [-1, 1) so NaNs and denormals do not hit slow paths that real files never take.
+static void fill(uint8_t *const p, size_t const len, enum fill_kind const kind, uint64_t *const rng) {
+  size_t const step = kind == fill_f32le || kind == fill_f32be ? 4 : 8;
+  for (size_t i = 0; i < len; i += step) {
+    uint64_t const r = bench_util_rand(rng);
+    double const v = (double)(r >> 11) / 9007199254740992.0 * 2.0 - 1.0;
+    uint64_t bits = r;
+    if (kind == fill_f32le || kind == fill_f32be) {
+      float const f = (float)v;
+      uint32_t u;
+      memcpy(&u, &f, sizeof(u));
+      bits = kind == fill_f32le ? swap32le(u) : swap32be(u);
+    } else if (kind == fill_f64le || kind == fill_f64be) {
+      memcpy(&bits, &v, sizeof(bits));
+      bits = kind == fill_f64le ? swap64le(bits) : swap64be(bits);
+    }
+    memcpy(p + i, &bits, len - i < step ? len - i : step);
+  }
+}
+
+struct measurement {
+  uint64_t ns;
+  uint64_t cycles;
+  size_t calls;
+};
+
+static struct measurement measure(struct options const *const opts,
+                                  struct variant const *const k,
+                                  void const *const src,
+                                  float *const *const dst,
+                                  size_t const channels,
+                                  size_t const frames) {
+  // Calibrate the number of calls so one repetition takes at least min_time_ns.
+  size_t calls = 1;
+  for (;;) {
+    uint64_t const t0 = bench_util_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+      k->fn(src, dst, channels, frames);
+    }
+    uint64_t const elapsed = bench_util_now_ns() - t0;
+    if (elapsed >= opts->min_time_ns || calls >= SIZE_MAX / 2) {
+      break;
+    }
+    calls *= 2;
+  }
+  struct measurement best = {.ns = UINT64_MAX, .calls = calls};
+  for (size_t r = 0; r < repetitions; ++r) {
+    uint64_t const c0 = bench_util_cycles();
+    uint64_t const t0 = bench_util_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+      k->fn(src, dst, channels, frames);
+    }
+    uint64_t const elapsed = bench_util_now_ns() - t0;
+    uint64_t const cycles = bench_util_cycles() - c0;
+    if (elapsed < best.ns) {
+      best.ns = elapsed;
+      best.cycles = cycles;
+    }
+  }
+  bench_util_consume(dst[0][frames - 1]);
+  return best;
+}
+
+static bool same_output(float *const *const a, float *const *const b, size_t const channels, size_t const frames) {
+  for (size_t c = 0; c < channels; ++c) {
+    if (memcmp(a[c], b[c], frames * sizeof(float)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static NODISCARD bool run_kernel(struct options const *const opts,
+                                 struct kernel const *const base,
+                                 struct variant const *const variants,
+                                 size_t const count,
+                                 size_t const channels,
+                                 size_t const frames,
+                                 FILE *const fp,
+                                 bool *const first,
+                                 struct ov_error *const err) {
+  uint8_t *src = NULL;
+  float *ref_buf = NULL;
+  float *out_buf = NULL;
+  bool result = false;
+
+  {
+    size_t const src_len = frames * channels * base->bytes;
+    // Pad the planes by a vector width so misaligned tails in vectorized variants stay in bounds.
+    size_t const stride = (frames + 16) & ~(size_t)15;
+    if (!OV_ALIGNED_ALLOC(&src, src_len + 64, sizeof(uint8_t), 64) ||
+        !OV_ALIGNED_ALLOC(&ref_buf, stride * channels, sizeof(float), 64) ||
+        !OV_ALIGNED_ALLOC(&out_buf, stride * channels, sizeof(float), 64)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    uint64_t rng = UINT64_C(0x9e3779b97f4a7c15);
+    fill(src, src_len, base->fill, &rng);
+
+    float *ref[max_channels];
+    float *out[max_channels];
+    for (size_t c = 0; c < channels; ++c) {
+      ref[c] = ref_buf + c * stride;
+      out[c] = out_buf + c * stride;
+    }
+    base->scalar(src, ref, channels, frames);
+
+    double scalar_ns = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+      struct variant const *const k = &variants[i];
+      memset(out_buf, 0, stride * channels * sizeof(float));
+      k->fn(src, out, channels, frames);
+      bool const matches = same_output(ref, out, channels, frames);
+
+      struct measurement const m = measure(opts, k, src, out, channels, frames);
+      double const ns_per_call = (double)m.ns / (double)m.calls;
+      double const samples = (double)(frames * channels);
+      if (i == 0) {
+        scalar_ns = ns_per_call;
+      }
+
+      fprintf(fp, "%s\n    {\"kernel\": ", *first ? "" : ",");
+      bench_util_json_string(fp, base->name);
+      fprintf(fp, ", \"variant\": ");
+      bench_util_json_string(fp, k->name);
+      fprintf(fp,
+              ", \"channels\": %zu, \"frames\": %zu, \"calls\": %zu,\n"
+              "     \"ns_per_call\": %.2f, \"input_gb_per_sec\": %.3f, \"output_gb_per_sec\": %.3f, "
+              "\"samples_per_sec\": %.0f,\n"
+              "     \"cycles_per_sample\": ",
+              channels,
+              frames,
+              m.calls,
+              ns_per_call,
+              (double)src_len / ns_per_call,
+              samples * (double)sizeof(float) / ns_per_call,
+              samples / ns_per_call * 1e9);
+      if (m.cycles) {
+        fprintf(fp, "%.3f", (double)m.cycles / (double)m.calls / samples);
+      } else {
+        fprintf(fp, "null");
+      }
+      fprintf(fp,
+              ", \"speedup_vs_scalar\": %.3f, \"matches_scalar\": %s}",
+              scalar_ns / ns_per_call,
+              matches ? "true" : "false");
+      fflush(fp);
+      *first = false;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (out_buf) {
+    OV_ALIGNED_FREE(&out_buf);
+  }
+  if (ref_buf) {
+    OV_ALIGNED_FREE(&ref_buf);
+  }
+  if (src) {
+    OV_ALIGNED_FREE(&src);
+  }
+  return result;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: bench_ovl_wav_kernels [options]\n"
+          "  --filter <name>       run only kernels whose name contains name (e.g. i24)\n"
+          "  --output <path>       write JSON to path instead of stdout\n"
+          "  --min-time-ms <n>     minimum duration of one repetition (default 20)\n");
+}
+
+int main(int argc, char **argv) {
+  struct options opts = {
+      .min_time_ns = UINT64_C(20000000),
+  };
+  for (int i = 1; i < argc; ++i) {
+    char const *const a = argv[i];
+    char const *const v = i + 1 < argc ? argv[i + 1] : NULL;
+    bool ok = v != NULL;
+    if (ok && strcmp(a, "--filter") == 0) {
+      opts.filter = v;
+    } else if (ok && strcmp(a, "--output") == 0) {
+      opts.output = v;
+    } else if (ok && strcmp(a, "--min-time-ms") == 0) {
+      char *end = NULL;
+      unsigned long long const n = strtoull(v, &end, 10);
+      ok = *v && !*end && n > 0;
+      opts.min_time_ns = (uint64_t)n * UINT64_C(1000000);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage();
+      return 2;
+    }
+    ++i;
+  }
+
+  struct ov_error err = {0};
+  FILE *fp = stdout;
+  bool first = true;
+  int exit_code = 1;
+  if (opts.output) {
+    fp = fopen(opts.output, "w");
+    if (!fp) {
+      fprintf(stderr, "failed to open %s\n", opts.output);
+      return 1;
+    }
+  }
+  fprintf(fp, "{\n  \"schema\": 1,\n  \"results\": [");
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i) {
+    struct kernel const *const k = &kernels[i];
+    if (opts.filter && !strstr(k->name, opts.filter)) {
+      continue;
+    }
+    struct variant variants[max_variants] = {{"scalar", k->scalar}};
+    size_t count = 1;
+    for (size_t j = 0; k->simd_offset != NO_SIMD && j < sizeof(isas) / sizeof(isas[0]); ++j) {
+      struct wav_kernels const *const table = wav_kernel_get(isas[j].isa);
+      if (table) {
+        variants[count].name = isas[j].name;
+        memcpy(&variants[count].fn, (char const *)table + k->simd_offset, sizeof(wav_kernel_func));
+        ++count;
+      }
+    }
+    for (size_t c = 0; c < sizeof(channel_counts) / sizeof(channel_counts[0]); ++c) {
+      for (size_t f = 0; f < sizeof(frame_counts) / sizeof(frame_counts[0]); ++f) {
+        if (!run_kernel(&opts, k, variants, count, channel_counts[c], frame_counts[f], fp, &first, &err)) {
+          OV_ERROR_REPORT(&err, NULL);
+          goto cleanup;
+        }
+      }
+    }
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  exit_code = 0;
+
+cleanup:
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return exit_code;
+}
@@ -0,0 +1,134 @@
+#include <ovtest.h>
+
+#include "wav_kernel.h"
+
+#include <string.h>
+
+struct format {
+  char const *name;
+  size_t offset;
+  size_t bytes;
+  bool is_float;
+  bool big_endian;
+};
+
+static struct format const formats[] = {
+    {"i16le", offsetof(struct wav_kernels, i16le), 2, false, false},
+    {"i16be", offsetof(struct wav_kernels, i16be), 2, false, true},
+    {"i24le", offsetof(struct wav_kernels, i24le), 3, false, false},
+    {"i24be", offsetof(struct wav_kernels, i24be), 3, false, true},
+    {"i32le", offsetof(struct wav_kernels, i32le), 4, false, false},
+    {"i32be", offsetof(struct wav_kernels, i32be), 4, false, true},
+    {"f32le", offsetof(struct wav_kernels, f32le), 4, true, false},
+    {"f32be", offsetof(struct wav_kernels, f32be), 4, true, true},
+    {"f64le", offsetof(struct wav_kernels, f64le), 8, true, false},
+    {"f64be", offsetof(struct wav_kernels, f64be), 8, true, true},
+};
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+static wav_kernel_func get_func(struct wav_kernels const *const k, struct format const *const f) {
+  wav_kernel_func fn;
+  memcpy(&fn, (char const *)k + f->offset, sizeof(fn));
+  return fn;
+}
+
+static uint64_t next_rand(uint64_t *const state) {
+  *state = *state * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+  return *state >> 11;
+}
+
+// Integer formats use raw random bytes so every bit pattern including the extremes is covered,
+// float formats use finite values in [-2, 2).
+static void fill(uint8_t *const p, size_t const values, struct format const *const f, uint64_t *const rng) {
+  for (size_t i = 0; i < values; ++i) {
+    uint8_t bytes[8];
+    if (!f->is_float) {
+      for (size_t b = 0; b < f->bytes; ++b) {
+        bytes[b] = (uint8_t)next_rand(rng);
+      }
+    } else {
+      double const v = (double)next_rand(rng) / 9007199254740992.0 * 4.0 - 2.0;
+      if (f->bytes == 4) {
+        float const x = (float)v;
+        memcpy(bytes, &x, 4);
+      } else {
+        memcpy(bytes, &v, 8);
+      }
+      if (f->big_endian) {
+        for (size_t b = 0; b < f->bytes / 2; ++b) {
+          uint8_t const t = bytes[b];
+          bytes[b] = bytes[f->bytes - 1 - b];
+          bytes[f->bytes - 1 - b] = t;
+        }
+      }
+    }
+    memcpy(p + i * f->bytes, bytes, f->bytes);
+  }
+}
+
+static void matches_scalar(void) {
+  enum {
+    max_channels = 9,
+    max_samples = 5000,
+  };
+  static size_t const sample_counts[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 100, 1023, max_samples};
+  struct wav_kernels const *const scalar = wav_kernel_get(kernel_isa_scalar);
+  if (!TEST_CHECK(scalar != NULL)) {
+    return;
+  }
+  TEST_CHECK(wav_kernel_get_best() != NULL);
+
+  static uint8_t src[max_samples * max_channels * 8];
+  static float ref_buf[max_channels][max_samples];
+  static float out_buf[max_channels][max_samples];
+  float *ref[max_channels];
+  float *out[max_channels];
+  for (size_t c = 0; c < max_channels; ++c) {
+    ref[c] = ref_buf[c];
+    out[c] = out_buf[c];
+  }
+
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    struct wav_kernels const *const k = wav_kernel_get(isas[i].isa);
+    if (!k) {
+      TEST_MSG("%s is not available", isas[i].name);
+      continue;
+    }
+    for (size_t fi = 0; fi < sizeof(formats) / sizeof(formats[0]); ++fi) {
+      struct format const *const f = &formats[fi];
+      for (size_t channels = 1; channels <= max_channels; ++channels) {
+        for (size_t si = 0; si < sizeof(sample_counts) / sizeof(sample_counts[0]); ++si) {
+          size_t const samples = sample_counts[si];
+          uint64_t rng = (uint64_t)(fi * 131 + channels * 17 + si);
+          fill(src, samples * channels, f, &rng);
+          memset(ref_buf, 0, sizeof(ref_buf));
+          memset(out_buf, 0x55, sizeof(out_buf));
+          get_func(scalar, f)(src, ref, channels, samples);
+          get_func(k, f)(src, out, channels, samples);
+          bool ok = true;
+          for (size_t c = 0; c < channels && ok; ++c) {
+            ok = memcmp(ref[c], out[c], samples * sizeof(float)) == 0;
+          }
+          if (!TEST_CHECK(ok)) {
+            TEST_MSG("%s %s channels=%zu samples=%zu differs from scalar", isas[i].name, f->name, channels, samples);
+            return;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_LIST = {
+    {"matches_scalar", matches_scalar},
+    {NULL, NULL},
+};
@@ -0,0 +1,47 @@
+#include "kernel.h"
+
+#include <ovl/os.h>
+
+enum kernel_isa const kernel_isa_preference[kernel_isa_count] = {
+    kernel_isa_avx2,
+    kernel_isa_sse2,
+    kernel_isa_neon,
+    kernel_isa_simd128,
+    kernel_isa_scalar,
+};
+
+bool kernel_isa_supported(enum kernel_isa const isa) {
+  switch (isa) {
+  case kernel_isa_scalar:
+    return true;
+  case kernel_isa_sse2:
+    return (ovl_os_get_cpu_features() & ovl_os_cpu_feature_sse2) != 0;
+  case kernel_isa_avx2:
+    return (ovl_os_get_cpu_features() & ovl_os_cpu_feature_avx2) != 0;
+  case kernel_isa_neon:
+    return (ovl_os_get_cpu_features() & ovl_os_cpu_feature_neon) != 0;
+  case kernel_isa_simd128:
+    return (ovl_os_get_cpu_features() & ovl_os_cpu_feature_simd128) != 0;
+  case kernel_isa_count:
+    break;
+  }
+  return false;
+}
+
+char const *kernel_isa_name(enum kernel_isa const isa) {
+  switch (isa) {
+  case kernel_isa_scalar:
+    return "scalar";
+  case kernel_isa_sse2:
+    return "sse2";
+  case kernel_isa_avx2:
+    return "avx2";
+  case kernel_isa_neon:
+    return "neon";
+  case kernel_isa_simd128:
+    return "simd128";
+  case kernel_isa_count:
+    break;
+  }
+  return "unknown";
+}
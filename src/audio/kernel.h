@@ -0,0 +1,40 @@
+#pragma once
+
+#include <ovbase.h>
+
+/**
+ * @brief Instruction sets the audio kernels are compiled for.
+ *
+ * Each kernel family (PCM conversion in wav_kernel and flac_kernel, deinterleave, reverse_copy,
+ * varispeed_kernel, mixer_kernel, loudness_kernel, silence_kernel) keeps a function-pointer table per instruction
+ * set, indexed by this enum, and picks one with kernel_isa_supported and kernel_isa_preference. Detection happens
+ * once, in ovl_os_get_cpu_features, so the OVL_CPU_FEATURES override applies to every family at the same time.
+ *
+ * kernel_isa_simd128 is WebAssembly SIMD, which has no runtime detection; its kernels are only compiled in
+ * when the module is built with -msimd128.
+ */
+enum kernel_isa {
+  kernel_isa_scalar,
+  kernel_isa_sse2,
+  kernel_isa_avx2,
+  kernel_isa_neon,
+  kernel_isa_simd128,
+  kernel_isa_count,
+};
+
+/**
+ * @brief Instruction sets from fastest to slowest, ending with kernel_isa_scalar.
+ */
+extern enum kernel_isa const kernel_isa_preference[kernel_isa_count];
+
+/**
+ * @brief Reports whether the running CPU supports the instruction set.
+ * kernel_isa_scalar is always supported. Whether a family has a kernel compiled for the instruction set
+ * is up to the family; a supported instruction set may still have no table on this target.
+ */
+bool kernel_isa_supported(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the name of the instruction set, such as "avx2".
+ */
+char const *kernel_isa_name(enum kernel_isa const isa);
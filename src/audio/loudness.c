@@ -0,0 +1,473 @@
+#include <ovl/audio/loudness.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+#include <ovl/os.h>
+
+#include <math.h>
+#include <ovthreads.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "loudness_kernel.h"
+
+// The stream is cut into 100 ms sub-blocks, and only the K-weighted energy of each sub-block is kept.
+// The 400 ms gating blocks of BS.1770, which overlap by 75 %, and the 3 s short-term windows of Tech 3342
+// are sums of consecutive sub-blocks, so both measurements come out of the same list at the end.
+// The true peak runs alongside on the unweighted samples; each channel keeps the last samples of the previous
+// chunk in front of the next one as the history of the oversampling filter.
+
+enum {
+  max_weighted_channels = 8,
+  peak_chunk = 1024,
+  history = loudness_true_peak_taps - 1,
+  gating_subs = 4,
+  short_term_subs = 30,
+  min_sample_rate = 8000,
+};
+
+#define SURROUND 1.41
+
+// Channel weights of BS.1770 by channel count, in the same layouts as decoder_remix.
+static double const wave_weights[max_weighted_channels][max_weighted_channels] = {
+    {1.0},
+    {1.0, 1.0},
+    {1.0, 1.0, 1.0},
+    {1.0, 1.0, SURROUND, SURROUND},
+    {1.0, 1.0, 1.0, SURROUND, SURROUND},
+    {1.0, 1.0, 1.0, 0.0, SURROUND, SURROUND},
+    {1.0, 1.0, 1.0, 0.0, SURROUND, SURROUND, SURROUND},
+    {1.0, 1.0, 1.0, 0.0, SURROUND, SURROUND, SURROUND, SURROUND},
+};
+
+static double const vorbis_weights[max_weighted_channels][max_weighted_channels] = {
+    {1.0},
+    {1.0, 1.0},
+    {1.0, 1.0, 1.0},
+    {1.0, 1.0, SURROUND, SURROUND},
+    {1.0, 1.0, 1.0, SURROUND, SURROUND},
+    {1.0, 1.0, 1.0, SURROUND, SURROUND, 0.0},
+    {1.0, 1.0, 1.0, SURROUND, SURROUND, SURROUND, 0.0},
+    {1.0, 1.0, 1.0, SURROUND, SURROUND, SURROUND, SURROUND, 0.0},
+};
+
+struct analyzer {
+  struct loudness_kernels const *kernels;
+  size_t channels;
+  size_t sub_len;
+  double coef[10];
+  double *state;
+  double *weights;
+  double *energy;
+  // history + peak_chunk samples per channel.
+  float *peak_buf;
+  size_t sub_filled;
+  // Weighted energy of every complete sub-block.
+  double *subs;
+  size_t subs_len;
+  size_t subs_cap;
+  float sample_peak;
+  float true_peak;
+};
+
+struct pool {
+  struct ovl_audio_loudness_batch const *batch;
+  size_t count;
+  struct ovl_audio_loudness *results;
+  bool *succeeded;
+  atomic_size_t next;
+};
+
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+
+static int compare_double(void const *const a, void const *const b) {
+  double const x = *(double const *)a;
+  double const y = *(double const *)b;
+  return (x > y) - (x < y);
+}
+
+static double to_lufs(double const mean_square) { return -0.691 + 10.0 * log10(mean_square); }
+
+static double from_lufs(double const lufs) { return pow(10.0, (lufs + 0.691) / 10.0); }
+
+/**
+ * The K-weighting filters of BS.1770 redesigned for the sample rate; at 48 kHz they match the
+ * coefficients in the recommendation.
+ */
+static void kweight_coefficients(double const sample_rate, double *const coef) {
+  double const pi = 3.14159265358979323846;
+
+  double k = tan(pi * 1681.974450955533 / sample_rate);
+  double q = 0.7071752369554196;
+  double const vh = pow(10.0, 3.999843853973347 / 20.0);
+  double const vb = pow(vh, 0.4996667741545416);
+  double a0 = 1.0 + k / q + k * k;
+  coef[0] = (vh + vb * k / q + k * k) / a0;
+  coef[1] = 2.0 * (k * k - vh) / a0;
+  coef[2] = (vh - vb * k / q + k * k) / a0;
+  coef[3] = 2.0 * (k * k - 1.0) / a0;
+  coef[4] = (1.0 - k / q + k * k) / a0;
+
+  k = tan(pi * 38.13547087602444 / sample_rate);
+  q = 0.5003270373238773;
+  a0 = 1.0 + k / q + k * k;
+  coef[5] = 1.0;
+  coef[6] = -2.0;
+  coef[7] = 1.0;
+  coef[8] = 2.0 * (k * k - 1.0) / a0;
+  coef[9] = (1.0 - k / q + k * k) / a0;
+}
+
+static void analyzer_free(struct analyzer *const a) {
+  if (a->subs) {
+    OV_FREE(&a->subs);
+  }
+  if (a->peak_buf) {
+    OV_FREE(&a->peak_buf);
+  }
+  if (a->energy) {
+    OV_FREE(&a->energy);
+  }
+  if (a->weights) {
+    OV_FREE(&a->weights);
+  }
+  if (a->state) {
+    OV_FREE(&a->state);
+  }
+}
+
+static NODISCARD bool analyzer_init(struct analyzer *const a,
+                                    struct ovl_audio_info const *const info,
+                                    enum ovl_audio_decoder_remix_order const order,
+                                    struct ov_error *const err) {
+  size_t const channels = info->channels;
+  bool result = false;
+
+  {
+    if (!channels || info->sample_rate < min_sample_rate) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+      goto cleanup;
+    }
+    *a = (struct analyzer){
+        .kernels = loudness_kernel_get_best(),
+        .channels = channels,
+        .sub_len = (info->sample_rate + 5) / 10,
+    };
+    kweight_coefficients((double)info->sample_rate, a->coef);
+    if (!OV_REALLOC(&a->state, channels * 4, sizeof(double)) ||
+        !OV_REALLOC(&a->weights, channels, sizeof(double)) || !OV_REALLOC(&a->energy, channels, sizeof(double)) ||
+        !OV_REALLOC(&a->peak_buf, channels * (history + peak_chunk), sizeof(float))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memset(a->state, 0, channels * 4 * sizeof(double));
+    memset(a->energy, 0, channels * sizeof(double));
+    memset(a->peak_buf, 0, channels * (history + peak_chunk) * sizeof(float));
+    for (size_t ch = 0; ch < channels; ++ch) {
+      a->weights[ch] = channels > max_weighted_channels                ? 1.0
+                       : order == ovl_audio_decoder_remix_order_vorbis ? vorbis_weights[channels - 1][ch]
+                                                                       : wave_weights[channels - 1][ch];
+    }
+  }
+  result = true;
+
+cleanup:
+  if (!result) {
+    analyzer_free(a);
+  }
+  return result;
+}
+
+static NODISCARD bool end_sub_block(struct analyzer *const a, struct ov_error *const err) {
+  if (a->subs_len == a->subs_cap) {
+    size_t const cap = a->subs_cap ? a->subs_cap * 2 : 1024;
+    if (!OV_REALLOC(&a->subs, cap, sizeof(double))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      return false;
+    }
+    a->subs_cap = cap;
+  }
+  double sum = 0.0;
+  for (size_t ch = 0; ch < a->channels; ++ch) {
+    sum += a->weights[ch] * a->energy[ch];
+    a->energy[ch] = 0.0;
+  }
+  a->subs[a->subs_len++] = sum;
+  // After a loud passage the filters decay towards denormals during silence, which are slow on most CPUs.
+  // Anything this small is far below what a 32-bit float sample can express anyway.
+  for (size_t i = 0; i < a->channels * 4; ++i) {
+    if (fabs(a->state[i]) < 1e-30) {
+      a->state[i] = 0.0;
+    }
+  }
+  a->sub_filled = 0;
+  return true;
+}
+
+static NODISCARD bool analyzer_feed(struct analyzer *const a,
+                                    float const *const *const pcm,
+                                    size_t const n,
+                                    struct ov_error *const err) {
+  size_t off = 0;
+  while (off < n) {
+    size_t const span = min2(min2(n - off, a->sub_len - a->sub_filled), peak_chunk);
+    a->kernels->kweight(a->coef, a->state, pcm, a->channels, off, span, a->energy);
+    for (size_t ch = 0; ch < a->channels; ++ch) {
+      float *const buf = a->peak_buf + ch * (history + peak_chunk);
+      float const *const src = pcm[ch] + off;
+      float peak = a->sample_peak;
+      for (size_t i = 0; i < span; ++i) {
+        float const v = fabsf(src[i]);
+        peak = v > peak ? v : peak;
+      }
+      a->sample_peak = peak;
+      memcpy(buf + history, src, span * sizeof(float));
+      a->true_peak = a->kernels->true_peak(buf + history, span, a->true_peak);
+      memmove(buf, buf + span, history * sizeof(float));
+    }
+    off += span;
+    a->sub_filled += span;
+    if (a->sub_filled == a->sub_len && !end_sub_block(a, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+  }
+  return true;
+}
+
+static double integrated_loudness(struct analyzer const *const a) {
+  if (a->subs_len < gating_subs) {
+    return -HUGE_VAL;
+  }
+  size_t const blocks = a->subs_len - gating_subs + 1;
+  double const scale = 1.0 / (double)(gating_subs * a->sub_len);
+  double const absolute = from_lufs(-70.0);
+  double sum = 0.0;
+  size_t count = 0;
+  for (size_t b = 0; b < blocks; ++b) {
+    double const e = (a->subs[b] + a->subs[b + 1] + a->subs[b + 2] + a->subs[b + 3]) * scale;
+    if (e > absolute) {
+      sum += e;
+      ++count;
+    }
+  }
+  if (!count) {
+    return -HUGE_VAL;
+  }
+  // 10 LU below the loudness of the blocks above the absolute gate.
+  double const relative = sum / (double)count * 0.1;
+  sum = 0.0;
+  count = 0;
+  for (size_t b = 0; b < blocks; ++b) {
+    double const e = (a->subs[b] + a->subs[b + 1] + a->subs[b + 2] + a->subs[b + 3]) * scale;
+    if (e > absolute && e > relative) {
+      sum += e;
+      ++count;
+    }
+  }
+  return count ? to_lufs(sum / (double)count) : -HUGE_VAL;
+}
+
+static NODISCARD bool
+loudness_range(struct analyzer const *const a, double *const range, struct ov_error *const err) {
+  double *values = NULL;
+  bool result = false;
+
+  {
+    *range = 0.0;
+    if (a->subs_len < short_term_subs) {
+      result = true;
+      goto cleanup;
+    }
+    size_t const windows = a->subs_len - short_term_subs + 1;
+    if (!OV_REALLOC(&values, windows, sizeof(double))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    double const scale = 1.0 / (double)(short_term_subs * a->sub_len);
+    double const absolute = from_lufs(-70.0);
+    double sum = 0.0;
+    size_t count = 0;
+    for (size_t w = 0; w < windows; ++w) {
+      double e = 0.0;
+      for (size_t i = 0; i < short_term_subs; ++i) {
+        e += a->subs[w + i];
+      }
+      e *= scale;
+      if (e > absolute) {
+        values[count++] = e;
+        sum += e;
+      }
+    }
+    // 20 LU below the loudness of the windows above the absolute gate.
+    double const relative = count ? sum / (double)count * 0.01 : 0.0;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (values[i] > relative) {
+        values[kept++] = values[i];
+      }
+    }
+    if (kept) {
+      qsort(values, kept, sizeof(double), compare_double);
+      double const lo = values[(size_t)((double)(kept - 1) * 0.10 + 0.5)];
+      double const hi = values[(size_t)((double)(kept - 1) * 0.95 + 0.5)];
+      *range = to_lufs(hi) - to_lufs(lo);
+    }
+  }
+  result = true;
+
+cleanup:
+  if (values) {
+    OV_FREE(&values);
+  }
+  return result;
+}
+
+NODISCARD bool ovl_audio_loudness_analyze(struct ovl_audio_decoder *const decoder,
+                                          enum ovl_audio_decoder_remix_order const order,
+                                          struct ovl_audio_loudness *const loudness,
+                                          struct ov_error *const err) {
+  if (!decoder || !loudness) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct analyzer a = {0};
+  bool initialized = false;
+  bool result = false;
+
+  {
+    if (!analyzer_init(&a, ovl_audio_decoder_get_info(decoder), order, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    initialized = true;
+    if (!ovl_audio_decoder_seek(decoder, 0, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    for (;;) {
+      float const *const *pcm = NULL;
+      size_t n = 0;
+      if (!ovl_audio_decoder_read(decoder, &pcm, &n, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      if (n == 0) {
+        break;
+      }
+      if (!analyzer_feed(&a, pcm, n, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+    double range = 0.0;
+    if (!loudness_range(&a, &range, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    *loudness = (struct ovl_audio_loudness){
+        .integrated = integrated_loudness(&a),
+        .range = range,
+        .sample_peak = (double)a.sample_peak,
+        .true_peak = (double)(a.true_peak > a.sample_peak ? a.true_peak : a.sample_peak),
+    };
+  }
+  result = true;
+
+cleanup:
+  if (initialized) {
+    analyzer_free(&a);
+  }
+  return result;
+}
+
+static void run_item(struct pool *const p, size_t const index) {
+  struct ovl_audio_loudness_batch const *const batch = p->batch;
+  struct ovl_audio_decoder *d = NULL;
+  enum ovl_audio_decoder_remix_order order = ovl_audio_decoder_remix_order_wave;
+  struct ov_error err = {0};
+  bool ok = false;
+
+  {
+    if (!batch->open(batch->userdata, index, &d, &order, &err)) {
+      OV_ERROR_ADD_TRACE(&err);
+      goto cleanup;
+    }
+    if (!ovl_audio_loudness_analyze(d, order, &p->results[index], &err)) {
+      OV_ERROR_ADD_TRACE(&err);
+      goto cleanup;
+    }
+  }
+  ok = true;
+
+cleanup:
+  if (d) {
+    batch->close(batch->userdata, index, &d);
+  }
+  if (!ok) {
+    OV_ERROR_REPORT(&err, NULL);
+  }
+  p->succeeded[index] = ok;
+}
+
+static int pool_thread(void *const userdata) {
+  struct pool *const p = (struct pool *)userdata;
+  for (;;) {
+    size_t const index = atomic_fetch_add_explicit(&p->next, 1, memory_order_relaxed);
+    if (index >= p->count) {
+      break;
+    }
+    run_item(p, index);
+  }
+  return 0;
+}
+
+NODISCARD bool ovl_audio_loudness_analyze_batch(struct ovl_audio_loudness_batch const *const batch,
+                                                size_t const count,
+                                                size_t const threads,
+                                                struct ovl_audio_loudness *const results,
+                                                bool *const succeeded,
+                                                struct ov_error *const err) {
+  if (!batch || !batch->open || !batch->close || (count && (!results || !succeeded))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct pool p = {
+      .batch = batch,
+      .count = count,
+      .results = results,
+      .succeeded = succeeded,
+  };
+  atomic_init(&p.next, 0);
+  thrd_t *workers = NULL;
+  size_t started = 0;
+  bool result = false;
+
+  {
+    size_t const n = min2(threads ? threads : ovl_os_get_cpu_count(), count);
+    if (n > 1) {
+      if (!OV_REALLOC(&workers, n - 1, sizeof(thrd_t))) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        goto cleanup;
+      }
+      // A thread that cannot be created only makes the batch slower; the calling thread always takes part.
+      while (started < n - 1 && thrd_create(&workers[started], pool_thread, &p) == thrd_success) {
+        ++started;
+      }
+    }
+    pool_thread(&p);
+  }
+  result = true;
+
+cleanup:
+  for (size_t i = 0; i < started; ++i) {
+    thrd_join(workers[i], NULL);
+  }
+  if (workers) {
+    OV_FREE(&workers);
+  }
+  return result;
+}
@@ -0,0 +1,458 @@
+#include "loudness_kernel.h"
+
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define LOUDNESS_KERNEL_X86 1
+#  include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define LOUDNESS_KERNEL_NEON 1
+#  include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#  define LOUDNESS_KERNEL_WASM 1
+#  include <wasm_simd128.h>
+#endif
+
+// The K-weighting filters are recursive, so the vector kernels run one channel per lane instead of one sample
+// per lane: two channels with 128-bit vectors and four with AVX2, which leaves nothing to spare for stereo.
+// The true-peak filter is a plain FIR and runs consecutive samples per lane, one phase at a time.
+// Contraction into fused multiply-adds is disabled so that targets with FMA round the scalar code the same way.
+#pragma STDC FP_CONTRACT OFF
+
+enum {
+  taps = loudness_true_peak_taps,
+  phases = 4,
+};
+
+// The 48-tap interpolation filter of ITU-R BS.1770-4 Annex 2, split into its four phases.
+static float const tp_coef[phases][taps] = {
+    {0.0017089843750f, 0.0109863281250f, -0.0196533203125f, 0.0332031250000f, -0.0594482421875f, 0.1373291015625f,
+     0.9721679687500f, -0.1022949218750f, 0.0476074218750f, -0.0266113281250f, 0.0148925781250f, -0.0083007812500f},
+    {-0.0291748046875f, 0.0292968750000f, -0.0517578125000f, 0.0891113281250f, -0.1665039062500f, 0.4650878906250f,
+     0.7797851562500f, -0.2003173828125f, 0.1015625000000f, -0.0582275390625f, 0.0330810546875f, -0.0189208984375f},
+    {-0.0189208984375f, 0.0330810546875f, -0.0582275390625f, 0.1015625000000f, -0.2003173828125f, 0.7797851562500f,
+     0.4650878906250f, -0.1665039062500f, 0.0891113281250f, -0.0517578125000f, 0.0292968750000f, -0.0291748046875f},
+    {-0.0083007812500f, 0.0148925781250f, -0.0266113281250f, 0.0476074218750f, -0.1022949218750f, 0.9721679687500f,
+     0.1373291015625f, -0.0594482421875f, 0.0332031250000f, -0.0196533203125f, 0.0109863281250f, 0.0017089843750f},
+};
+
+static void scalar_kweight_range(double const *const coef,
+                                 double *const state,
+                                 float const *const *const src,
+                                 size_t const first,
+                                 size_t const last,
+                                 size_t const offset,
+                                 size_t const n,
+                                 double *const energy) {
+  double const b0 = coef[0], b1 = coef[1], b2 = coef[2], a1 = coef[3], a2 = coef[4];
+  double const c0 = coef[5], c1 = coef[6], c2 = coef[7], d1 = coef[8], d2 = coef[9];
+  for (size_t ch = first; ch < last; ++ch) {
+    double *const st = state + ch * 4;
+    double z1 = st[0], z2 = st[1], z3 = st[2], z4 = st[3];
+    double e = 0.0;
+    float const *const s = src[ch] + offset;
+    for (size_t i = 0; i < n; ++i) {
+      double const x = (double)s[i];
+      double const y = b0 * x + z1;
+      z1 = b1 * x - a1 * y + z2;
+      z2 = b2 * x - a2 * y;
+      double const w = c0 * y + z3;
+      z3 = c1 * y - d1 * w + z4;
+      z4 = c2 * y - d2 * w;
+      e += w * w;
+    }
+    st[0] = z1;
+    st[1] = z2;
+    st[2] = z3;
+    st[3] = z4;
+    energy[ch] += e;
+  }
+}
+
+static void scalar_kweight(double const *const coef,
+                           double *const state,
+                           float const *const *const src,
+                           size_t const channels,
+                           size_t const offset,
+                           size_t const n,
+                           double *const energy) {
+  scalar_kweight_range(coef, state, src, 0, channels, offset, n, energy);
+}
+
+// Finishes a true-peak search from sample i0, which the vector kernels use for their tail.
+static float scalar_true_peak_from(float const *const src, size_t const i0, size_t const n, float peak) {
+  for (size_t i = i0; i < n; ++i) {
+    for (size_t p = 0; p < phases; ++p) {
+      float y = tp_coef[p][0] * src[i];
+      for (size_t t = 1; t < taps; ++t) {
+        y += tp_coef[p][t] * src[i - t];
+      }
+      float const a = fabsf(y);
+      peak = a > peak ? a : peak;
+    }
+  }
+  return peak;
+}
+
+static float scalar_true_peak(float const *const src, size_t const n, float const peak) {
+  return scalar_true_peak_from(src, 0, n, peak);
+}
+
+static struct loudness_kernels const scalar_kernels = {
+    .kweight = scalar_kweight,
+    .true_peak = scalar_true_peak,
+};
+
+#ifdef LOUDNESS_KERNEL_X86
+
+static __attribute__((target("sse2"))) void sse2_kweight_range(double const *const coef,
+                                                               double *const state,
+                                                               float const *const *const src,
+                                                               size_t const first,
+                                                               size_t const last,
+                                                               size_t const offset,
+                                                               size_t const n,
+                                                               double *const energy) {
+  __m128d const b0 = _mm_set1_pd(coef[0]), b1 = _mm_set1_pd(coef[1]), b2 = _mm_set1_pd(coef[2]);
+  __m128d const a1 = _mm_set1_pd(coef[3]), a2 = _mm_set1_pd(coef[4]);
+  __m128d const c0 = _mm_set1_pd(coef[5]), c1 = _mm_set1_pd(coef[6]), c2 = _mm_set1_pd(coef[7]);
+  __m128d const d1 = _mm_set1_pd(coef[8]), d2 = _mm_set1_pd(coef[9]);
+  size_t ch = first;
+  for (; ch + 2 <= last; ch += 2) {
+    double *const s0 = state + ch * 4;
+    double *const s1 = s0 + 4;
+    __m128d z1 = _mm_setr_pd(s0[0], s1[0]);
+    __m128d z2 = _mm_setr_pd(s0[1], s1[1]);
+    __m128d z3 = _mm_setr_pd(s0[2], s1[2]);
+    __m128d z4 = _mm_setr_pd(s0[3], s1[3]);
+    __m128d e = _mm_setzero_pd();
+    float const *const x0 = src[ch] + offset;
+    float const *const x1 = src[ch + 1] + offset;
+    for (size_t i = 0; i < n; ++i) {
+      __m128d const x = _mm_setr_pd((double)x0[i], (double)x1[i]);
+      __m128d const y = _mm_add_pd(_mm_mul_pd(b0, x), z1);
+      z1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1, x), _mm_mul_pd(a1, y)), z2);
+      z2 = _mm_sub_pd(_mm_mul_pd(b2, x), _mm_mul_pd(a2, y));
+      __m128d const w = _mm_add_pd(_mm_mul_pd(c0, y), z3);
+      z3 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(c1, y), _mm_mul_pd(d1, w)), z4);
+      z4 = _mm_sub_pd(_mm_mul_pd(c2, y), _mm_mul_pd(d2, w));
+      e = _mm_add_pd(e, _mm_mul_pd(w, w));
+    }
+    _mm_storel_pd(&s0[0], z1);
+    _mm_storeh_pd(&s1[0], z1);
+    _mm_storel_pd(&s0[1], z2);
+    _mm_storeh_pd(&s1[1], z2);
+    _mm_storel_pd(&s0[2], z3);
+    _mm_storeh_pd(&s1[2], z3);
+    _mm_storel_pd(&s0[3], z4);
+    _mm_storeh_pd(&s1[3], z4);
+    double sums[2];
+    _mm_storeu_pd(sums, e);
+    energy[ch] += sums[0];
+    energy[ch + 1] += sums[1];
+  }
+  scalar_kweight_range(coef, state, src, ch, last, offset, n, energy);
+}
+
+static __attribute__((target("sse2"))) void sse2_kweight(double const *const coef,
+                                                         double *const state,
+                                                         float const *const *const src,
+                                                         size_t const channels,
+                                                         size_t const offset,
+                                                         size_t const n,
+                                                         double *const energy) {
+  sse2_kweight_range(coef, state, src, 0, channels, offset, n, energy);
+}
+
+static __attribute__((target("sse2"))) float sse2_true_peak(float const *const src, size_t const n, float peak) {
+  __m128 const mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 m = _mm_set1_ps(peak);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (size_t p = 0; p < phases; ++p) {
+      __m128 y = _mm_mul_ps(_mm_set1_ps(tp_coef[p][0]), _mm_loadu_ps(src + i));
+      for (size_t t = 1; t < taps; ++t) {
+        y = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(tp_coef[p][t]), _mm_loadu_ps(src + i - t)));
+      }
+      // Keeps m where y is NaN, as the scalar comparison does.
+      m = _mm_max_ps(_mm_and_ps(y, mask), m);
+    }
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, m);
+  for (size_t j = 0; j < 4; ++j) {
+    peak = lanes[j] > peak ? lanes[j] : peak;
+  }
+  return scalar_true_peak_from(src, i, n, peak);
+}
+
+static __attribute__((target("avx2"))) void avx2_kweight(double const *const coef,
+                                                         double *const state,
+                                                         float const *const *const src,
+                                                         size_t const channels,
+                                                         size_t const offset,
+                                                         size_t const n,
+                                                         double *const energy) {
+  __m256d const b0 = _mm256_set1_pd(coef[0]), b1 = _mm256_set1_pd(coef[1]), b2 = _mm256_set1_pd(coef[2]);
+  __m256d const a1 = _mm256_set1_pd(coef[3]), a2 = _mm256_set1_pd(coef[4]);
+  __m256d const c0 = _mm256_set1_pd(coef[5]), c1 = _mm256_set1_pd(coef[6]), c2 = _mm256_set1_pd(coef[7]);
+  __m256d const d1 = _mm256_set1_pd(coef[8]), d2 = _mm256_set1_pd(coef[9]);
+  size_t ch = 0;
+  for (; ch + 4 <= channels; ch += 4) {
+    double *const s = state + ch * 4;
+    // state holds four values per channel, so a 4x4 transpose turns it into one vector per delay.
+    __m256d z1 = _mm256_setr_pd(s[0], s[4], s[8], s[12]);
+    __m256d z2 = _mm256_setr_pd(s[1], s[5], s[9], s[13]);
+    __m256d z3 = _mm256_setr_pd(s[2], s[6], s[10], s[14]);
+    __m256d z4 = _mm256_setr_pd(s[3], s[7], s[11], s[15]);
+    __m256d e = _mm256_setzero_pd();
+    float const *const x0 = src[ch] + offset;
+    float const *const x1 = src[ch + 1] + offset;
+    float const *const x2 = src[ch + 2] + offset;
+    float const *const x3 = src[ch + 3] + offset;
+    for (size_t i = 0; i < n; ++i) {
+      __m256d const x = _mm256_cvtps_pd(_mm_setr_ps(x0[i], x1[i], x2[i], x3[i]));
+      __m256d const y = _mm256_add_pd(_mm256_mul_pd(b0, x), z1);
+      z1 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(b1, x), _mm256_mul_pd(a1, y)), z2);
+      z2 = _mm256_sub_pd(_mm256_mul_pd(b2, x), _mm256_mul_pd(a2, y));
+      __m256d const w = _mm256_add_pd(_mm256_mul_pd(c0, y), z3);
+      z3 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(c1, y), _mm256_mul_pd(d1, w)), z4);
+      z4 = _mm256_sub_pd(_mm256_mul_pd(c2, y), _mm256_mul_pd(d2, w));
+      e = _mm256_add_pd(e, _mm256_mul_pd(w, w));
+    }
+    double v[4][4];
+    _mm256_storeu_pd(v[0], z1);
+    _mm256_storeu_pd(v[1], z2);
+    _mm256_storeu_pd(v[2], z3);
+    _mm256_storeu_pd(v[3], z4);
+    double sums[4];
+    _mm256_storeu_pd(sums, e);
+    for (size_t j = 0; j < 4; ++j) {
+      for (size_t k = 0; k < 4; ++k) {
+        s[j * 4 + k] = v[k][j];
+      }
+      energy[ch + j] += sums[j];
+    }
+  }
+  // sse2_kweight_range is not VEX encoded, so clear the upper halves first to avoid the transition penalty.
+  _mm256_zeroupper();
+  sse2_kweight_range(coef, state, src, ch, channels, offset, n, energy);
+}
+
+static __attribute__((target("avx2"))) float avx2_true_peak(float const *const src, size_t const n, float peak) {
+  __m256 const mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 m = _mm256_set1_ps(peak);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    for (size_t p = 0; p < phases; ++p) {
+      __m256 y = _mm256_mul_ps(_mm256_set1_ps(tp_coef[p][0]), _mm256_loadu_ps(src + i));
+      for (size_t t = 1; t < taps; ++t) {
+        y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_set1_ps(tp_coef[p][t]), _mm256_loadu_ps(src + i - t)));
+      }
+      m = _mm256_max_ps(_mm256_and_ps(y, mask), m);
+    }
+  }
+  float lanes[8];
+  _mm256_storeu_ps(lanes, m);
+  for (size_t j = 0; j < 8; ++j) {
+    peak = lanes[j] > peak ? lanes[j] : peak;
+  }
+  _mm256_zeroupper();
+  return sse2_true_peak(src + i, n - i, peak);
+}
+
+static struct loudness_kernels const sse2_kernels = {
+    .kweight = sse2_kweight,
+    .true_peak = sse2_true_peak,
+};
+
+static struct loudness_kernels const avx2_kernels = {
+    .kweight = avx2_kweight,
+    .true_peak = avx2_true_peak,
+};
+
+#endif // LOUDNESS_KERNEL_X86
+
+#ifdef LOUDNESS_KERNEL_NEON
+
+static void neon_kweight(double const *const coef,
+                         double *const state,
+                         float const *const *const src,
+                         size_t const channels,
+                         size_t const offset,
+                         size_t const n,
+                         double *const energy) {
+  float64x2_t const b0 = vdupq_n_f64(coef[0]), b1 = vdupq_n_f64(coef[1]), b2 = vdupq_n_f64(coef[2]);
+  float64x2_t const a1 = vdupq_n_f64(coef[3]), a2 = vdupq_n_f64(coef[4]);
+  float64x2_t const c0 = vdupq_n_f64(coef[5]), c1 = vdupq_n_f64(coef[6]), c2 = vdupq_n_f64(coef[7]);
+  float64x2_t const d1 = vdupq_n_f64(coef[8]), d2 = vdupq_n_f64(coef[9]);
+  size_t ch = 0;
+  for (; ch + 2 <= channels; ch += 2) {
+    double *const s = state + ch * 4;
+    float64x2_t z1 = vcombine_f64(vld1_f64(s + 0), vld1_f64(s + 4));
+    float64x2_t z2 = vcombine_f64(vld1_f64(s + 1), vld1_f64(s + 5));
+    float64x2_t z3 = vcombine_f64(vld1_f64(s + 2), vld1_f64(s + 6));
+    float64x2_t z4 = vcombine_f64(vld1_f64(s + 3), vld1_f64(s + 7));
+    float64x2_t e = vdupq_n_f64(0.0);
+    float const *const x0 = src[ch] + offset;
+    float const *const x1 = src[ch + 1] + offset;
+    for (size_t i = 0; i < n; ++i) {
+      double const xs[2] = {(double)x0[i], (double)x1[i]};
+      float64x2_t const x = vld1q_f64(xs);
+      float64x2_t const y = vaddq_f64(vmulq_f64(b0, x), z1);
+      z1 = vaddq_f64(vsubq_f64(vmulq_f64(b1, x), vmulq_f64(a1, y)), z2);
+      z2 = vsubq_f64(vmulq_f64(b2, x), vmulq_f64(a2, y));
+      float64x2_t const w = vaddq_f64(vmulq_f64(c0, y), z3);
+      z3 = vaddq_f64(vsubq_f64(vmulq_f64(c1, y), vmulq_f64(d1, w)), z4);
+      z4 = vsubq_f64(vmulq_f64(c2, y), vmulq_f64(d2, w));
+      e = vaddq_f64(e, vmulq_f64(w, w));
+    }
+    s[0] = vgetq_lane_f64(z1, 0);
+    s[1] = vgetq_lane_f64(z2, 0);
+    s[2] = vgetq_lane_f64(z3, 0);
+    s[3] = vgetq_lane_f64(z4, 0);
+    s[4] = vgetq_lane_f64(z1, 1);
+    s[5] = vgetq_lane_f64(z2, 1);
+    s[6] = vgetq_lane_f64(z3, 1);
+    s[7] = vgetq_lane_f64(z4, 1);
+    energy[ch] += vgetq_lane_f64(e, 0);
+    energy[ch + 1] += vgetq_lane_f64(e, 1);
+  }
+  scalar_kweight_range(coef, state, src, ch, channels, offset, n, energy);
+}
+
+static float neon_true_peak(float const *const src, size_t const n, float peak) {
+  float32x4_t m = vdupq_n_f32(peak);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (size_t p = 0; p < phases; ++p) {
+      float32x4_t y = vmulq_f32(vdupq_n_f32(tp_coef[p][0]), vld1q_f32(src + i));
+      for (size_t t = 1; t < taps; ++t) {
+        y = vaddq_f32(y, vmulq_f32(vdupq_n_f32(tp_coef[p][t]), vld1q_f32(src + i - t)));
+      }
+      // vmaxq_f32 would propagate NaN; the comparison keeps m instead, as the scalar code does.
+      float32x4_t const a = vabsq_f32(y);
+      m = vbslq_f32(vcgtq_f32(a, m), a, m);
+    }
+  }
+  float lanes[4];
+  vst1q_f32(lanes, m);
+  for (size_t j = 0; j < 4; ++j) {
+    peak = lanes[j] > peak ? lanes[j] : peak;
+  }
+  return scalar_true_peak_from(src, i, n, peak);
+}
+
+static struct loudness_kernels const neon_kernels = {
+    .kweight = neon_kweight,
+    .true_peak = neon_true_peak,
+};
+
+#endif // LOUDNESS_KERNEL_NEON
+
+#ifdef LOUDNESS_KERNEL_WASM
+
+static void simd128_kweight(double const *const coef,
+                            double *const state,
+                            float const *const *const src,
+                            size_t const channels,
+                            size_t const offset,
+                            size_t const n,
+                            double *const energy) {
+  v128_t const b0 = wasm_f64x2_splat(coef[0]), b1 = wasm_f64x2_splat(coef[1]), b2 = wasm_f64x2_splat(coef[2]);
+  v128_t const a1 = wasm_f64x2_splat(coef[3]), a2 = wasm_f64x2_splat(coef[4]);
+  v128_t const c0 = wasm_f64x2_splat(coef[5]), c1 = wasm_f64x2_splat(coef[6]), c2 = wasm_f64x2_splat(coef[7]);
+  v128_t const d1 = wasm_f64x2_splat(coef[8]), d2 = wasm_f64x2_splat(coef[9]);
+  size_t ch = 0;
+  for (; ch + 2 <= channels; ch += 2) {
+    double *const s0 = state + ch * 4;
+    double *const s1 = s0 + 4;
+    v128_t z1 = wasm_f64x2_make(s0[0], s1[0]);
+    v128_t z2 = wasm_f64x2_make(s0[1], s1[1]);
+    v128_t z3 = wasm_f64x2_make(s0[2], s1[2]);
+    v128_t z4 = wasm_f64x2_make(s0[3], s1[3]);
+    v128_t e = wasm_f64x2_splat(0.0);
+    float const *const x0 = src[ch] + offset;
+    float const *const x1 = src[ch + 1] + offset;
+    for (size_t i = 0; i < n; ++i) {
+      v128_t const x = wasm_f64x2_make((double)x0[i], (double)x1[i]);
+      v128_t const y = wasm_f64x2_add(wasm_f64x2_mul(b0, x), z1);
+      z1 = wasm_f64x2_add(wasm_f64x2_sub(wasm_f64x2_mul(b1, x), wasm_f64x2_mul(a1, y)), z2);
+      z2 = wasm_f64x2_sub(wasm_f64x2_mul(b2, x), wasm_f64x2_mul(a2, y));
+      v128_t const w = wasm_f64x2_add(wasm_f64x2_mul(c0, y), z3);
+      z3 = wasm_f64x2_add(wasm_f64x2_sub(wasm_f64x2_mul(c1, y), wasm_f64x2_mul(d1, w)), z4);
+      z4 = wasm_f64x2_sub(wasm_f64x2_mul(c2, y), wasm_f64x2_mul(d2, w));
+      e = wasm_f64x2_add(e, wasm_f64x2_mul(w, w));
+    }
+    s0[0] = wasm_f64x2_extract_lane(z1, 0);
+    s1[0] = wasm_f64x2_extract_lane(z1, 1);
+    s0[1] = wasm_f64x2_extract_lane(z2, 0);
+    s1[1] = wasm_f64x2_extract_lane(z2, 1);
+    s0[2] = wasm_f64x2_extract_lane(z3, 0);
+    s1[2] = wasm_f64x2_extract_lane(z3, 1);
+    s0[3] = wasm_f64x2_extract_lane(z4, 0);
+    s1[3] = wasm_f64x2_extract_lane(z4, 1);
+    energy[ch] += wasm_f64x2_extract_lane(e, 0);
+    energy[ch + 1] += wasm_f64x2_extract_lane(e, 1);
+  }
+  scalar_kweight_range(coef, state, src, ch, channels, offset, n, energy);
+}
+
+static float simd128_true_peak(float const *const src, size_t const n, float peak) {
+  v128_t m = wasm_f32x4_splat(peak);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (size_t p = 0; p < phases; ++p) {
+      v128_t y = wasm_f32x4_mul(wasm_f32x4_splat(tp_coef[p][0]), wasm_v128_load(src + i));
+      for (size_t t = 1; t < taps; ++t) {
+        y = wasm_f32x4_add(y, wasm_f32x4_mul(wasm_f32x4_splat(tp_coef[p][t]), wasm_v128_load(src + i - t)));
+      }
+      // pmax is m < a ? a : m, which keeps m where a is NaN.
+      m = wasm_f32x4_pmax(m, wasm_f32x4_abs(y));
+    }
+  }
+  float lanes[4];
+  wasm_v128_store(lanes, m);
+  for (size_t j = 0; j < 4; ++j) {
+    peak = lanes[j] > peak ? lanes[j] : peak;
+  }
+  return scalar_true_peak_from(src, i, n, peak);
+}
+
+static struct loudness_kernels const simd128_kernels = {
+    .kweight = simd128_kweight,
+    .true_peak = simd128_true_peak,
+};
+
+#endif // LOUDNESS_KERNEL_WASM
+
+static struct loudness_kernels const *const tables[kernel_isa_count] = {
+    [kernel_isa_scalar] = &scalar_kernels,
+#ifdef LOUDNESS_KERNEL_X86
+    [kernel_isa_sse2] = &sse2_kernels,
+    [kernel_isa_avx2] = &avx2_kernels,
+#endif
+#ifdef LOUDNESS_KERNEL_NEON
+    [kernel_isa_neon] = &neon_kernels,
+#endif
+#ifdef LOUDNESS_KERNEL_WASM
+    [kernel_isa_simd128] = &simd128_kernels,
+#endif
+};
+
+struct loudness_kernels const *loudness_kernel_get(enum kernel_isa const isa) {
+  if ((size_t)isa >= kernel_isa_count || !kernel_isa_supported(isa)) {
+    return NULL;
+  }
+  return tables[isa];
+}
+
+struct loudness_kernels const *loudness_kernel_get_best(void) {
+  for (size_t i = 0; i < kernel_isa_count; ++i) {
+    struct loudness_kernels const *const k = loudness_kernel_get(kernel_isa_preference[i]);
+    if (k) {
+      return k;
+    }
+  }
+  return &scalar_kernels;
+}
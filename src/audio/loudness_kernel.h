@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "kernel.h"
+
+enum {
+  /**
+   * @brief Taps of each phase of the true-peak oversampling filter.
+   * The true-peak kernel reads this many samples minus one before the first one it is given.
+   */
+  loudness_true_peak_taps = 12,
+};
+
+/**
+ * @brief Runs channels through the K-weighting filter of ITU-R BS.1770 and sums the squares of the output.
+ * The filter is a high shelf followed by a high-pass, both biquads in transposed direct form II.
+ * @param coef b0, b1, b2, a1, a2 of the shelf, then of the high-pass, normalized to a0 = 1.
+ * @param state Four values per channel: the two delays of the shelf, then of the high-pass. Updated.
+ * @param src Channel planes.
+ * @param channels Number of channels.
+ * @param offset First sample to read from every plane.
+ * @param n Number of samples per channel.
+ * @param energy Sum of squares per channel; the sum of this call is added to it.
+ */
+typedef void (*loudness_kweight_func)(double const *const coef,
+                                      double *const state,
+                                      float const *const *const src,
+                                      size_t const channels,
+                                      size_t const offset,
+                                      size_t const n,
+                                      double *const energy);
+
+/**
+ * @brief Upsamples a channel four times with the interpolation filter of ITU-R BS.1770 and finds its peak.
+ * @param src Samples, preceded by loudness_true_peak_taps - 1 samples of history.
+ * @param n Number of samples.
+ * @param peak The peak so far.
+ * @return The larger of peak and the highest absolute value of the 4 * n interpolated samples.
+ * NaN samples are ignored.
+ */
+typedef float (*loudness_true_peak_func)(float const *const src, size_t const n, float const peak);
+
+/**
+ * @brief Loudness kernels for one instruction set.
+ * Every variant produces bit-identical output to the scalar kernels.
+ */
+struct loudness_kernels {
+  loudness_kweight_func kweight;
+  loudness_true_peak_func true_peak;
+};
+
+/**
+ * @brief Returns the kernels for the given instruction set.
+ * @return The kernels, or NULL if the instruction set is not compiled in or not supported by the running CPU.
+ */
+struct loudness_kernels const *loudness_kernel_get(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the fastest kernels supported by the running CPU.
+ */
+struct loudness_kernels const *loudness_kernel_get_best(void);
@@ -0,0 +1,234 @@
+#include "../bench_util.h"
+
+#include "loudness_kernel.h"
+
+#include <string.h>
+
+// Measures the two loudness kernels over one 100 ms sub-block at 48 kHz, the unit the analyzer feeds them in:
+// K-weighting of every channel, then the true peak of every channel. realtime is how many times faster than
+// playback one core gets through the audio.
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"scalar", kernel_isa_scalar},
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+// Stereo and 5.1.
+static size_t const channel_counts[] = {2, 6};
+
+enum {
+  max_channels = 6,
+  sample_rate = 48000,
+  samples = sample_rate / 10,
+  history = loudness_true_peak_taps - 1,
+  max_variants = kernel_isa_count,
+  repetitions = 5,
+};
+
+// The K-weighting filters at 48 kHz as listed in BS.1770.
+static double const coef48k[10] = {
+    1.53512485958697,
+    -2.69169618940638,
+    1.19839281085285,
+    -1.69065929318241,
+    0.73248077421585,
+    1.0,
+    -2.0,
+    1.0,
+    -1.99004745483398,
+    0.99007225036621,
+};
+
+struct variant {
+  char const *name;
+  struct loudness_kernels const *k;
+};
+
+struct options {
+  char const *output;
+  uint64_t min_time_ns;
+};
+
+struct measurement {
+  uint64_t ns;
+  uint64_t cycles;
+  size_t calls;
+};
+
+struct result {
+  double state[max_channels * 4];
+  double energy[max_channels];
+  float peak[max_channels];
+};
+
+static float src[max_channels][history + samples];
+
+static void process(struct loudness_kernels const *const k,
+                    float const *const *const planes,
+                    size_t const channels,
+                    struct result *const r) {
+  k->kweight(coef48k, r->state, planes, channels, history, samples, r->energy);
+  for (size_t ch = 0; ch < channels; ++ch) {
+    r->peak[ch] = k->true_peak(planes[ch] + history, samples, r->peak[ch]);
+  }
+}
+
+static struct measurement measure(struct options const *const opts,
+                                  struct loudness_kernels const *const k,
+                                  float const *const *const planes,
+                                  size_t const channels) {
+  struct result r = {0};
+  // Calibrate the number of calls so one repetition takes at least min_time_ns.
+  size_t calls = 1;
+  for (;;) {
+    uint64_t const t0 = bench_util_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+      process(k, planes, channels, &r);
+    }
+    uint64_t const elapsed = bench_util_now_ns() - t0;
+    if (elapsed >= opts->min_time_ns || calls >= SIZE_MAX / 2) {
+      break;
+    }
+    calls *= 2;
+  }
+  struct measurement best = {.ns = UINT64_MAX, .calls = calls};
+  for (size_t rep = 0; rep < repetitions; ++rep) {
+    uint64_t const c0 = bench_util_cycles();
+    uint64_t const t0 = bench_util_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+      process(k, planes, channels, &r);
+    }
+    uint64_t const elapsed = bench_util_now_ns() - t0;
+    uint64_t const cycles = bench_util_cycles() - c0;
+    if (elapsed < best.ns) {
+      best.ns = elapsed;
+      best.cycles = cycles;
+    }
+  }
+  bench_util_consume((float)r.energy[0] + r.peak[0]);
+  return best;
+}
+
+static void run(struct options const *const opts,
+                struct variant const *const variants,
+                size_t const count,
+                size_t const channels,
+                FILE *const fp,
+                bool *const first) {
+  float const *planes[max_channels];
+  for (size_t ch = 0; ch < max_channels; ++ch) {
+    planes[ch] = src[ch];
+  }
+  struct result ref = {0};
+  process(variants[0].k, planes, channels, &ref);
+
+  double scalar_ns = 0.0;
+  for (size_t i = 0; i < count; ++i) {
+    struct variant const *const v = &variants[i];
+    struct result out = {0};
+    process(v->k, planes, channels, &out);
+    bool const matches = memcmp(&ref, &out, sizeof(ref)) == 0;
+
+    struct measurement const m = measure(opts, v->k, planes, channels);
+    double const ns_per_call = (double)m.ns / (double)m.calls;
+    if (i == 0) {
+      scalar_ns = ns_per_call;
+    }
+
+    fprintf(fp, "%s\n    {\"kernel\": \"loudness\", \"variant\": ", *first ? "" : ",");
+    bench_util_json_string(fp, v->name);
+    fprintf(fp,
+            ", \"channels\": %zu, \"samples\": %d, \"calls\": %zu,\n"
+            "     \"ns_per_call\": %.1f, \"realtime\": %.0f, \"cycles_per_channel_sample\": ",
+            channels,
+            samples,
+            m.calls,
+            ns_per_call,
+            1e8 / ns_per_call);
+    if (m.cycles) {
+      fprintf(fp, "%.3f", (double)m.cycles / (double)m.calls / (double)(samples * channels));
+    } else {
+      fprintf(fp, "null");
+    }
+    fprintf(fp,
+            ", \"speedup_vs_scalar\": %.3f, \"matches_scalar\": %s}",
+            scalar_ns / ns_per_call,
+            matches ? "true" : "false");
+    fflush(fp);
+    *first = false;
+  }
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: bench_ovl_loudness_kernels [options]\n"
+          "  --output <path>       write JSON to path instead of stdout\n"
+          "  --min-time-ms <n>     minimum duration of one repetition (default 20)\n");
+}
+
+int main(int argc, char **argv) {
+  struct options opts = {
+      .min_time_ns = UINT64_C(20000000),
+  };
+  for (int i = 1; i < argc; ++i) {
+    char const *const a = argv[i];
+    char const *const v = i + 1 < argc ? argv[i + 1] : NULL;
+    bool ok = v != NULL;
+    if (ok && strcmp(a, "--output") == 0) {
+      opts.output = v;
+    } else if (ok && strcmp(a, "--min-time-ms") == 0) {
+      char *end = NULL;
+      unsigned long long const n = strtoull(v, &end, 10);
+      ok = *v && !*end && n > 0;
+      opts.min_time_ns = (uint64_t)n * UINT64_C(1000000);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage();
+      return 2;
+    }
+    ++i;
+  }
+
+  struct variant variants[max_variants];
+  size_t count = 0;
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    struct loudness_kernels const *const k = loudness_kernel_get(isas[i].isa);
+    if (k) {
+      variants[count++] = (struct variant){isas[i].name, k};
+    }
+  }
+
+  uint64_t rng = UINT64_C(0x9e3779b97f4a7c15);
+  for (size_t ch = 0; ch < max_channels; ++ch) {
+    for (size_t i = 0; i < history + samples; ++i) {
+      src[ch][i] = (float)(int32_t)(bench_util_rand(&rng) >> 32) * (1.f / 2147483648.f);
+    }
+  }
+
+  FILE *fp = stdout;
+  bool first = true;
+  if (opts.output) {
+    fp = fopen(opts.output, "w");
+    if (!fp) {
+      fprintf(stderr, "failed to open %s\n", opts.output);
+      return 1;
+    }
+  }
+  fprintf(fp, "{\n  \"schema\": 1,\n  \"results\": [");
+  for (size_t c = 0; c < sizeof(channel_counts) / sizeof(channel_counts[0]); ++c) {
+    run(&opts, variants, count, channel_counts[c], fp, &first);
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return 0;
+}
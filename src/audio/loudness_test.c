@@ -0,0 +1,279 @@
+#include <ovtest.h>
+
+#include "../test_util.h"
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+#include <ovl/audio/loudness.h>
+
+#include <math.h>
+#include <string.h>
+
+enum {
+  max_channels = 8,
+  max_parts = 2,
+  chunk = 4000,
+  batch_items = 6,
+};
+
+struct part {
+  double seconds;
+  double dbfs;
+  double freq;
+  double phase;
+};
+
+// Sine parts played one after the other on the channels in mask, computed from the position so it can seek.
+struct tone {
+  struct part parts[max_parts];
+  size_t parts_len;
+  uint32_t mask;
+  size_t sample_rate;
+};
+
+static float tone_value(void const *const userdata, uint64_t const i, size_t const ch) {
+  struct tone const *const tone = (struct tone const *)userdata;
+  if (!(tone->mask & (1u << ch))) {
+    return 0.f;
+  }
+  double t = (double)i / (double)tone->sample_rate;
+  for (size_t p = 0; p < tone->parts_len; ++p) {
+    struct part const *const part = &tone->parts[p];
+    if (t < part->seconds || p + 1 == tone->parts_len) {
+      double const amp = pow(10.0, part->dbfs / 20.0);
+      return (float)(amp * sin(2.0 * 3.14159265358979323846 * part->freq * t + part->phase));
+    }
+    t -= part->seconds;
+  }
+  return 0.f;
+}
+
+static struct tone tones[batch_items];
+
+/**
+ * Creates a decoder playing parts, keeping its description in tones[index] for as long as it lives.
+ */
+static NODISCARD bool tone_create(size_t const index,
+                                  size_t const channels,
+                                  uint32_t const mask,
+                                  size_t const sample_rate,
+                                  struct part const *const parts,
+                                  size_t const parts_len,
+                                  struct ovl_audio_decoder **const dp,
+                                  struct ov_error *const err) {
+  struct tone *const tone = &tones[index];
+  *tone = (struct tone){
+      .parts_len = parts_len,
+      .mask = mask,
+      .sample_rate = sample_rate,
+  };
+  double seconds = 0.0;
+  for (size_t p = 0; p < parts_len; ++p) {
+    tone->parts[p] = parts[p];
+    seconds += parts[p].seconds;
+  }
+  if (!test_util_decoder_create(
+          &(struct test_util_decoder_options){
+              .channels = channels,
+              .sample_rate = sample_rate,
+              .samples = (uint64_t)(seconds * (double)sample_rate),
+              .position = 777,
+              .chunk = chunk,
+              .value = tone_value,
+              .userdata = tone,
+          },
+          dp,
+          err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Measures parts played on their own.
+ */
+static NODISCARD bool measure(size_t const channels,
+                              uint32_t const mask,
+                              size_t const sample_rate,
+                              struct part const *const parts,
+                              size_t const parts_len,
+                              enum ovl_audio_decoder_remix_order const order,
+                              struct ovl_audio_loudness *const l,
+                              struct ov_error *const err) {
+  struct ovl_audio_decoder *d = NULL;
+  bool result = false;
+
+  {
+    if (!tone_create(0, channels, mask, sample_rate, parts, parts_len, &d, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (!ovl_audio_loudness_analyze(d, order, l, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  return result;
+}
+
+static bool near(double const a, double const b, double const tolerance) { return fabs(a - b) <= tolerance; }
+
+static void sine(void) {
+  struct ov_error err = {0};
+  // EBU Tech 3341 case 1: a 1 kHz sine at -23 dBFS on both channels reads -23 LUFS.
+  static size_t const rates[] = {48000, 44100, 96000};
+  for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+    struct part const part = {20.0, -23.0, 1000.0, 0.0};
+    struct ovl_audio_loudness l;
+    if (!TEST_SUCCEEDED(measure(2, 3, rates[r], &part, 1, ovl_audio_decoder_remix_order_wave, &l, &err), &err)) {
+      return;
+    }
+    TEST_CHECK(near(l.integrated, -23.0, 0.1));
+    TEST_MSG("rate=%zu integrated=%f", rates[r], l.integrated);
+    TEST_CHECK(near(l.range, 0.0, 0.1));
+    TEST_MSG("rate=%zu range=%f", rates[r], l.range);
+    TEST_CHECK(near(20.0 * log10(l.sample_peak), -23.0, 0.01));
+    TEST_CHECK(l.true_peak >= l.sample_peak && near(20.0 * log10(l.true_peak), -23.0, 0.1));
+  }
+}
+
+static void range(void) {
+  struct ov_error err = {0};
+  // EBU Tech 3342 case 1: 20 s at -20 dBFS, then 20 s at -30 dBFS, has a loudness range of 10 LU.
+  struct part const parts[2] = {{20.0, -20.0, 1000.0, 0.0}, {20.0, -30.0, 1000.0, 0.0}};
+  struct ovl_audio_loudness l;
+  if (!TEST_SUCCEEDED(measure(2, 3, 48000, parts, 2, ovl_audio_decoder_remix_order_wave, &l, &err), &err)) {
+    return;
+  }
+  TEST_CHECK(near(l.range, 10.0, 1.0));
+  TEST_MSG("range=%f", l.range);
+  // The quiet half is within 10 LU of the loud one, so both halves count.
+  double const expected = 10.0 * log10((pow(10.0, -2.0) + pow(10.0, -3.0)) / 2.0);
+  TEST_CHECK(near(l.integrated, expected, 0.1));
+  TEST_MSG("integrated=%f expected=%f", l.integrated, expected);
+}
+
+static void surround(void) {
+  struct ov_error err = {0};
+  struct part const part = {10.0, -23.0, 1000.0, 0.0};
+  static struct {
+    char const *name;
+    enum ovl_audio_decoder_remix_order order;
+    uint32_t mask;
+    double expected;
+  } const cases[] = {
+      // One channel alone reads 3 dB lower than the same sine on both sides.
+      {"wave left", ovl_audio_decoder_remix_order_wave, 1u << 0, -26.01},
+      {"wave left surround", ovl_audio_decoder_remix_order_wave, 1u << 4, -26.01 + 1.49},
+      {"vorbis right surround", ovl_audio_decoder_remix_order_vorbis, 1u << 4, -26.01 + 1.49},
+      {"wave lfe", ovl_audio_decoder_remix_order_wave, 1u << 3, -HUGE_VAL},
+      {"vorbis lfe", ovl_audio_decoder_remix_order_vorbis, 1u << 5, -HUGE_VAL},
+  };
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+    struct ovl_audio_loudness l;
+    if (!TEST_SUCCEEDED(measure(6, cases[c].mask, 48000, &part, 1, cases[c].order, &l, &err), &err)) {
+      return;
+    }
+    bool const ok = isinf(cases[c].expected) ? isinf(l.integrated) && l.integrated < 0.0
+                                             : near(l.integrated, cases[c].expected, 0.1);
+    TEST_CHECK(ok);
+    TEST_MSG("%s: integrated=%f expected=%f", cases[c].name, l.integrated, cases[c].expected);
+  }
+}
+
+static void true_peak(void) {
+  struct ov_error err = {0};
+  // A sine at a quarter of the sample rate, sampled 45 degrees off its peaks, never has a sample above 0.7071.
+  struct part const part = {5.0, 0.0, 12000.0, 3.14159265358979323846 / 4.0};
+  struct ovl_audio_loudness l;
+  if (!TEST_SUCCEEDED(measure(1, 1, 48000, &part, 1, ovl_audio_decoder_remix_order_wave, &l, &err), &err)) {
+    return;
+  }
+  TEST_CHECK(near(l.sample_peak, 0.70710678, 1e-4));
+  TEST_MSG("sample_peak=%f", l.sample_peak);
+  TEST_CHECK(near(20.0 * log10(l.true_peak), 0.0, 0.5));
+  TEST_MSG("true_peak=%f", l.true_peak);
+
+  // Silence is gated out entirely.
+  struct part const quiet = {5.0, -200.0, 1000.0, 0.0};
+  if (TEST_SUCCEEDED(measure(2, 0, 48000, &quiet, 1, ovl_audio_decoder_remix_order_wave, &l, &err), &err)) {
+    TEST_CHECK(isinf(l.integrated) && l.integrated < 0.0);
+    TEST_CHECK(near(l.range, 0.0, 0.0) && near(l.true_peak, 0.0, 0.0));
+  }
+}
+
+static NODISCARD bool batch_open(void *const userdata,
+                                 size_t const index,
+                                 struct ovl_audio_decoder **const dp,
+                                 enum ovl_audio_decoder_remix_order *const order,
+                                 struct ov_error *const err) {
+  (void)userdata;
+  if (index == 2) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, "item 2 cannot be opened");
+    return false;
+  }
+  struct part const part = {3.0 + (double)index, -10.0 - (double)index * 3.0, 500.0 + (double)index * 100.0, 0.0};
+  if (!tone_create(index, 2, 3, 48000, &part, 1, dp, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  *order = ovl_audio_decoder_remix_order_wave;
+  return true;
+}
+
+static void batch_close(void *const userdata, size_t const index, struct ovl_audio_decoder **const dp) {
+  (void)userdata;
+  (void)index;
+  ovl_audio_decoder_destroy(dp);
+}
+
+static void batch(void) {
+  struct ov_error err = {0};
+  struct ovl_audio_loudness_batch const b = {
+      .open = batch_open,
+      .close = batch_close,
+  };
+  struct ovl_audio_loudness results[batch_items];
+  bool succeeded[batch_items];
+  if (!TEST_SUCCEEDED(ovl_audio_loudness_analyze_batch(&b, batch_items, 3, results, succeeded, &err), &err)) {
+    return;
+  }
+  for (size_t i = 0; i < batch_items; ++i) {
+    if (i == 2) {
+      TEST_CHECK(!succeeded[i]);
+      continue;
+    }
+    if (!TEST_CHECK(succeeded[i])) {
+      continue;
+    }
+    // The same item measured alone gives exactly the same figures.
+    struct ovl_audio_decoder *d = NULL;
+    enum ovl_audio_decoder_remix_order order;
+    struct ovl_audio_loudness alone;
+    if (!TEST_SUCCEEDED(batch_open(NULL, i, &d, &order, &err), &err)) {
+      continue;
+    }
+    bool const ok = TEST_SUCCEEDED(ovl_audio_loudness_analyze(d, order, &alone, &err), &err);
+    batch_close(NULL, i, &d);
+    if (!ok) {
+      continue;
+    }
+    TEST_CHECK(memcmp(&alone, &results[i], sizeof(alone)) == 0);
+    TEST_MSG("item %zu: batch %f alone %f", i, results[i].integrated, alone.integrated);
+  }
+}
+
+TEST_LIST = {
+    {"sine", sine},
+    {"range", range},
+    {"surround", surround},
+    {"true_peak", true_peak},
+    {"batch", batch},
+    {NULL, NULL},
+};
@@ -0,0 +1,515 @@
+#include <ovl/audio/mixer.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+
+#include <math.h>
+#include <ovmo.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "mixer_kernel.h"
+
+// Control threads and the render thread share only two things: the command queue and the owner word of
+// each voice. A voice handle is a 16-bit generation above the 16-bit slot index. voice_add claims a free
+// slot by swapping its owner from 0 to the new handle and then posts the add command; render clears the owner
+// once the voice has stopped, which is what frees the slot and releases the decoder. Everything else in a
+// voice belongs to the render thread alone, and commands whose handle no longer matches are dropped there.
+//
+// The queue is a bounded multi-producer ring in which every cell carries a sequence number telling producers
+// and the consumer whose turn it is, so posting is a single compare-and-swap and never blocks.
+
+enum {
+  max_voices = 65535,
+  max_voice_channels = 8,
+  min_queue_capacity = 64,
+};
+
+enum command_type {
+  command_add,
+  command_remove,
+  command_gain,
+  command_pan,
+};
+
+struct command {
+  enum command_type type;
+  uint32_t voice;
+  struct ovl_audio_decoder *decoder;
+  float value;
+  float pan;
+};
+
+struct cell {
+  atomic_size_t seq;
+  struct command command;
+};
+
+struct route {
+  size_t src;
+  size_t bus;
+  float current;
+  float target;
+};
+
+struct voice {
+  atomic_uint_least32_t owner;
+
+  // Owned by the render thread.
+  uint32_t handle;
+  struct ovl_audio_decoder *decoder;
+  size_t channels;
+  float const *const *src_pcm;
+  size_t src_off;
+  size_t src_len;
+  float gain;
+  float pan;
+  // Whether the route gains move during the next block.
+  bool ramping;
+  bool removing;
+  size_t routes;
+  struct route route[max_voice_channels];
+};
+
+struct ovl_audio_mixer {
+  struct mixer_kernels const *kernels;
+  size_t channels;
+  size_t block_size;
+
+  struct voice *voices;
+  size_t voice_count;
+  atomic_uint_least32_t generation;
+
+  struct cell *cells;
+  size_t mask;
+  atomic_size_t enqueue_pos;
+  size_t dequeue_pos;
+
+  float **bus;
+  float const **pcm;
+};
+
+static inline size_t adjust_align8(size_t const size) { return (size + (size_t)(7)) & ~(size_t)(7); }
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+
+static NODISCARD bool
+alloc_planes(float ***const planes, size_t const channels, size_t const stride, struct ov_error *const err) {
+  if (!OV_REALLOC(planes, channels, sizeof(float *))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  (*planes)[0] = NULL;
+  if (!OV_ALIGNED_ALLOC(&(*planes)[0], stride * channels, sizeof(float), 16)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  for (size_t ch = 1; ch < channels; ++ch) {
+    (*planes)[ch] = (*planes)[ch - 1] + stride;
+  }
+  return true;
+}
+
+static void free_planes(float ***const planes) {
+  if (*planes) {
+    if ((*planes)[0]) {
+      OV_ALIGNED_FREE(&(*planes)[0]);
+    }
+    OV_FREE(planes);
+  }
+}
+
+static bool push(struct ovl_audio_mixer *const m, struct command const *const command) {
+  size_t pos = atomic_load_explicit(&m->enqueue_pos, memory_order_relaxed);
+  struct cell *cell;
+  for (;;) {
+    cell = &m->cells[pos & m->mask];
+    size_t const seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    if (seq == pos) {
+      if (atomic_compare_exchange_weak_explicit(
+              &m->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    } else if (seq < pos) {
+      // The consumer has not freed this cell since the last lap, so the queue is full.
+      return false;
+    } else {
+      pos = atomic_load_explicit(&m->enqueue_pos, memory_order_relaxed);
+    }
+  }
+  cell->command = *command;
+  atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+  return true;
+}
+
+static bool pop(struct ovl_audio_mixer *const m, struct command *const command) {
+  size_t const pos = m->dequeue_pos;
+  struct cell *const cell = &m->cells[pos & m->mask];
+  if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1) {
+    return false;
+  }
+  *command = cell->command;
+  atomic_store_explicit(&cell->seq, pos + m->mask + 1, memory_order_release);
+  m->dequeue_pos = pos + 1;
+  return true;
+}
+
+static NODISCARD bool
+post(struct ovl_audio_mixer *const m, struct command const *const command, struct ov_error *const err) {
+  if (!push(m, command)) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Mixer command queue is full"));
+    return false;
+  }
+  return true;
+}
+
+static inline float sanitize_gain(float const gain) { return isnan(gain) ? 0.f : gain; }
+static inline float sanitize_pan(float const pan) {
+  return isnan(pan) ? 0.f : pan < -1.f ? -1.f : pan > 1.f ? 1.f : pan;
+}
+
+/**
+ * @brief Sets the route targets of a voice from its gain and pan.
+ */
+static void update_targets(struct ovl_audio_mixer const *const m, struct voice *const v) {
+  float const g = v->gain;
+  float const pan = v->pan;
+  if (v->channels == 1 && m->channels == 2) {
+    // Constant power: both sides are at -3 dB in the center.
+    float const angle = (pan + 1.f) * (float)(3.14159265358979323846 / 4.0);
+    v->route[0] = (struct route){.src = 0, .bus = 0, .current = v->route[0].current, .target = g * cosf(angle)};
+    v->route[1] = (struct route){.src = 0, .bus = 1, .current = v->route[1].current, .target = g * sinf(angle)};
+    return;
+  }
+  for (size_t r = 0; r < v->routes; ++r) {
+    v->route[r].src = r;
+    v->route[r].bus = r % m->channels;
+    v->route[r].target = g;
+  }
+  if (v->channels == 2 && m->channels == 2) {
+    // Balance: the far side is attenuated and the near side is left alone.
+    v->route[0].target = g * (pan > 0.f ? 1.f - pan : 1.f);
+    v->route[1].target = g * (pan < 0.f ? 1.f + pan : 1.f);
+  }
+}
+
+static void stop(struct voice *const v) {
+  v->decoder = NULL;
+  v->src_pcm = NULL;
+  v->src_off = 0;
+  v->src_len = 0;
+  v->handle = 0;
+  // Hands the decoder back to the caller and frees the slot.
+  atomic_store_explicit(&v->owner, 0, memory_order_release);
+}
+
+static void apply(struct ovl_audio_mixer *const m, struct command const *const c) {
+  struct voice *const v = &m->voices[c->voice & 0xffff];
+  if (c->type == command_add) {
+    // owner already holds the handle; it is the only field control threads read.
+    size_t const channels = ovl_audio_decoder_get_info(c->decoder)->channels;
+    v->handle = c->voice;
+    v->decoder = c->decoder;
+    v->channels = channels;
+    v->src_pcm = NULL;
+    v->src_off = 0;
+    v->src_len = 0;
+    v->gain = c->value;
+    v->pan = c->pan;
+    v->ramping = false;
+    v->removing = false;
+    // A mono voice on a stereo bus is panned into both sides.
+    v->routes = channels == 1 && m->channels == 2 ? 2 : channels;
+    update_targets(m, v);
+    // A new voice starts at its gain; the decoder is responsible for starting without a click.
+    for (size_t r = 0; r < v->routes; ++r) {
+      v->route[r].current = v->route[r].target;
+    }
+    return;
+  }
+  if (v->handle != c->voice) {
+    // The voice stopped on its own before this command arrived.
+    return;
+  }
+  switch (c->type) {
+  case command_add:
+    break;
+  case command_remove:
+    v->removing = true;
+    v->ramping = true;
+    break;
+  case command_gain:
+    v->gain = c->value;
+    update_targets(m, v);
+    v->ramping = true;
+    break;
+  case command_pan:
+    v->pan = c->pan;
+    update_targets(m, v);
+    v->ramping = true;
+    break;
+  }
+}
+
+/**
+ * @brief Mixes up to one block of a voice into the bus.
+ * @return false when the voice has no more samples to play.
+ */
+static bool mix_voice(struct ovl_audio_mixer *const m, struct voice *const v) {
+  size_t const block_size = m->block_size;
+  float const inv_block = 1.f / (float)block_size;
+  size_t filled = 0;
+  while (filled < block_size) {
+    if (v->src_off == v->src_len) {
+      struct ov_error err = {0};
+      size_t read;
+      if (!ovl_audio_decoder_read(v->decoder, &v->src_pcm, &read, &err)) {
+        OV_ERROR_ADD_TRACE(&err);
+        OV_ERROR_REPORT(&err, NULL);
+        return false;
+      }
+      v->src_off = 0;
+      v->src_len = read;
+      if (read == 0) {
+        return false;
+      }
+    }
+    size_t const n = min2(block_size - filled, v->src_len - v->src_off);
+    for (size_t r = 0; r < v->routes; ++r) {
+      struct route const *const route = &v->route[r];
+      float *const dst = m->bus[route->bus] + filled;
+      float const *const src = v->src_pcm[route->src] + v->src_off;
+      if (v->ramping) {
+        float const to = v->removing ? 0.f : route->target;
+        float const step = (to - route->current) * inv_block;
+        m->kernels->add_ramp(dst, src, n, route->current + step * (float)filled, step);
+      } else {
+        m->kernels->add(dst, src, n, route->current);
+      }
+    }
+    v->src_off += n;
+    filled += n;
+  }
+  if (v->removing) {
+    return false;
+  }
+  if (v->ramping) {
+    for (size_t r = 0; r < v->routes; ++r) {
+      v->route[r].current = v->route[r].target;
+    }
+    v->ramping = false;
+  }
+  return true;
+}
+
+NODISCARD bool ovl_audio_mixer_create(size_t const voices,
+                                      size_t const channels,
+                                      size_t const block_size,
+                                      struct ovl_audio_mixer **const mp,
+                                      struct ov_error *const err) {
+  if (!mp || *mp || !voices || voices > max_voices || !channels || !block_size) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct ovl_audio_mixer *m = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&m, 1, sizeof(*m))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    *m = (struct ovl_audio_mixer){
+        .kernels = mixer_kernel_get_best(),
+        .channels = channels,
+        .block_size = block_size,
+        .voice_count = voices,
+    };
+    atomic_init(&m->generation, 0);
+    atomic_init(&m->enqueue_pos, 0);
+
+    // Room for every voice to be added, moved and removed within one block.
+    size_t capacity = min_queue_capacity;
+    while (capacity < voices * 4) {
+      capacity *= 2;
+    }
+    m->mask = capacity - 1;
+
+    if (!OV_REALLOC(&m->voices, voices, sizeof(struct voice))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    for (size_t i = 0; i < voices; ++i) {
+      m->voices[i] = (struct voice){0};
+      atomic_init(&m->voices[i].owner, 0);
+    }
+    if (!OV_REALLOC(&m->cells, capacity, sizeof(struct cell))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+      atomic_init(&m->cells[i].seq, i);
+    }
+    if (!OV_REALLOC(&m->pcm, channels, sizeof(float *))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (!alloc_planes(&m->bus, channels, adjust_align8(block_size), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    for (size_t ch = 0; ch < channels; ++ch) {
+      m->pcm[ch] = m->bus[ch];
+    }
+    *mp = m;
+  }
+  result = true;
+
+cleanup:
+  if (!result) {
+    if (m) {
+      ovl_audio_mixer_destroy(&m);
+    }
+  }
+  return result;
+}
+
+void ovl_audio_mixer_destroy(struct ovl_audio_mixer **const mp) {
+  if (!mp || !*mp) {
+    return;
+  }
+  struct ovl_audio_mixer *m = *mp;
+  free_planes(&m->bus);
+  if (m->pcm) {
+    OV_FREE(&m->pcm);
+  }
+  if (m->cells) {
+    OV_FREE(&m->cells);
+  }
+  if (m->voices) {
+    OV_FREE(&m->voices);
+  }
+  OV_FREE(mp);
+}
+
+NODISCARD bool
+ovl_audio_mixer_render(struct ovl_audio_mixer *const m, float const *const **const pcm, struct ov_error *const err) {
+  if (!m || !pcm) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  for (size_t ch = 0; ch < m->channels; ++ch) {
+    memset(m->bus[ch], 0, m->block_size * sizeof(float));
+  }
+  struct command c;
+  while (pop(m, &c)) {
+    apply(m, &c);
+  }
+  for (size_t i = 0; i < m->voice_count; ++i) {
+    struct voice *const v = &m->voices[i];
+    if (v->handle && !mix_voice(m, v)) {
+      stop(v);
+    }
+  }
+  *pcm = m->pcm;
+  return true;
+}
+
+NODISCARD bool ovl_audio_mixer_voice_add(struct ovl_audio_mixer *const m,
+                                         struct ovl_audio_decoder *const decoder,
+                                         float const gain,
+                                         float const pan,
+                                         uint32_t *const voice,
+                                         struct ov_error *const err) {
+  if (!m || !decoder || !voice) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  size_t const channels = ovl_audio_decoder_get_info(decoder)->channels;
+  if (!channels || channels > max_voice_channels) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  uint32_t generation;
+  do {
+    generation = (atomic_fetch_add_explicit(&m->generation, 1, memory_order_relaxed) + 1) & 0xffff;
+  } while (!generation);
+  for (size_t i = 0; i < m->voice_count; ++i) {
+    uint_least32_t expected = 0;
+    uint32_t const handle = (generation << 16) | (uint32_t)i;
+    if (!atomic_compare_exchange_strong_explicit(
+            &m->voices[i].owner, &expected, handle, memory_order_acquire, memory_order_relaxed)) {
+      continue;
+    }
+    struct command const c = {
+        .type = command_add,
+        .voice = handle,
+        .decoder = decoder,
+        .value = sanitize_gain(gain),
+        .pan = sanitize_pan(pan),
+    };
+    if (!push(m, &c)) {
+      atomic_store_explicit(&m->voices[i].owner, 0, memory_order_release);
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Mixer command queue is full"));
+      return false;
+    }
+    *voice = handle;
+    return true;
+  }
+  OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("No free mixer voice"));
+  return false;
+}
+
+static bool valid_voice(struct ovl_audio_mixer const *const m, uint32_t const voice) {
+  return (voice >> 16) != 0 && (voice & 0xffff) < m->voice_count;
+}
+
+NODISCARD bool
+ovl_audio_mixer_voice_remove(struct ovl_audio_mixer *const m, uint32_t const voice, struct ov_error *const err) {
+  if (!m || !valid_voice(m, voice)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (!post(m, &(struct command){.type = command_remove, .voice = voice}, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+NODISCARD bool ovl_audio_mixer_voice_set_gain(struct ovl_audio_mixer *const m,
+                                              uint32_t const voice,
+                                              float const gain,
+                                              struct ov_error *const err) {
+  if (!m || !valid_voice(m, voice)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (!post(m, &(struct command){.type = command_gain, .voice = voice, .value = sanitize_gain(gain)}, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+NODISCARD bool ovl_audio_mixer_voice_set_pan(struct ovl_audio_mixer *const m,
+                                             uint32_t const voice,
+                                             float const pan,
+                                             struct ov_error *const err) {
+  if (!m || !valid_voice(m, voice)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (!post(m, &(struct command){.type = command_pan, .voice = voice, .pan = sanitize_pan(pan)}, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+bool ovl_audio_mixer_voice_is_active(struct ovl_audio_mixer *const m, uint32_t const voice) {
+  if (!m || !valid_voice(m, voice)) {
+    return false;
+  }
+  return atomic_load_explicit(&m->voices[voice & 0xffff].owner, memory_order_acquire) == voice;
+}
@@ -0,0 +1,246 @@
+#include "../bench_util.h"
+#include "../test_util.h"
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+#include <ovl/audio/mixer.h>
+
+#include <math.h>
+#include <string.h>
+
+// Measures the CPU cost of the mixer into a stereo bus. Every voice reads a synthetic signal that costs
+// nothing to produce, half of them mono and half stereo, so the figures are the mixer alone;
+// voices_per_core is how many voices one core could mix in real time.
+
+enum {
+  bus_channels = 2,
+  sample_rate = 48000,
+  max_voices = 256,
+  repetitions = 3,
+  chunk = 4096,
+};
+
+static size_t const voice_counts[] = {8, 64, max_voices};
+static size_t const block_sizes[] = {64, 256, 1024};
+
+static struct {
+  char const *name;
+  // Moves the gain and pan of every voice on every block, so every route is ramped.
+  bool automate;
+} const settings[] = {
+    {"static", false},
+    {"automation", true},
+};
+
+struct options {
+  char const *output;
+  size_t seconds;
+};
+
+static NODISCARD bool run(struct options const *const opts,
+                          struct ovl_audio_decoder *const *const tones,
+                          size_t const voices,
+                          size_t const block_size,
+                          size_t const setting,
+                          FILE *const fp,
+                          bool *const first,
+                          struct ov_error *const err) {
+  struct ovl_audio_mixer *m = NULL;
+  uint32_t handles[max_voices];
+  bool result = false;
+
+  {
+    if (!ovl_audio_mixer_create(voices, bus_channels, block_size, &m, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    for (size_t v = 0; v < voices; ++v) {
+      float const pan = (float)v / (float)voices * 2.f - 1.f;
+      if (!ovl_audio_mixer_voice_add(m, tones[v], 1.f / (float)voices, pan, &handles[v], err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+    bool const automate = settings[setting].automate;
+
+    size_t const blocks = opts->seconds * sample_rate / block_size;
+    uint64_t best_ns = UINT64_MAX;
+    uint64_t best_cycles = 0;
+    float acc = 0.f;
+    for (size_t r = 0; r < repetitions; ++r) {
+      uint64_t const c0 = bench_util_cycles();
+      uint64_t const t0 = bench_util_now_ns();
+      for (size_t i = 0; i < blocks; ++i) {
+        if (automate) {
+          float const t = (float)(i * block_size) / (float)sample_rate;
+          for (size_t v = 0; v < voices; ++v) {
+            float const phase = t * 3.f + (float)v;
+            if (!ovl_audio_mixer_voice_set_gain(m, handles[v], (1.f + sinf(phase)) / (float)voices, err) ||
+                !ovl_audio_mixer_voice_set_pan(m, handles[v], cosf(phase), err)) {
+              OV_ERROR_ADD_TRACE(err);
+              goto cleanup;
+            }
+          }
+        }
+        float const *const *pcm = NULL;
+        if (!ovl_audio_mixer_render(m, &pcm, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+        acc += pcm[0][block_size - 1];
+      }
+      uint64_t const elapsed = bench_util_now_ns() - t0;
+      uint64_t const cycles = bench_util_cycles() - c0;
+      if (elapsed < best_ns) {
+        best_ns = elapsed;
+        best_cycles = cycles;
+      }
+    }
+    bench_util_consume(acc);
+
+    double const audio_ns = (double)(blocks * block_size) / (double)sample_rate * 1e9;
+    fprintf(fp, "%s\n    {\"kernel\": \"mixer\", \"setting\": ", *first ? "" : ",");
+    bench_util_json_string(fp, settings[setting].name);
+    fprintf(fp,
+            ", \"voices\": %zu, \"block_size\": %zu, \"blocks\": %zu,\n"
+            "     \"ns_per_block\": %.1f, \"ns_per_voice_block\": %.2f, \"cpu_percent\": %.4f,"
+            " \"voices_per_core\": %.0f,\n"
+            "     \"cycles_per_voice_sample\": ",
+            voices,
+            block_size,
+            blocks,
+            (double)best_ns / (double)blocks,
+            (double)best_ns / (double)blocks / (double)voices,
+            (double)best_ns / audio_ns * 100.0,
+            audio_ns / (double)best_ns * (double)voices);
+    if (best_cycles) {
+      fprintf(fp, "%.2f}", (double)best_cycles / (double)(blocks * block_size * voices));
+    } else {
+      fprintf(fp, "null}");
+    }
+    fflush(fp);
+    *first = false;
+  }
+  result = true;
+
+cleanup:
+  ovl_audio_mixer_destroy(&m);
+  return result;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: bench_ovl_mixer [options]\n"
+          "  --output <path>       write JSON to path instead of stdout\n"
+          "  --seconds <n>         seconds of output per repetition (default 10)\n");
+}
+
+int main(int argc, char **argv) {
+  struct options opts = {
+      .seconds = 10,
+  };
+  for (int i = 1; i < argc; ++i) {
+    char const *const a = argv[i];
+    char const *const v = i + 1 < argc ? argv[i + 1] : NULL;
+    bool ok = v != NULL;
+    if (ok && strcmp(a, "--output") == 0) {
+      opts.output = v;
+    } else if (ok && strcmp(a, "--seconds") == 0) {
+      char *end = NULL;
+      unsigned long long const n = strtoull(v, &end, 10);
+      ok = *v && !*end && n > 0;
+      opts.seconds = (size_t)n;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage();
+      return 2;
+    }
+    ++i;
+  }
+
+  static struct ovl_audio_decoder *tones[max_voices];
+  float *buffer[2] = {NULL, NULL};
+  struct ov_error err = {0};
+  FILE *fp = stdout;
+  bool first = true;
+  int exit_code = 1;
+
+  // A chunk of a chord with a little noise, shared by every voice.
+  for (size_t ch = 0; ch < 2; ++ch) {
+    if (!OV_ALIGNED_ALLOC(&buffer[ch], chunk, sizeof(float), 16)) {
+      OV_ERROR_SET_GENERIC(&err, ov_error_generic_out_of_memory);
+      OV_ERROR_REPORT(&err, NULL);
+      goto cleanup;
+    }
+  }
+  {
+    uint64_t rng = UINT64_C(0x9e3779b97f4a7c15);
+    static double const freqs[] = {220.0, 277.0, 330.0, 440.0};
+    for (size_t i = 0; i < chunk; ++i) {
+      double v = 0.0;
+      for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); ++f) {
+        v += sin(2.0 * 3.14159265358979323846 * freqs[f] * (double)i / (double)sample_rate) * 0.2;
+      }
+      for (size_t ch = 0; ch < 2; ++ch) {
+        float const noise = (float)(int32_t)(bench_util_rand(&rng) >> 32) * (1.f / 2147483648.f);
+        buffer[ch][i] = (float)v + noise * 0.01f;
+      }
+    }
+  }
+  // Every read returns the same chunk of a signal that never ends.
+  for (size_t v = 0; v < max_voices; ++v) {
+    if (!test_util_decoder_create(
+            &(struct test_util_decoder_options){
+                .channels = 1 + v % 2,
+                .sample_rate = sample_rate,
+                .samples = UINT64_MAX,
+                .chunk = chunk,
+                .planes = (float const *const *)buffer,
+                .period = chunk,
+            },
+            &tones[v],
+            &err)) {
+      OV_ERROR_REPORT(&err, NULL);
+      goto cleanup;
+    }
+  }
+
+  if (opts.output) {
+    fp = fopen(opts.output, "w");
+    if (!fp) {
+      fprintf(stderr, "failed to open %s\n", opts.output);
+      goto cleanup;
+    }
+  }
+  fprintf(fp, "{\n  \"schema\": 1,\n  \"results\": [");
+  for (size_t s = 0; s < sizeof(settings) / sizeof(settings[0]); ++s) {
+    for (size_t n = 0; n < sizeof(voice_counts) / sizeof(voice_counts[0]); ++n) {
+      for (size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); ++b) {
+        if (!run(&opts, tones, voice_counts[n], block_sizes[b], s, fp, &first, &err)) {
+          OV_ERROR_REPORT(&err, NULL);
+          goto cleanup;
+        }
+      }
+    }
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  exit_code = 0;
+
+cleanup:
+  if (fp && fp != stdout) {
+    fclose(fp);
+  }
+  for (size_t v = 0; v < max_voices; ++v) {
+    if (tones[v]) {
+      ovl_audio_decoder_destroy(&tones[v]);
+    }
+  }
+  for (size_t ch = 0; ch < 2; ++ch) {
+    if (buffer[ch]) {
+      OV_ALIGNED_FREE(&buffer[ch]);
+    }
+  }
+  return exit_code;
+}
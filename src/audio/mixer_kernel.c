@@ -0,0 +1,212 @@
+#include "mixer_kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define MIXER_KERNEL_X86 1
+#  include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define MIXER_KERNEL_NEON 1
+#  include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#  define MIXER_KERNEL_WASM 1
+#  include <wasm_simd128.h>
+#endif
+
+// The ramp kernels keep the sample index as a float vector and compute each gain as gain + step * index,
+// exactly as the scalar code does, instead of accumulating the step, which would drift from it.
+// Contraction into fused multiply-adds is disabled so that targets with FMA round the scalar code the same way.
+#pragma STDC FP_CONTRACT OFF
+
+static void scalar_add(float *const dst, float const *const src, size_t const n, float const gain) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] += src[i] * gain;
+  }
+}
+
+// Finishes a ramp from sample i0, which the vector kernels use for their tail.
+static void scalar_add_ramp_from(
+    float *const dst, float const *const src, size_t const i0, size_t const n, float const gain, float const step) {
+  for (size_t i = i0; i < n; ++i) {
+    dst[i] += src[i] * (gain + step * (float)(i + 1));
+  }
+}
+
+static void
+scalar_add_ramp(float *const dst, float const *const src, size_t const n, float const gain, float const step) {
+  scalar_add_ramp_from(dst, src, 0, n, gain, step);
+}
+
+static struct mixer_kernels const scalar_kernels = {
+    .add = scalar_add,
+    .add_ramp = scalar_add_ramp,
+};
+
+#ifdef MIXER_KERNEL_X86
+
+static __attribute__((target("sse2"))) void
+sse2_add(float *const dst, float const *const src, size_t const n, float const gain) {
+  __m128 const g = _mm_set1_ps(gain);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+    _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), g)));
+  }
+  scalar_add(dst + i, src + i, n - i, gain);
+}
+
+static __attribute__((target("sse2"))) void
+sse2_add_ramp(float *const dst, float const *const src, size_t const n, float const gain, float const step) {
+  __m128 const g = _mm_set1_ps(gain);
+  __m128 const s = _mm_set1_ps(step);
+  __m128 const four = _mm_set1_ps(4.f);
+  __m128 idx = _mm_setr_ps(1.f, 2.f, 3.f, 4.f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 const gi = _mm_add_ps(g, _mm_mul_ps(s, idx));
+    _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), gi)));
+    idx = _mm_add_ps(idx, four);
+  }
+  scalar_add_ramp_from(dst, src, i, n, gain, step);
+}
+
+static __attribute__((target("avx2"))) void
+avx2_add(float *const dst, float const *const src, size_t const n, float const gain) {
+  __m256 const g = _mm256_set1_ps(gain);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+    _mm256_storeu_ps(dst + i + 8,
+                     _mm256_add_ps(_mm256_loadu_ps(dst + i + 8), _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), g)));
+  }
+  // sse2_add is not VEX encoded, so clear the upper halves first to avoid the transition penalty.
+  _mm256_zeroupper();
+  sse2_add(dst + i, src + i, n - i, gain);
+}
+
+static __attribute__((target("avx2"))) void
+avx2_add_ramp(float *const dst, float const *const src, size_t const n, float const gain, float const step) {
+  __m256 const g = _mm256_set1_ps(gain);
+  __m256 const s = _mm256_set1_ps(step);
+  __m256 const eight = _mm256_set1_ps(8.f);
+  __m256 idx = _mm256_setr_ps(1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 const gi = _mm256_add_ps(g, _mm256_mul_ps(s, idx));
+    _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), gi)));
+    idx = _mm256_add_ps(idx, eight);
+  }
+  _mm256_zeroupper();
+  scalar_add_ramp_from(dst, src, i, n, gain, step);
+}
+
+static struct mixer_kernels const sse2_kernels = {
+    .add = sse2_add,
+    .add_ramp = sse2_add_ramp,
+};
+
+static struct mixer_kernels const avx2_kernels = {
+    .add = avx2_add,
+    .add_ramp = avx2_add_ramp,
+};
+
+#endif // MIXER_KERNEL_X86
+
+#ifdef MIXER_KERNEL_NEON
+
+static void neon_add(float *const dst, float const *const src, size_t const n, float const gain) {
+  float32x4_t const g = vdupq_n_f32(gain);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), g)));
+    vst1q_f32(dst + i + 4, vaddq_f32(vld1q_f32(dst + i + 4), vmulq_f32(vld1q_f32(src + i + 4), g)));
+  }
+  scalar_add(dst + i, src + i, n - i, gain);
+}
+
+static void
+neon_add_ramp(float *const dst, float const *const src, size_t const n, float const gain, float const step) {
+  static float const first[4] = {1.f, 2.f, 3.f, 4.f};
+  float32x4_t const g = vdupq_n_f32(gain);
+  float32x4_t const s = vdupq_n_f32(step);
+  float32x4_t const four = vdupq_n_f32(4.f);
+  float32x4_t idx = vld1q_f32(first);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t const gi = vaddq_f32(g, vmulq_f32(s, idx));
+    vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), gi)));
+    idx = vaddq_f32(idx, four);
+  }
+  scalar_add_ramp_from(dst, src, i, n, gain, step);
+}
+
+static struct mixer_kernels const neon_kernels = {
+    .add = neon_add,
+    .add_ramp = neon_add_ramp,
+};
+
+#endif // MIXER_KERNEL_NEON
+
+#ifdef MIXER_KERNEL_WASM
+
+static void simd128_add(float *const dst, float const *const src, size_t const n, float const gain) {
+  v128_t const g = wasm_f32x4_splat(gain);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), wasm_f32x4_mul(wasm_v128_load(src + i), g)));
+    wasm_v128_store(dst + i + 4,
+                    wasm_f32x4_add(wasm_v128_load(dst + i + 4), wasm_f32x4_mul(wasm_v128_load(src + i + 4), g)));
+  }
+  scalar_add(dst + i, src + i, n - i, gain);
+}
+
+static void
+simd128_add_ramp(float *const dst, float const *const src, size_t const n, float const gain, float const step) {
+  v128_t const g = wasm_f32x4_splat(gain);
+  v128_t const s = wasm_f32x4_splat(step);
+  v128_t const four = wasm_f32x4_splat(4.f);
+  v128_t idx = wasm_f32x4_make(1.f, 2.f, 3.f, 4.f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    v128_t const gi = wasm_f32x4_add(g, wasm_f32x4_mul(s, idx));
+    wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), wasm_f32x4_mul(wasm_v128_load(src + i), gi)));
+    idx = wasm_f32x4_add(idx, four);
+  }
+  scalar_add_ramp_from(dst, src, i, n, gain, step);
+}
+
+static struct mixer_kernels const simd128_kernels = {
+    .add = simd128_add,
+    .add_ramp = simd128_add_ramp,
+};
+
+#endif // MIXER_KERNEL_WASM
+
+static struct mixer_kernels const *const tables[kernel_isa_count] = {
+    [kernel_isa_scalar] = &scalar_kernels,
+#ifdef MIXER_KERNEL_X86
+    [kernel_isa_sse2] = &sse2_kernels,
+    [kernel_isa_avx2] = &avx2_kernels,
+#endif
+#ifdef MIXER_KERNEL_NEON
+    [kernel_isa_neon] = &neon_kernels,
+#endif
+#ifdef MIXER_KERNEL_WASM
+    [kernel_isa_simd128] = &simd128_kernels,
+#endif
+};
+
+struct mixer_kernels const *mixer_kernel_get(enum kernel_isa const isa) {
+  if ((size_t)isa >= kernel_isa_count || !kernel_isa_supported(isa)) {
+    return NULL;
+  }
+  return tables[isa];
+}
+
+struct mixer_kernels const *mixer_kernel_get_best(void) {
+  for (size_t i = 0; i < kernel_isa_count; ++i) {
+    struct mixer_kernels const *const k = mixer_kernel_get(kernel_isa_preference[i]);
+    if (k) {
+      return k;
+    }
+  }
+  return &scalar_kernels;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "kernel.h"
+
+/**
+ * @brief Mixes samples into a bus at a constant gain, dst[i] += src[i] * gain.
+ * @param dst Bus samples, no alignment required.
+ * @param src Source samples, no alignment required. Must not overlap dst.
+ * @param n Number of samples.
+ * @param gain Linear gain.
+ */
+typedef void (*mixer_add_func)(float *const dst, float const *const src, size_t const n, float const gain);
+
+/**
+ * @brief Mixes samples into a bus with a linear gain ramp, dst[i] += src[i] * (gain + step * (i + 1)).
+ * The gain after the last sample is gain + step * n, so a ramp split across calls continues where it left off.
+ * Parameters are the same as mixer_add_func; n must be below 2^24 so every index is exact in float.
+ * @param step Gain change per sample.
+ */
+typedef void (*mixer_add_ramp_func)(
+    float *const dst, float const *const src, size_t const n, float const gain, float const step);
+
+/**
+ * @brief Mixer kernels for one instruction set.
+ * Every variant produces bit-identical output to the scalar kernels.
+ */
+struct mixer_kernels {
+  mixer_add_func add;
+  mixer_add_ramp_func add_ramp;
+};
+
+/**
+ * @brief Returns the kernels for the given instruction set.
+ * @return The kernels, or NULL if the instruction set is not compiled in or not supported by the running CPU.
+ */
+struct mixer_kernels const *mixer_kernel_get(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the fastest kernels supported by the running CPU.
+ */
+struct mixer_kernels const *mixer_kernel_get_best(void);
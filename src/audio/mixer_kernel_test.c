@@ -0,0 +1,124 @@
+#include <ovtest.h>
+
+#include "mixer_kernel.h"
+
+#include <string.h>
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"scalar", kernel_isa_scalar},
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+enum {
+  max_samples = 1031,
+  guard = 4,
+};
+
+static float src[max_samples];
+static float bus[max_samples];
+static float expected[max_samples];
+static float out[max_samples + guard * 2];
+
+static uint32_t xorshift(uint32_t *const state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static void prepare(void) {
+  uint32_t state = 0x9e3779b9;
+  for (size_t i = 0; i < max_samples; ++i) {
+    src[i] = (float)(xorshift(&state) & 0xffff) / 32768.f - 1.f;
+    bus[i] = (float)(xorshift(&state) & 0xffff) / 32768.f - 1.f;
+  }
+}
+
+static void check(char const *const kind, bool const ramp) {
+  static size_t const sample_counts[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 33, 100, max_samples};
+  struct mixer_kernels const *const scalar = mixer_kernel_get(kernel_isa_scalar);
+  if (!TEST_CHECK(scalar != NULL)) {
+    return;
+  }
+  float const gain = 0.7f;
+  float const step = -0.6f / (float)max_samples;
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    struct mixer_kernels const *const k = mixer_kernel_get(isas[i].isa);
+    if (!k) {
+      TEST_MSG("%s is not available", isas[i].name);
+      continue;
+    }
+    for (size_t si = 0; si < sizeof(sample_counts) / sizeof(sample_counts[0]); ++si) {
+      size_t const samples = sample_counts[si];
+      // Start on alternate positions so the kernels also see unaligned buffers.
+      size_t const offset = si & 1;
+      size_t const n = samples - (samples && offset ? 1 : 0);
+      memcpy(expected, bus, n * sizeof(float));
+      memset(out, 0x55, sizeof(out));
+      memcpy(out + guard + offset, bus, n * sizeof(float));
+      if (ramp) {
+        scalar->add_ramp(expected, src + offset, n, gain, step);
+        k->add_ramp(out + guard + offset, src + offset, n, gain, step);
+      } else {
+        scalar->add(expected, src + offset, n, gain);
+        k->add(out + guard + offset, src + offset, n, gain);
+      }
+      if (!TEST_CHECK(memcmp(out + guard + offset, expected, n * sizeof(float)) == 0)) {
+        TEST_MSG("%s %s samples=%zu differs from scalar", isas[i].name, kind, n);
+        return;
+      }
+      static uint8_t const untouched[guard * sizeof(float)] = {
+          0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55};
+      if (!TEST_CHECK(memcmp(out + offset, untouched, sizeof(untouched)) == 0 &&
+                      memcmp(out + guard + offset + n, untouched, sizeof(untouched)) == 0)) {
+        TEST_MSG("%s %s samples=%zu wrote out of bounds", isas[i].name, kind, n);
+        return;
+      }
+    }
+  }
+}
+
+static void add_matches_scalar(void) {
+  prepare();
+  check("add", false);
+}
+
+static void add_ramp_matches_scalar(void) {
+  prepare();
+  check("add_ramp", true);
+}
+
+static void ramp_ends_on_target(void) {
+  struct mixer_kernels const *const k = mixer_kernel_get_best();
+  if (!TEST_CHECK(k != NULL)) {
+    return;
+  }
+  // A ramp of n samples from gain with step (to - gain) / n reaches exactly to on its last sample.
+  enum { n = 64 };
+  float ones[n];
+  float acc[n];
+  for (size_t i = 0; i < n; ++i) {
+    ones[i] = 1.f;
+    acc[i] = 0.f;
+  }
+  k->add_ramp(acc, ones, n, 1.f, -1.f / (float)n);
+  TEST_CHECK(acc[n - 1] < 1e-6f && acc[n - 1] > -1e-6f);
+  TEST_MSG("last=%g", (double)acc[n - 1]);
+  TEST_CHECK(acc[0] > 0.98f && acc[0] < 0.99f);
+  TEST_MSG("first=%g", (double)acc[0]);
+}
+
+TEST_LIST = {
+    {"add_matches_scalar", add_matches_scalar},
+    {"add_ramp_matches_scalar", add_ramp_matches_scalar},
+    {"ramp_ends_on_target", ramp_ends_on_target},
+    {NULL, NULL},
+};
@@ -0,0 +1,336 @@
+#include <ovtest.h>
+
+#include "../test_util.h"
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+#include <ovl/audio/mixer.h>
+
+#include <math.h>
+#include <ovthreads.h>
+#include <stdatomic.h>
+
+enum {
+  block_size = 64,
+  // Shorter than a block and not a divisor of it, so voices gather across reads.
+  chunk = 23,
+  max_channels = 9,
+};
+
+static float constant_value(void const *const userdata, uint64_t const position, size_t const channel) {
+  (void)position;
+  return ((float const *)userdata)[channel];
+}
+
+// Plays a constant value per channel for a given number of samples.
+static NODISCARD bool constant_create(size_t const channels,
+                                      float const *const values,
+                                      uint64_t const samples,
+                                      struct ovl_audio_decoder **const dp,
+                                      struct ov_error *const err) {
+  if (!test_util_decoder_create(
+          &(struct test_util_decoder_options){
+              .channels = channels,
+              .sample_rate = 48000,
+              .samples = samples,
+              .chunk = chunk,
+              .value = constant_value,
+              .userdata = values,
+          },
+          dp,
+          err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+static bool near(float const a, float const b) { return fabsf(a - b) < 1e-5f; }
+
+static void mixes(void) {
+  struct ovl_audio_mixer *m = NULL;
+  struct ov_error err = {0};
+  struct ovl_audio_decoder *mono = NULL;
+  struct ovl_audio_decoder *stereo = NULL;
+  float const one = 1.f;
+  float const pair[2] = {0.5f, 0.25f};
+
+  if (!TEST_SUCCEEDED(ovl_audio_mixer_create(4, 2, block_size, &m, &err), &err) ||
+      !TEST_SUCCEEDED(constant_create(1, &one, 100, &mono, &err), &err) ||
+      !TEST_SUCCEEDED(constant_create(2, pair, 1000, &stereo, &err), &err)) {
+    goto cleanup;
+  }
+  {
+    uint32_t a = 0;
+    uint32_t b = 0;
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_voice_add(m, mono, 1.f, 0.f, &a, &err), &err) ||
+        !TEST_SUCCEEDED(ovl_audio_mixer_voice_add(m, stereo, 2.f, 0.f, &b, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(a != b);
+    TEST_CHECK(ovl_audio_mixer_voice_is_active(m, a) && ovl_audio_mixer_voice_is_active(m, b));
+
+    // The mono voice is at -3 dB on both sides; the stereo voice keeps its channels apart.
+    float const center = sqrtf(0.5f);
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    size_t bad = 0;
+    for (size_t i = 0; i < block_size; ++i) {
+      bad += !near(pcm[0][i], center + 1.f) || !near(pcm[1][i], center + 0.5f);
+    }
+    TEST_CHECK(bad == 0);
+    TEST_MSG("first block: %zu wrong samples, L=%g R=%g", bad, (double)pcm[0][0], (double)pcm[1][0]);
+
+    // The mono voice ends 36 samples into the second block and stops.
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    bad = 0;
+    for (size_t i = 0; i < block_size; ++i) {
+      float const a_part = i < 100 - block_size ? center : 0.f;
+      bad += !near(pcm[0][i], a_part + 1.f) || !near(pcm[1][i], a_part + 0.5f);
+    }
+    TEST_CHECK(bad == 0);
+    TEST_MSG("second block: %zu wrong samples", bad);
+    TEST_CHECK(!ovl_audio_mixer_voice_is_active(m, a));
+    TEST_CHECK(ovl_audio_mixer_voice_is_active(m, b));
+
+    // Commands for a voice that already stopped are accepted and ignored.
+    TEST_CHECK(ovl_audio_mixer_voice_set_gain(m, a, 3.f, &err));
+    TEST_CHECK(ovl_audio_mixer_voice_remove(m, a, &err));
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(near(pcm[0][0], 1.f) && near(pcm[1][0], 0.5f));
+  }
+
+cleanup:
+  ovl_audio_mixer_destroy(&m);
+  TEST_CHECK(m == NULL);
+  if (stereo) {
+    ovl_audio_decoder_destroy(&stereo);
+  }
+  if (mono) {
+    ovl_audio_decoder_destroy(&mono);
+  }
+}
+
+static void ramps(void) {
+  struct ovl_audio_mixer *m = NULL;
+  struct ov_error err = {0};
+  struct ovl_audio_decoder *mono = NULL;
+  float const one = 1.f;
+
+  if (!TEST_SUCCEEDED(ovl_audio_mixer_create(1, 2, block_size, &m, &err), &err) ||
+      !TEST_SUCCEEDED(constant_create(1, &one, UINT64_MAX, &mono, &err), &err)) {
+    goto cleanup;
+  }
+  {
+    uint32_t v = 0;
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_voice_add(m, mono, 1.f, -1.f, &v, &err), &err)) {
+      goto cleanup;
+    }
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(near(pcm[0][block_size - 1], 1.f) && near(pcm[1][block_size - 1], 0.f));
+
+    // Panning hard right and halving the gain moves across one block and then holds.
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_voice_set_gain(m, v, 0.5f, &err), &err) ||
+        !TEST_SUCCEEDED(ovl_audio_mixer_voice_set_pan(m, v, 1.f, &err), &err) ||
+        !TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    size_t bad = 0;
+    for (size_t i = 0; i < block_size; ++i) {
+      float const t = (float)(i + 1) / (float)block_size;
+      bad += !near(pcm[0][i], 1.f - t) || !near(pcm[1][i], 0.5f * t);
+    }
+    TEST_CHECK(bad == 0);
+    TEST_MSG("ramp: %zu wrong samples", bad);
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(near(pcm[0][0], 0.f) && near(pcm[1][0], 0.5f));
+
+    // Removing fades out over one block, after which the voice is gone.
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_voice_remove(m, v, &err), &err) ||
+        !TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(near(pcm[1][0], 0.5f * (1.f - 1.f / (float)block_size)) && near(pcm[1][block_size - 1], 0.f));
+    TEST_MSG("fade: first=%g last=%g", (double)pcm[1][0], (double)pcm[1][block_size - 1]);
+    TEST_CHECK(!ovl_audio_mixer_voice_is_active(m, v));
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(near(pcm[0][0], 0.f) && near(pcm[1][0], 0.f));
+  }
+
+cleanup:
+  ovl_audio_mixer_destroy(&m);
+  if (mono) {
+    ovl_audio_decoder_destroy(&mono);
+  }
+}
+
+static void limits(void) {
+  struct ovl_audio_mixer *m = NULL;
+  struct ov_error err = {0};
+  struct ovl_audio_decoder *d[3] = {NULL, NULL, NULL};
+  struct ovl_audio_decoder *wide = NULL;
+  float const values[max_channels] = {0};
+
+  TEST_FAILED_WITH(ovl_audio_mixer_create(0, 2, block_size, &m, &err),
+                   &err,
+                   ov_error_type_generic,
+                   ov_error_generic_invalid_argument);
+  if (!TEST_SUCCEEDED(ovl_audio_mixer_create(2, 2, block_size, &m, &err), &err) ||
+      !TEST_SUCCEEDED(constant_create(max_channels, values, 100, &wide, &err), &err)) {
+    goto cleanup;
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    if (!TEST_SUCCEEDED(constant_create(1, values, UINT64_MAX, &d[i], &err), &err)) {
+      goto cleanup;
+    }
+  }
+  {
+    uint32_t v[3] = {0};
+    TEST_FAILED_WITH(ovl_audio_mixer_voice_add(m, wide, 1.f, 0.f, &v[0], &err),
+                     &err,
+                     ov_error_type_generic,
+                     ov_error_generic_invalid_argument);
+    for (size_t i = 0; i < 2; ++i) {
+      if (!TEST_SUCCEEDED(ovl_audio_mixer_voice_add(m, d[i], 1.f, 0.f, &v[i], &err), &err)) {
+        goto cleanup;
+      }
+    }
+    // Every voice is taken until render lets one go.
+    TEST_FAILED_WITH(ovl_audio_mixer_voice_add(m, d[2], 1.f, 0.f, &v[2], &err),
+                     &err,
+                     ov_error_type_generic,
+                     ov_error_generic_fail);
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_voice_remove(m, v[0], &err), &err)) {
+      goto cleanup;
+    }
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_voice_add(m, d[2], 1.f, 0.f, &v[2], &err), &err)) {
+      goto cleanup;
+    }
+    // The slot is reused under a new handle, so the old one stays inactive.
+    TEST_CHECK(v[2] != v[0]);
+    TEST_CHECK(!ovl_audio_mixer_voice_is_active(m, v[0]) && ovl_audio_mixer_voice_is_active(m, v[2]));
+
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      goto cleanup;
+    }
+    TEST_CHECK(ovl_audio_mixer_voice_is_active(m, v[1]) && ovl_audio_mixer_voice_is_active(m, v[2]));
+  }
+
+cleanup:
+  ovl_audio_mixer_destroy(&m);
+  for (size_t i = 0; i < 3; ++i) {
+    if (d[i]) {
+      ovl_audio_decoder_destroy(&d[i]);
+    }
+  }
+  if (wide) {
+    ovl_audio_decoder_destroy(&wide);
+  }
+}
+
+enum {
+  control_threads = 4,
+  rounds = 200,
+};
+
+struct control {
+  struct ovl_audio_mixer *m;
+  size_t index;
+  atomic_size_t *done;
+  bool failed;
+};
+
+static int control_thread(void *userdata) {
+  struct control *const c = (struct control *)userdata;
+  float const values[2] = {0.25f, -0.25f};
+  struct ovl_audio_decoder *sources[2] = {NULL, NULL};
+  struct ov_error err = {0};
+  for (size_t i = 0; i < 2; ++i) {
+    if (!constant_create(1 + i, values, UINT64_MAX, &sources[i], &err)) {
+      OV_ERROR_REPORT(&err, NULL);
+      c->failed = true;
+    }
+  }
+  for (size_t r = 0; r < rounds && !c->failed; ++r) {
+    // Each thread plays one voice at a time, so neither the voices nor the queue can run out.
+    uint32_t v = 0;
+    struct ovl_audio_decoder *const d = sources[(r + c->index) % 2];
+    if (!ovl_audio_mixer_voice_add(c->m, d, 1.f, 0.f, &v, &err) ||
+        !ovl_audio_mixer_voice_set_pan(c->m, v, (float)(r % 3) - 1.f, &err) ||
+        !ovl_audio_mixer_voice_set_gain(c->m, v, 0.5f, &err) || !ovl_audio_mixer_voice_remove(c->m, v, &err)) {
+      OV_ERROR_REPORT(&err, NULL);
+      c->failed = true;
+      break;
+    }
+    // The decoder may only be reused once render has let go of it.
+    while (ovl_audio_mixer_voice_is_active(c->m, v)) {
+      thrd_yield();
+    }
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    if (sources[i]) {
+      ovl_audio_decoder_destroy(&sources[i]);
+    }
+  }
+  atomic_fetch_add(c->done, 1);
+  return 0;
+}
+
+static void threads(void) {
+  struct ovl_audio_mixer *m = NULL;
+  struct ov_error err = {0};
+  struct control controls[control_threads];
+  thrd_t workers[control_threads];
+  size_t started = 0;
+  atomic_size_t done;
+  atomic_init(&done, 0);
+
+  if (!TEST_SUCCEEDED(ovl_audio_mixer_create(control_threads, 2, block_size, &m, &err), &err)) {
+    goto cleanup;
+  }
+  for (; started < control_threads; ++started) {
+    controls[started] = (struct control){.m = m, .index = started, .done = &done};
+    if (!TEST_CHECK(thrd_create(&workers[started], control_thread, &controls[started]) == thrd_success)) {
+      break;
+    }
+  }
+  // Render keeps going until every control thread has seen its last voice stop.
+  while (atomic_load(&done) < started) {
+    float const *const *pcm = NULL;
+    if (!TEST_SUCCEEDED(ovl_audio_mixer_render(m, &pcm, &err), &err)) {
+      break;
+    }
+  }
+  for (size_t i = 0; i < started; ++i) {
+    thrd_join(workers[i], NULL);
+    TEST_CHECK(!controls[i].failed);
+    TEST_MSG("control thread %zu failed", i);
+  }
+
+cleanup:
+  ovl_audio_mixer_destroy(&m);
+}
+
+TEST_LIST = {
+    {"mixes", mixes},
+    {"ramps", ramps},
+    {"limits", limits},
+    {"threads", threads},
+    {NULL, NULL},
+};
@@ -0,0 +1,671 @@
+#include <ovl/audio/peak.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+#include <ovl/file.h>
+#include <ovl/source.h>
+
+#include <math.h>
+#include <ovmo.h>
+#include <ovthreads.h>
+#include <string.h>
+
+// The builder keeps level 0 in memory as floats, with the mean square instead of the RMS so that levels
+// can be merged exactly, and derives each coarser level in place from the one below after writing it.
+// Segments start on a block boundary, so the decoder of each segment fills its own range of level 0.
+
+enum {
+  version = 1,
+  block_shift = 8,
+  block = 1 << block_shift,
+  header_size = 64,
+  level_table_entry_size = 16,
+  channel_entry_size = 6,
+  max_channels = 255,
+  max_levels = 64,
+  write_entries = 4096,
+};
+
+static char const magic[8] = "OVLPEAK";
+
+struct entry {
+  float min;
+  float max;
+  float ms;
+};
+
+struct accumulator {
+  float min;
+  float max;
+  double sum;
+};
+
+struct build;
+
+struct segment {
+  struct build *b;
+  struct ovl_audio_decoder *decoder;
+  struct accumulator *acc;
+  uint64_t start;
+  // UINT64_MAX reads until the decoder ends.
+  uint64_t end;
+  uint64_t decoded;
+  thrd_t thread;
+  bool ok;
+  struct ov_error err;
+};
+
+struct build {
+  size_t channels;
+  // Level 0, channels entries per block. Grows only when a single segment reads to the end.
+  struct entry *entries;
+  uint64_t cap;
+};
+
+struct ovl_audio_peak {
+  struct ovl_source *source;
+  struct ovl_audio_peak_info info;
+  uint64_t offsets[max_levels];
+  uint64_t entries[max_levels];
+  uint8_t *buffer;
+  size_t buffer_cap;
+};
+
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+static inline uint64_t adjust_align8(uint64_t const size) { return (size + UINT64_C(7)) & ~UINT64_C(7); }
+
+static void put_u16(uint8_t *const p, uint16_t const v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *const p, uint32_t const v) {
+  put_u16(p, (uint16_t)v);
+  put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *const p, uint64_t const v) {
+  put_u32(p, (uint32_t)v);
+  put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_u16(uint8_t const *const p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(uint8_t const *const p) { return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16); }
+static uint64_t get_u64(uint8_t const *const p) { return get_u32(p) | ((uint64_t)get_u32(p + 4) << 32); }
+
+static uint16_t quantize_signed(float const v) {
+  float const s = v * 32767.f;
+  int32_t const q = s >= 32767.f ? 32767 : s > -32768.f ? (int32_t)lrintf(s) : -32768;
+  return (uint16_t)q;
+}
+
+static uint16_t quantize_unsigned(float const v) {
+  float const s = v * 65535.f;
+  // NaN becomes 0 as well.
+  return s >= 65535.f ? 65535 : s > 0.f ? (uint16_t)lrintf(s) : 0;
+}
+
+static uint64_t level0_entries(uint64_t const samples) {
+  return (samples >> block_shift) + ((samples & (block - 1)) != 0);
+}
+
+static size_t level_count(uint64_t entries) {
+  size_t levels = 1;
+  while (entries > 1) {
+    entries = (entries + 1) / 2;
+    ++levels;
+  }
+  return levels;
+}
+
+static NODISCARD bool grow(struct build *const b, uint64_t const index, struct ov_error *const err) {
+  if (index < b->cap) {
+    return true;
+  }
+  uint64_t cap = b->cap ? b->cap * 2 : 1024;
+  while (cap <= index) {
+    cap *= 2;
+  }
+  if (cap > SIZE_MAX / sizeof(struct entry) / b->channels ||
+      !OV_REALLOC(&b->entries, (size_t)cap * b->channels, sizeof(struct entry))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  b->cap = cap;
+  return true;
+}
+
+static void reset(struct accumulator *const acc, size_t const channels) {
+  for (size_t ch = 0; ch < channels; ++ch) {
+    acc[ch] = (struct accumulator){.min = INFINITY, .max = -INFINITY, .sum = 0.0};
+  }
+}
+
+static void accumulate(struct accumulator *const acc, float const *const src, size_t const n) {
+  // Summing sample by sample keeps the result independent of how the decoder splits its reads.
+  float lo = acc->min;
+  float hi = acc->max;
+  double sum = acc->sum;
+  for (size_t i = 0; i < n; ++i) {
+    float const v = src[i];
+    lo = v < lo ? v : lo;
+    hi = v > hi ? v : hi;
+    sum += (double)v * (double)v;
+  }
+  acc->min = lo;
+  acc->max = hi;
+  acc->sum = sum;
+}
+
+static NODISCARD bool
+flush(struct segment *const s, uint64_t const index, size_t const filled, struct ov_error *const err) {
+  struct build *const b = s->b;
+  if (!grow(b, index, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  struct entry *const e = b->entries + index * b->channels;
+  for (size_t ch = 0; ch < b->channels; ++ch) {
+    e[ch] = (struct entry){
+        .min = s->acc[ch].min,
+        .max = s->acc[ch].max,
+        .ms = (float)(s->acc[ch].sum / (double)filled),
+    };
+  }
+  reset(s->acc, b->channels);
+  return true;
+}
+
+static NODISCARD bool decode_segment(struct segment *const s, struct ov_error *const err) {
+  size_t const channels = s->b->channels;
+  uint64_t index = s->start >> block_shift;
+  uint64_t pos = s->start;
+  size_t filled = 0;
+  bool result = false;
+
+  {
+    if (s->start == s->end) {
+      // More decoders than blocks.
+      result = true;
+      goto cleanup;
+    }
+    if (!ovl_audio_decoder_seek(s->decoder, s->start, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    reset(s->acc, channels);
+    while (pos < s->end) {
+      float const *const *pcm = NULL;
+      size_t n = 0;
+      if (!ovl_audio_decoder_read(s->decoder, &pcm, &n, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      if (n == 0) {
+        break;
+      }
+      if (n > s->end - pos) {
+        n = (size_t)(s->end - pos);
+      }
+      size_t off = 0;
+      while (off < n) {
+        size_t const span = min2(n - off, block - filled);
+        for (size_t ch = 0; ch < channels; ++ch) {
+          accumulate(&s->acc[ch], pcm[ch] + off, span);
+        }
+        off += span;
+        filled += span;
+        if (filled == block) {
+          if (!flush(s, index++, filled, err)) {
+            OV_ERROR_ADD_TRACE(err);
+            goto cleanup;
+          }
+          filled = 0;
+        }
+      }
+      pos += n;
+    }
+    if (filled && !flush(s, index, filled, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    s->decoded = pos - s->start;
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static int segment_thread(void *const userdata) {
+  struct segment *const s = (struct segment *)userdata;
+  s->ok = decode_segment(s, &s->err);
+  return 0;
+}
+
+static NODISCARD bool write_all(struct ovl_file *const file,
+                                void const *const buffer,
+                                size_t const bytes,
+                                struct ov_error *const err) {
+  size_t written = 0;
+  if (!ovl_file_write(file, buffer, bytes, &written, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  if (written != bytes) {
+    OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to write peak file"));
+    return false;
+  }
+  return true;
+}
+
+static NODISCARD bool write_level(struct ovl_file *const file,
+                                  struct entry const *const entries,
+                                  uint64_t const count,
+                                  size_t const channels,
+                                  uint8_t *const buffer,
+                                  struct ov_error *const err) {
+  for (uint64_t i = 0; i < count;) {
+    size_t const n = (size_t)(count - i < write_entries ? count - i : write_entries);
+    uint8_t *p = buffer;
+    for (size_t j = 0; j < n * channels; ++j) {
+      struct entry const *const e = entries + i * channels + j;
+      put_u16(p, quantize_signed(e->min));
+      put_u16(p + 2, quantize_signed(e->max));
+      put_u16(p + 4, quantize_unsigned(sqrtf(e->ms)));
+      p += channel_entry_size;
+    }
+    if (!write_all(file, buffer, (size_t)(p - buffer), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      return false;
+    }
+    i += n;
+  }
+  static uint8_t const zeros[8] = {0};
+  size_t const bytes = (size_t)(count * channels * channel_entry_size);
+  if (!write_all(file, zeros, (size_t)(adjust_align8(bytes) - bytes), err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Merges pairs of entries of a level into the next level, in place.
+ * size is the number of samples in an entry of the source level; the last entry may hold fewer.
+ */
+static void merge_level(struct entry *const entries,
+                        uint64_t const count,
+                        size_t const channels,
+                        uint64_t const size,
+                        uint64_t const samples) {
+  for (uint64_t j = 0; j * 2 < count; ++j) {
+    uint64_t const a = j * 2;
+    if (a + 1 == count) {
+      memmove(entries + j * channels, entries + a * channels, channels * sizeof(struct entry));
+      continue;
+    }
+    uint64_t const tail = samples - (a + 1) * size;
+    double const wb = (double)(tail < size ? tail : size) / (double)size;
+    for (size_t ch = 0; ch < channels; ++ch) {
+      struct entry const ea = entries[a * channels + ch];
+      struct entry const eb = entries[(a + 1) * channels + ch];
+      entries[j * channels + ch] = (struct entry){
+          .min = ea.min < eb.min ? ea.min : eb.min,
+          .max = ea.max > eb.max ? ea.max : eb.max,
+          .ms = (float)(((double)ea.ms + (double)eb.ms * wb) / (1.0 + wb)),
+      };
+    }
+  }
+}
+
+static NODISCARD bool write_file(struct build *const b,
+                                 size_t const sample_rate,
+                                 uint64_t const samples,
+                                 NATIVE_CHAR const *const path,
+                                 struct ov_error *const err) {
+  size_t const channels = b->channels;
+  uint64_t const count0 = level0_entries(samples);
+  size_t const levels = level_count(count0);
+  struct ovl_file *file = NULL;
+  uint8_t *buffer = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&buffer, header_size + levels * level_table_entry_size, 1)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memset(buffer, 0, header_size);
+    memcpy(buffer, magic, sizeof(magic));
+    put_u32(buffer + 8, version);
+    put_u32(buffer + 12, (uint32_t)channels);
+    put_u32(buffer + 16, (uint32_t)sample_rate);
+    put_u32(buffer + 20, block_shift);
+    put_u32(buffer + 24, (uint32_t)levels);
+    put_u64(buffer + 32, samples);
+    uint64_t offset = adjust_align8(header_size + levels * level_table_entry_size);
+    uint64_t count = count0;
+    for (size_t k = 0; k < levels; ++k) {
+      uint8_t *const t = buffer + header_size + k * level_table_entry_size;
+      put_u64(t, offset);
+      put_u64(t + 8, count);
+      offset = adjust_align8(offset + count * channels * channel_entry_size);
+      count = (count + 1) / 2;
+    }
+
+    if (!ovl_file_create(path, &file, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    size_t const table_bytes = header_size + levels * level_table_entry_size;
+    static uint8_t const zeros[8] = {0};
+    if (!write_all(file, buffer, table_bytes, err) ||
+        !write_all(file, zeros, (size_t)(adjust_align8(table_bytes) - table_bytes), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+
+    if (!OV_REALLOC(&buffer, write_entries * channels * channel_entry_size, 1)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    count = count0;
+    for (size_t k = 0; k < levels; ++k) {
+      if (!write_level(file, b->entries, count, channels, buffer, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      merge_level(b->entries, count, channels, (uint64_t)block << k, samples);
+      count = (count + 1) / 2;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (file) {
+    ovl_file_close(file);
+  }
+  if (buffer) {
+    OV_FREE(&buffer);
+  }
+  return result;
+}
+
+NODISCARD bool ovl_audio_peak_build(struct ovl_audio_decoder *const *const decoders,
+                                    size_t const count,
+                                    NATIVE_CHAR const *const path,
+                                    struct ov_error *const err) {
+  if (!decoders || !count || !path) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  struct ovl_audio_info const *const info = ovl_audio_decoder_get_info(decoders[0]);
+  size_t const channels = info->channels;
+  if (!channels || channels > max_channels || (count > 1 && info->samples == UINT64_MAX)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct build b = {.channels = channels};
+  struct segment *segments = NULL;
+  size_t started = 1;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&segments, count, sizeof(struct segment))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memset(segments, 0, count * sizeof(struct segment));
+    uint64_t const blocks = level0_entries(info->samples == UINT64_MAX ? 0 : info->samples);
+    uint64_t const per_segment = (blocks + count - 1) / count;
+    for (size_t i = 0; i < count; ++i) {
+      struct segment *const s = &segments[i];
+      *s = (struct segment){
+          .b = &b,
+          .decoder = decoders[i],
+          .start = i ? segments[i - 1].end : 0,
+          .end = UINT64_MAX,
+          .ok = true,
+      };
+      if (count > 1) {
+        uint64_t const end = i + 1 == count ? info->samples : ((uint64_t)(i + 1) * per_segment) << block_shift;
+        s->end = end < info->samples ? end : info->samples;
+      }
+      if (!OV_REALLOC(&s->acc, channels, sizeof(struct accumulator))) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        goto cleanup;
+      }
+    }
+    // With more than one segment every entry is known beforehand, so nothing grows while threads run.
+    if (blocks && !grow(&b, blocks - 1, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+
+    for (; started < count; ++started) {
+      if (thrd_create(&segments[started].thread, segment_thread, &segments[started]) != thrd_success) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to create thread"));
+        goto cleanup;
+      }
+    }
+    segments[0].ok = decode_segment(&segments[0], err);
+    for (; started > 1; --started) {
+      thrd_join(segments[started - 1].thread, NULL);
+    }
+    if (!segments[0].ok) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    uint64_t samples = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (!segments[i].ok) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to decode audio"));
+        goto cleanup;
+      }
+      // Every segment but the last must be complete, or level 0 would have holes.
+      if (i + 1 < count && segments[i].decoded != segments[i].end - segments[i].start) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Audio stream ended early"));
+        goto cleanup;
+      }
+      samples += segments[i].decoded;
+    }
+    if (!write_file(&b, info->sample_rate, samples, path, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  for (; started > 1; --started) {
+    thrd_join(segments[started - 1].thread, NULL);
+  }
+  if (segments) {
+    for (size_t i = 0; i < count; ++i) {
+      if (i && !segments[i].ok) {
+        OV_ERROR_REPORT(&segments[i].err, NULL);
+      }
+      if (segments[i].acc) {
+        OV_FREE(&segments[i].acc);
+      }
+    }
+    OV_FREE(&segments);
+  }
+  if (b.entries) {
+    OV_FREE(&b.entries);
+  }
+  return result;
+}
+
+NODISCARD bool
+ovl_audio_peak_open(struct ovl_source *const source, struct ovl_audio_peak **const pp, struct ov_error *const err) {
+  if (!source || !pp || *pp) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct ovl_audio_peak *p = NULL;
+  uint8_t header[header_size];
+  uint8_t table[max_levels * level_table_entry_size];
+  bool result = false;
+
+  {
+    uint64_t const size = ovl_source_size(source);
+    if (size == UINT64_MAX || ovl_source_read(source, header, 0, header_size) != header_size) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read peak file"));
+      goto cleanup;
+    }
+    size_t const channels = get_u32(header + 12);
+    uint32_t const shift = get_u32(header + 20);
+    size_t const levels = get_u32(header + 24);
+    uint64_t const samples = get_u64(header + 32);
+    if (memcmp(header, magic, sizeof(magic)) != 0 || get_u32(header + 8) != version || !channels ||
+        channels > max_channels || shift != block_shift || !levels || levels > max_levels ||
+        levels != level_count(level0_entries(samples)) || shift + levels - 1 >= 64) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Invalid peak file"));
+      goto cleanup;
+    }
+    size_t const table_bytes = levels * level_table_entry_size;
+    if (ovl_source_read(source, table, header_size, table_bytes) != table_bytes) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read peak file"));
+      goto cleanup;
+    }
+
+    if (!OV_REALLOC(&p, 1, sizeof(struct ovl_audio_peak))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    *p = (struct ovl_audio_peak){
+        .source = source,
+        .info =
+            {
+                .samples = samples,
+                .sample_rate = get_u32(header + 16),
+                .channels = channels,
+                .block = block,
+                .levels = levels,
+            },
+    };
+    uint64_t const stride = channels * channel_entry_size;
+    uint64_t count = level0_entries(samples);
+    for (size_t k = 0; k < levels; ++k) {
+      uint64_t const offset = get_u64(table + k * level_table_entry_size);
+      uint64_t const entries = get_u64(table + k * level_table_entry_size + 8);
+      if (entries != count || offset % 8 || offset < header_size + table_bytes || offset > size ||
+          entries > (size - offset) / stride) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Invalid peak file"));
+        goto cleanup;
+      }
+      p->offsets[k] = offset;
+      p->entries[k] = entries;
+      count = (count + 1) / 2;
+    }
+    *pp = p;
+    p = NULL;
+  }
+  result = true;
+
+cleanup:
+  if (p) {
+    ovl_audio_peak_destroy(&p);
+  }
+  return result;
+}
+
+void ovl_audio_peak_destroy(struct ovl_audio_peak **const pp) {
+  if (!pp || !*pp) {
+    return;
+  }
+  struct ovl_audio_peak *const p = *pp;
+  if (p->buffer) {
+    OV_FREE(&p->buffer);
+  }
+  OV_FREE(pp);
+}
+
+struct ovl_audio_peak_info const *ovl_audio_peak_get_info(struct ovl_audio_peak const *const p) {
+  return p ? &p->info : NULL;
+}
+
+NODISCARD bool ovl_audio_peak_query(struct ovl_audio_peak *const p,
+                                    size_t const channel,
+                                    uint64_t const start,
+                                    double const samples_per_pixel,
+                                    size_t const pixels,
+                                    struct ovl_audio_peak_value *const values,
+                                    struct ov_error *const err) {
+  if (!p || channel >= p->info.channels || !(samples_per_pixel > 0.0) || isinf(samples_per_pixel) ||
+      (pixels && !values)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+  if (!pixels) {
+    return true;
+  }
+
+  size_t level = 0;
+  while (level + 1 < p->info.levels && ldexp((double)block, (int)level + 1) <= samples_per_pixel) {
+    ++level;
+  }
+  double const size = ldexp((double)block, (int)level);
+  uint64_t const count = p->entries[level];
+  size_t const stride = p->info.channels * channel_entry_size;
+
+  // Only the entries under the pixels are read; a pixel spans at most three of them.
+  double const first = (double)start / size;
+  double const last = ceil(((double)start + (double)pixels * samples_per_pixel) / size);
+  uint64_t const lo = first < (double)count ? (uint64_t)first : count;
+  uint64_t const hi = last < (double)count ? (uint64_t)last : count;
+  if (hi > lo) {
+    if ((hi - lo) > SIZE_MAX / stride) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      return false;
+    }
+    size_t const bytes = (size_t)(hi - lo) * stride;
+    if (bytes > p->buffer_cap) {
+      if (!OV_REALLOC(&p->buffer, bytes, 1)) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        return false;
+      }
+      p->buffer_cap = bytes;
+    }
+    if (ovl_source_read(p->source, p->buffer, p->offsets[level] + lo * stride, bytes) != bytes) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read peak file"));
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < pixels; ++i) {
+    double const a = ((double)start + (double)i * samples_per_pixel) / size;
+    double const z = ((double)start + (double)(i + 1) * samples_per_pixel) / size;
+    uint64_t const e0 = a < (double)hi ? (uint64_t)a : hi;
+    uint64_t e1 = z < (double)hi ? (uint64_t)ceil(z) : hi;
+    if (e0 >= hi) {
+      values[i] = (struct ovl_audio_peak_value){0};
+      continue;
+    }
+    if (e1 <= e0) {
+      e1 = e0 + 1;
+    }
+    float lo_v = INFINITY;
+    float hi_v = -INFINITY;
+    float ms = 0.f;
+    for (uint64_t e = e0; e < e1; ++e) {
+      uint8_t const *const q = p->buffer + (size_t)(e - lo) * stride + channel * channel_entry_size;
+      float const mn = (float)(int16_t)get_u16(q) * (1.f / 32767.f);
+      float const mx = (float)(int16_t)get_u16(q + 2) * (1.f / 32767.f);
+      float const rms = (float)get_u16(q + 4) * (1.f / 65535.f);
+      lo_v = mn < lo_v ? mn : lo_v;
+      hi_v = mx > hi_v ? mx : hi_v;
+      ms += rms * rms;
+    }
+    values[i] = (struct ovl_audio_peak_value){
+        .min = lo_v,
+        .max = hi_v,
+        .rms = sqrtf(ms / (float)(e1 - e0)),
+    };
+  }
+  return true;
+}
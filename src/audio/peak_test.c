@@ -0,0 +1,248 @@
+#include <ovtest.h>
+
+#include <ovarray.h>
+
+#include "../test_util.h"
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+#include <ovl/audio/peak.h>
+#include <ovl/file.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+#include <ovl/source/memory.h>
+
+#include <math.h>
+#include <string.h>
+
+enum {
+  channels = 2,
+  // Not a multiple of the block, so the last entry of every level is partial.
+  length = 300000 + 37,
+  // Not a multiple of the block either, so blocks straddle reads.
+  chunk = 1000,
+  decoders = 3,
+};
+
+// A swept sine whose amplitude differs per channel, computed from the position so any decoder can seek.
+static float sweep_value(void const *const userdata, uint64_t const i, size_t const ch) {
+  (void)userdata;
+  float const t = (float)i / (float)length;
+  return sinf((float)i * (0.01f + t * 0.05f)) * (0.25f + t * 0.7f) / (float)(ch + 1);
+}
+
+static NODISCARD bool sweep_create(uint64_t const samples, struct ovl_audio_decoder **const dp) {
+  struct ov_error err = {0};
+  return TEST_SUCCEEDED(test_util_decoder_create(
+                            &(struct test_util_decoder_options){
+                                .channels = channels,
+                                .sample_rate = 48000,
+                                .samples = samples,
+                                .position = 12345,
+                                .chunk = chunk,
+                                .value = sweep_value,
+                            },
+                            dp,
+                            &err),
+                        &err);
+}
+
+static void destroy_all(struct ovl_audio_decoder **const ds, size_t const count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (ds[i]) {
+      ovl_audio_decoder_destroy(&ds[i]);
+    }
+  }
+}
+
+/**
+ * Builds a peak file from count decoders into a new temporary file and returns its path.
+ */
+static NATIVE_CHAR *build(size_t const count, NATIVE_CHAR const *const name) {
+  struct ov_error err = {0};
+  struct ovl_file *file = NULL;
+  NATIVE_CHAR *path = NULL;
+  if (!TEST_SUCCEEDED(ovl_file_create_temp(name, &file, &path, &err), &err)) {
+    return NULL;
+  }
+  ovl_file_close(file);
+  struct ovl_audio_decoder *ds[decoders] = {NULL};
+  bool ok = true;
+  for (size_t i = 0; ok && i < count; ++i) {
+    ok = sweep_create(length, &ds[i]);
+  }
+  ok = ok && TEST_SUCCEEDED(ovl_audio_peak_build(ds, count, path, &err), &err);
+  destroy_all(ds, count);
+  if (!ok) {
+    DeleteFileW(path);
+    OV_ARRAY_DESTROY(&path);
+    return NULL;
+  }
+  return path;
+}
+
+static void query(void) {
+  struct ov_error err = {0};
+  struct ovl_source *src = NULL;
+  struct ovl_audio_peak *p = NULL;
+  NATIVE_CHAR *path = build(1, NSTR("ovl_test_peak.peak"));
+  if (!path) {
+    return;
+  }
+  if (!TEST_SUCCEEDED(ovl_source_file_create(path, &src, &err), &err) ||
+      !TEST_SUCCEEDED(ovl_audio_peak_open(src, &p, &err), &err)) {
+    goto cleanup;
+  }
+
+  {
+    struct ovl_audio_peak_info const *const info = ovl_audio_peak_get_info(p);
+    TEST_CHECK(info->samples == length);
+    TEST_CHECK(info->sample_rate == 48000);
+    TEST_CHECK(info->channels == channels);
+    TEST_CHECK(info->block == 256);
+    // 1173 entries at level 0 halve down to one in 11 more levels.
+    TEST_CHECK(info->levels == 12);
+    TEST_MSG("levels=%zu", info->levels);
+
+    // Pixels that line up with entries of some level give exactly the values of their samples.
+    static size_t const zooms[] = {256, 1024, 16384, 131072};
+    enum { pixels = 64 };
+    for (size_t z = 0; z < sizeof(zooms) / sizeof(zooms[0]); ++z) {
+      for (size_t ch = 0; ch < channels; ++ch) {
+        uint64_t const start = zooms[z];
+        struct ovl_audio_peak_value values[pixels];
+        if (!TEST_SUCCEEDED(ovl_audio_peak_query(p, ch, start, (double)zooms[z], pixels, values, &err), &err)) {
+          goto cleanup;
+        }
+        size_t bad = 0;
+        for (size_t i = 0; i < pixels; ++i) {
+          uint64_t const a = start + i * zooms[z];
+          uint64_t const b = a + zooms[z] < length ? a + zooms[z] : length;
+          if (a >= length) {
+            bad += !(values[i].max <= 0.f && values[i].max >= 0.f && values[i].rms <= 0.f);
+            continue;
+          }
+          float lo = INFINITY;
+          float hi = -INFINITY;
+          double sum = 0.0;
+          for (uint64_t s = a; s < b; ++s) {
+            float const v = sweep_value(NULL, s, ch);
+            lo = v < lo ? v : lo;
+            hi = v > hi ? v : hi;
+            sum += (double)v * (double)v;
+          }
+          float const rms = (float)sqrt(sum / (double)(b - a));
+          bad += fabsf(values[i].min - lo) > 1e-4f || fabsf(values[i].max - hi) > 1e-4f ||
+                 fabsf(values[i].rms - rms) > rms * 0.01f + 1e-4f;
+        }
+        TEST_CHECK(bad == 0);
+        TEST_MSG("zoom=%zu channel=%zu: %zu wrong pixels", zooms[z], ch, bad);
+      }
+    }
+
+    // Any zoom between two levels covers every sample once.
+    struct ovl_audio_peak_value whole;
+    if (TEST_SUCCEEDED(ovl_audio_peak_query(p, 0, 0, (double)length, 1, &whole, &err), &err)) {
+      TEST_CHECK(whole.max > 0.9f && whole.max <= 1.f);
+      TEST_CHECK(whole.min < -0.9f && whole.min >= -1.f);
+    }
+
+    struct ovl_audio_peak_value value;
+    TEST_FAILED_WITH(ovl_audio_peak_query(p, channels, 0, 256.0, 1, &value, &err),
+                     &err,
+                     ov_error_type_generic,
+                     ov_error_generic_invalid_argument);
+    TEST_FAILED_WITH(ovl_audio_peak_query(p, 0, 0, 0.0, 1, &value, &err),
+                     &err,
+                     ov_error_type_generic,
+                     ov_error_generic_invalid_argument);
+  }
+
+cleanup:
+  if (p) {
+    ovl_audio_peak_destroy(&p);
+  }
+  if (src) {
+    ovl_source_destroy(&src);
+  }
+  DeleteFileW(path);
+  OV_ARRAY_DESTROY(&path);
+}
+
+static NODISCARD bool read_all(NATIVE_CHAR const *const path, uint8_t **const data, size_t *const size) {
+  struct ov_error err = {0};
+  struct ovl_source *src = NULL;
+  bool result = false;
+  if (!TEST_SUCCEEDED(ovl_source_file_create(path, &src, &err), &err)) {
+    goto cleanup;
+  }
+  *size = (size_t)ovl_source_size(src);
+  if (!TEST_CHECK(OV_REALLOC(data, *size, 1)) || !TEST_CHECK(ovl_source_read(src, *data, 0, *size) == *size)) {
+    goto cleanup;
+  }
+  result = true;
+
+cleanup:
+  if (src) {
+    ovl_source_destroy(&src);
+  }
+  return result;
+}
+
+static void segments(void) {
+  NATIVE_CHAR *single = build(1, NSTR("ovl_test_peak_single.peak"));
+  NATIVE_CHAR *parallel = build(decoders, NSTR("ovl_test_peak_parallel.peak"));
+  uint8_t *a = NULL;
+  uint8_t *b = NULL;
+  size_t a_size = 0;
+  size_t b_size = 0;
+  if (!single || !parallel || !read_all(single, &a, &a_size) || !read_all(parallel, &b, &b_size)) {
+    goto cleanup;
+  }
+  // Decoding in segments must not change a single byte.
+  TEST_CHECK(a_size == b_size && memcmp(a, b, a_size) == 0);
+
+cleanup:
+  if (b) {
+    OV_FREE(&b);
+  }
+  if (a) {
+    OV_FREE(&a);
+  }
+  if (parallel) {
+    DeleteFileW(parallel);
+    OV_ARRAY_DESTROY(&parallel);
+  }
+  if (single) {
+    DeleteFileW(single);
+    OV_ARRAY_DESTROY(&single);
+  }
+}
+
+static void invalid(void) {
+  struct ov_error err = {0};
+  struct ovl_source *src = NULL;
+  struct ovl_audio_peak *p = NULL;
+  static uint8_t const garbage[128] = "OVLPEAK";
+  if (!TEST_SUCCEEDED(ovl_source_memory_create(garbage, sizeof(garbage), &src, &err), &err)) {
+    return;
+  }
+  TEST_FAILED_WITH(ovl_audio_peak_open(src, &p, &err), &err, ov_error_type_generic, ov_error_generic_fail);
+  ovl_source_destroy(&src);
+
+  // Segments need to know where the stream ends.
+  struct ovl_audio_decoder *ds[2] = {NULL, NULL};
+  if (sweep_create(UINT64_MAX, &ds[0]) && sweep_create(UINT64_MAX, &ds[1])) {
+    TEST_FAILED_WITH(ovl_audio_peak_build(ds, 2, NSTR("unused.peak"), &err),
+                     &err,
+                     ov_error_type_generic,
+                     ov_error_generic_invalid_argument);
+  }
+  destroy_all(ds, 2);
+}
+
+TEST_LIST = {
+    {"query", query},
+    {"segments", segments},
+    {"invalid", invalid},
+    {NULL, NULL},
+};
@@ -0,0 +1,720 @@
+#include "probe.h"
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/mp3.h>
+#include <ovl/audio/decoder/ogg.h>
+#include <ovl/audio/decoder/opus.h>
+#include <ovl/audio/decoder/wav.h>
+#include <ovl/audio/info.h>
+#include <ovl/source.h>
+
+#include <ovmo.h>
+#include <string.h>
+
+#include "tag.h"
+#include "tag/id3v2.h"
+#include "tag/vorbis_comment.h"
+
+// Every format is recognized from its first bytes, after an ID3v2 tag if there is one. WAVE and its relatives go
+// to their decoder, whose open only walks the chunk headers. FLAC is read up to the end of its metadata blocks,
+// Ogg up to the comment header and then its last page, MP3 only around its first frame and its trailing tags.
+// Where the headers cannot give the answer the decoder would, the decoder is opened instead.
+
+enum {
+  head_size = 16,
+  mp3_search_size = 64 * 1024,
+  ogg_page_header_size = 27,
+  ogg_max_page_header_size = ogg_page_header_size + 255,
+  ogg_tail_size = 128 * 1024,
+  max_comment_size = 16 * 1024 * 1024,
+  // minimp3 adds the decoder delay of LAME to the encoder delay of the LAME extension, and takes it off the padding.
+  lame_decoder_delay = 528 + 1,
+};
+
+typedef bool (*decoder_create_func)(struct ovl_source *const source,
+                                    struct ovl_audio_decoder **const dp,
+                                    struct ov_error *const err);
+
+static inline uint16_t le16(uint8_t const *const p) { return (uint16_t)(p[0] | p[1] << 8); }
+static inline uint32_t le32(uint8_t const *const p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+static inline uint64_t le64(uint8_t const *const p) { return (uint64_t)le32(p) | (uint64_t)le32(p + 4) << 32; }
+static inline uint32_t be32(uint8_t const *const p) {
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+static inline bool read_at(struct ovl_source *const source, void *const p, uint64_t const offset, size_t const len) {
+  return ovl_source_read(source, p, offset, len) == len;
+}
+
+// Returns the size of the ID3v2 tag at the start of h, header and footer included, or 0 when there is none.
+static uint64_t id3v2_size(uint8_t const *const h, size_t const len) {
+  if (len < 10 || memcmp(h, "ID3", 3) != 0 || h[3] == 0xff || h[4] == 0xff || ((h[6] | h[7] | h[8] | h[9]) & 0x80)) {
+    return 0;
+  }
+  uint64_t const size = 10 + ((uint64_t)h[6] << 21 | (uint64_t)h[7] << 14 | (uint64_t)h[8] << 7 | (uint64_t)h[9]);
+  return h[5] & 0x10 ? size + 10 : size;
+}
+
+static NODISCARD bool probe_with_decoder(struct ovl_source *const source,
+                                         decoder_create_func const create,
+                                         struct ovl_audio_info *const info,
+                                         struct ov_error *const err) {
+  struct ovl_audio_decoder *d = NULL;
+  bool result = false;
+
+  {
+    if (!create(source, &d, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    struct ovl_audio_info const *const di = ovl_audio_decoder_get_info(d);
+    info->sample_rate = di->sample_rate;
+    info->channels = di->channels;
+    info->samples = di->samples;
+    info->tag.loop_start = di->tag.loop_start;
+    info->tag.loop_end = di->tag.loop_end;
+    info->tag.loop_length = di->tag.loop_length;
+    if (di->tag.title && !ovl_audio_tag_set_title(&info->tag, di->tag.title, strlen(di->tag.title), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (di->tag.artist && !ovl_audio_tag_set_artist(&info->tag, di->tag.artist, strlen(di->tag.artist), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  return result;
+}
+
+struct comment_entry {
+  char const *p;
+  size_t len;
+};
+
+struct comments {
+  struct comment_entry *entries;
+  size_t len;
+};
+
+static size_t get_entry(void *const userdata, size_t const n, char const **const entry) {
+  struct comments const *const c = (struct comments const *)userdata;
+  if (n >= c->len) {
+    return 0;
+  }
+  *entry = c->entries[n].p;
+  return c->entries[n].len;
+}
+
+// Reads a Vorbis comment list, the body of a FLAC VORBIS_COMMENT block and of the Vorbis and Opus comment headers.
+// Entries past a malformed one are ignored.
+static NODISCARD bool
+read_comments(struct ovl_audio_tag *const tag, uint8_t const *const p, size_t const len, struct ov_error *const err) {
+  struct comments c = {0};
+  bool result = false;
+
+  {
+    if (len < 8 || le32(p) > len - 8) {
+      result = true;
+      goto cleanup;
+    }
+    size_t pos = 4 + le32(p);
+    size_t const count = le32(p + pos);
+    pos += 4;
+    if (count > (len - pos) / 4) {
+      result = true;
+      goto cleanup;
+    }
+    if (count && !OV_REALLOC(&c.entries, count, sizeof(struct comment_entry))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    for (size_t i = 0; i < count && len - pos >= 4; ++i) {
+      size_t const entry_len = le32(p + pos);
+      pos += 4;
+      if (entry_len > len - pos) {
+        break;
+      }
+      c.entries[c.len++] = (struct comment_entry){(char const *)(p + pos), entry_len};
+      pos += entry_len;
+    }
+    if (!ovl_audio_tag_vorbis_comment_read(tag, c.len, &c, get_entry, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (c.entries) {
+    OV_FREE(&c.entries);
+  }
+  return result;
+}
+
+static NODISCARD bool probe_flac(struct ovl_source *const source,
+                                 uint64_t const start,
+                                 struct ovl_audio_info *const info,
+                                 struct ov_error *const err) {
+  uint8_t *block = NULL;
+  size_t block_cap = 0;
+  bool result = false;
+
+  {
+    uint64_t offset = start + 4;
+    bool streaminfo = false;
+    for (;;) {
+      uint8_t h[4];
+      if (!read_at(source, h, offset, sizeof(h))) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read FLAC metadata"));
+        goto cleanup;
+      }
+      offset += sizeof(h);
+      size_t const len = (size_t)h[1] << 16 | (size_t)h[2] << 8 | (size_t)h[3];
+      uint8_t const type = h[0] & 0x7f;
+      // STREAMINFO and VORBIS_COMMENT are the only blocks the decoder reads too.
+      if ((type == 0 && len >= 34) || type == 4) {
+        if (len > block_cap) {
+          if (!OV_REALLOC(&block, len, 1)) {
+            OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+            goto cleanup;
+          }
+          block_cap = len;
+        }
+        if (!read_at(source, block, offset, len)) {
+          OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read FLAC metadata"));
+          goto cleanup;
+        }
+        if (type == 0) {
+          info->sample_rate = (size_t)block[10] << 12 | (size_t)block[11] << 4 | (size_t)block[12] >> 4;
+          info->channels = ((size_t)(block[12] >> 1) & 7) + 1;
+          info->samples = (uint64_t)(block[13] & 0x0f) << 32 | be32(block + 14);
+          streaminfo = true;
+        } else if (!read_comments(&info->tag, block, len, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+      }
+      offset += len;
+      if (h[0] & 0x80) {
+        break;
+      }
+    }
+    if (!streaminfo) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("FLAC stream has no STREAMINFO"));
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (block) {
+    OV_FREE(&block);
+  }
+  return result;
+}
+
+struct mpeg_frame {
+  bool mpeg1;
+  bool mono;
+  bool crc;
+  size_t layer;
+  size_t sample_rate;
+  size_t bitrate; // bits per second, 0 for free format
+  size_t samples;
+  size_t bytes; // 0 for free format
+};
+
+static bool parse_mpeg_frame(uint8_t const *const h, struct mpeg_frame *const f) {
+  static uint16_t const bitrates[2][3][15] = {
+      {
+          {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+          {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+          {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},
+      },
+      {
+          {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},
+          {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+          {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+      },
+  };
+  static uint32_t const rates[3] = {44100, 48000, 32000};
+  if (h[0] != 0xff || (h[1] & 0xe0) != 0xe0) {
+    return false;
+  }
+  // Version 0 is MPEG 2.5, 1 is reserved, 2 is MPEG 2 and 3 is MPEG 1; layer 4 is reserved.
+  size_t const version = (h[1] >> 3) & 3;
+  size_t const layer = 4 - ((h[1] >> 1) & 3);
+  size_t const bitrate_index = h[2] >> 4;
+  size_t const rate_index = (h[2] >> 2) & 3;
+  if (version == 1 || layer == 4 || bitrate_index == 15 || rate_index == 3) {
+    return false;
+  }
+  bool const mpeg1 = version == 3;
+  size_t const rate = rates[rate_index] >> (mpeg1 ? 0 : version == 2 ? 1 : 2);
+  size_t const samples = layer == 1 ? 384 : layer == 2 || mpeg1 ? 1152 : 576;
+  size_t const bitrate = (size_t)bitrates[mpeg1 ? 0 : 1][layer - 1][bitrate_index] * 1000;
+  size_t const padding = (h[2] >> 1) & 1;
+  *f = (struct mpeg_frame){
+      .mpeg1 = mpeg1,
+      .mono = (h[3] & 0xc0) == 0xc0,
+      .crc = !(h[1] & 1),
+      .layer = layer,
+      .sample_rate = rate,
+      .bitrate = bitrate,
+      .samples = samples,
+      .bytes = !bitrate           ? 0
+               : layer == 1       ? (12 * bitrate / rate + padding) * 4
+                                  : samples / 8 * bitrate / rate + padding,
+  };
+  return true;
+}
+
+// Finds the first frame whose successor starts right after it with the same version, layer and sample rate.
+static bool find_mpeg_frame(uint8_t const *const buf, size_t const len, size_t *const pos, struct mpeg_frame *const f) {
+  for (size_t i = 0; i + 4 <= len; ++i) {
+    if (!parse_mpeg_frame(buf + i, f) || !f->bytes || i + f->bytes + 4 > len) {
+      continue;
+    }
+    uint8_t const *const next = buf + i + f->bytes;
+    struct mpeg_frame g;
+    if (parse_mpeg_frame(next, &g) && (next[1] & 0x1e) == (buf[i + 1] & 0x1e) &&
+        (next[2] & 0x0c) == (buf[i + 2] & 0x0c)) {
+      *pos = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reads the frame count of a Xing or Info header and the delay and padding of its LAME extension, with the same
+// rules as minimp3 so the length matches the decoder.
+static bool read_xing(uint8_t const *const frame, struct mpeg_frame const *const f, uint64_t *const samples) {
+  if (f->layer != 3) {
+    return false;
+  }
+  size_t pos = 4 + (f->crc ? 2 : 0) + (f->mpeg1 ? (f->mono ? 17 : 32) : (f->mono ? 9 : 17));
+  if (pos + 12 > f->bytes || (memcmp(frame + pos, "Xing", 4) != 0 && memcmp(frame + pos, "Info", 4) != 0)) {
+    return false;
+  }
+  uint32_t const flags = be32(frame + pos + 4);
+  if (!(flags & 1)) {
+    return false;
+  }
+  uint64_t const frames = be32(frame + pos + 8);
+  pos += 12 + (flags & 2 ? 4 : 0) + (flags & 4 ? 100 : 0) + (flags & 8 ? 4 : 0);
+  uint64_t delay = 0;
+  int64_t padding = 0;
+  if (pos < f->bytes && frame[pos]) {
+    pos += 21;
+    if (pos + 14 >= f->bytes) {
+      return false;
+    }
+    uint8_t const *const t = frame + pos;
+    delay = (uint64_t)(t[0] << 4 | t[1] >> 4) + lame_decoder_delay;
+    padding = (int64_t)((t[1] & 0x0f) << 8 | t[2]) - lame_decoder_delay;
+  }
+  uint64_t s = frames * f->samples;
+  s = s > delay ? s - delay : 0;
+  if (padding > 0 && (uint64_t)padding <= s) {
+    s -= (uint64_t)padding;
+  }
+  *samples = s;
+  return true;
+}
+
+static bool read_vbri(uint8_t const *const frame, struct mpeg_frame const *const f, uint64_t *const samples) {
+  size_t const pos = 4 + 32;
+  if (pos + 18 > f->bytes || memcmp(frame + pos, "VBRI", 4) != 0) {
+    return false;
+  }
+  *samples = (uint64_t)be32(frame + pos + 14) * f->samples;
+  return true;
+}
+
+// Estimates the length of a constant bitrate stream from the bytes between its first frame and its trailing tags.
+static uint64_t estimate_mpeg_samples(struct ovl_source *const source,
+                                      uint64_t const start,
+                                      uint64_t end,
+                                      struct mpeg_frame const *const f) {
+  uint8_t tail[128];
+  if (end - start >= sizeof(tail) && read_at(source, tail, end - sizeof(tail), sizeof(tail)) &&
+      memcmp(tail, "TAG", 3) == 0) {
+    end -= sizeof(tail);
+  }
+  uint8_t ape[32];
+  if (end - start >= sizeof(ape) && read_at(source, ape, end - sizeof(ape), sizeof(ape)) &&
+      memcmp(ape, "APETAGEX", 8) == 0) {
+    uint64_t const size = (uint64_t)le32(ape + 12) + (le32(ape + 20) & 0x80000000u ? sizeof(ape) : 0);
+    end = size < end - start ? end - size : start;
+  }
+  uint64_t const den = (uint64_t)f->bitrate * f->samples;
+  uint64_t const frames = ((end - start) * 8 * f->sample_rate + den / 2) / den;
+  return frames * f->samples;
+}
+
+static NODISCARD bool probe_mp3(struct ovl_source *const source,
+                                uint64_t const size,
+                                uint64_t const start,
+                                struct ovl_audio_info *const info,
+                                bool *const estimated,
+                                struct ov_error *const err) {
+  uint8_t *buf = NULL;
+  bool result = false;
+
+  {
+    size_t const len = size - start < mp3_search_size ? (size_t)(size - start) : mp3_search_size;
+    if (!OV_REALLOC(&buf, len ? len : 1, 1)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (!read_at(source, buf, start, len)) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read MP3 frames"));
+      goto cleanup;
+    }
+    size_t pos = 0;
+    struct mpeg_frame f;
+    if (!find_mpeg_frame(buf, len, &pos, &f)) {
+      // Free format streams and streams behind a lot of junk are left to the decoder, which scans further.
+      if (!probe_with_decoder(source, ovl_audio_decoder_mp3_create, info, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      result = true;
+      goto cleanup;
+    }
+    info->sample_rate = f.sample_rate;
+    info->channels = f.mono ? 1 : 2;
+    if (!read_xing(buf + pos, &f, &info->samples)) {
+      *estimated = true;
+      if (!read_vbri(buf + pos, &f, &info->samples)) {
+        info->samples = estimate_mpeg_samples(source, start + pos, size, &f);
+      }
+    }
+    if (!ovl_audio_tag_id3v2_read(&info->tag, source, 0, size > SIZE_MAX ? SIZE_MAX : (size_t)size, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (buf) {
+    OV_FREE(&buf);
+  }
+  return result;
+}
+
+struct ogg_page {
+  uint8_t header_type;
+  uint64_t granule;
+  uint32_t serial;
+  size_t segments;
+  size_t header_size;
+  size_t body_size;
+  uint8_t lacing[255];
+};
+
+static bool parse_ogg_page(uint8_t const *const h, size_t const len, struct ogg_page *const page) {
+  if (len < ogg_page_header_size || memcmp(h, "OggS", 4) != 0 || h[4] != 0 ||
+      len < ogg_page_header_size + (size_t)h[26]) {
+    return false;
+  }
+  page->header_type = h[5];
+  page->granule = le64(h + 6);
+  page->serial = le32(h + 14);
+  page->segments = h[26];
+  page->header_size = ogg_page_header_size + page->segments;
+  page->body_size = 0;
+  for (size_t i = 0; i < page->segments; ++i) {
+    page->lacing[i] = h[ogg_page_header_size + i];
+    page->body_size += page->lacing[i];
+  }
+  return true;
+}
+
+// CRC-32 of a page with polynomial 0x04c11db7, unreflected, the checksum field taken as zero.
+static uint32_t ogg_crc(uint8_t const *const p, size_t const len) {
+  uint32_t crc = 0;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= (uint32_t)(i >= 22 && i < 26 ? 0 : p[i]) << 24;
+    for (size_t b = 0; b < 8; ++b) {
+      crc = crc & 0x80000000u ? crc << 1 ^ 0x04c11db7u : crc << 1;
+    }
+  }
+  return crc;
+}
+
+// Finds the last intact page of the file on which a packet ends. found is false when the tail has none.
+static NODISCARD bool find_last_ogg_page(struct ovl_source *const source,
+                                         uint64_t const size,
+                                         bool *const found,
+                                         uint32_t *const serial,
+                                         uint64_t *const granule,
+                                         struct ov_error *const err) {
+  uint8_t *buf = NULL;
+  bool result = false;
+
+  {
+    *found = false;
+    size_t const len = size < ogg_tail_size ? (size_t)size : ogg_tail_size;
+    if (!OV_REALLOC(&buf, len ? len : 1, 1)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (!read_at(source, buf, size - len, len)) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read Ogg pages"));
+      goto cleanup;
+    }
+    for (size_t i = len; i-- > 0;) {
+      struct ogg_page page;
+      if (buf[i] != 'O' || !parse_ogg_page(buf + i, len - i, &page) || page.granule == UINT64_MAX ||
+          page.body_size > len - i - page.header_size ||
+          ogg_crc(buf + i, page.header_size + page.body_size) != le32(buf + i + 22)) {
+        continue;
+      }
+      *found = true;
+      *serial = page.serial;
+      *granule = page.granule;
+      break;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (buf) {
+    OV_FREE(&buf);
+  }
+  return result;
+}
+
+enum ogg_codec {
+  ogg_codec_unknown,
+  ogg_codec_vorbis,
+  ogg_codec_opus,
+};
+
+struct ogg_headers {
+  uint32_t serial;
+  enum ogg_codec codec;
+  size_t channels;
+  size_t sample_rate;
+  uint64_t pre_skip;
+  uint8_t *comment;
+  size_t comment_len;
+  size_t comment_cap;
+  bool comment_too_large;
+};
+
+static void parse_ogg_ident(struct ogg_headers *const h, uint8_t const *const p, size_t const len) {
+  if (len >= 16 && p[0] == 1 && memcmp(p + 1, "vorbis", 6) == 0) {
+    h->codec = ogg_codec_vorbis;
+    h->channels = p[11];
+    h->sample_rate = le32(p + 12);
+  } else if (len >= 19 && memcmp(p, "OpusHead", 8) == 0) {
+    h->codec = ogg_codec_opus;
+    h->channels = p[9];
+    h->sample_rate = 48000; // Opus always decodes at 48kHz
+    h->pre_skip = le16(p + 10);
+  }
+}
+
+// Collects the identification and comment headers, the first two packets of the stream that starts the file.
+// A comment header over max_comment_size is skipped.
+static NODISCARD bool read_ogg_headers(struct ovl_source *const source,
+                                       uint64_t const size,
+                                       struct ogg_headers *const h,
+                                       struct ov_error *const err) {
+  uint8_t *body = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&body, 255 * 255, 1)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    size_t packet = 0;
+    uint64_t offset = 0;
+    bool first = true;
+    while (packet < 2) {
+      uint8_t header[ogg_max_page_header_size];
+      size_t const n = ovl_source_read(source, header, offset, sizeof(header));
+      struct ogg_page page;
+      if (offset >= size || n == SIZE_MAX || !parse_ogg_page(header, n, &page) ||
+          !read_at(source, body, offset + page.header_size, page.body_size)) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read Ogg headers"));
+        goto cleanup;
+      }
+      offset += page.header_size + page.body_size;
+      if (first) {
+        h->serial = page.serial;
+        first = false;
+      } else if (page.serial != h->serial) {
+        continue;
+      }
+      size_t pos = 0;
+      for (size_t i = 0; i < page.segments && packet < 2; ++i) {
+        size_t const l = page.lacing[i];
+        if (h->comment_len + l > max_comment_size) {
+          h->comment_too_large = true;
+        } else {
+          if (h->comment_len + l > h->comment_cap) {
+            size_t const cap = h->comment_cap ? h->comment_cap * 2 : 4096;
+            if (!OV_REALLOC(&h->comment, cap, 1)) {
+              OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+              goto cleanup;
+            }
+            h->comment_cap = cap;
+          }
+          memcpy(h->comment + h->comment_len, body + pos, l);
+          h->comment_len += l;
+        }
+        pos += l;
+        if (l < 255) {
+          if (packet == 0) {
+            parse_ogg_ident(h, h->comment, h->comment_len);
+            h->comment_len = 0;
+          }
+          ++packet;
+        }
+      }
+    }
+  }
+  result = true;
+
+cleanup:
+  if (body) {
+    OV_FREE(&body);
+  }
+  return result;
+}
+
+static NODISCARD bool probe_ogg(struct ovl_source *const source,
+                                uint64_t const size,
+                                struct ovl_audio_info *const info,
+                                struct ov_error *const err) {
+  struct ogg_headers h = {0};
+  bool result = false;
+
+  {
+    if (!read_ogg_headers(source, size, &h, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (h.codec == ogg_codec_unknown) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Unsupported Ogg stream"));
+      goto cleanup;
+    }
+    bool found = false;
+    uint32_t serial = 0;
+    uint64_t granule = 0;
+    if (!find_last_ogg_page(source, size, &found, &serial, &granule, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (!found || serial != h.serial) {
+      // A chained stream ends with another serial, and the decoder adds up the lengths of all the links.
+      decoder_create_func const create =
+          h.codec == ogg_codec_vorbis ? ovl_audio_decoder_ogg_create : ovl_audio_decoder_opus_create;
+      if (!probe_with_decoder(source, create, info, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      result = true;
+      goto cleanup;
+    }
+    info->sample_rate = h.sample_rate;
+    info->channels = h.channels;
+    info->samples = granule > h.pre_skip ? granule - h.pre_skip : 0;
+    size_t const magic = h.codec == ogg_codec_vorbis ? 7 : 8;
+    if (!h.comment_too_large && h.comment_len > magic &&
+        (h.codec == ogg_codec_vorbis ? h.comment[0] == 3 && memcmp(h.comment + 1, "vorbis", 6) == 0
+                                     : memcmp(h.comment, "OpusTags", 8) == 0) &&
+        !read_comments(&info->tag, h.comment + magic, h.comment_len - magic, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (h.comment) {
+    OV_FREE(&h.comment);
+  }
+  return result;
+}
+
+NODISCARD bool ovl_audio_probe(struct ovl_source *const source,
+                               struct ovl_audio_info *const info,
+                               bool *const estimated,
+                               struct ov_error *const err) {
+  if (!source || !info || !estimated) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  *info = (struct ovl_audio_info){
+      .tag =
+          {
+              .loop_start = UINT64_MAX,
+              .loop_end = UINT64_MAX,
+              .loop_length = UINT64_MAX,
+          },
+  };
+  *estimated = false;
+  bool result = false;
+
+  {
+    uint64_t const size = ovl_source_size(source);
+    if (size == UINT64_MAX) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to get source size"));
+      goto cleanup;
+    }
+    uint8_t head[head_size];
+    size_t n = ovl_source_read(source, head, 0, sizeof(head));
+    if (n == SIZE_MAX) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Failed to read file signature"));
+      goto cleanup;
+    }
+    if (n >= 4 && (memcmp(head, "RIFF", 4) == 0 || memcmp(head, "RF64", 4) == 0 || memcmp(head, "riff", 4) == 0 ||
+                   memcmp(head, "FORM", 4) == 0)) {
+      if (!probe_with_decoder(source, ovl_audio_decoder_wav_create, info, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    } else if (n >= 4 && memcmp(head, "OggS", 4) == 0) {
+      if (!probe_ogg(source, size, info, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    } else {
+      uint64_t const start = id3v2_size(head, n);
+      if (start) {
+        n = start < size ? ovl_source_read(source, head, start, 4) : 0;
+      }
+      if (n != SIZE_MAX && n >= 4 && memcmp(head, "fLaC", 4) == 0) {
+        if (!probe_flac(source, start, info, err)) {
+          OV_ERROR_ADD_TRACE(err);
+          goto cleanup;
+        }
+      } else if (!probe_mp3(source, size, start < size ? start : size, info, estimated, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+  }
+  result = true;
+
+cleanup:
+  if (!result) {
+    ovl_audio_tag_destroy(&info->tag);
+  }
+  return result;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ovbase.h>
+
+struct ovl_audio_info;
+struct ovl_source;
+
+/**
+ * @brief Reads the format, length and tags of an audio file without preparing to decode it.
+ *
+ * The format is recognized from the content: WAVE, RF64, Wave64, AIFF, FLAC, Ogg Vorbis, Ogg Opus and MP3.
+ * The result is what the decoder of the file reports, but only headers are read:
+ * - MP3 takes its length from a Xing, Info or VBRI header. Without one the length is estimated from the
+ *   bitrate of the first frame and the size of the file, and estimated is set.
+ * - Ogg takes its length from the granule position of the last page, so the tail of the file is read too.
+ *   Chained streams, and files whose frames or pages cannot be found near the edges, are opened with their
+ *   decoder instead.
+ *
+ * @param source The file.
+ * @param info Receives the format. The tag must be released with ovl_audio_tag_destroy.
+ * @param estimated Receives whether info->samples is an estimate.
+ * @param err Error information output.
+ * @return true on success, false on failure.
+ */
+NODISCARD bool ovl_audio_probe(struct ovl_source *const source,
+                               struct ovl_audio_info *const info,
+                               bool *const estimated,
+                               struct ov_error *const err);
@@ -0,0 +1,156 @@
+#include <ovtest.h>
+
+#include "probe.h"
+#include "tag.h"
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/decoder/flac.h>
+#include <ovl/audio/decoder/mp3.h>
+#include <ovl/audio/decoder/ogg.h>
+#include <ovl/audio/decoder/opus.h>
+#include <ovl/audio/decoder/wav.h>
+#include <ovl/audio/info.h>
+#include <ovl/file.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+#include <ovl/source/memory.h>
+
+#include <string.h>
+
+#ifndef TESTDATADIR
+#  define TESTDATADIR NSTR(".")
+#endif
+
+typedef bool (*decoder_create_func)(struct ovl_source *const source,
+                                    struct ovl_audio_decoder **const dp,
+                                    struct ov_error *const err);
+
+static bool same_string(char const *const a, char const *const b) {
+  return (!a && !b) || (a && b && strcmp(a, b) == 0);
+}
+
+static void check_file(NATIVE_CHAR const *const path, decoder_create_func const create) {
+  struct ovl_source *source = NULL;
+  struct ovl_audio_decoder *d = NULL;
+  struct ovl_audio_info info = {0};
+  struct ov_error err = {0};
+  bool estimated = true;
+
+  if (!TEST_SUCCEEDED(ovl_source_file_create(path, &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_probe(source, &info, &estimated, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(create(source, &d, &err), &err)) {
+    goto cleanup;
+  }
+  struct ovl_audio_info const *const want = ovl_audio_decoder_get_info(d);
+  TEST_CHECK(!estimated);
+  TEST_CHECK(info.sample_rate == want->sample_rate);
+  TEST_CHECK(info.channels == want->channels);
+  TEST_CHECK(info.samples == want->samples);
+  TEST_MSG("%ls: rate %zu/%zu channels %zu/%zu samples %llu/%llu",
+           path,
+           info.sample_rate,
+           want->sample_rate,
+           info.channels,
+           want->channels,
+           (unsigned long long)info.samples,
+           (unsigned long long)want->samples);
+  TEST_CHECK(same_string(info.tag.title, want->tag.title));
+  TEST_CHECK(same_string(info.tag.artist, want->tag.artist));
+  TEST_CHECK(info.tag.loop_start == want->tag.loop_start);
+  TEST_CHECK(info.tag.loop_end == want->tag.loop_end);
+  TEST_CHECK(info.tag.loop_length == want->tag.loop_length);
+
+cleanup:
+  ovl_audio_tag_destroy(&info.tag);
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+}
+
+static void matches_decoder(void) {
+  static struct {
+    NATIVE_CHAR const *path;
+    decoder_create_func create;
+  } const files[] = {
+      {TESTDATADIR NSTR("/test.flac"), ovl_audio_decoder_flac_create},
+      {TESTDATADIR NSTR("/test.mp3"), ovl_audio_decoder_mp3_create},
+      {TESTDATADIR NSTR("/test.ogg"), ovl_audio_decoder_ogg_create},
+      {TESTDATADIR NSTR("/test.opus"), ovl_audio_decoder_opus_create},
+      {TESTDATADIR NSTR("/test-8khz-stereo-8.wav"), ovl_audio_decoder_wav_create},
+      {TESTDATADIR NSTR("/test-8khz-mono-8-loop-id3.wav"), ovl_audio_decoder_wav_create},
+      {TESTDATADIR NSTR("/test-8khz-mono-8-rf64-loop-id3.wav"), ovl_audio_decoder_wav_create},
+      {TESTDATADIR NSTR("/test-8khz-mono-8-loop-id3.w64"), ovl_audio_decoder_wav_create},
+      {TESTDATADIR NSTR("/test-8khz-mono-8-loop-id3.aiff"), ovl_audio_decoder_wav_create},
+  };
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+    check_file(files[i].path, files[i].create);
+  }
+}
+
+static void mp3_without_length_header(void) {
+  struct ovl_file *file = NULL;
+  struct ovl_source *source = NULL;
+  struct ovl_audio_info info = {0};
+  struct ov_error err = {0};
+  static uint8_t buf[256 * 1024];
+  size_t len = 0;
+  bool estimated = false;
+
+  if (!TEST_SUCCEEDED(ovl_file_open(TESTDATADIR NSTR("/test.mp3"), &file, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_file_read(file, buf, sizeof(buf), &len, &err), &err)) {
+    goto cleanup;
+  }
+  // Without its Xing header the length can only come from the bitrate of the first frame.
+  for (size_t i = 0; i + 4 <= len && i < 8192; ++i) {
+    if (memcmp(buf + i, "Xing", 4) == 0 || memcmp(buf + i, "Info", 4) == 0) {
+      memcpy(buf + i, "None", 4);
+      break;
+    }
+  }
+  if (!TEST_SUCCEEDED(ovl_source_memory_create(buf, len, &source, &err), &err)) {
+    goto cleanup;
+  }
+  if (!TEST_SUCCEEDED(ovl_audio_probe(source, &info, &estimated, &err), &err)) {
+    goto cleanup;
+  }
+  TEST_CHECK(estimated);
+  TEST_CHECK(info.sample_rate == 48000 && info.channels == 2);
+  TEST_CHECK(info.samples > 0 && info.samples % 1152 == 0);
+  TEST_MSG("samples=%llu", (unsigned long long)info.samples);
+  TEST_CHECK(info.tag.title != NULL);
+
+cleanup:
+  ovl_audio_tag_destroy(&info.tag);
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (file) {
+    ovl_file_close(file);
+  }
+}
+
+static void invalid_arguments(void) {
+  struct ov_error err = {0};
+  struct ovl_audio_info info = {0};
+  bool estimated = false;
+  TEST_FAILED_WITH(ovl_audio_probe(NULL, &info, &estimated, &err),
+                   &err,
+                   ov_error_type_generic,
+                   ov_error_generic_invalid_argument);
+}
+
+TEST_LIST = {
+    {"matches_decoder", matches_decoder},
+    {"mp3_without_length_header", mp3_without_length_header},
+    {"invalid_arguments", invalid_arguments},
+    {NULL, NULL},
+};
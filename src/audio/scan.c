@@ -0,0 +1,766 @@
+#include <ovl/audio/scan.h>
+
+#include <ovl/file.h>
+#include <ovl/os.h>
+#include <ovl/path.h>
+#include <ovl/source.h>
+#include <ovl/source/file.h>
+
+#include <ovarray.h>
+#include <ovmo.h>
+#include <ovthreads.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "probe.h"
+#include "tag.h"
+
+#ifdef _WIN32
+
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+
+// The walk takes the size and write time of each file from the directory listing, so files that match their
+// cache entry are never opened. The others are handed out one at a time to a pool of threads, each opening its
+// file only for ovl_audio_probe.
+//
+// The cache is a header followed by one record per file, in native byte order:
+//   header: "OVLSCAN\0", u32 version, u32 reserved, u64 record count, u64 reserved
+//   record: u32 path length in UTF-16 units, u32 flags, u64 size, u64 modified, u64 sample rate, u64 channels,
+//           u64 samples, u64 loop start, u64 loop end, u64 loop length, u32 title bytes, u32 artist bytes,
+//           then the path, the title and the artist; a string length of UINT32_MAX means there is none.
+
+enum {
+  cache_version = 1,
+  cache_header_size = 32,
+  cache_record_size = 80,
+  cache_flag_valid = 1,
+  cache_flag_estimated = 2,
+  file_chunk_size = 64 * 1024 * 1024,
+  // 100-nanosecond intervals between 1601-01-01 and 1970-01-01
+  filetime_unix_epoch = 116444736000000000ULL,
+};
+
+static char const cache_magic[8] = "OVLSCAN";
+
+struct ovl_audio_scan {
+  struct ovl_audio_scan_info info;
+  struct ovl_audio_scan_entry *entries;
+  size_t entries_cap;
+};
+
+// Entries read from the cache, indexed by path with open addressing. Buckets hold an index plus one.
+struct cache {
+  struct ovl_audio_scan_entry *entries;
+  size_t len;
+  size_t *buckets;
+  size_t mask;
+};
+
+struct pool {
+  struct ovl_audio_scan_entry *entries;
+  size_t const *pending;
+  size_t count;
+  atomic_size_t next;
+};
+
+struct buffer {
+  uint8_t *p;
+  size_t len;
+  size_t cap;
+};
+
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+
+static inline uint32_t get_u32(uint8_t const *const p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t get_u64(uint8_t const *const p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline void put_u32(uint8_t *const p, uint32_t const v) { memcpy(p, &v, sizeof(v)); }
+static inline void put_u64(uint8_t *const p, uint64_t const v) { memcpy(p, &v, sizeof(v)); }
+
+static struct ovl_audio_info empty_info(void) {
+  return (struct ovl_audio_info){
+      .tag =
+          {
+              .loop_start = UINT64_MAX,
+              .loop_end = UINT64_MAX,
+              .loop_length = UINT64_MAX,
+          },
+  };
+}
+
+static void entry_free(struct ovl_audio_scan_entry *const e) {
+  if (e->path) {
+    OV_ARRAY_DESTROY(&e->path);
+  }
+  ovl_audio_tag_destroy(&e->info.tag);
+}
+
+static void cache_free(struct cache *const c) {
+  for (size_t i = 0; i < c->len; ++i) {
+    entry_free(&c->entries[i]);
+  }
+  if (c->entries) {
+    OV_FREE(&c->entries);
+  }
+  if (c->buckets) {
+    OV_FREE(&c->buckets);
+  }
+  *c = (struct cache){0};
+}
+
+static bool is_audio_file(wchar_t const *const name) {
+  static wchar_t const *const exts[] = {L".wav", L".w64", L".aif", L".aiff", L".flac", L".mp3", L".ogg", L".opus"};
+  wchar_t const *const ext = ovl_path_find_ext(name);
+  if (!ext) {
+    return false;
+  }
+  for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); ++i) {
+    if (ovl_path_is_same_ext(ext, exts[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static NODISCARD bool join_path(wchar_t **const dest,
+                                wchar_t const *const dir,
+                                size_t const dir_len,
+                                wchar_t const *const name,
+                                struct ov_error *const err) {
+  size_t const name_len = wcslen(name);
+  size_t const len = dir_len + 1 + name_len;
+  if (!OV_ARRAY_GROW(dest, len + 1)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  memcpy(*dest, dir, dir_len * sizeof(wchar_t));
+  (*dest)[dir_len] = L'\\';
+  memcpy(*dest + dir_len + 1, name, (name_len + 1) * sizeof(wchar_t));
+  OV_ARRAY_SET_LENGTH(*dest, len);
+  return true;
+}
+
+static NODISCARD bool add_entry(struct ovl_audio_scan *const s,
+                                wchar_t const *const dir,
+                                size_t const dir_len,
+                                WIN32_FIND_DATAW const *const fd,
+                                struct ov_error *const err) {
+  if (s->info.entries == s->entries_cap) {
+    size_t const cap = s->entries_cap ? s->entries_cap * 2 : 256;
+    if (!OV_REALLOC(&s->entries, cap, sizeof(struct ovl_audio_scan_entry))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      return false;
+    }
+    s->entries_cap = cap;
+  }
+  uint64_t const write_time = (uint64_t)fd->ftLastWriteTime.dwHighDateTime << 32 | fd->ftLastWriteTime.dwLowDateTime;
+  struct ovl_audio_scan_entry *const e = &s->entries[s->info.entries];
+  *e = (struct ovl_audio_scan_entry){
+      .size = (uint64_t)fd->nFileSizeHigh << 32 | fd->nFileSizeLow,
+      .modified = write_time > filetime_unix_epoch ? (write_time - filetime_unix_epoch) / 10 : 0,
+      .info = empty_info(),
+  };
+  if (!join_path(&e->path, dir, dir_len, fd->cFileName, err)) {
+    OV_ERROR_ADD_TRACE(err);
+    return false;
+  }
+  ++s->info.entries;
+  return true;
+}
+
+static NODISCARD bool walk(struct ovl_audio_scan *const s, wchar_t const *const root, struct ov_error *const err) {
+  wchar_t **stack = NULL;
+  size_t stack_len = 0;
+  size_t stack_cap = 0;
+  wchar_t *dir = NULL;
+  wchar_t *pattern = NULL;
+  HANDLE h = INVALID_HANDLE_VALUE;
+  bool result = false;
+
+  {
+    size_t root_len = wcslen(root);
+    while (root_len > 0 && (root[root_len - 1] == L'\\' || root[root_len - 1] == L'/')) {
+      --root_len;
+    }
+    if (!OV_ARRAY_GROW(&dir, root_len + 1)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memcpy(dir, root, root_len * sizeof(wchar_t));
+    dir[root_len] = L'\0';
+    OV_ARRAY_SET_LENGTH(dir, root_len);
+    bool is_root = true;
+    for (;;) {
+      size_t const dir_len = OV_ARRAY_LENGTH(dir);
+      if (!join_path(&pattern, dir, dir_len, L"*", err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      WIN32_FIND_DATAW fd;
+      h = FindFirstFileExW(pattern, FindExInfoBasic, &fd, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+      if (h == INVALID_HANDLE_VALUE) {
+        // A subdirectory that went away or cannot be listed is left out; only the root has to be readable.
+        if (is_root) {
+          OV_ERROR_SET_HRESULT(err, HRESULT_FROM_WIN32(GetLastError()));
+          goto cleanup;
+        }
+      } else {
+        do {
+          if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            // Links and junctions are not followed, so the walk cannot loop.
+            if ((fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) || wcscmp(fd.cFileName, L".") == 0 ||
+                wcscmp(fd.cFileName, L"..") == 0) {
+              continue;
+            }
+            if (stack_len == stack_cap) {
+              size_t const cap = stack_cap ? stack_cap * 2 : 64;
+              if (!OV_REALLOC(&stack, cap, sizeof(wchar_t *))) {
+                OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+                goto cleanup;
+              }
+              stack_cap = cap;
+            }
+            stack[stack_len] = NULL;
+            if (!join_path(&stack[stack_len], dir, dir_len, fd.cFileName, err)) {
+              OV_ERROR_ADD_TRACE(err);
+              goto cleanup;
+            }
+            ++stack_len;
+          } else if (is_audio_file(fd.cFileName) && !add_entry(s, dir, dir_len, &fd, err)) {
+            OV_ERROR_ADD_TRACE(err);
+            goto cleanup;
+          }
+        } while (FindNextFileW(h, &fd));
+        FindClose(h);
+        h = INVALID_HANDLE_VALUE;
+      }
+      is_root = false;
+      OV_ARRAY_DESTROY(&dir);
+      if (stack_len == 0) {
+        break;
+      }
+      dir = stack[--stack_len];
+    }
+  }
+  result = true;
+
+cleanup:
+  if (h != INVALID_HANDLE_VALUE) {
+    FindClose(h);
+  }
+  while (stack_len > 0) {
+    OV_ARRAY_DESTROY(&stack[--stack_len]);
+  }
+  if (stack) {
+    OV_FREE(&stack);
+  }
+  if (dir) {
+    OV_ARRAY_DESTROY(&dir);
+  }
+  if (pattern) {
+    OV_ARRAY_DESTROY(&pattern);
+  }
+  return result;
+}
+
+// FNV-1a over the UTF-16 units, ASCII letters folded to lower case like the comparison in cache_find.
+static size_t hash_path(wchar_t const *p) {
+  uint64_t h = 14695981039346656037ULL;
+  for (; *p; ++p) {
+    wchar_t const c = *p >= L'A' && *p <= L'Z' ? (wchar_t)(*p | 0x20) : *p;
+    h = (h ^ (uint64_t)c) * 1099511628211ULL;
+  }
+  return (size_t)h;
+}
+
+static NODISCARD bool cache_index(struct cache *const c, struct ov_error *const err) {
+  if (c->len == 0) {
+    return true;
+  }
+  size_t n = 64;
+  while (n < c->len * 2) {
+    n *= 2;
+  }
+  if (!OV_REALLOC(&c->buckets, n, sizeof(size_t))) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+    return false;
+  }
+  memset(c->buckets, 0, n * sizeof(size_t));
+  c->mask = n - 1;
+  for (size_t i = 0; i < c->len; ++i) {
+    size_t b = hash_path(c->entries[i].path) & c->mask;
+    while (c->buckets[b]) {
+      b = (b + 1) & c->mask;
+    }
+    c->buckets[b] = i + 1;
+  }
+  return true;
+}
+
+static struct ovl_audio_scan_entry *cache_find(struct cache const *const c, wchar_t const *const path) {
+  if (!c->buckets) {
+    return NULL;
+  }
+  for (size_t b = hash_path(path) & c->mask; c->buckets[b]; b = (b + 1) & c->mask) {
+    struct ovl_audio_scan_entry *const e = &c->entries[c->buckets[b] - 1];
+    // Entries already taken have no path.
+    if (e->path && CompareStringOrdinal(e->path, -1, path, -1, TRUE) == CSTR_EQUAL) {
+      return e;
+    }
+  }
+  return NULL;
+}
+
+static NODISCARD bool
+cache_parse(struct cache *const c, uint8_t const *const data, size_t const len, struct ov_error *const err) {
+  bool result = false;
+
+  {
+    if (len < cache_header_size || memcmp(data, cache_magic, sizeof(cache_magic)) != 0 ||
+        get_u32(data + 8) != cache_version || get_u64(data + 16) > (len - cache_header_size) / cache_record_size) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Scan cache is corrupt"));
+      goto cleanup;
+    }
+    size_t const count = (size_t)get_u64(data + 16);
+    if (count && !OV_REALLOC(&c->entries, count, sizeof(struct ovl_audio_scan_entry))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    size_t pos = cache_header_size;
+    for (size_t i = 0; i < count; ++i) {
+      if (len - pos < cache_record_size) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Scan cache is corrupt"));
+        goto cleanup;
+      }
+      uint8_t const *const r = data + pos;
+      pos += cache_record_size;
+      size_t const path_bytes = (size_t)get_u32(r) * sizeof(wchar_t);
+      uint32_t const title_len = get_u32(r + 72);
+      uint32_t const artist_len = get_u32(r + 76);
+      size_t const title_bytes = title_len == UINT32_MAX ? 0 : title_len;
+      size_t const artist_bytes = artist_len == UINT32_MAX ? 0 : artist_len;
+      if (path_bytes == 0 || len - pos < path_bytes || len - pos - path_bytes < title_bytes ||
+          len - pos - path_bytes - title_bytes < artist_bytes) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Scan cache is corrupt"));
+        goto cleanup;
+      }
+      uint32_t const flags = get_u32(r + 4);
+      struct ovl_audio_scan_entry *const e = &c->entries[c->len++];
+      *e = (struct ovl_audio_scan_entry){
+          .size = get_u64(r + 8),
+          .modified = get_u64(r + 16),
+          .info =
+              {
+                  .sample_rate = (size_t)get_u64(r + 24),
+                  .channels = (size_t)get_u64(r + 32),
+                  .samples = get_u64(r + 40),
+                  .tag =
+                      {
+                          .loop_start = get_u64(r + 48),
+                          .loop_end = get_u64(r + 56),
+                          .loop_length = get_u64(r + 64),
+                      },
+              },
+          .valid = (flags & cache_flag_valid) != 0,
+          .estimated = (flags & cache_flag_estimated) != 0,
+      };
+      size_t const path_len = path_bytes / sizeof(wchar_t);
+      if (!OV_ARRAY_GROW(&e->path, path_len + 1)) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        goto cleanup;
+      }
+      memcpy(e->path, data + pos, path_bytes);
+      e->path[path_len] = L'\0';
+      OV_ARRAY_SET_LENGTH(e->path, path_len);
+      pos += path_bytes;
+      if (title_len != UINT32_MAX &&
+          !ovl_audio_tag_set_title(&e->info.tag, (char const *)(data + pos), title_bytes, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      pos += title_bytes;
+      if (artist_len != UINT32_MAX &&
+          !ovl_audio_tag_set_artist(&e->info.tag, (char const *)(data + pos), artist_bytes, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      pos += artist_bytes;
+    }
+  }
+  result = true;
+
+cleanup:
+  return result;
+}
+
+static NODISCARD bool cache_load(struct cache *const c, wchar_t const *const path, struct ov_error *const err) {
+  struct ovl_file *file = NULL;
+  uint8_t *data = NULL;
+  bool result = false;
+
+  {
+    if (GetFileAttributesW(path) == INVALID_FILE_ATTRIBUTES) {
+      // The first scan has no cache yet.
+      result = true;
+      goto cleanup;
+    }
+    if (!ovl_file_open(path, &file, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    uint64_t size = 0;
+    if (!ovl_file_size(file, &size, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (size > SIZE_MAX) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Scan cache is corrupt"));
+      goto cleanup;
+    }
+    size_t const len = (size_t)size;
+    if (!OV_REALLOC(&data, len ? len : 1, 1)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    size_t pos = 0;
+    while (pos < len) {
+      size_t read = 0;
+      if (!ovl_file_read(file, data + pos, min2(len - pos, file_chunk_size), &read, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      if (read == 0) {
+        OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Scan cache is corrupt"));
+        goto cleanup;
+      }
+      pos += read;
+    }
+    if (!cache_parse(c, data, len, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (data) {
+    OV_FREE(&data);
+  }
+  if (file) {
+    ovl_file_close(file);
+  }
+  return result;
+}
+
+static NODISCARD bool
+buffer_append(struct buffer *const b, void const *const p, size_t const len, struct ov_error *const err) {
+  if (len == 0) {
+    return true;
+  }
+  if (len > b->cap - b->len) {
+    size_t cap = b->cap ? b->cap : 64 * 1024;
+    while (len > cap - b->len) {
+      cap *= 2;
+    }
+    if (!OV_REALLOC(&b->p, cap, 1)) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      return false;
+    }
+    b->cap = cap;
+  }
+  memcpy(b->p + b->len, p, len);
+  b->len += len;
+  return true;
+}
+
+static NODISCARD bool
+cache_save(struct ovl_audio_scan const *const s, wchar_t const *const path, struct ov_error *const err) {
+  struct buffer b = {0};
+  wchar_t *temp = NULL;
+  struct ovl_file *file = NULL;
+  bool result = false;
+
+  {
+    uint8_t header[cache_header_size] = {0};
+    memcpy(header, cache_magic, sizeof(cache_magic));
+    put_u32(header + 8, cache_version);
+    put_u64(header + 16, s->info.entries);
+    if (!buffer_append(&b, header, sizeof(header), err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    for (size_t i = 0; i < s->info.entries; ++i) {
+      struct ovl_audio_scan_entry const *const e = &s->entries[i];
+      size_t const path_len = OV_ARRAY_LENGTH(e->path);
+      size_t const title_len = e->info.tag.title ? strlen(e->info.tag.title) : 0;
+      size_t const artist_len = e->info.tag.artist ? strlen(e->info.tag.artist) : 0;
+      uint8_t r[cache_record_size];
+      put_u32(r, (uint32_t)path_len);
+      put_u32(r + 4, (e->valid ? cache_flag_valid : 0) | (e->estimated ? cache_flag_estimated : 0));
+      put_u64(r + 8, e->size);
+      put_u64(r + 16, e->modified);
+      put_u64(r + 24, e->info.sample_rate);
+      put_u64(r + 32, e->info.channels);
+      put_u64(r + 40, e->info.samples);
+      put_u64(r + 48, e->info.tag.loop_start);
+      put_u64(r + 56, e->info.tag.loop_end);
+      put_u64(r + 64, e->info.tag.loop_length);
+      put_u32(r + 72, e->info.tag.title ? (uint32_t)title_len : UINT32_MAX);
+      put_u32(r + 76, e->info.tag.artist ? (uint32_t)artist_len : UINT32_MAX);
+      if (!buffer_append(&b, r, sizeof(r), err) || !buffer_append(&b, e->path, path_len * sizeof(wchar_t), err) ||
+          !buffer_append(&b, e->info.tag.title, title_len, err) ||
+          !buffer_append(&b, e->info.tag.artist, artist_len, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+
+    // The cache is replaced in one step, so a scan that is cut short leaves the previous one intact.
+    size_t const path_len = wcslen(path);
+    static wchar_t const suffix[] = L".tmp";
+    if (!OV_ARRAY_GROW(&temp, path_len + sizeof(suffix) / sizeof(wchar_t))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    memcpy(temp, path, path_len * sizeof(wchar_t));
+    memcpy(temp + path_len, suffix, sizeof(suffix));
+    if (!ovl_file_create(temp, &file, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    size_t pos = 0;
+    while (pos < b.len) {
+      size_t written = 0;
+      if (!ovl_file_write(file, b.p + pos, min2(b.len - pos, file_chunk_size), &written, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      pos += written;
+    }
+    ovl_file_close(file);
+    file = NULL;
+    if (!MoveFileExW(temp, path, MOVEFILE_REPLACE_EXISTING)) {
+      OV_ERROR_SET_HRESULT(err, HRESULT_FROM_WIN32(GetLastError()));
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (file) {
+    ovl_file_close(file);
+  }
+  if (temp) {
+    if (!result) {
+      DeleteFileW(temp);
+    }
+    OV_ARRAY_DESTROY(&temp);
+  }
+  if (b.p) {
+    OV_FREE(&b.p);
+  }
+  return result;
+}
+
+static void probe_entry(struct ovl_audio_scan_entry *const e) {
+  struct ovl_source *source = NULL;
+  struct ov_error err = {0};
+  bool ok = false;
+
+  {
+    if (!ovl_source_file_create(e->path, &source, &err)) {
+      OV_ERROR_ADD_TRACE(&err);
+      goto cleanup;
+    }
+    if (!ovl_audio_probe(source, &e->info, &e->estimated, &err)) {
+      OV_ERROR_ADD_TRACE(&err);
+      goto cleanup;
+    }
+  }
+  ok = true;
+
+cleanup:
+  if (source) {
+    ovl_source_destroy(&source);
+  }
+  if (!ok) {
+    OV_ERROR_REPORT(&err, NULL);
+    e->info = empty_info();
+    e->estimated = false;
+  }
+  e->valid = ok;
+}
+
+static int pool_thread(void *const userdata) {
+  struct pool *const p = (struct pool *)userdata;
+  for (;;) {
+    size_t const index = atomic_fetch_add_explicit(&p->next, 1, memory_order_relaxed);
+    if (index >= p->count) {
+      break;
+    }
+    probe_entry(&p->entries[p->pending[index]]);
+  }
+  return 0;
+}
+
+static NODISCARD bool probe_pending(struct ovl_audio_scan_entry *const entries,
+                                    size_t const *const pending,
+                                    size_t const count,
+                                    size_t const threads,
+                                    struct ov_error *const err) {
+  struct pool p = {
+      .entries = entries,
+      .pending = pending,
+      .count = count,
+  };
+  atomic_init(&p.next, 0);
+  thrd_t *workers = NULL;
+  size_t started = 0;
+  bool result = false;
+
+  {
+    size_t const n = min2(threads ? threads : ovl_os_get_cpu_count(), count);
+    if (n > 1) {
+      if (!OV_REALLOC(&workers, n - 1, sizeof(thrd_t))) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        goto cleanup;
+      }
+      // A thread that cannot be created only makes the scan slower; the calling thread always takes part.
+      while (started < n - 1 && thrd_create(&workers[started], pool_thread, &p) == thrd_success) {
+        ++started;
+      }
+    }
+    pool_thread(&p);
+  }
+  result = true;
+
+cleanup:
+  for (size_t i = 0; i < started; ++i) {
+    thrd_join(workers[i], NULL);
+  }
+  if (workers) {
+    OV_FREE(&workers);
+  }
+  return result;
+}
+
+NODISCARD bool ovl_audio_scan(NATIVE_CHAR const *const root,
+                              struct ovl_audio_scan_options const *const options,
+                              struct ovl_audio_scan **const sp,
+                              struct ov_error *const err) {
+  if (!root || !sp || *sp) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct ovl_audio_scan *s = NULL;
+  struct cache c = {0};
+  size_t *pending = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&s, 1, sizeof(struct ovl_audio_scan))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    *s = (struct ovl_audio_scan){0};
+    if (!walk(s, root, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    wchar_t const *const cache_path = options ? options->cache_path : NULL;
+    if (cache_path) {
+      struct ov_error cache_err = {0};
+      if (!cache_load(&c, cache_path, &cache_err)) {
+        OV_ERROR_ADD_TRACE(&cache_err);
+        OV_ERROR_REPORT(&cache_err, NULL);
+        cache_free(&c);
+      }
+    }
+    if (!cache_index(&c, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (s->info.entries && !OV_REALLOC(&pending, s->info.entries, sizeof(size_t))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    for (size_t i = 0; i < s->info.entries; ++i) {
+      struct ovl_audio_scan_entry *const e = &s->entries[i];
+      struct ovl_audio_scan_entry *const hit = cache_find(&c, e->path);
+      if (!hit || hit->size != e->size || hit->modified != e->modified) {
+        pending[s->info.probed++] = i;
+        continue;
+      }
+      e->info = hit->info;
+      e->valid = hit->valid;
+      e->estimated = hit->estimated;
+      e->cached = true;
+      hit->info.tag.title = NULL;
+      hit->info.tag.artist = NULL;
+      OV_ARRAY_DESTROY(&hit->path);
+      ++s->info.cached;
+    }
+    if (!probe_pending(s->entries, pending, s->info.probed, options ? options->threads : 0, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    for (size_t i = 0; i < s->info.entries; ++i) {
+      if (!s->entries[i].valid) {
+        ++s->info.failed;
+      }
+    }
+    if (cache_path) {
+      struct ov_error cache_err = {0};
+      if (!cache_save(s, cache_path, &cache_err)) {
+        OV_ERROR_ADD_TRACE(&cache_err);
+        OV_ERROR_REPORT(&cache_err, NULL);
+      }
+    }
+    *sp = s;
+    s = NULL;
+  }
+  result = true;
+
+cleanup:
+  if (pending) {
+    OV_FREE(&pending);
+  }
+  cache_free(&c);
+  ovl_audio_scan_destroy(&s);
+  return result;
+}
+
+void ovl_audio_scan_destroy(struct ovl_audio_scan **const sp) {
+  if (!sp || !*sp) {
+    return;
+  }
+  struct ovl_audio_scan *const s = *sp;
+  for (size_t i = 0; i < s->info.entries; ++i) {
+    entry_free(&s->entries[i]);
+  }
+  if (s->entries) {
+    OV_FREE(&s->entries);
+  }
+  OV_FREE(sp);
+}
+
+struct ovl_audio_scan_info const *ovl_audio_scan_get_info(struct ovl_audio_scan const *const s) {
+  return s ? &s->info : NULL;
+}
+
+struct ovl_audio_scan_entry const *ovl_audio_scan_get_entries(struct ovl_audio_scan const *const s) {
+  return s ? s->entries : NULL;
+}
+
+#endif
@@ -0,0 +1,176 @@
+#include <ovtest.h>
+
+#include <ovl/audio/scan.h>
+#include <ovl/path.h>
+
+#include <ovarray.h>
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#ifndef TESTDATADIR
+#  define TESTDATADIR NSTR(".")
+#endif
+
+// A small library: four readable files, one that is not audio despite its name and one that is skipped.
+static struct {
+  NATIVE_CHAR const *src;
+  NATIVE_CHAR const *name;
+} const library[] = {
+    {TESTDATADIR NSTR("/test.flac"), NSTR("a.flac")},
+    {TESTDATADIR NSTR("/test.mp3"), NSTR("sub\\b.MP3")},
+    {TESTDATADIR NSTR("/test.ogg"), NSTR("sub\\c.ogg")},
+    {TESTDATADIR NSTR("/test.opus"), NSTR("sub\\deeper\\d.opus")},
+    {TESTDATADIR NSTR("/test_hello.txt"), NSTR("broken.wav")},
+    {TESTDATADIR NSTR("/test_hello.txt"), NSTR("notes.txt")},
+};
+
+static NATIVE_CHAR const *const dirs[] = {NSTR("sub\\deeper"), NSTR("sub"), NSTR("")};
+
+static void make_path(NATIVE_CHAR *const dest, NATIVE_CHAR const *const root, NATIVE_CHAR const *const name) {
+  wcscpy(dest, root);
+  wcscat(dest, name);
+}
+
+static struct ovl_audio_scan_entry const *find_entry(struct ovl_audio_scan const *const s,
+                                                     NATIVE_CHAR const *const name) {
+  struct ovl_audio_scan_info const *const info = ovl_audio_scan_get_info(s);
+  struct ovl_audio_scan_entry const *const entries = ovl_audio_scan_get_entries(s);
+  for (size_t i = 0; i < info->entries; ++i) {
+    if (wcscmp(ovl_path_extract_file_name(entries[i].path), name) == 0) {
+      return &entries[i];
+    }
+  }
+  return NULL;
+}
+
+static bool scan(NATIVE_CHAR const *const root,
+                 NATIVE_CHAR const *const cache,
+                 size_t const entries,
+                 size_t const probed,
+                 size_t const cached,
+                 struct ovl_audio_scan **const sp) {
+  struct ov_error err = {0};
+  struct ovl_audio_scan_options const options = {.cache_path = cache, .threads = 3};
+  if (!TEST_SUCCEEDED(ovl_audio_scan(root, &options, sp, &err), &err)) {
+    return false;
+  }
+  struct ovl_audio_scan_info const *const info = ovl_audio_scan_get_info(*sp);
+  bool const ok = info->entries == entries && info->probed == probed && info->cached == cached && info->failed == 1;
+  TEST_CHECK(ok);
+  TEST_MSG("entries %zu (want %zu), probed %zu (want %zu), cached %zu (want %zu), failed %zu (want 1)",
+           info->entries,
+           entries,
+           info->probed,
+           probed,
+           info->cached,
+           cached,
+           info->failed);
+  return ok;
+}
+
+static void rescan_uses_cache(void) {
+  NATIVE_CHAR *temp = NULL;
+  struct ovl_audio_scan *s = NULL;
+  struct ov_error err = {0};
+  NATIVE_CHAR root[MAX_PATH] = {0};
+  NATIVE_CHAR cache[MAX_PATH] = {0};
+  NATIVE_CHAR path[MAX_PATH];
+
+  if (!TEST_SUCCEEDED(ovl_path_get_temp_directory(&temp, &err), &err)) {
+    goto cleanup;
+  }
+  make_path(root, temp, NSTR("ovl_test_scan\\"));
+  make_path(cache, temp, NSTR("ovl_test_scan.cache"));
+  DeleteFileW(cache);
+  for (size_t i = sizeof(dirs) / sizeof(dirs[0]); i-- > 0;) {
+    make_path(path, root, dirs[i]);
+    CreateDirectoryW(path, NULL);
+  }
+  for (size_t i = 0; i < sizeof(library) / sizeof(library[0]); ++i) {
+    make_path(path, root, library[i].name);
+    if (!TEST_CHECK(CopyFileW(library[i].src, path, FALSE))) {
+      goto cleanup;
+    }
+  }
+
+  // The first scan reads every audio file and fills the cache.
+  if (!scan(root, cache, 5, 5, 0, &s)) {
+    goto cleanup;
+  }
+  struct ovl_audio_scan_entry const *e = find_entry(s, NSTR("b.MP3"));
+  TEST_CHECK(e && e->valid && !e->cached && !e->estimated && e->info.sample_rate == 48000 && e->info.samples > 0);
+  TEST_CHECK(e && e->info.tag.title && strcmp(e->info.tag.title, "タイトル") == 0);
+  e = find_entry(s, NSTR("broken.wav"));
+  TEST_CHECK(e && !e->valid);
+  TEST_CHECK(find_entry(s, NSTR("notes.txt")) == NULL);
+  e = find_entry(s, NSTR("c.ogg"));
+  uint64_t const ogg_samples = e ? e->info.samples : 0;
+  e = find_entry(s, NSTR("d.opus"));
+  uint64_t const opus_samples = e ? e->info.samples : 0;
+  ovl_audio_scan_destroy(&s);
+
+  // Nothing changed, so nothing is opened, and the cached entries carry the same information.
+  if (!scan(root, cache, 5, 0, 5, &s)) {
+    goto cleanup;
+  }
+  e = find_entry(s, NSTR("b.MP3"));
+  TEST_CHECK(e && e->valid && e->cached && e->info.sample_rate == 48000 && e->info.channels == 2);
+  TEST_CHECK(e && e->info.tag.title && strcmp(e->info.tag.title, "タイトル") == 0);
+  e = find_entry(s, NSTR("broken.wav"));
+  TEST_CHECK(e && !e->valid && e->cached);
+  e = find_entry(s, NSTR("c.ogg"));
+  TEST_CHECK(e && e->cached && e->info.samples == ogg_samples);
+  ovl_audio_scan_destroy(&s);
+
+  // A file whose size changed is read again.
+  make_path(path, root, NSTR("sub\\c.ogg"));
+  if (!TEST_CHECK(CopyFileW(TESTDATADIR NSTR("/test.opus"), path, FALSE))) {
+    goto cleanup;
+  }
+  if (!scan(root, cache, 5, 1, 4, &s)) {
+    goto cleanup;
+  }
+  e = find_entry(s, NSTR("c.ogg"));
+  TEST_CHECK(e && e->valid && !e->cached && e->info.samples == opus_samples);
+  ovl_audio_scan_destroy(&s);
+
+  // Without a cache every file is read.
+  scan(root, NULL, 5, 5, 0, &s);
+
+cleanup:
+  ovl_audio_scan_destroy(&s);
+  if (temp) {
+    for (size_t i = 0; i < sizeof(library) / sizeof(library[0]); ++i) {
+      make_path(path, root, library[i].name);
+      DeleteFileW(path);
+    }
+    for (size_t i = 0; i < sizeof(dirs) / sizeof(dirs[0]); ++i) {
+      make_path(path, root, dirs[i]);
+      RemoveDirectoryW(path);
+    }
+    DeleteFileW(cache);
+    OV_ARRAY_DESTROY(&temp);
+  }
+}
+
+static void missing_root(void) {
+  struct ovl_audio_scan *s = NULL;
+  struct ov_error err = {0};
+  TEST_FAILED_WITH(ovl_audio_scan(NULL, NULL, &s, &err),
+                   &err,
+                   ov_error_type_generic,
+                   ov_error_generic_invalid_argument);
+  TEST_FAILED_WITH(ovl_audio_scan(TESTDATADIR NSTR("/no such directory"), NULL, &s, &err),
+                   &err,
+                   ov_error_type_hresult,
+                   HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND));
+  TEST_CHECK(s == NULL);
+}
+
+TEST_LIST = {
+    {"rescan_uses_cache", rescan_uses_cache},
+    {"missing_root", missing_root},
+    {NULL, NULL},
+};
@@ -0,0 +1,212 @@
+#include <ovl/audio/silence.h>
+
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+
+#include <math.h>
+#include <ovmo.h>
+
+#include "silence_kernel.h"
+
+// The scanner takes the maximum absolute value of each tile of samples with the vector kernel and only looks
+// at single samples in tiles that have a loud one: forward to the first loud sample, which ends the silent run
+// before it, and backward to the last, which starts the next. A run that lies inside one tile is never seen,
+// so tiles are no longer than the minimum region length.
+
+enum {
+  max_tile = 1024,
+};
+
+struct ovl_audio_silence {
+  struct ovl_audio_silence_info info;
+  struct ovl_audio_silence_region *regions;
+  size_t regions_cap;
+};
+
+struct scanner {
+  silence_max_abs_func max_abs;
+  float threshold;
+  uint64_t min_length;
+  size_t tile;
+  size_t channels;
+  uint64_t position;
+  uint64_t first_loud;
+  uint64_t loud_end;
+};
+
+static inline size_t min2(size_t const a, size_t const b) { return a < b ? a : b; }
+
+static inline bool
+is_loud(float const *const *const pcm, size_t const channels, size_t const i, float const threshold) {
+  for (size_t ch = 0; ch < channels; ++ch) {
+    if (fabsf(pcm[ch][i]) > threshold) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static NODISCARD bool
+add_region(struct ovl_audio_silence *const s, uint64_t const start, uint64_t const end, struct ov_error *const err) {
+  if (s->info.regions == s->regions_cap) {
+    size_t const cap = s->regions_cap ? s->regions_cap * 2 : 64;
+    if (!OV_REALLOC(&s->regions, cap, sizeof(struct ovl_audio_silence_region))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      return false;
+    }
+    s->regions_cap = cap;
+  }
+  s->regions[s->info.regions++] = (struct ovl_audio_silence_region){.start = start, .end = end};
+  return true;
+}
+
+static NODISCARD bool scanner_feed(struct scanner *const sc,
+                                   struct ovl_audio_silence *const s,
+                                   float const *const *const pcm,
+                                   size_t const n,
+                                   struct ov_error *const err) {
+  for (size_t off = 0; off < n; off += sc->tile) {
+    size_t const len = min2(sc->tile, n - off);
+    float m = 0.f;
+    for (size_t ch = 0; ch < sc->channels; ++ch) {
+      m = sc->max_abs(pcm[ch] + off, len, m);
+    }
+    if (!(m > sc->threshold)) {
+      continue;
+    }
+    uint64_t const t = sc->position + off;
+    // The silent run since loud_end can only be long enough if it reaches into this tile far enough.
+    if (sc->first_loud == UINT64_MAX || t + len - sc->loud_end >= sc->min_length) {
+      size_t f = 0;
+      while (!is_loud(pcm, sc->channels, off + f, sc->threshold)) {
+        ++f;
+      }
+      uint64_t const start = t + f;
+      if (sc->first_loud == UINT64_MAX) {
+        sc->first_loud = start;
+      }
+      if (start - sc->loud_end >= sc->min_length && !add_region(s, sc->loud_end, start, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        return false;
+      }
+    }
+    size_t l = len;
+    while (!is_loud(pcm, sc->channels, off + l - 1, sc->threshold)) {
+      --l;
+    }
+    sc->loud_end = t + l;
+  }
+  sc->position += n;
+  return true;
+}
+
+NODISCARD bool ovl_audio_silence_scan(struct ovl_audio_decoder *const decoder,
+                                      float const threshold,
+                                      uint64_t const min_length,
+                                      struct ovl_audio_silence **const sp,
+                                      struct ov_error *const err) {
+  if (!decoder || !(threshold >= 0.f) || !sp || *sp) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct ovl_audio_silence *s = NULL;
+  bool result = false;
+
+  {
+    struct ovl_audio_info const *const info = ovl_audio_decoder_get_info(decoder);
+    if (!info || info->channels == 0) {
+      OV_ERROR_SET(err, ov_error_type_generic, ov_error_generic_fail, gettext("Unsupported channel count"));
+      goto cleanup;
+    }
+    if (!OV_REALLOC(&s, 1, sizeof(struct ovl_audio_silence))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    *s = (struct ovl_audio_silence){0};
+    uint64_t const min = min_length ? min_length : 1;
+    struct scanner sc = {
+        .max_abs = silence_max_abs_get_best(),
+        .threshold = threshold,
+        .min_length = min,
+        .tile = min < max_tile ? (size_t)min : max_tile,
+        .channels = info->channels,
+        .first_loud = UINT64_MAX,
+    };
+    if (!ovl_audio_decoder_seek(decoder, 0, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    for (;;) {
+      float const *const *pcm = NULL;
+      size_t n = 0;
+      if (!ovl_audio_decoder_read(decoder, &pcm, &n, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+      if (n == 0) {
+        break;
+      }
+      if (!scanner_feed(&sc, s, pcm, n, err)) {
+        OV_ERROR_ADD_TRACE(err);
+        goto cleanup;
+      }
+    }
+    if (sc.position - sc.loud_end >= min && !add_region(s, sc.loud_end, sc.position, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    s->info.samples = sc.position;
+    if (sc.first_loud != UINT64_MAX) {
+      s->info.content_start = sc.first_loud;
+      s->info.content_end = sc.loud_end;
+    }
+    *sp = s;
+    s = NULL;
+  }
+  result = true;
+
+cleanup:
+  ovl_audio_silence_destroy(&s);
+  return result;
+}
+
+void ovl_audio_silence_destroy(struct ovl_audio_silence **const sp) {
+  if (!sp || !*sp) {
+    return;
+  }
+  struct ovl_audio_silence *const s = *sp;
+  if (s->regions) {
+    OV_FREE(&s->regions);
+  }
+  OV_FREE(sp);
+}
+
+struct ovl_audio_silence_info const *ovl_audio_silence_get_info(struct ovl_audio_silence const *const s) {
+  return s ? &s->info : NULL;
+}
+
+struct ovl_audio_silence_region const *ovl_audio_silence_get_regions(struct ovl_audio_silence const *const s) {
+  return s ? s->regions : NULL;
+}
+
+uint64_t ovl_audio_silence_skip(struct ovl_audio_silence const *const s, uint64_t const position) {
+  if (!s || s->info.regions == 0) {
+    return position;
+  }
+  // Finds the last region that starts at or before position.
+  size_t lo = 0;
+  size_t hi = s->info.regions;
+  while (lo < hi) {
+    size_t const mid = lo + (hi - lo) / 2;
+    if (s->regions[mid].start <= position) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo > 0 && position < s->regions[lo - 1].end) {
+    return s->regions[lo - 1].end;
+  }
+  return position;
+}
@@ -0,0 +1,143 @@
+#include "silence_kernel.h"
+
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define SILENCE_KERNEL_X86 1
+#  include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define SILENCE_KERNEL_NEON 1
+#  include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#  define SILENCE_KERNEL_WASM 1
+#  include <wasm_simd128.h>
+#endif
+
+// Every variant keeps two accumulators of one vector each so consecutive maxima do not wait on each other,
+// folds them at the end and leaves the remainder to the scalar loop. A maximum does not depend on the order
+// it is taken in, so all variants return the same value; NaN is skipped by comparing, never by propagating.
+
+static float scalar_max_abs(float const *const src, size_t const n, float peak) {
+  for (size_t i = 0; i < n; ++i) {
+    float const a = fabsf(src[i]);
+    peak = a > peak ? a : peak;
+  }
+  return peak;
+}
+
+#ifdef SILENCE_KERNEL_X86
+
+static __attribute__((target("sse2"))) float sse2_max_abs(float const *const src, size_t const n, float peak) {
+  __m128 const mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 m0 = _mm_set1_ps(peak);
+  __m128 m1 = m0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    // Keeps m where the sample is NaN, as the scalar comparison does.
+    m0 = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(src + i), mask), m0);
+    m1 = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(src + i + 4), mask), m1);
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, _mm_max_ps(m0, m1));
+  for (size_t j = 0; j < 4; ++j) {
+    peak = lanes[j] > peak ? lanes[j] : peak;
+  }
+  return scalar_max_abs(src + i, n - i, peak);
+}
+
+static __attribute__((target("avx2"))) float avx2_max_abs(float const *const src, size_t const n, float peak) {
+  __m256 const mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 m0 = _mm256_set1_ps(peak);
+  __m256 m1 = m0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    m0 = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(src + i), mask), m0);
+    m1 = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(src + i + 8), mask), m1);
+  }
+  float lanes[8];
+  _mm256_storeu_ps(lanes, _mm256_max_ps(m0, m1));
+  for (size_t j = 0; j < 8; ++j) {
+    peak = lanes[j] > peak ? lanes[j] : peak;
+  }
+  _mm256_zeroupper();
+  return sse2_max_abs(src + i, n - i, peak);
+}
+
+#endif // SILENCE_KERNEL_X86
+
+#ifdef SILENCE_KERNEL_NEON
+
+static float neon_max_abs(float const *const src, size_t const n, float peak) {
+  float32x4_t m0 = vdupq_n_f32(peak);
+  float32x4_t m1 = m0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    // vmaxq_f32 would propagate NaN; the comparison keeps m instead, as the scalar code does.
+    float32x4_t const a0 = vabsq_f32(vld1q_f32(src + i));
+    float32x4_t const a1 = vabsq_f32(vld1q_f32(src + i + 4));
+    m0 = vbslq_f32(vcgtq_f32(a0, m0), a0, m0);
+    m1 = vbslq_f32(vcgtq_f32(a1, m1), a1, m1);
+  }
+  float lanes[8];
+  vst1q_f32(lanes, m0);
+  vst1q_f32(lanes + 4, m1);
+  for (size_t j = 0; j < 8; ++j) {
+    peak = lanes[j] > peak ? lanes[j] : peak;
+  }
+  return scalar_max_abs(src + i, n - i, peak);
+}
+
+#endif // SILENCE_KERNEL_NEON
+
+#ifdef SILENCE_KERNEL_WASM
+
+static float simd128_max_abs(float const *const src, size_t const n, float peak) {
+  v128_t m0 = wasm_f32x4_splat(peak);
+  v128_t m1 = m0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    // pmax is m < a ? a : m, which keeps m where a is NaN.
+    m0 = wasm_f32x4_pmax(m0, wasm_f32x4_abs(wasm_v128_load(src + i)));
+    m1 = wasm_f32x4_pmax(m1, wasm_f32x4_abs(wasm_v128_load(src + i + 4)));
+  }
+  float lanes[8];
+  wasm_v128_store(lanes, m0);
+  wasm_v128_store(lanes + 4, m1);
+  for (size_t j = 0; j < 8; ++j) {
+    peak = lanes[j] > peak ? lanes[j] : peak;
+  }
+  return scalar_max_abs(src + i, n - i, peak);
+}
+
+#endif // SILENCE_KERNEL_WASM
+
+static silence_max_abs_func const kernels[kernel_isa_count] = {
+    [kernel_isa_scalar] = scalar_max_abs,
+#ifdef SILENCE_KERNEL_X86
+    [kernel_isa_sse2] = sse2_max_abs,
+    [kernel_isa_avx2] = avx2_max_abs,
+#endif
+#ifdef SILENCE_KERNEL_NEON
+    [kernel_isa_neon] = neon_max_abs,
+#endif
+#ifdef SILENCE_KERNEL_WASM
+    [kernel_isa_simd128] = simd128_max_abs,
+#endif
+};
+
+silence_max_abs_func silence_max_abs_get(enum kernel_isa const isa) {
+  if ((size_t)isa >= kernel_isa_count || !kernel_isa_supported(isa)) {
+    return NULL;
+  }
+  return kernels[isa];
+}
+
+silence_max_abs_func silence_max_abs_get_best(void) {
+  for (size_t i = 0; i < kernel_isa_count; ++i) {
+    silence_max_abs_func const k = silence_max_abs_get(kernel_isa_preference[i]);
+    if (k) {
+      return k;
+    }
+  }
+  return scalar_max_abs;
+}
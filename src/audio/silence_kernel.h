@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include "kernel.h"
+
+/**
+ * @brief Finds the highest absolute sample value.
+ * @param src Samples, no alignment required.
+ * @param n Number of samples.
+ * @param peak The peak so far.
+ * @return The larger of peak and the highest absolute value in src. NaN samples are ignored.
+ */
+typedef float (*silence_max_abs_func)(float const *const src, size_t const n, float const peak);
+
+/**
+ * @brief Returns the kernel for the given instruction set.
+ * @return The kernel, or NULL if the instruction set is not compiled in or not supported by the running CPU.
+ */
+silence_max_abs_func silence_max_abs_get(enum kernel_isa const isa);
+
+/**
+ * @brief Returns the fastest kernel supported by the running CPU.
+ */
+silence_max_abs_func silence_max_abs_get_best(void);
@@ -0,0 +1,75 @@
+#include <ovtest.h>
+
+#include "silence_kernel.h"
+
+#include <math.h>
+#include <string.h>
+
+static struct {
+  char const *name;
+  enum kernel_isa isa;
+} const isas[] = {
+    {"scalar", kernel_isa_scalar},
+    {"sse2", kernel_isa_sse2},
+    {"avx2", kernel_isa_avx2},
+    {"neon", kernel_isa_neon},
+    {"simd128", kernel_isa_simd128},
+};
+
+enum {
+  max_samples = 1031,
+};
+
+static float src[max_samples];
+
+static uint32_t xorshift(uint32_t *const state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static void max_abs_matches_scalar(void) {
+  static size_t const sample_counts[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, max_samples};
+  uint32_t state = 0x9e3779b9;
+  for (size_t i = 0; i < max_samples; ++i) {
+    src[i] = (float)(xorshift(&state) & 0xffff) / 32768.f - 1.f;
+  }
+  // A NaN and a negative spike, each at a different position within a vector; the kernels have to skip the one
+  // and find the other.
+  src[21] = NAN;
+  src[701] = -3.f;
+  silence_max_abs_func const scalar = silence_max_abs_get(kernel_isa_scalar);
+  if (!TEST_CHECK(scalar != NULL)) {
+    return;
+  }
+  for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); ++i) {
+    silence_max_abs_func const k = silence_max_abs_get(isas[i].isa);
+    if (!k) {
+      TEST_MSG("%s is not available", isas[i].name);
+      continue;
+    }
+    for (size_t s = 0; s < sizeof(sample_counts) / sizeof(sample_counts[0]); ++s) {
+      size_t const n = sample_counts[s];
+      for (size_t offset = 0; offset < 3; ++offset) {
+        size_t const len = n > offset ? n - offset : 0;
+        float const ref = scalar(src + offset, len, 0.25f);
+        float const out = k(src + offset, len, 0.25f);
+        if (!TEST_CHECK(memcmp(&ref, &out, sizeof(float)) == 0)) {
+          TEST_MSG("%s samples=%zu offset=%zu: want %g got %g", isas[i].name, len, offset, (double)ref, (double)out);
+          return;
+        }
+      }
+    }
+  }
+  float const peak = scalar(src, max_samples, 0.f);
+  TEST_CHECK(peak > 2.99f && peak < 3.01f);
+  TEST_MSG("peak=%g", (double)peak);
+}
+
+TEST_LIST = {
+    {"max_abs_matches_scalar", max_abs_matches_scalar},
+    {NULL, NULL},
+};
@@ -0,0 +1,264 @@
+#include <ovtest.h>
+
+#include "../test_util.h"
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
+#include <ovl/audio/silence.h>
+
+#include <math.h>
+
+enum {
+  max_channels = 3,
+  max_samples = 300000,
+  max_regions = max_samples,
+};
+
+static float const threshold = 0.001f;
+
+static float buffer[max_channels][max_samples];
+static float const *const planes[max_channels] = {buffer[0], buffer[1], buffer[2]};
+
+/**
+ * Scans the first samples of buffer, read in sizes that cut tiles at every possible place.
+ */
+static NODISCARD bool scan(size_t const channels,
+                           size_t const samples,
+                           float const level,
+                           uint64_t const min_length,
+                           struct ovl_audio_silence **const sp,
+                           struct ov_error *const err) {
+  static size_t const sizes[] = {1000, 333, 4096, 1, 2048, 77};
+  struct ovl_audio_decoder *d = NULL;
+  bool result = false;
+
+  {
+    if (!test_util_decoder_create(
+            &(struct test_util_decoder_options){
+                .channels = channels,
+                .sample_rate = 48000,
+                .samples = samples,
+                .position = 123,
+                .read_sizes = sizes,
+                .read_sizes_len = sizeof(sizes) / sizeof(sizes[0]),
+                .planes = planes,
+                .period = max_samples,
+            },
+            &d,
+            err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+    if (!ovl_audio_silence_scan(d, level, min_length, sp, err)) {
+      OV_ERROR_ADD_TRACE(err);
+      goto cleanup;
+    }
+  }
+  result = true;
+
+cleanup:
+  if (d) {
+    ovl_audio_decoder_destroy(&d);
+  }
+  return result;
+}
+
+static uint32_t xorshift(uint32_t *const state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static float uniform(uint32_t *const state) { return (float)(xorshift(state) & 0xffff) / 32768.f - 1.f; }
+
+// Alternates loud and silent stretches of very different lengths. Loud stretches cross zero, so some of their
+// samples are quiet too, and silent ones carry noise just below the threshold.
+static void fill_random(size_t const channels, size_t const samples) {
+  static size_t const spans[][2] = {{1, 20}, {50, 200}, {1000, 6000}};
+  uint32_t state = 0x12345678;
+  bool loud = (xorshift(&state) & 1) != 0;
+  size_t i = 0;
+  while (i < samples) {
+    size_t const *const span = spans[xorshift(&state) % 3];
+    size_t const len = span[0] + xorshift(&state) % (span[1] - span[0] + 1);
+    size_t const end = i + len < samples ? i + len : samples;
+    size_t const only = xorshift(&state) % (channels + 1);
+    for (; i < end; ++i) {
+      for (size_t ch = 0; ch < channels; ++ch) {
+        bool const active = loud && (only == channels || only == ch);
+        buffer[ch][i] = active ? uniform(&state) : uniform(&state) * threshold * 0.99f;
+      }
+    }
+    loud = !loud;
+  }
+}
+
+static size_t reference(size_t const channels,
+                        size_t const samples,
+                        uint64_t const min_length,
+                        struct ovl_audio_silence_info *const info,
+                        struct ovl_audio_silence_region *const regions) {
+  size_t count = 0;
+  uint64_t run_start = 0;
+  bool any = false;
+  *info = (struct ovl_audio_silence_info){.samples = samples};
+  for (size_t i = 0; i <= samples; ++i) {
+    bool loud = i == samples;
+    for (size_t ch = 0; ch < channels && !loud; ++ch) {
+      loud = fabsf(buffer[ch][i]) > threshold;
+    }
+    if (!loud) {
+      continue;
+    }
+    if (i - run_start >= min_length) {
+      regions[count++] = (struct ovl_audio_silence_region){.start = run_start, .end = i};
+    }
+    if (i < samples) {
+      if (!any) {
+        info->content_start = i;
+        any = true;
+      }
+      run_start = i + 1;
+      info->content_end = run_start;
+    }
+  }
+  info->regions = count;
+  return count;
+}
+
+static void matches_reference(void) {
+  static uint64_t const min_lengths[] = {1, 2, 7, 100, 1024, 1025, 3000, 100000};
+  static struct ovl_audio_silence_region expected[max_regions];
+  size_t const samples = max_samples;
+  for (size_t channels = 1; channels <= max_channels; ++channels) {
+    fill_random(channels, samples);
+    for (size_t m = 0; m < sizeof(min_lengths) / sizeof(min_lengths[0]); ++m) {
+      struct ov_error err = {0};
+      struct ovl_audio_silence *s = NULL;
+      if (!TEST_SUCCEEDED(scan(channels, samples, threshold, min_lengths[m], &s, &err), &err)) {
+        return;
+      }
+      struct ovl_audio_silence_info want;
+      size_t const count = reference(channels, samples, min_lengths[m], &want, expected);
+      struct ovl_audio_silence_info const *const got = ovl_audio_silence_get_info(s);
+      bool ok = got->samples == want.samples && got->content_start == want.content_start &&
+                got->content_end == want.content_end && got->regions == count;
+      TEST_CHECK(ok);
+      TEST_MSG("channels=%zu min=%llu: content %llu-%llu (want %llu-%llu), regions %zu (want %zu)",
+               channels,
+               (unsigned long long)min_lengths[m],
+               (unsigned long long)got->content_start,
+               (unsigned long long)got->content_end,
+               (unsigned long long)want.content_start,
+               (unsigned long long)want.content_end,
+               got->regions,
+               count);
+      if (ok) {
+        struct ovl_audio_silence_region const *const r = ovl_audio_silence_get_regions(s);
+        for (size_t i = 0; i < count && ok; ++i) {
+          ok = r[i].start == expected[i].start && r[i].end == expected[i].end;
+        }
+        TEST_CHECK(ok);
+        TEST_MSG("channels=%zu min=%llu: regions differ", channels, (unsigned long long)min_lengths[m]);
+      }
+      ovl_audio_silence_destroy(&s);
+    }
+  }
+}
+
+static void skip(void) {
+  struct ov_error err = {0};
+  struct ovl_audio_silence *s = NULL;
+  // 1000 silent, 1000 loud, 5000 silent, 1000 loud, then 500 silent, too short to be a region.
+  size_t const samples = 8500;
+  for (size_t i = 0; i < samples; ++i) {
+    bool const loud = (i >= 1000 && i < 2000) || (i >= 7000 && i < 8000);
+    buffer[0][i] = loud ? 0.5f : 0.f;
+  }
+  if (!TEST_SUCCEEDED(scan(1, samples, threshold, 1000, &s, &err), &err)) {
+    return;
+  }
+  struct ovl_audio_silence_info const *const info = ovl_audio_silence_get_info(s);
+  TEST_CHECK(info->samples == samples);
+  TEST_CHECK(info->content_start == 1000 && info->content_end == 8000);
+  TEST_CHECK(info->regions == 2);
+  static struct {
+    uint64_t position;
+    uint64_t expected;
+  } const cases[] = {
+      {0, 1000},
+      {999, 1000},
+      {1000, 1000},
+      {1999, 1999},
+      {2000, 7000},
+      {6999, 7000},
+      {7000, 7000},
+      {8200, 8200},
+      {UINT64_MAX, UINT64_MAX},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    uint64_t const got = ovl_audio_silence_skip(s, cases[i].position);
+    TEST_CHECK(got == cases[i].expected);
+    TEST_MSG("skip(%llu) = %llu, want %llu",
+             (unsigned long long)cases[i].position,
+             (unsigned long long)got,
+             (unsigned long long)cases[i].expected);
+  }
+  ovl_audio_silence_destroy(&s);
+}
+
+static void edges(void) {
+  struct ov_error err = {0};
+  struct ovl_audio_silence *s = NULL;
+
+  // All silence is one region and has no content.
+  for (size_t i = 0; i < 5000; ++i) {
+    buffer[0][i] = buffer[1][i] = 0.f;
+  }
+  if (TEST_SUCCEEDED(scan(2, 5000, threshold, 100, &s, &err), &err)) {
+    struct ovl_audio_silence_info const *const info = ovl_audio_silence_get_info(s);
+    struct ovl_audio_silence_region const *const r = ovl_audio_silence_get_regions(s);
+    TEST_CHECK(info->content_start == 0 && info->content_end == 0);
+    TEST_CHECK(info->regions == 1 && r[0].start == 0 && r[0].end == 5000);
+    ovl_audio_silence_destroy(&s);
+  }
+
+  // An empty stream has nothing at all.
+  if (TEST_SUCCEEDED(scan(2, 0, threshold, 0, &s, &err), &err)) {
+    struct ovl_audio_silence_info const *const info = ovl_audio_silence_get_info(s);
+    TEST_CHECK(info->samples == 0 && info->regions == 0);
+    TEST_CHECK(ovl_audio_silence_skip(s, 0) == 0);
+    ovl_audio_silence_destroy(&s);
+  }
+
+  // A threshold of 0 makes every sample that is not zero loud.
+  buffer[0][2500] = 1e-30f;
+  if (TEST_SUCCEEDED(scan(2, 5000, 0.f, 1, &s, &err), &err)) {
+    struct ovl_audio_silence_info const *const info = ovl_audio_silence_get_info(s);
+    TEST_CHECK(info->content_start == 2500 && info->content_end == 2501 && info->regions == 2);
+    ovl_audio_silence_destroy(&s);
+  }
+
+  TEST_FAILED_WITH(scan(2, 5000, -1.f, 1, &s, &err),
+                   &err,
+                   ov_error_type_generic,
+                   ov_error_generic_invalid_argument);
+  TEST_FAILED_WITH(scan(2, 5000, NAN, 1, &s, &err),
+                   &err,
+                   ov_error_type_generic,
+                   ov_error_generic_invalid_argument);
+  TEST_FAILED_WITH(ovl_audio_silence_scan(NULL, threshold, 1, &s, &err),
+                   &err,
+                   ov_error_type_generic,
+                   ov_error_generic_invalid_argument);
+  TEST_CHECK(s == NULL);
+}
+
+TEST_LIST = {
+    {"matches_reference", matches_reference},
+    {"skip", skip},
+    {"edges", edges},
+    {NULL, NULL},
+};
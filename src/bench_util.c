@@ -0,0 +1,94 @@
+#include "bench_util.h"
+
+#include <ovl/time.h>
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+// clang-format off
+#  include <psapi.h>
+// clang-format on
+#elif !defined(__wasi__)
+#  include <sys/resource.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define BENCH_UTIL_HAS_TSC 1
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  else
+#    include <x86intrin.h>
+#  endif
+#endif
+
+uint64_t bench_util_now_ns(void) { return ovl_time_monotonic_ns(); }
+
+uint64_t bench_util_peak_rss(void) {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc = {.cb = sizeof(pmc)};
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+    return 0;
+  }
+  return (uint64_t)pmc.PeakWorkingSetSize;
+#elif defined(__wasi__)
+  // getrusage is only available through wasi-libc's process clock emulation.
+  return 0;
+#else
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0) {
+    return 0;
+  }
+#  ifdef __APPLE__
+  return (uint64_t)ru.ru_maxrss;
+#  else
+  return (uint64_t)ru.ru_maxrss * 1024;
+#  endif
+#endif
+}
+
+uint64_t bench_util_cycles(void) {
+#ifdef BENCH_UTIL_HAS_TSC
+  return (uint64_t)__rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static int compare_u64(void const *const a, void const *const b) {
+  uint64_t const x = *(uint64_t const *)a;
+  uint64_t const y = *(uint64_t const *)b;
+  return x < y ? -1 : x > y ? 1 : 0;
+}
+
+void bench_util_sort_u64(uint64_t *const values, size_t const n) { qsort(values, n, sizeof(uint64_t), compare_u64); }
+
+uint64_t bench_util_percentile(uint64_t const *const sorted, size_t const n, size_t const percent) {
+  if (!n) {
+    return 0;
+  }
+  size_t rank = (percent * n + 99) / 100;
+  if (rank == 0) {
+    rank = 1;
+  }
+  return sorted[(rank > n ? n : rank) - 1];
+}
+
+static float volatile g_sink;
+
+void bench_util_consume(float const v) { g_sink = v; }
+
+void bench_util_json_string(FILE *const fp, char const *const s) {
+  fputc('"', fp);
+  for (char const *p = s; *p; ++p) {
+    unsigned char const c = (unsigned char)*p;
+    if (c == '"' || c == '\\') {
+      fputc('\\', fp);
+      fputc(c, fp);
+    } else if (c < 0x20) {
+      fprintf(fp, "\\u%04x", c);
+    } else {
+      fputc(c, fp);
+    }
+  }
+  fputc('"', fp);
+}
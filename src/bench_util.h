@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ovbase.h>
+
+#include <stdio.h>
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+uint64_t bench_util_now_ns(void);
+
+/**
+ * @brief Returns the peak resident set size of the process in bytes, or 0 if unavailable.
+ * The value is a process-wide high-water mark, so run a single case to attribute it.
+ */
+uint64_t bench_util_peak_rss(void);
+
+/**
+ * @brief Returns the CPU timestamp counter, or 0 where none is available.
+ * On x86 this is the TSC, which ticks at a constant rate close to the nominal clock,
+ * so cycle figures derived from it are comparable across runs on the same machine.
+ */
+uint64_t bench_util_cycles(void);
+
+/**
+ * @brief Sorts values in ascending order.
+ */
+void bench_util_sort_u64(uint64_t *const values, size_t const n);
+
+/**
+ * @brief Returns the nearest-rank percentile of sorted values.
+ * @param sorted Values sorted by bench_util_sort_u64.
+ * @param n Number of values.
+ * @param percent Percentile in the range 0 to 100.
+ */
+uint64_t bench_util_percentile(uint64_t const *const sorted, size_t const n, size_t const percent);
+
+/**
+ * @brief Deterministic pseudo random number generator (xorshift64*).
+ */
+static inline uint64_t bench_util_rand(uint64_t *const state) {
+  uint64_t x = *state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *state = x;
+  return x * UINT64_C(2685821657736338717);
+}
+
+/**
+ * @brief Makes the compiler believe the value is used so the work producing it is not optimized away.
+ */
+void bench_util_consume(float const v);
+
+/**
+ * @brief Writes a JSON string literal, escaping as needed.
+ */
+void bench_util_json_string(FILE *const fp, char const *const s);
@@ -0,0 +1,23 @@
+#include <ovl/os.h>
+
+#ifdef _WIN32
+
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+
+size_t ovl_os_get_cpu_count(void) {
+  SYSTEM_INFO si;
+  GetSystemInfo(&si);
+  return si.dwNumberOfProcessors ? (size_t)si.dwNumberOfProcessors : 1;
+}
+
+#else
+
+#  include <unistd.h>
+
+size_t ovl_os_get_cpu_count(void) {
+  long const n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (size_t)n : 1;
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include <ovl/os.h>
+
+#include <stdatomic.h>
+#include <string.h>
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <stdlib.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <cpuid.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#  include <intrin.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#  include <sys/auxv.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+static void cpuid(uint32_t const leaf, uint32_t const subleaf, uint32_t regs[4]) {
+#  ifdef _MSC_VER
+  int r[4];
+  __cpuidex(r, (int)leaf, (int)subleaf);
+  for (size_t i = 0; i < 4; ++i) {
+    regs[i] = (uint32_t)r[i];
+  }
+#  else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#  endif
+}
+
+static uint64_t xgetbv0(void) {
+#  ifdef _MSC_VER
+  return (uint64_t)_xgetbv(0);
+#  else
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((uint64_t)edx << 32) | eax;
+#  endif
+}
+
+// cpuid is used directly instead of __builtin_cpu_supports, which depends on a runtime library constructor
+// that is not always linked in static and compiler-rt builds.
+static uint32_t detect(void) {
+  uint32_t regs[4];
+  cpuid(0, 0, regs);
+  uint32_t const max_leaf = regs[0];
+  if (max_leaf < 1) {
+    return 0;
+  }
+  uint32_t features = 0;
+  cpuid(1, 0, regs);
+  if (regs[3] & (UINT32_C(1) << 26)) {
+    features |= ovl_os_cpu_feature_sse2;
+  }
+  // AVX state has to be enabled by the OS (OSXSAVE, and XCR0 saving XMM and YMM) before AVX2 is usable.
+  bool const osxsave = (regs[2] & (UINT32_C(1) << 27)) != 0;
+  bool const avx = (regs[2] & (UINT32_C(1) << 28)) != 0;
+  if (max_leaf >= 7 && osxsave && avx && (xgetbv0() & 6) == 6) {
+    cpuid(7, 0, regs);
+    if (regs[1] & (UINT32_C(1) << 5)) {
+      features |= ovl_os_cpu_feature_avx2;
+    }
+  }
+  return features;
+}
+
+#elif defined(__aarch64__) || defined(_M_ARM64)
+
+static uint32_t detect(void) {
+#  if defined(__linux__) && defined(HWCAP_ASIMD)
+  return (getauxval(AT_HWCAP) & HWCAP_ASIMD) ? ovl_os_cpu_feature_neon : 0;
+#  else
+  // Advanced SIMD is mandatory on AArch64.
+  return ovl_os_cpu_feature_neon;
+#  endif
+}
+
+#elif defined(__wasm__)
+
+static uint32_t detect(void) {
+  // WebAssembly has no runtime detection; a module built with -msimd128 does not load without SIMD support.
+#  ifdef __wasm_simd128__
+  return ovl_os_cpu_feature_simd128;
+#  else
+  return 0;
+#  endif
+}
+
+#else
+
+static uint32_t detect(void) { return 0; }
+
+#endif
+
+static uint32_t parse_override(char const *const s, uint32_t const detected) {
+  static struct {
+    char const *name;
+    uint32_t feature;
+  } const names[] = {
+      {"sse2", ovl_os_cpu_feature_sse2},
+      {"avx2", ovl_os_cpu_feature_avx2},
+      {"neon", ovl_os_cpu_feature_neon},
+      {"simd128", ovl_os_cpu_feature_simd128},
+  };
+  uint32_t allowed = 0;
+  char const *p = s;
+  while (*p) {
+    char const *const end = strchr(p, ',');
+    size_t const len = end ? (size_t)(end - p) : strlen(p);
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+      if (strlen(names[i].name) == len && strncmp(names[i].name, p, len) == 0) {
+        allowed |= names[i].feature;
+      }
+    }
+    p += len;
+    if (*p == ',') {
+      ++p;
+    }
+  }
+  return detected & allowed;
+}
+
+static uint32_t apply_override(uint32_t const detected) {
+#ifdef _WIN32
+  char buf[64];
+  DWORD const n = GetEnvironmentVariableA("OVL_CPU_FEATURES", buf, sizeof(buf));
+  if (n == 0 && GetLastError() == ERROR_ENVVAR_NOT_FOUND) {
+    return detected;
+  }
+  if (n >= sizeof(buf)) {
+    return detected;
+  }
+  buf[n] = '\0';
+  char const *const s = buf;
+#else
+  char const *const s = getenv("OVL_CPU_FEATURES");
+  if (!s) {
+    return detected;
+  }
+#endif
+  return parse_override(s, detected);
+}
+
+uint32_t ovl_os_get_cpu_features(void) {
+  // Detection is idempotent, so concurrent first calls may both run it and store the same value.
+  // UINT32_MAX is never a valid result because only the low bits are assigned.
+  static _Atomic uint32_t cached = UINT32_MAX;
+  uint32_t features = atomic_load_explicit(&cached, memory_order_relaxed);
+  if (features == UINT32_MAX) {
+    features = apply_override(detect());
+    atomic_store_explicit(&cached, features, memory_order_relaxed);
+  }
+  return features;
+}
@@ -0,0 +1,23 @@
+#include <ovtest.h>
+
+#include <ovl/os.h>
+
+static void test_get_cpu_count(void) { TEST_CHECK(ovl_os_get_cpu_count() >= 1); }
+
+static void test_get_cpu_features(void) {
+  uint32_t const features = ovl_os_get_cpu_features();
+  TEST_CHECK(ovl_os_get_cpu_features() == features);
+  uint32_t const known = ovl_os_cpu_feature_sse2 | ovl_os_cpu_feature_avx2 | ovl_os_cpu_feature_neon |
+                         ovl_os_cpu_feature_simd128;
+  TEST_CHECK((features & ~known) == 0);
+  if (features & ovl_os_cpu_feature_avx2) {
+    TEST_CHECK((features & ovl_os_cpu_feature_sse2) != 0);
+  }
+  TEST_MSG("features: 0x%x", (unsigned)features);
+}
+
+TEST_LIST = {
+    {"test_get_cpu_count", test_get_cpu_count},
+    {"test_get_cpu_features", test_get_cpu_features},
+    {NULL, NULL},
+};
@@ -213,3 +213,130 @@ bool test_util_write_wave_body_double(struct file *file,
   return true;
 }
 #endif
+
+static void test_decoder_destroy(struct ovl_audio_decoder **const dp) {
+  struct test_util_decoder **const ctxp = (struct test_util_decoder **)(void *)dp;
+  if (!ctxp || !*ctxp) {
+    return;
+  }
+  struct test_util_decoder *ctx = *ctxp;
+  if (ctx->buffer) {
+    OV_ALIGNED_FREE(&ctx->buffer);
+  }
+  if (ctx->pcm) {
+    OV_FREE(&ctx->pcm);
+  }
+  OV_FREE(ctxp);
+}
+
+static struct ovl_audio_info const *test_decoder_get_info(struct ovl_audio_decoder const *const d) {
+  struct test_util_decoder const *const ctx = (struct test_util_decoder const *)(void const *)d;
+  return &ctx->info;
+}
+
+static NODISCARD bool test_decoder_read(struct ovl_audio_decoder *const d,
+                                        float const *const **const pcm,
+                                        size_t *const samples,
+                                        struct ov_error *const err) {
+  (void)err;
+  struct test_util_decoder *const ctx = (struct test_util_decoder *)(void *)d;
+  struct test_util_decoder_options const *const opts = &ctx->opts;
+  size_t n = opts->read_sizes ? opts->read_sizes[ctx->reads++ % opts->read_sizes_len] : opts->chunk;
+  uint64_t const left = ctx->position < ctx->info.samples ? ctx->info.samples - ctx->position : 0;
+  if (left < n) {
+    n = (size_t)left;
+  }
+  if (opts->planes) {
+    size_t const offset = (size_t)(ctx->position % opts->period);
+    if (opts->period - offset < n) {
+      n = opts->period - offset;
+    }
+    for (size_t ch = 0; ch < ctx->info.channels; ++ch) {
+      ctx->pcm[ch] = opts->planes[ch] + offset;
+    }
+  } else {
+    for (size_t ch = 0; ch < ctx->info.channels; ++ch) {
+      float *const plane = ctx->buffer + ch * ctx->buffer_samples;
+      for (size_t i = 0; i < n; ++i) {
+        plane[i] = opts->value(opts->userdata, ctx->position + i, ch);
+      }
+      ctx->pcm[ch] = plane;
+    }
+  }
+  ctx->position += n;
+  *pcm = ctx->pcm;
+  *samples = n;
+  return true;
+}
+
+static NODISCARD bool
+test_decoder_seek(struct ovl_audio_decoder *const d, uint64_t const position, struct ov_error *const err) {
+  (void)err;
+  struct test_util_decoder *const ctx = (struct test_util_decoder *)(void *)d;
+  ctx->position = position;
+  return true;
+}
+
+static struct ovl_audio_decoder_vtable const test_decoder_vtable = {
+    .destroy = test_decoder_destroy,
+    .get_info = test_decoder_get_info,
+    .read = test_decoder_read,
+    .seek = test_decoder_seek,
+};
+
+NODISCARD bool test_util_decoder_create(struct test_util_decoder_options const *const opts,
+                                        struct ovl_audio_decoder **const dp,
+                                        struct ov_error *const err) {
+  if (!opts || !dp || *dp || !opts->channels || !opts->sample_rate || (!opts->read_sizes && !opts->chunk) ||
+      (opts->read_sizes && !opts->read_sizes_len) || !opts->planes == !opts->value || (opts->planes && !opts->period)) {
+    OV_ERROR_SET_GENERIC(err, ov_error_generic_invalid_argument);
+    return false;
+  }
+
+  struct test_util_decoder *ctx = NULL;
+  bool result = false;
+
+  {
+    if (!OV_REALLOC(&ctx, 1, sizeof(*ctx))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    *ctx = (struct test_util_decoder){
+        .vtable = &test_decoder_vtable,
+        .info =
+            {
+                .channels = opts->channels,
+                .sample_rate = opts->sample_rate,
+                .samples = opts->samples,
+                .tag = {.loop_start = UINT64_MAX, .loop_end = UINT64_MAX, .loop_length = UINT64_MAX},
+            },
+        .position = opts->position,
+        .opts = *opts,
+    };
+    if (!OV_REALLOC(&ctx->pcm, opts->channels, sizeof(float const *))) {
+      OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+      goto cleanup;
+    }
+    if (opts->value) {
+      ctx->buffer_samples = opts->chunk;
+      for (size_t i = 0; opts->read_sizes && i < opts->read_sizes_len; ++i) {
+        if (ctx->buffer_samples < opts->read_sizes[i]) {
+          ctx->buffer_samples = opts->read_sizes[i];
+        }
+      }
+      if (!OV_ALIGNED_ALLOC(&ctx->buffer, opts->channels * ctx->buffer_samples, sizeof(float), 16)) {
+        OV_ERROR_SET_GENERIC(err, ov_error_generic_out_of_memory);
+        goto cleanup;
+      }
+    }
+    *dp = (struct ovl_audio_decoder *)(void *)ctx;
+    ctx = NULL;
+  }
+  result = true;
+
+cleanup:
+  if (ctx) {
+    test_decoder_destroy((struct ovl_audio_decoder **)(void *)&ctx);
+  }
+  return result;
+}
@@ -4,6 +4,8 @@
 
 #include <stdio.h>
 
+#include <ovl/audio/decoder.h>
+#include <ovl/audio/info.h>
 #include <ovl/file.h>
 
 static inline enum ovl_file_seek_method test_util_convert_seek_method(int const whence) {
@@ -55,3 +57,54 @@ bool test_util_write_wave_body_double(struct ovl_file *file,
                                       double const *const *const data,
                                       size_t const samples,
                                       size_t const channels);
+
+struct test_util_decoder_options {
+  size_t channels;
+  size_t sample_rate;
+  uint64_t samples;
+  /**
+   * @brief Position before the first read.
+   */
+  uint64_t position;
+  /**
+   * @brief Samples per read, unless read_sizes is set.
+   */
+  size_t chunk;
+  /**
+   * @brief Sizes that successive reads cycle through, so consumers see blocks cut at varying places.
+   */
+  size_t const *read_sizes;
+  size_t read_sizes_len;
+  /**
+   * @brief Caller-owned planes of period samples that repeat for as long as the stream lasts.
+   *
+   * Reads return pointers into them, so no sample is copied.
+   */
+  float const *const *planes;
+  size_t period;
+  /**
+   * @brief Computes the sample at position on channel when planes is NULL.
+   */
+  float (*value)(void const *userdata, uint64_t position, size_t channel);
+  void const *userdata;
+};
+
+/**
+ * @brief An in-memory decoder that tests and benchmarks feed to the code under test.
+ *
+ * Destroy it with ovl_audio_decoder_destroy. Tests may cast it back to change info or position between reads.
+ */
+struct test_util_decoder {
+  struct ovl_audio_decoder_vtable const *vtable;
+  struct ovl_audio_info info;
+  uint64_t position;
+  struct test_util_decoder_options opts;
+  size_t reads;
+  float *buffer;
+  size_t buffer_samples;
+  float const **pcm;
+};
+
+NODISCARD bool test_util_decoder_create(struct test_util_decoder_options const *const opts,
+                                        struct ovl_audio_decoder **const dp,
+                                        struct ov_error *const err);
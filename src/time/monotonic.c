@@ -0,0 +1,37 @@
+#ifndef _WIN32
+// clock_gettime and CLOCK_MONOTONIC are POSIX, not part of strict C11.
+#  ifndef _POSIX_C_SOURCE
+#    define _POSIX_C_SOURCE 199309L
+#  endif
+#endif
+
+#include <ovl/time.h>
+
+#ifdef _WIN32
+
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+
+uint64_t ovl_time_monotonic_ns(void) {
+  static LARGE_INTEGER freq = {0};
+  if (!freq.QuadPart) {
+    QueryPerformanceFrequency(&freq);
+  }
+  LARGE_INTEGER c;
+  QueryPerformanceCounter(&c);
+  uint64_t const ticks = (uint64_t)c.QuadPart;
+  uint64_t const f = (uint64_t)freq.QuadPart;
+  return (ticks / f) * UINT64_C(1000000000) + (ticks % f) * UINT64_C(1000000000) / f;
+}
+
+#else
+
+#  include <time.h>
+
+uint64_t ovl_time_monotonic_ns(void) {
+  struct timespec ts = {0};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + (uint64_t)ts.tv_nsec;
+}
+
+#endif
@@ -184,6 +184,12 @@ static void test_now(void) {
   TEST_CHECK(buf[19] == 'Z');
 }
 
+static void test_monotonic(void) {
+  uint64_t const a = ovl_time_monotonic_ns();
+  uint64_t const b = ovl_time_monotonic_ns();
+  TEST_CHECK(b >= a);
+}
+
 static void test_format_null_buffer(void) { TEST_CHECK(ovl_time_format(1000000000000000ULL, NULL, 0) == NULL); }
 
 static void test_format_offsets(void) {
@@ -292,6 +298,7 @@ TEST_LIST = {
     {"test_roundtrip_with_tz", test_roundtrip_with_tz},
     {"test_microsecond_roundtrip", test_microsecond_roundtrip},
     {"test_now", test_now},
+    {"test_monotonic", test_monotonic},
     {"test_format_null_buffer", test_format_null_buffer},
     {"test_format_offsets", test_format_offsets},
     {"test_format_max_timestamp", test_format_max_timestamp},